@@ -48,6 +48,8 @@ public:
     void DrawBall(const BallData& b);
     void DrawRamp(const RampData& r);
     void DrawBlock(const BlockData& blk);
+    // one pixel per particle, written straight into the frame buffer (x, y in meters)
+    void DrawParticles(const float* x, const float* y, size_t count, COLORREF color);
 
     // coord transform
     int WorldToScreenX(double wx) const;
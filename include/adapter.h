@@ -53,7 +53,7 @@ enum PhysicsObjectType {
 // 当前方案：适配器维护自己的ID映射表
 struct ObjectConnection {
     int adapterId;          // 适配器分配的ID
-    Shape* physicsObject;   // 指向物理引擎中物体的指针
+    ShapeHandle physicsObject; // 物理引擎中物体的句柄（物体被删除后失效，不会悬空）
     PhysicsObjectType type; // 物体类型
     
     // 上一次同步的状态（用于变化检测）
@@ -66,19 +66,22 @@ struct ObjectConnection {
     double width, height; // 矩形宽高
     double length;      // 斜坡长度
     double slopeAngle;  // 斜坡角度
+    double mass;        // 质量
+    double friction;    // 摩擦系数
     
     // 可视化属性
     COLORREF color;
     bool isVisible;
     
     ObjectConnection() 
-        : adapterId(-1), physicsObject(nullptr), type(OBJ_GENERIC),
+        : adapterId(-1), physicsObject(), type(OBJ_GENERIC),
           lastX(0), lastY(0), lastVx(0), lastVy(0), lastAngle(0),
           radius(0), width(0), height(0), length(0), slopeAngle(0),
+          mass(1.0), friction(0.1),
           color(RGB(0, 0, 0)), isVisible(true) {}
     
-    // 从物理对象更新状态
-    void updateFromPhysics();
+    // 从物理对象更新状态；物体已从世界中删除时隐藏并返回 false
+    bool updateFromPhysics(const PhysicalWorld& world);
     
     // 转换为可视化数据
     BallData getBallData() const;
@@ -97,6 +100,8 @@ private:
     
     // 对象管理
     std::unordered_map<int, ObjectConnection> objectConnections; // ID->连接信息
+    std::unordered_map<uint32_t, int> objectIdByHandle;          // 物理对象句柄->ID（点选时使用）
+    mutable std::vector<Shape*> pickResults;                     // 点选查询结果（复用内存）
     int nextObjectId;                                            // 下一个可用的ID
     
     // UI状态
@@ -146,6 +151,12 @@ private:
                            COLORREF color,
                            bool isDynamic = true);
     
+    // 设置物体的初速度（场景初始化时使用）
+    void setObjectVelocity(int adapterId, double vx, double vy);
+    
+    // 用距离约束连接两个物体（链条，场景初始化时使用）
+    void connectObjects(int adapterIdA, int adapterIdB);
+    
     // 查找屏幕位置的物体
     int findObjectAtScreen(int screenX, int screenY) const;
     
@@ -0,0 +1,111 @@
+#ifndef _BODYSTORE_H_
+#define _BODYSTORE_H_
+
+#include <vector>
+#include <cstddef>
+#include "shapes.h"
+
+/*=========================================================================================================
+ * 物体状态的连续存储（BodyStore）
+ *
+ * 作用：Shape 是分散在堆上的多态对象，里面还有两个 std::string 等很少用到的数据，逐个遍历
+ *       std::vector<Shape*> 时每个物体都要跳转一次指针，并把这些冷数据一起读进缓存。
+ *       BodyStore 把每步都要读写的状态放进按槽位排列的平行数组（SoA）：
+ *         位置、速度、合力（各 2 个 double）、质量、标志位 —— 每个物体 57 字节
+ *       加入 PhysicalWorld 的物体，其 mass_centre / velocity / totalforce 指向这里对应的槽位，
+ *       原来的 Shape 接口（getCentre、setVelocity、mass_centre[0] ...）不变，只是变成了这些数组的视图；
+ *       updatePhysics 按槽位直接在数组上累加重力、积分速度和位置。
+ *
+ * 质量以原值保存（不是倒数）：积分时仍然计算 F / m，与 Shape::applyTotalForce 的结果逐位相同。
+ * 摩擦系数、恢复系数、几何尺寸只在被支撑的物体和碰撞处理中用到，仍然放在 Shape 中。
+ *
+ * 槽位紧凑排列：移出物体时用最后一个物体填补空位，并更新被移动物体的视图；
+ * 数组扩容后所有物体的视图都会重新指向新的数组。加入、移出只能在单线程中进行。
+ *=========================================================================================================*/
+
+// 标志位
+enum BodyFlag {
+	BODY_SUPPORTED = 1 << 0,   // 被地面或其他物体支撑（与 Shape::isSupported 同步）
+	BODY_STATIC    = 1 << 1,   // 静态形状：update() 不移动位置
+	BODY_CONSTRAINED = 1 << 2  // 连接着约束（见 constraint.h）：在空中时积分不截断反向的速度
+};
+
+class BodyStore {
+public:
+	BodyStore() {}
+	~BodyStore();   // 仍在其中的物体把状态复制回自己的 ownState
+
+	// 加入：状态复制到新的槽位，物体的视图指向槽位；已在其他 BodyStore 中时先从那里移出
+	void attach(Shape* shape);
+	// 移出：状态复制回物体自己的 ownState
+	void detach(Shape* shape);
+	void clear();
+
+	size_t size() const { return owners.size(); }
+	Shape* getShape(size_t slot) const { return owners[slot]; }
+
+	// 热数据：槽位 i 的位置为 position[2i], position[2i + 1]，速度、合力相同
+	double* positionData() { return position.data(); }
+	double* velocityData() { return velocity.data(); }
+	double* forceData() { return force.data(); }
+	const double* massData() const { return mass.data(); }
+	const unsigned char* flagData() const { return flags.data(); }
+
+	// 由 Shape 的设置方法调用，保持同步
+	void setMass(int slot, double m) { mass[slot] = m; }
+	void setFlag(int slot, unsigned char flag, bool value) {
+		flags[slot] = value ? (flags[slot] | flag) : (flags[slot] & ~flag);
+	}
+
+	// 休眠的物体被唤醒（Shape::wakeUp）时记下它的句柄，PhysicalWorld 在下一步开始时取走，
+	// 这样世界不需要每步检查所有物体是否还在休眠
+	void noteWoken(ShapeHandle handle) { if (!handle.isNull()) wokenHandles.push_back(handle); }
+	std::vector<ShapeHandle>& getWokenHandles() { return wokenHandles; }
+
+	// 每个物体在热数据数组中占用的字节数
+	static size_t hotBytesPerBody() { return 6 * sizeof(double) + sizeof(double) + sizeof(unsigned char); }
+
+private:
+	std::vector<double> position;
+	std::vector<double> velocity;
+	std::vector<double> force;
+	std::vector<double> mass;
+	std::vector<unsigned char> flags;
+	std::vector<Shape*> owners;
+	std::vector<ShapeHandle> wokenHandles;
+
+	void rebindAll();
+	void rebind(size_t slot);
+
+	BodyStore(const BodyStore&);
+	BodyStore& operator=(const BodyStore&);
+};
+
+/*=========================================================================================================
+ * 速度积分：v += (F / m) · dt，摩擦力导致速度反向时置 0，最后清空合力
+ * Shape::applyTotalForce 与 PhysicalWorld::updatePhysics 共用，保证两条路径的结果逐位相同
+ *=========================================================================================================*/
+inline void integrateBodyVelocity(double m, double* velocity, double* force, double deltaTime) {
+	if (m > 0.0) {
+		double ax = force[0] / m;
+		double ay = force[1] / m;
+		double new_vx = velocity[0] + ax * deltaTime;
+		double new_vy = velocity[1] + ay * deltaTime;
+
+		// 速度反向且加速度与原速度方向相反时，是摩擦力导致的过度减速，速度置 0
+		if (velocity[0] != 0.0 && new_vx * velocity[0] < 0) {
+			velocity[0] = (ax * velocity[0] < 0) ? 0.0 : new_vx;
+		} else {
+			velocity[0] = new_vx;
+		}
+		if (velocity[1] != 0.0 && new_vy * velocity[1] < 0) {
+			velocity[1] = (ay * velocity[1] < 0) ? 0.0 : new_vy;
+		} else {
+			velocity[1] = new_vy;
+		}
+	}
+	force[0] = 0.0;
+	force[1] = 0.0;
+}
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef _BROADPHASE_H_
+#define _BROADPHASE_H_
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include "shapes.h"
+
+/*=========================================================================================================
+ * 宽相位碰撞检测（Broadphase）
+ *
+ * 作用：在逐对调用 check_collision 之前，先用包围盒快速筛掉不可能相撞的物体对，
+ *       只把"候选物体对"交给窄相位（check_collision / resolveCollision）处理。
+ *
+ * 候选物体对使用形状在列表中的下标 (i, j) 表示，保证 i < j，
+ * 并按 (i, j) 字典序排列——与原来的双重循环遍历顺序一致，碰撞处理结果不受影响。
+ *=========================================================================================================*/
+
+// 候选物体对：first < second，均为形状列表中的下标
+typedef std::pair<int, int> CandidatePair;
+
+// 可选的宽相位算法
+enum BroadphaseType {
+	BROADPHASE_BRUTE_FORCE,      // 全配对（原来的双重循环，用于对照验证）
+	BROADPHASE_SPATIAL_HASH,     // 均匀网格 / 空间哈希（默认）
+	BROADPHASE_SWEEP_AND_PRUNE,  // 增量式排序扫描（适合运动连贯的场景）
+	BROADPHASE_AABB_TREE         // 动态包围盒树（适合大小悬殊的形状）
+};
+
+// 宽相位统计信息（每步更新）
+struct BroadphaseStats {
+	size_t shapeCount;        // 参与检测的形状数量
+	size_t allPairs;          // 全配对循环需要测试的物体对数量 n(n-1)/2
+	size_t candidatePairs;    // 宽相位输出的候选物体对数量
+	size_t savedPairTests;    // 相比全配对循环节省的窄相位测试次数
+	size_t endpointSwaps;     // 排序扫描中插入排序的交换次数（其他算法为0）
+	size_t proxyReinserts;    // 包围盒树中移出放大包围盒、需要重新插入的叶子数量（其他算法为0）
+
+	BroadphaseStats() : shapeCount(0), allPairs(0), candidatePairs(0), savedPairTests(0),
+	                    endpointSwaps(0), proxyReinserts(0) {}
+};
+
+// 形状的（放大后的）包围盒
+struct BroadphaseBounds {
+	double minX, minY, maxX, maxY;
+
+	bool overlaps(const BroadphaseBounds& other) const {
+		return !(minX > other.maxX || maxX < other.minX || minY > other.maxY || maxY < other.minY);
+	}
+
+	bool contains(const BroadphaseBounds& other) const {
+		return minX <= other.minX && minY <= other.minY && maxX >= other.maxX && maxY >= other.maxY;
+	}
+
+	bool isFinite() const;
+
+	// 线段 (x0, y0) + t·(dx, dy)，t ∈ [0, 1] 与包围盒相交时返回 true，tEnter 为进入包围盒时的 t（起点在内部时为 0）
+	bool intersectsSegment(double x0, double y0, double dx, double dy, double& tEnter) const;
+};
+
+/*=========================================================================================================
+ * Broadphase - 宽相位算法的公共接口
+ * 每步先调用 update() 传入当前形状列表，再调用 computePairs() 取得候选物体对。
+ *=========================================================================================================*/
+class Broadphase {
+public:
+	Broadphase() : fatMargin(0.1), predictionTime(0.0), predictionAcceleration(0.0) {}
+	virtual ~Broadphase() {}
+
+	// 根据形状列表更新内部数据结构（每一步调用一次）
+	virtual void update(const std::vector<Shape*>& shapes) = 0;
+
+	// 输出候选物体对（按 (i, j) 字典序排列），并更新统计信息
+	virtual void computePairs(std::vector<CandidatePair>& pairs) = 0;
+
+	const BroadphaseStats& getStats() const { return stats; }
+
+	// 设置预测时长：包围盒再向四周放大 |v|·dt + a·dt²，覆盖形状在接下来 dt 时间内的位移，
+	// 这样在一步开始时生成的候选对可以在整步中复用（支撑检测和碰撞处理共用）。dt 为 0 时不放大
+	void setPrediction(double dt, double maxAcceleration) {
+		predictionTime = dt > 0.0 ? dt : 0.0;
+		predictionAcceleration = std::abs(maxAcceleration);
+	}
+
+protected:
+	// 计算形状的包围盒，并按尺寸比例放大 fatMargin 倍，
+	// 覆盖碰撞处理过程中分离推动造成的小位移；设置了预测时长时再按速度放大
+	void computeFatBounds(const Shape& shape, BroadphaseBounds& bounds) const;
+
+	// 根据输出的候选对数量填写统计信息
+	void recordStats(size_t shapeCount, size_t candidateCount);
+
+	double fatMargin;                // 包围盒放大比例（相对于形状尺寸）
+	double predictionTime;           // 预测时长（秒）
+	double predictionAcceleration;   // 预测时假设的最大加速度
+	BroadphaseStats stats;
+};
+
+/*=========================================================================================================
+ * BruteForceBroadphase - 全配对宽相位
+ * 输出所有 n(n-1)/2 个物体对，等价于原来的双重循环，用于验证其他算法。
+ *=========================================================================================================*/
+class BruteForceBroadphase : public Broadphase {
+public:
+	BruteForceBroadphase() : shapeCount(0) {}
+
+	virtual void update(const std::vector<Shape*>& shapes) override { shapeCount = shapes.size(); }
+	virtual void computePairs(std::vector<CandidatePair>& pairs) override;
+
+private:
+	size_t shapeCount;
+};
+
+/*=========================================================================================================
+ * SpatialHashGrid - 均匀网格 / 空间哈希宽相位
+ *
+ * 每一步重建：
+ *   1. 计算每个形状的包围盒（按尺寸放大 fatMargin 倍）
+ *   2. 根据形状的平均尺寸自动确定网格单元大小（也可以手动指定）
+ *   3. 把每个形状登记到它覆盖的所有网格单元中，按单元排序
+ *   4. 同一单元中的形状两两成为候选对（只在两者共同覆盖的第一个单元中输出，避免重复）
+ *
+ * 覆盖网格单元过多的超大形状（如无限大的 Ground、很长的 Wall）不进入网格，
+ * 单独放在 oversized 列表中，与所有形状做包围盒测试。
+ *=========================================================================================================*/
+class SpatialHashGrid : public Broadphase {
+public:
+	SpatialHashGrid() : cellSize(1.0), fixedCellSize(0.0), maxCellsPerShape(16) {}
+
+	virtual void update(const std::vector<Shape*>& shapes) override;
+	virtual void computePairs(std::vector<CandidatePair>& pairs) override;
+
+	// 手动指定网格单元大小；传入 0 表示根据形状尺寸自动计算
+	void setCellSize(double size) { fixedCellSize = size > 0.0 ? size : 0.0; }
+	double getCellSize() const { return cellSize; }
+
+	// 单个形状最多允许覆盖的网格单元数，超过则视为超大形状
+	void setMaxCellsPerShape(int count) { if (count > 0) maxCellsPerShape = count; }
+
+private:
+	// 形状包围盒及其覆盖的网格单元范围
+	struct Proxy {
+		BroadphaseBounds bounds;
+		int cellMinX, cellMinY, cellMaxX, cellMaxY;
+		bool oversized;
+	};
+
+	// 网格单元登记项：单元键 + 形状下标
+	struct CellEntry {
+		uint64_t key;
+		int index;
+		bool operator<(const CellEntry& other) const {
+			return key != other.key ? key < other.key : index < other.index;
+		}
+	};
+
+	static uint64_t cellKey(int cx, int cy) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+	}
+
+	double cellSize;          // 当前使用的网格单元大小
+	double fixedCellSize;     // 手动指定的单元大小（0 表示自动）
+	int maxCellsPerShape;     // 超大形状判定阈值
+
+	std::vector<Proxy> proxies;        // 与形状列表一一对应
+	std::vector<CellEntry> entries;    // 按单元排序的登记项
+	std::vector<int> oversizedList;    // 超大形状下标
+};
+
+/*=========================================================================================================
+ * SweepAndPrune - 增量式排序扫描宽相位
+ *
+ * 在 X、Y 两个轴上各保存一份按坐标排序的端点数组（每个形状一个 min 端点、一个 max 端点），
+ * 跨帧保留。每步只更新端点坐标，再用插入排序恢复有序——物体运动连贯时几乎不需要交换，
+ * 排序代价接近 O(n)。
+ *
+ * 扫描时选择形状中心分布更分散的轴（例如竖直的堆叠选 Y 轴，水平铺开的球堆选 X 轴），
+ * 沿该轴维护"活动列表"，只有在扫描轴上重叠的形状才做另一轴的包围盒测试。
+ *
+ * 形状列表发生增删（数量或顺序变化）时自动从头重建端点数组。
+ *=========================================================================================================*/
+class SweepAndPrune : public Broadphase {
+public:
+	SweepAndPrune() : sweepAxis(0) {}
+
+	virtual void update(const std::vector<Shape*>& shapes) override;
+	virtual void computePairs(std::vector<CandidatePair>& pairs) override;
+
+	// 本步扫描使用的轴：0 = X，1 = Y
+	int getSweepAxis() const { return sweepAxis; }
+
+private:
+	// 端点：坐标值 + 形状下标 + 是否为 max 端点
+	struct Endpoint {
+		double value;
+		int index;
+		bool isMax;
+
+		// 坐标相同时 min 端点排在 max 端点之前，保证相切的包围盒也被视为重叠
+		bool operator<(const Endpoint& other) const {
+			if (value != other.value) return value < other.value;
+			return !isMax && other.isMax;
+		}
+	};
+
+	void rebuild();
+	size_t insertionSort(std::vector<Endpoint>& axis);
+	void refreshEndpoints(std::vector<Endpoint>& axis, int axisIndex);
+
+	std::vector<Shape*> trackedShapes;          // 上一步的形状列表（用于检测增删）
+	std::vector<BroadphaseBounds> bounds;       // 与形状列表一一对应
+	std::vector<Endpoint> endpoints[2];         // X 轴、Y 轴的有序端点数组
+	std::vector<int> activeList;                // 扫描时的活动形状
+	std::vector<int> activeSlot;                // 形状在活动列表中的位置（-1 表示不在列表中）
+	int sweepAxis;
+};
+
+/*=========================================================================================================
+ * DynamicAABBTree - 动态包围盒树（BVH）
+ *
+ * 二叉树，叶子保存形状放大后的包围盒（"胖"包围盒），内部节点保存两个子节点包围盒的并集。
+ *   - 插入：从根往下按"周长增量最小"选择兄弟节点，然后沿路径向上更新（refit）包围盒
+ *   - 移动：形状仍在叶子的胖包围盒内时什么都不做；移出后才删除并重新插入
+ *   - 平衡：插入/删除后沿路径做旋转，使左右子树高度差不超过 1
+ *   - 查询：从根往下只进入与查询包围盒重叠的子树，单次查询 O(log n)
+ *
+ * 节点存放在数组中，空闲节点串成链表复用；叶子通过 proxyId（节点下标）引用。
+ * 只接受有限大小的包围盒，无限大的形状（如 Ground）需要调用方单独处理。
+ *=========================================================================================================*/
+class DynamicAABBTree {
+public:
+	static const int NULL_NODE = -1;
+
+	DynamicAABBTree() : root(NULL_NODE), freeList(NULL_NODE), proxyCount(0) {}
+
+	// 插入一个叶子，包围盒向四周放大 margin，返回 proxyId
+	int createProxy(const BroadphaseBounds& bounds, int userData, double margin);
+
+	// 删除叶子
+	void destroyProxy(int proxyId);
+
+	// 更新叶子的包围盒；仍在胖包围盒内时返回 false，否则重新插入并返回 true
+	bool moveProxy(int proxyId, const BroadphaseBounds& bounds, double margin);
+
+	// 清空整棵树
+	void clear();
+
+	// 查询与给定包围盒重叠的所有叶子，把它们的 userData 追加到 result 中
+	void query(const BroadphaseBounds& bounds, std::vector<int>& result) const;
+	// 同上，使用调用方提供的遍历栈（多个线程同时查询同一棵树时使用）
+	void query(const BroadphaseBounds& bounds, std::vector<int>& result, std::vector<int>& stack) const;
+
+	// 查询与线段 (x0, y0) + t·(dx, dy)，t ∈ [0, 1] 相交的所有叶子，把它们的 userData 追加到 result 中
+	void raycast(double x0, double y0, double dx, double dy, std::vector<int>& result, std::vector<int>& stack) const;
+
+	const BroadphaseBounds& getFatBounds(int proxyId) const { return nodes[proxyId].bounds; }
+	int getUserData(int proxyId) const { return nodes[proxyId].userData; }
+	size_t getProxyCount() const { return proxyCount; }
+
+	// 树的高度（空树为 0，只有一个叶子时为 1）
+	int getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height + 1; }
+
+	// 所有内部节点中左右子树高度差的最大值（用于测试平衡性）
+	int getMaxBalance() const;
+
+private:
+	struct TreeNode {
+		BroadphaseBounds bounds;
+		int parent;               // 空闲节点中表示下一个空闲节点
+		int child1;
+		int child2;
+		int height;               // 叶子为 0，空闲节点为 -1
+		int userData;
+
+		bool isLeaf() const { return child1 == NULL_NODE; }
+	};
+
+	int allocateNode();
+	void freeNode(int nodeId);
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+	void refitAncestors(int nodeId);
+	int balance(int nodeId);
+
+	std::vector<TreeNode> nodes;
+	int root;
+	int freeList;
+	size_t proxyCount;
+	mutable std::vector<int> queryStack;      // 查询时的遍历栈（复用内存）
+};
+
+/*=========================================================================================================
+ * AABBTreeBroadphase - 基于动态包围盒树的宽相位
+ *
+ * 每个形状对应树中的一个叶子，跨帧保留。叶子的包围盒在 fatMargin 放大的基础上再按尺寸
+ * 放大 displacementMargin 倍，形状在这个范围内移动时不需要修改树，只有移出时才重新插入。
+ *
+ * 每个形状用自己（fatMargin 放大后）的包围盒查询一次树，再用同样的包围盒精确测试，
+ * 所以输出的候选对与空间哈希、排序扫描完全相同。
+ * 无限大的形状不进入树，单独与所有形状测试。
+ *=========================================================================================================*/
+class AABBTreeBroadphase : public Broadphase {
+public:
+	AABBTreeBroadphase() : displacementMargin(0.5) {}
+
+	virtual void update(const std::vector<Shape*>& shapes) override;
+	virtual void computePairs(std::vector<CandidatePair>& pairs) override;
+
+	const DynamicAABBTree& getTree() const { return tree; }
+
+private:
+	void rebuild();
+	double leafMargin(const BroadphaseBounds& b) const;
+
+	double displacementMargin;                // 叶子额外放大比例（相对于形状尺寸）
+	DynamicAABBTree tree;
+	std::vector<Shape*> trackedShapes;        // 上一步的形状列表（用于检测增删）
+	std::vector<BroadphaseBounds> bounds;     // 与形状列表一一对应
+	std::vector<int> proxyIds;                // 形状对应的叶子（无限大的形状为 NULL_NODE）
+	std::vector<int> unboundedList;           // 无限大形状的下标
+	std::vector<int> queryResult;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef _CONSTRAINT_H_
+#define _CONSTRAINT_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "shapeHandle.h"
+#include "bodyStore.h"
+#include "island.h"
+
+/*=========================================================================================================
+ * 距离约束（Distance Constraints）- 摆、绳子、链条
+ *
+ * 距离约束保持两点距离为 L（刚性杆），绳子约束只限制距离不超过 L，钉住约束把形状连到世界中的固定点；
+ * 通过 PhysicalWorld::addDistanceConstraint / addRopeConstraint / addPinConstraint 加入，柔度为 0 时完全刚性。
+ * 每步在各个岛计算完之后按 XPBD 修正位置：约束图着色后同一颜色的约束并行求解，首尾相连的链条整条做牛顿迭代，
+ * 结果与线程数无关。静态形状、休眠的物体在约束中当作固定点；约束两端的物体一起入睡、一起醒来，
+ * 形状被移出世界后，连接它的约束在下一步自动删除。
+ *=========================================================================================================*/
+
+enum ConstraintType {
+	CONSTRAINT_DISTANCE,   // 距离等于 L
+	CONSTRAINT_ROPE,       // 距离不超过 L
+	CONSTRAINT_PIN         // 与固定点的距离等于 L
+};
+
+// 约束求解统计信息（每步更新）
+struct ConstraintStats {
+	size_t constraintCount;   // 本步求解的约束数量
+	size_t bodyCount;         // 参与的动态物体数量
+	size_t colorCount;        // 颜色（批次）数量
+	int iterations;           // 迭代轮数
+	size_t chainCount;        // 直接求解的链条数量
+	size_t chainConstraints;  // 其中的约束数量
+	double maxError;          // 求解后最大的约束误差 |C|（绳子只计拉长的部分）
+
+	ConstraintStats() : constraintCount(0), bodyCount(0), colorCount(0), iterations(0), chainCount(0), chainConstraints(0), maxError(0.0) {}
+};
+
+/*=========================================================================================================
+ * ConstraintSolver - 保存约束并在每步结束时求解
+ *=========================================================================================================*/
+class ConstraintSolver {
+public:
+	ConstraintSolver() : iterations(10), liveCount(0), colorsDirty(false), linksDirty(false) {}
+
+	/*
+	 * 加入约束，返回约束编号（removeConstraint 使用）；参数不合法时返回 -1。
+	 * b 为空句柄时 a 连接到固定点 (anchorX, anchorY)；compliance 为柔度（米/牛，0 为刚性）
+	 */
+	int add(ConstraintType type, ShapeHandle a, ShapeHandle b, double anchorX, double anchorY,
+	        double length, double compliance);
+	bool remove(int id);
+	void clear();
+
+	size_t size() const { return liveCount; }
+	bool isValid(int id) const { return id >= 0 && id < static_cast<int>(constraints.size()) && constraints[id].alive; }
+	ConstraintType getType(int id) const { return constraints[id].type; }
+	double getLength(int id) const { return constraints[id].length; }
+	void setLength(int id, double length) { if (length >= 0.0) constraints[id].length = length; }
+	// 约束的颜色（批次），最近一次求解之后有效；着色后新加入的约束为 -1
+	int getColor(int id) const { return constraints[id].color; }
+
+	// 每步的迭代轮数（默认 10）
+	void setIterations(int count) { if (count >= 1) iterations = count; }
+	int getIterations() const { return iterations; }
+
+	// 连接两个形状的约束（不含连接到固定点的），休眠时两端的物体一起入睡、一起醒来
+	const std::vector<std::pair<ShapeHandle, ShapeHandle> >& getLinks();
+	// 与 handle 通过约束相连的形状；没有时 count 为 0
+	const ShapeHandle* getLinkedShapes(ShapeHandle handle, size_t& count);
+
+	// 求解所有约束：位置、速度直接写回 store；pool 不为空时同一颜色的约束分块并行
+	void solve(const HandleTable& handles, BodyStore& store, double deltaTime, ThreadPool* pool = nullptr);
+
+	const ConstraintStats& getStats() const { return stats; }
+
+private:
+	struct Constraint {
+		ConstraintType type;
+		ShapeHandle a, b;          // b 为空时连接到固定点
+		double anchorX, anchorY;
+		double length;
+		double compliance;
+		int color;
+		double force;              // 上一步的约束力 λ / Δt²（链条的牛顿迭代从它开始）
+		bool alive;
+	};
+
+	static const int kMaxColors = 64;   // 超过的约束放进最后一批，在调用线程中依次求解
+
+	// 贪心着色，并按颜色排列约束；同时清除所有物体的 BODY_CONSTRAINED 标志，由之后的求解重新设置
+	void buildColors(const HandleTable& handles, BodyStore& store);
+	// 约束端点在本步的粒子下标（动态物体共用一个粒子，固定点各自一个）
+	int particleFor(const HandleTable& handles, BodyStore& store, ShapeHandle handle, double x, double y, bool& valid);
+	// 求解 batch 中 [begin, end) 的约束一轮
+	void solveRange(size_t begin, size_t end, double alphaScale);
+	// 约束有增删后重新整理 links 和邻接表
+	void rebuildLinks();
+	// 找出本步可以直接求解的链条（依赖粒子，每步重新整理）
+	void buildChains();
+	bool isChainable(int k) const;
+	// 约束 k 经过粒子 particle 相邻的、可以放进链条的约束，没有时返回 -1
+	int chainNeighbour(int k, int particle) const;
+	// 第 chain 条链做一次牛顿迭代，返回迭代前的残差（小于 kChainTolerance 时不修正）
+	double solveChain(size_t chain, double alphaScale);
+
+	int iterations;
+	size_t liveCount;
+	bool colorsDirty;
+	std::vector<Constraint> constraints;
+	std::vector<int> freeIds;
+	ConstraintStats stats;
+
+	// 按颜色排列的约束编号，颜色 c 为 [colorStart[c], colorStart[c + 1])
+	std::vector<int> colorOrder;
+	std::vector<size_t> colorStart;
+	std::vector<uint64_t> usedColors;   // 着色时：句柄槽位 -> 已用颜色的位掩码
+
+	// 连接两个形状的约束，以及按句柄槽位索引的邻接表：槽位 i 的相连形状为 linked[linkStart[i], linkStart[i + 1])
+	bool linksDirty;
+	std::vector<std::pair<ShapeHandle, ShapeHandle> > links;
+	std::vector<size_t> linkStart;
+	std::vector<ShapeHandle> linked;
+
+	// 本步的粒子：位置、求解前的位置、质量的倒数、BodyStore 槽位（固定点为 -1）
+	std::vector<double> particlePosition, particleStart, particleInvMass;
+	std::vector<int> particleSlot;
+	std::vector<int> slotParticle;      // BodyStore 槽位 -> 粒子下标
+
+	// 本步的批次数据（与 colorOrder 一一对应，端点无效的约束 endA 为 -1）
+	std::vector<int> endA, endB;
+	std::vector<double> restLength, compliance, lambda;
+	std::vector<unsigned char> unilateral;
+	std::vector<unsigned char> inChain;   // 直接求解的约束，按颜色求解时跳过
+
+	// 本步的链条：第 c 条链的约束（批次下标，首尾相连）为 chainOrder[chainStart[c], chainStart[c + 1])，
+	// 链上的粒子依次为 chainParticle[chainStart[c] + c, chainStart[c + 1] + c]（比约束多一个：第 i 个约束连接第 i 与第 i + 1 个粒子）
+	std::vector<int> chainOrder, chainParticle;
+	std::vector<size_t> chainStart;
+	std::vector<int> particleDegree;      // 粒子连接的约束数量与前两个约束
+	std::vector<int> particleEdges;
+	std::vector<unsigned char> chainConverged;
+	std::vector<double> chainDiag, chainUpper, chainRhs;   // 分块追赶法的临时数据：每个粒子一块（对称的对角块、上方的块，右端）
+};
+
+#endif
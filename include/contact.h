@@ -0,0 +1,172 @@
+#ifndef _CONTACT_H_
+#define _CONTACT_H_
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "shapes.h"
+
+/*=========================================================================================================
+ * 持久接触（Contact Manifold）与接触缓存
+ *
+ * 作用：按物体对保存上一帧的接触信息（法向、穿透深度、累积冲量），
+ *       同一对物体在下一帧继续接触时直接复用，求解器用上一帧的累积冲量做热启动（warm starting），
+ *       静止接触（并排的方块、挤在一起的圆）一两次迭代就能收敛，不再每帧从零开始抖动。
+ *
+ * 缓存以两个形状的指针为键（与顺序无关），每步开始时 beginStep()，对本步仍然接触的物体对调用
+ * findOrCreate()，最后 endStep() 删除本步没有再出现的接触。
+ *=========================================================================================================*/
+
+// 碰撞响应方式
+enum ContactSolverType {
+	CONTACT_SOLVER_DIRECT,    // 原来的逐对一维弹性碰撞公式（默认）
+	CONTACT_SOLVER_IMPULSE    // 基于持久接触的迭代冲量求解（Sequential Impulse / PGS，支持热启动和摩擦）
+};
+
+// 一对物体之间的接触
+struct ContactManifold {
+	Shape* shapeA;
+	Shape* shapeB;
+
+	double normal[2];         // 接触法向（由 A 指向 B）
+	double penetration;       // 穿透深度（> 0 表示重叠）
+
+	// 求解用的预计算量：只在接触建立或质量改变时重新计算
+	double massA, massB;      // 计算 normalMass 时使用的质量
+	double invMassA, invMassB;
+	double normalMass;        // 法向有效质量 1 / (1/mA + 1/mB)
+	double restitution;       // 平均弹性系数
+	double friction;          // 平均滑动摩擦系数（fraction）
+	double staticFriction;    // 平均静摩擦系数（static_fraction）
+	double velocityBias;      // 法向目标速度（弹性反弹）
+	double frictionLimit;     // 本步使用的摩擦系数（相对静止时取静摩擦系数，否则取滑动摩擦系数）
+
+	double normalImpulse;     // 累积法向冲量（跨帧保留，用于热启动）
+	double tangentImpulse;    // 累积切向冲量（切向为法向逆时针旋转 90°）
+
+	int age;                  // 接触已持续的步数（新建为 0）
+	bool touched;             // 本步是否仍然接触
+
+	ContactManifold() : shapeA(nullptr), shapeB(nullptr), normal{0.0, 0.0}, penetration(0.0),
+	                    massA(0.0), massB(0.0), invMassA(0.0), invMassB(0.0), normalMass(0.0),
+	                    restitution(0.0), friction(0.0), staticFriction(0.0), velocityBias(0.0), frictionLimit(0.0),
+	                    normalImpulse(0.0), tangentImpulse(0.0),
+	                    age(0), touched(false) {}
+};
+
+// 接触缓存统计信息（每步更新）
+struct ContactStats {
+	size_t contactCount;        // 本步的接触数量
+	size_t newContacts;         // 本步新建的接触
+	size_t persistentContacts;  // 从上一帧延续下来的接触
+	size_t removedContacts;     // 本步删除的接触（不再接触）
+	size_t setupSkipped;        // 复用了预计算量（未重新计算有效质量和弹性系数）的接触
+	int velocityIterations;     // 速度求解实际迭代次数（收敛后提前结束）
+	int positionIterations;     // 位置修正实际迭代次数
+
+	ContactStats() : contactCount(0), newContacts(0), persistentContacts(0), removedContacts(0), setupSkipped(0),
+	                 velocityIterations(0), positionIterations(0) {}
+
+	// 合并一个岛的统计：数量相加，迭代次数取最大值
+	void accumulate(const ContactStats& other);
+};
+
+/*=========================================================================================================
+ * ContactCache - 以物体对为键的接触缓存
+ * unordered_map 插入新元素时不会使已有元素的引用失效，所以 findOrCreate() 返回的引用在本步内一直有效。
+ *=========================================================================================================*/
+class ContactCache {
+public:
+	// 每步开始时调用：把所有接触标记为未接触
+	void beginStep();
+
+	// 查找或新建 (a, b) 之间的接触；已有的接触 age 加 1，新建的接触 age 为 0
+	ContactManifold& findOrCreate(Shape* a, Shape* b);
+
+	// 按岛并行求解时使用：
+	// touch() 只查找已有的接触（age 加 1，计入 stepStats），没有时返回 nullptr。它只修改找到的接触本身，
+	// 不修改散列表，所以不同的岛可以在不同线程中同时调用；岛内新建的接触先由 initContact() 放在岛自己的存储中，
+	// 全部求解完后再用 insert() 并入缓存
+	ContactManifold* touch(Shape* a, Shape* b, ContactStats& stepStats);
+	static void initContact(ContactManifold& contact, Shape* a, Shape* b, ContactStats& stepStats);
+	void insert(const ContactManifold& contact);
+
+	// 每步结束时调用：删除本步没有再接触的物体对
+	void endStep();
+
+	// 删除与某个形状有关的所有接触（形状被移出世界时调用）
+	void removeShape(const Shape* shape);
+	void clear();
+
+	size_t size() const { return contacts.size(); }
+	const ContactManifold* find(const Shape* a, const Shape* b) const;
+
+	ContactStats& getStats() { return stats; }
+	const ContactStats& getStats() const { return stats; }
+
+private:
+	struct ContactKey {
+		const Shape* first;
+		const Shape* second;
+
+		bool operator==(const ContactKey& other) const {
+			return first == other.first && second == other.second;
+		}
+	};
+
+	struct ContactKeyHash {
+		size_t operator()(const ContactKey& key) const {
+			std::uint64_t a = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(key.first));
+			std::uint64_t b = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(key.second));
+			return static_cast<size_t>((a * 0x9E3779B97F4A7C15ULL) ^ (b + 0x7F4A7C159E3779B9ULL + (a << 6) + (a >> 2)));
+		}
+	};
+
+	// 键与顺序无关：地址小的形状放在前面
+	static ContactKey makeKey(const Shape* a, const Shape* b) {
+		ContactKey key;
+		if (a < b) { key.first = a; key.second = b; }
+		else { key.first = b; key.second = a; }
+		return key;
+	}
+
+	std::unordered_map<ContactKey, ContactManifold, ContactKeyHash> contacts;
+	ContactStats stats;
+};
+
+/*=========================================================================================================
+ * 冲量求解的各个步骤（对单个接触）
+ *
+ * prepareContact()   计算法向与穿透深度；持久接触复用有效质量、弹性系数和摩擦系数（reusedSetup 为 true），
+ *                    返回 false 表示不需要求解
+ * warmStartContact() 先施加上一帧的累积冲量（法向 + 切向）
+ * solveContactFriction() 库仑摩擦：累积切向冲量限制在 ±μ·累积法向冲量 之内
+ * solveContact()     计算本次迭代的法向冲量增量，累积冲量限制为非负（只推不拉）
+ * 两个 solve 函数都返回本次冲量增量的绝对值，用于判断迭代是否收敛
+ *
+ * updateContactPenetration() 按当前位置重新计算穿透深度（位置修正迭代时使用）
+ * correctContactPosition()   按穿透深度分离物体（与原来的 separateOverlappingShapes 相同的比例）
+ *=========================================================================================================*/
+bool prepareContact(ContactManifold& contact, double restitutionThreshold, bool& reusedSetup);
+void warmStartContact(ContactManifold& contact);
+double solveContactFriction(ContactManifold& contact);
+double solveContact(ContactManifold& contact);
+double updateContactPenetration(ContactManifold& contact);
+void correctContactPosition(ContactManifold& contact, double separationPercent);
+
+/*=========================================================================================================
+ * 连续碰撞检测（CCD）：扫掠求碰撞时间（time of impact）
+ *
+ * 圆心从 (x, y) 沿位移 (dx, dy) 运动（另一个物体视为静止，运动物体之间使用相对位移），
+ * 返回 true 时 toi ∈ [0, 1] 为第一次接触时位移的比例。开始时已经重叠的情况交给离散碰撞处理，返回 false。
+ *
+ * sweepCircleCircle() 圆对圆：射线与半径 r1 + r2 的圆求交
+ * sweepCircleRect()   圆对矩形（AABB / Wall）：射线与圆角矩形（矩形向外扩大 r）求交
+ *=========================================================================================================*/
+bool sweepCircleCircle(double x, double y, double dx, double dy, double radius,
+                       double otherX, double otherY, double otherRadius, double& toi);
+bool sweepCircleRect(double x, double y, double dx, double dy, double radius,
+                     double left, double bottom, double right, double top, double& toi);
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef _FLUID_H_
+#define _FLUID_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "island.h"
+
+/*=========================================================================================================
+ * 粒子流体与颗粒（Position Based Fluids / 位置约束的颗粒）
+ *
+ * 让粒子之间产生作用，用 PhysicalWorld::setParticleMode 选择：PARTICLE_FLUID 为水（密度约束 + XSPH 粘性），
+ * PARTICLE_GRANULAR 为沙（不穿透约束与静摩擦 / 动摩擦，几乎不动的粒子留在原处）；参数见 FluidSettings。
+ * 每步在核半径的均匀网格上排序粒子、建一次邻居列表，再迭代若干轮；流体按块并行，颗粒按单元着色分批并行，
+ * 结果与线程数无关。排序、与边界的碰撞、速度的更新由 ParticleSystem 完成。
+ *=========================================================================================================*/
+
+// 粒子之间的作用方式
+enum ParticleMode {
+	PARTICLE_BALLISTIC,   // 互不影响（默认）
+	PARTICLE_FLUID,       // 流体：密度约束
+	PARTICLE_GRANULAR     // 颗粒：不穿透约束与摩擦
+};
+
+// 流体、颗粒的参数
+struct FluidSettings {
+	int iterations;              // 每步的约束迭代轮数
+	double relaxation;           // 流体：ε 与静止时 Σ|∇C|² 的比值（越大越软、越稳定）
+	double artificialPressure;   // 流体：人工压强系数 k（s_corr = -k·(W(r)/W(0.2h))^4 / 静止时的 Σ|∇C|²）
+	double viscosity;            // 流体：XSPH 粘性系数 c（0 ~ 1）；与边界接触的粒子每步的切向位移也按它减小
+	double staticFriction;       // 颗粒：静摩擦系数（切向位移小于 μs × 重叠量时完全消除）
+	double kineticFriction;      // 颗粒：动摩擦系数
+	int stabilizationIterations; // 颗粒：每步开始时在原来的位置上分开重叠粒子的轮数（不产生速度）
+	double sleepVelocity;        // 颗粒：本步的速度小于它的粒子留在原处（米/秒，消除静止堆积中的缓慢蠕动）
+
+	FluidSettings() : iterations(8), relaxation(0.1), artificialPressure(0.001), viscosity(0.05),
+	                  staticFriction(1.0), kineticFriction(0.8), stabilizationIterations(1), sleepVelocity(0.1) {}
+};
+
+// 流体、颗粒统计信息（每步更新）
+struct FluidStats {
+	size_t particleCount;        // 参与计算的粒子数
+	size_t cellCount;            // 非空的网格单元数
+	size_t neighbourCount;       // 邻居列表的总长度（每对邻居计两次）
+	int iterations;              // 迭代轮数
+	double densityError;         // 流体：最后一轮之前的平均压缩量 max(ρ/ρ0 - 1, 0)
+	double maxOverlap;           // 颗粒：最后一轮之前相邻粒子的最大重叠量（米）
+
+	FluidStats() : particleCount(0), cellCount(0), neighbourCount(0), iterations(0), densityError(0.0), maxOverlap(0.0) {}
+};
+
+/*=========================================================================================================
+ * ParticleFluid - 网格排序、邻居列表与约束迭代
+ *=========================================================================================================*/
+class ParticleFluid {
+public:
+	ParticleFluid() : kernelRadius(0.0f), restDensity(0.0f), restGradient(0.0f) {}
+
+	/*
+	 * 按单元边长 cellSize 的网格对 n 个粒子排序，返回新的顺序：order[k] 为排在第 k 位的粒子原来的下标
+	 * （单元编号相同的粒子保持原来的先后）。调用方按这个顺序重新排列所有粒子数组之后再调用 buildNeighbours
+	 */
+	const std::vector<uint32_t>& sortByCell(const float* x, const float* y, size_t n, float cellSize);
+
+	// 为排序后的粒子建立邻居列表：距离小于 cellSize 的其他粒子
+	void buildNeighbours(const float* x, const float* y, size_t n, ThreadPool* pool);
+
+	// 流体：一轮密度约束，修正量写入 dx、dy（不修改 x、y）；particleRadius 决定静止间距 2r 与核半径 4r
+	void solveDensity(const float* x, const float* y, float* dx, float* dy, size_t n, float particleRadius,
+	                  const FluidSettings& settings, ThreadPool* pool);
+	// 颗粒：一轮不穿透约束与摩擦，直接修改 x、y；x0、y0 为本步开始时的位置（用来求切向位移）
+	void solveContacts(float* x, float* y, const float* x0, const float* y0, const float* radius,
+	                   const FluidSettings& settings, ThreadPool* pool);
+	// 流体：XSPH 粘性，v_i += c · Σ_j (v_j - v_i) W_ij / Σ_j W_ij
+	void applyViscosity(const float* x, const float* y, float* vx, float* vy, size_t n, float viscosity, ThreadPool* pool);
+
+	// 排序后第 i 个粒子的邻居（buildNeighbours 之后有效）
+	const uint32_t* neighboursOf(size_t i) const { return neighbours.data() + neighbourStart[i]; }
+	size_t neighbourCountOf(size_t i) const { return neighbourStart[i + 1] - neighbourStart[i]; }
+
+	const FluidStats& getStats() const { return stats; }
+	void resetStats(int iterations) { stats = FluidStats(); stats.iterations = iterations; }
+
+	// 每块的粒子数（并行的单位）
+	static const size_t kChunkSize = 4096;
+
+private:
+	// 按 particleRadius 计算核半径与静止密度（规则的方形排列，间距 2r）
+	void updateKernel(float particleRadius);
+	template <typename Body>
+	void forChunks(size_t n, ThreadPool* pool, const Body& body);
+	// 单元 c 的颜色 (cx mod 3) + 3 (cy mod 3)
+	int cellColour(size_t c) const {
+		return static_cast<int>(cellKeys[c] % gridWidth % 3 + 3 * (cellKeys[c] / gridWidth % 3));
+	}
+
+	float kernelRadius;
+	float restDensity;               // 静止时的 ρ0
+	float restGradient;              // 静止时的 Σ|∇C|²
+	FluidStats stats;
+
+	// 排序：单元编号（行优先，四周各留一格），与粒子下标一起排序
+	std::vector<std::pair<uint64_t, uint32_t> > sortKeys;
+	std::vector<uint32_t> order;
+	uint64_t gridWidth;              // 每行的单元数（含两侧留空的单元）
+	float gridOriginX, gridOriginY, cellSize;
+
+	// 非空单元：编号、第一个粒子的下标；粒子 -> 单元
+	std::vector<uint64_t> cellKeys;
+	std::vector<uint32_t> cellBegin;
+	std::vector<uint32_t> particleCell;
+	std::vector<uint32_t> cellRows;  // 每个单元的 3 段邻居范围 [begin, end)（下、中、上三行）
+
+	// 邻居列表（CSR）：粒子 i 的邻居为 neighbours[neighbourStart[i], neighbourStart[i + 1])
+	std::vector<uint32_t> neighbourStart;
+	std::vector<uint32_t> neighbours;
+	std::vector<std::vector<uint32_t> > chunkNeighbours;   // 建列表时每块的临时列表
+
+	// 颗粒：按颜色排列的单元，颜色 k 为 colourOrder[colourStart[k], colourStart[k + 1])
+	std::vector<uint32_t> colourOrder;
+	std::vector<uint32_t> colourStart;
+
+	std::vector<float> lambda;
+	std::vector<float> pairGradient, pairCorrection;   // 流体：每对邻居（与 neighbours 对应）本轮的 ∇W 与 s_corr
+	std::vector<float> scratchX, scratchY;
+	std::vector<double> chunkError;
+};
+
+#endif
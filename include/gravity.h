@@ -0,0 +1,176 @@
+#ifndef _GRAVITY_H_
+#define _GRAVITY_H_
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "island.h"
+
+/*=========================================================================================================
+ * 万有引力（Mutual Gravity）
+ *
+ * 每个圆吸引其他所有物体：a_i = Σ G·m_j·r_ij / (|r_ij|² + ε²)^(3/2)。世界中用 PhysicalWorld::setMutualGravity 开启。
+ * 直接求和逐对累加（O(n²)，作为参考）；Barnes-Hut 建四叉树，节点边长 s < θ·d 时把整个节点当作一个质点（O(n log n)）。
+ * 用法：先 build() 传入引力源（位置、质量），再 evaluate() 求任意一组位置处的加速度；
+ * 受力点与引力源重合时该引力源不产生加速度，引力源和受力物体可以是同一组物体。
+ *=========================================================================================================*/
+
+// 可选的求解方法
+enum GravitySolverType {
+	GRAVITY_SOLVER_DIRECT,       // 直接求和 O(n²)（用于对照验证）
+	GRAVITY_SOLVER_BARNES_HUT    // Barnes-Hut 四叉树（默认）
+};
+
+// 引力求解统计信息（每次 build / evaluate 更新）
+struct GravityStats {
+	size_t sourceCount;       // 引力源数量
+	size_t targetCount;       // 受力点数量
+	size_t nodeCount;         // 四叉树节点数量（直接求和时为 0）
+	size_t leafCount;         // 四叉树叶子数量
+	int treeDepth;            // 四叉树深度
+	size_t interactions;      // 计算的质点-质点与质点-节点相互作用次数（直接求和为 受力点数 × 引力源数）
+
+	GravityStats() : sourceCount(0), targetCount(0), nodeCount(0), leafCount(0), treeDepth(0), interactions(0) {}
+};
+
+/*=========================================================================================================
+ * GravitySolver - 一组引力源产生的引力加速度
+ *=========================================================================================================*/
+class GravitySolver {
+public:
+	GravitySolver() : type(GRAVITY_SOLVER_BARNES_HUT), G(1.0), theta(0.5), softening(0.0),
+	                  rootMinX(0.0), rootMinY(0.0), quantizeScale(1.0) {}
+
+	void setType(GravitySolverType solverType) { type = solverType; }
+	GravitySolverType getType() const { return type; }
+
+	// 引力常数（默认 1，按场景的单位设置）
+	void setGravitationalConstant(double g) { G = g; }
+	double getGravitationalConstant() const { return G; }
+
+	// 张角 θ（默认 0.5）
+	void setOpeningAngle(double angle) { if (angle >= 0.0) theta = angle; }
+	double getOpeningAngle() const { return theta; }
+
+	// 软化长度 ε（默认 0）：避免两个物体非常接近时加速度发散
+	void setSoftening(double length) { if (length >= 0.0) softening = length; }
+	double getSoftening() const { return softening; }
+
+	// 设置引力源：position 为 n 个 (x, y)，mass 为 n 个质量（质量不大于 0 的引力源不产生引力）
+	void build(const double* position, const double* mass, size_t n);
+
+	// 求 n 个受力点处的加速度，写入 acceleration（n 个 (ax, ay)）；pool 不为空时按受力点分块并行计算
+	void evaluate(const double* position, size_t n, double* acceleration, ThreadPool* pool = nullptr);
+
+	const GravityStats& getStats() const { return stats; }
+
+private:
+	// 四叉树节点：子节点在 nodes 中连续存放，叶子的引力源为排序后的 [bodyBegin, bodyEnd)
+	struct Node {
+		double minX, minY, maxX, maxY;   // 节点内引力源的包围盒
+		double mass;                     // 总质量
+		double comX, comY;               // 质心
+		int firstChild;                  // 第一个子节点（叶子为 -1）
+		int childCount;
+		int bodyBegin, bodyEnd;
+	};
+
+	static const int kLeafCapacity = 8;  // 引力源不多于这么多时不再细分
+	static const int kMortonBits = 21;   // 每个坐标的量化位数（最大深度）
+
+	void buildNode(int index, int begin, int end, int level);
+	uint64_t mortonCode(double x, double y) const;
+	// 一个受力点 (px, py) 处的加速度，返回计算的相互作用次数
+	size_t accelerationDirect(double px, double py, double& ax, double& ay) const;
+	size_t accelerationTree(double px, double py, double& ax, double& ay, std::vector<int>& stack) const;
+
+	GravitySolverType type;
+	double G;
+	double theta;
+	double softening;
+	GravityStats stats;
+
+	// 引力源（直接求和按输入顺序，Barnes-Hut 按 Morton 码排序）
+	std::vector<double> sourceX, sourceY, sourceMass;
+	std::vector<uint64_t> sourceCodes;
+	std::vector<std::pair<uint64_t, int> > sortKeys;
+	std::vector<Node> nodes;
+	double rootMinX, rootMinY, quantizeScale;
+
+	// 受力点按 Morton 码排序后依次计算，相邻的受力点打开的节点大致相同
+	std::vector<std::pair<uint64_t, int> > targetOrder;
+	std::vector<std::vector<int> > workerStacks;   // workerStacks[worker]：遍历四叉树的栈
+	std::vector<size_t> workerInteractions;
+};
+
+/*=========================================================================================================
+ * 分层时间步（Block Timestepping）
+ *
+ * 作用：轨道场景中内圈物体需要很小的步长，外圈物体不需要；全局 timeStep 让所有物体都按最快的轨道走。
+ *       这里每个物体有自己的步长 Δt / 2^k（k 为该物体的级别 rung，Δt 为一帧的时间），
+ *       用辛的 kick-drift-kick 蛙跳积分：步首 v += a·dt/2，所有物体一起漂移，步末求新的加速度再 v += a·dt/2。
+ *       每个时刻只有步长在此结束的物体需要求引力，外圈物体很少参与计算。
+ *
+ * 级别按加速度和速度选择：时间尺度 τ = |v| / |a| + sqrt(尺寸 / |a|)（圆轨道时 |v| / |a| 为周期的 1/2π），
+ * 取步长不超过 η·τ 的最小级别。物体在步末可以立即进入更深的级别（更小的步长），
+ * 回到较浅的级别时每次只升一级，并且要等到与较长的步长对齐的时刻，保证所有物体在帧末同步。
+ *=========================================================================================================*/
+
+// 分层时间步统计信息（每帧更新）
+struct BlockStepStats {
+	size_t bodyCount;         // 参与分层时间步的物体数量
+	size_t forceEvaluations;  // 求加速度的物体次数之和（全部物体按最深级别的步长走时为 物体数 × 2^最深级别）
+	size_t forceUpdates;      // 求引力的次数（每次重建一次引力源）
+	int deepestRung;          // 本帧用到的最深级别
+
+	BlockStepStats() : bodyCount(0), forceEvaluations(0), forceUpdates(0), deepestRung(0) {}
+};
+
+class BlockTimestepper {
+public:
+	BlockTimestepper() : accuracy(0.02), maxRung(10), fixedSourceCount(0) {}
+
+	// 步长与时间尺度之比 η（默认 0.02，越小越精确）
+	void setAccuracy(double eta) { if (eta > 0.0) accuracy = eta; }
+	double getAccuracy() const { return accuracy; }
+
+	// 最深级别（默认 10，即一帧最多分成 1024 步）
+	void setMaxRung(int rung) { if (rung >= 0 && rung <= 30) maxRung = rung; }
+	int getMaxRung() const { return maxRung; }
+
+	/*
+	 * 把 n 个运动的物体推进 deltaTime：
+	 *   position、velocity、acceleration 为 n 个 (x, y)，mass、size 为 n 个值，isSource 为 1 的物体同时是引力源；
+	 *   fixedPosition、fixedMass 为本帧不动的引力源（静态的圆、不参与分层时间步的圆）。
+	 *   acceleration 为步首的加速度，accelerationValid[i] 为 0 时在步首重新计算；返回时为帧末的加速度。
+	 */
+	void advance(GravitySolver& solver, size_t n, double* position, double* velocity, double* acceleration,
+	             const unsigned char* accelerationValid, const double* mass, const double* size,
+	             const unsigned char* isSource, const double* fixedPosition, const double* fixedMass, size_t fixedCount,
+	             double deltaTime, ThreadPool* pool = nullptr);
+
+	// 最近一帧结束时各物体的级别
+	const std::vector<int>& getRungs() const { return rungs; }
+	const BlockStepStats& getStats() const { return stats; }
+
+private:
+	int chooseRung(const double* a, const double* v, double size, double deltaTime) const;
+	// 求 active 中各物体的加速度（先把运动的引力源更新到当前位置）
+	void computeAccelerations(GravitySolver& solver, const double* position, double* acceleration, ThreadPool* pool);
+
+	double accuracy;
+	int maxRung;
+	BlockStepStats stats;
+
+	std::vector<int> rungs;
+	std::vector<uint64_t> stepTicks;       // 当前步长（以 Δt / 2^maxRung 为单位）
+	std::vector<uint64_t> nextTick;        // 当前步结束的时刻
+	std::vector<int> active;               // 本时刻步长结束的物体
+	std::vector<int> movingSources;        // 同时是引力源的运动物体
+	size_t fixedSourceCount;
+	std::vector<double> sourcePosition, sourceMass;
+	std::vector<double> targetPosition, targetAcceleration;
+};
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef _INTEGRATOR_H_
+#define _INTEGRATOR_H_
+
+/*=========================================================================================================
+ * 积分器（Integrator）
+ *
+ * 编译期的积分策略，用 PhysicalWorld::setIntegrator 选择：半隐式欧拉（一阶，默认）、速度 Verlet（二阶辛积分）、
+ * RK4（四阶）、蛙跳（二阶辛积分）。每个策略提供 step(p, v, field, dt)，field(p, v, a) 写出该状态下的加速度；
+ * 世界按选定的策略实例化整个物理更新循环。世界中的力每步只在步首计算一次（常加速度），
+ * 与位置有关的力场（引力、弹簧）直接调用策略的 step 时，各方法才体现出不同的阶数。
+ *=========================================================================================================*/
+
+// 积分方法
+enum IntegratorType {
+	INTEGRATOR_SEMI_IMPLICIT_EULER,   // 半隐式欧拉（默认）
+	INTEGRATOR_VELOCITY_VERLET,       // 速度 Verlet
+	INTEGRATOR_RK4,                   // 四阶 Runge-Kutta
+	INTEGRATOR_LEAPFROG               // 蛙跳
+};
+
+inline const char* getIntegratorName(IntegratorType type) {
+	switch (type) {
+		case INTEGRATOR_SEMI_IMPLICIT_EULER: return "SemiImplicitEuler";
+		case INTEGRATOR_VELOCITY_VERLET:     return "VelocityVerlet";
+		case INTEGRATOR_RK4:                 return "RK4";
+		case INTEGRATOR_LEAPFROG:            return "Leapfrog";
+	}
+	return "Unknown";
+}
+
+template <IntegratorType Type>
+struct Integrator;
+
+template <>
+struct Integrator<INTEGRATOR_SEMI_IMPLICIT_EULER> {
+	static const int kEvaluations = 1;
+
+	template <class Field>
+	static void step(double* p, double* v, const Field& field, double dt) {
+		double a[2];
+		field(p, v, a);
+		v[0] += a[0] * dt;
+		v[1] += a[1] * dt;
+		p[0] += v[0] * dt;
+		p[1] += v[1] * dt;
+	}
+};
+
+template <>
+struct Integrator<INTEGRATOR_VELOCITY_VERLET> {
+	static const int kEvaluations = 2;
+
+	template <class Field>
+	static void step(double* p, double* v, const Field& field, double dt) {
+		const double half = 0.5 * dt;
+		double a[2];
+		field(p, v, a);
+		v[0] += a[0] * half;          // 半步速度
+		v[1] += a[1] * half;
+		p[0] += v[0] * dt;
+		p[1] += v[1] * dt;
+		field(p, v, a);               // 新位置的加速度
+		v[0] += a[0] * half;
+		v[1] += a[1] * half;
+	}
+};
+
+template <>
+struct Integrator<INTEGRATOR_RK4> {
+	static const int kEvaluations = 4;
+
+	template <class Field>
+	static void step(double* p, double* v, const Field& field, double dt) {
+		const double half = 0.5 * dt;
+		double p2[2], v2[2], p3[2], v3[2], p4[2], v4[2];
+		double a1[2], a2[2], a3[2], a4[2];
+
+		field(p, v, a1);
+		p2[0] = p[0] + v[0] * half;  p2[1] = p[1] + v[1] * half;
+		v2[0] = v[0] + a1[0] * half; v2[1] = v[1] + a1[1] * half;
+		field(p2, v2, a2);
+		p3[0] = p[0] + v2[0] * half; p3[1] = p[1] + v2[1] * half;
+		v3[0] = v[0] + a2[0] * half; v3[1] = v[1] + a2[1] * half;
+		field(p3, v3, a3);
+		p4[0] = p[0] + v3[0] * dt;   p4[1] = p[1] + v3[1] * dt;
+		v4[0] = v[0] + a3[0] * dt;   v4[1] = v[1] + a3[1] * dt;
+		field(p4, v4, a4);
+
+		const double sixth = dt / 6.0;
+		p[0] += (v[0] + 2.0 * v2[0] + 2.0 * v3[0] + v4[0]) * sixth;
+		p[1] += (v[1] + 2.0 * v2[1] + 2.0 * v3[1] + v4[1]) * sixth;
+		v[0] += (a1[0] + 2.0 * a2[0] + 2.0 * a3[0] + a4[0]) * sixth;
+		v[1] += (a1[1] + 2.0 * a2[1] + 2.0 * a3[1] + a4[1]) * sixth;
+	}
+};
+
+template <>
+struct Integrator<INTEGRATOR_LEAPFROG> {
+	static const int kEvaluations = 1;
+
+	template <class Field>
+	static void step(double* p, double* v, const Field& field, double dt) {
+		const double half = 0.5 * dt;
+		double a[2];
+		p[0] += v[0] * half;          // 半步位置
+		p[1] += v[1] * half;
+		field(p, v, a);
+		v[0] += a[0] * dt;
+		v[1] += a[1] * dt;
+		p[0] += v[0] * half;
+		p[1] += v[1] * half;
+	}
+};
+
+// 常加速度（世界内部使用：步首累加的合力除以质量）
+struct ConstantAcceleration {
+	double ax, ay;
+	ConstantAcceleration(double x, double y) : ax(x), ay(y) {}
+	void operator()(const double*, const double*, double* a) const {
+		a[0] = ax;
+		a[1] = ay;
+	}
+};
+
+/*=========================================================================================================
+ * 积分一个物体：按策略推进位置和速度，最后清空合力
+ *
+ * 摩擦力导致速度反向时该方向速度置 0：
+ *   半隐式欧拉保持原来的处理（对所有物体判断，位置不动），与 integrateBodyVelocity + x += v·dt 逐位相同；
+ *   其他积分器只对被支撑（受摩擦力）的物体判断，位置取常加速度下速度减到 0 的位置 x0 - v0²/(2a)，
+ *   在空中的物体（例如上抛到最高点）不截断。
+ * 受约束（constrained）且在空中的物体（摆、链条）速度反向是约束造成的，任何积分器都不截断。
+ *=========================================================================================================*/
+template <IntegratorType Type>
+inline void integrateBodyMotion(double m, double* position, double* velocity, double* force, double deltaTime, bool supported,
+                                bool constrained = false) {
+	if (m > 0.0) {
+		const double a[2] = {force[0] / m, force[1] / m};
+		const double p0[2] = {position[0], position[1]};
+		const double v0[2] = {velocity[0], velocity[1]};
+		Integrator<Type>::step(position, velocity, ConstantAcceleration(a[0], a[1]), deltaTime);
+
+		for (int k = 0; k < 2; k++) {
+			// 速度反向且加速度与原速度方向相反时，是摩擦力导致的过度减速
+			if (v0[k] != 0.0 && velocity[k] * v0[k] < 0 && a[k] * v0[k] < 0) {
+				if (Type == INTEGRATOR_SEMI_IMPLICIT_EULER && (supported || !constrained)) {
+					velocity[k] = 0.0;
+					position[k] = p0[k];
+				} else if (supported) {
+					velocity[k] = 0.0;
+					position[k] = p0[k] - v0[k] * v0[k] / (2.0 * a[k]);
+				}
+			}
+		}
+	} else {
+		// 没有质量的物体不受力，匀速运动
+		position[0] += velocity[0] * deltaTime;
+		position[1] += velocity[1] * deltaTime;
+	}
+	force[0] = 0.0;
+	force[1] = 0.0;
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef _ISLAND_H_
+#define _ISLAND_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+#include "broadphase.h"
+
+/*=========================================================================================================
+ * 接触岛（Island）划分与并行求解
+ *
+ * 作用：一步中只有候选物体对之间可能产生支撑、摩擦、碰撞和连续碰撞，所以用并查集按候选对把物体
+ *       连成若干个岛，不同岛之间在这一步内互不影响，可以交给不同的线程各自完成整步计算。
+ *
+ * 每个岛内的物体保持在形状列表中的顺序，候选对保持 (i, j) 的排序，所以岛内各阶段的计算顺序
+ * 与整个世界一起计算时完全相同，结果与线程数量无关（逐位相同）。
+ *=========================================================================================================*/
+
+// 并查集：带路径减半的查找；合并时保留较小的下标作为根，结果与合并顺序无关
+int findIslandRoot(std::vector<int>& parent, int i);
+void mergeIslandRoots(std::vector<int>& parent, int a, int b);
+
+/*=========================================================================================================
+ * IslandBuilder - 按候选物体对把物体划分为岛
+ * 岛按其中最小的物体下标排序；岛内的物体按下标升序排列，候选对改为岛内下标并保持原来的顺序。
+ *=========================================================================================================*/
+class IslandBuilder {
+public:
+	void build(size_t count, const std::vector<CandidatePair>& pairs);
+
+	size_t getIslandCount() const { return islandBodyStart.empty() ? 0 : islandBodyStart.size() - 1; }
+	size_t getLargestIslandSize() const { return largestIsland; }
+
+	// 第 k 个岛的物体（形状列表下标）与候选对（岛内下标）
+	size_t getBodyCount(size_t k) const { return islandBodyStart[k + 1] - islandBodyStart[k]; }
+	const int* getBodies(size_t k) const { return islandBodies.data() + islandBodyStart[k]; }
+	size_t getPairCount(size_t k) const { return islandPairStart[k + 1] - islandPairStart[k]; }
+	const CandidatePair* getPairs(size_t k) const { return islandPairs.data() + islandPairStart[k]; }
+
+private:
+	std::vector<int> parent;
+	std::vector<int> islandOfBody;        // 物体所在的岛
+	std::vector<int> localIndex;          // 物体在岛内的下标
+	std::vector<int> islandBodyStart;     // CSR：岛 k 的物体为 islandBodies[start[k], start[k+1])
+	std::vector<int> islandBodies;
+	std::vector<int> islandPairStart;     // CSR：岛 k 的候选对为 islandPairs[start[k], start[k+1])
+	std::vector<CandidatePair> islandPairs;
+	size_t largestIsland = 0;
+};
+
+/*=========================================================================================================
+ * ThreadPool - 固定数量的工作线程
+ * parallelFor(count, task) 对 index ∈ [0, count) 调用 task(index, worker)，全部完成后才返回。
+ * 调用线程本身作为 0 号工作线程参与计算；worker ∈ [0, getThreadCount())，用于选择线程各自的临时数据。
+ * 线程数量为 1 时不创建任何线程，直接在调用线程中依次执行。
+ *=========================================================================================================*/
+class ThreadPool {
+public:
+	ThreadPool() = default;
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void setThreadCount(int count);
+	int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+	void parallelFor(size_t count, const std::function<void(size_t, int)>& task);
+
+private:
+	void workerLoop(int worker, size_t seenGeneration);
+	void runTasks(int worker);
+	void stopWorkers();
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wakeCondition;
+	std::condition_variable doneCondition;
+	const std::function<void(size_t, int)>* currentTask = nullptr;
+	size_t taskCount = 0;
+	std::atomic<size_t> nextTask{0};
+	size_t generation = 0;                // 每次 parallelFor 加 1，唤醒工作线程
+	int busyWorkers = 0;
+	bool stopping = false;
+};
+
+#endif
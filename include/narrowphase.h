@@ -0,0 +1,96 @@
+#ifndef _NARROWPHASE_H_
+#define _NARROWPHASE_H_
+
+#include <vector>
+#include <cstddef>
+#include "shapes.h"
+#include "broadphase.h"
+
+/*=========================================================================================================
+ * 批量窄相位（Narrowphase）
+ *
+ * 作用：宽相位之后的候选物体对中，绝大多数是圆-圆、圆-矩形（AABB），而且大多并不接触。
+ *       把物体的中心和尺寸整理成连续的数组（SoA），一次检测 2 个（SSE2）或 4 个（AVX2）物体对，
+ *       用距离的平方比较，不开平方；只有接触的物体对才计算法向和穿透深度，写成紧凑的接触记录。
+ *       其余组合（矩形-矩形、斜坡等）逐对调用 check_collision。
+ *
+ * 运行时检测 CPU 支持的指令集，选择最快的实现；标量实现使用完全相同的运算顺序，
+ * 所以任何指令集下的结果都逐位相同，也与 check_collision 的判定相同。
+ *=========================================================================================================*/
+
+// 批量检测使用的指令集
+enum NarrowphaseISA {
+	NARROWPHASE_SCALAR,   // 逐个计算（所有平台）
+	NARROWPHASE_SSE2,     // 每次 2 个物体对（x86）
+	NARROWPHASE_AVX2      // 每次 4 个物体对（x86，运行时检测）
+};
+
+// CPU 支持的最高指令集
+NarrowphaseISA detectNarrowphaseISA();
+const char* getNarrowphaseISAName(NarrowphaseISA isa);
+
+// 接触记录：法向由 first 指向 second，穿透深度相切时为 0
+struct NarrowphaseContact {
+	int pair;             // 候选对在输入数组中的下标
+	double nx, ny;
+	double depth;
+};
+
+/*=========================================================================================================
+ * BatchNarrowphase - 对一组候选物体对做窄相位检测
+ * collide() 输出所有接触的物体对，按候选对的顺序排列。各个数组跨帧复用，避免每步分配内存。
+ *=========================================================================================================*/
+class BatchNarrowphase {
+public:
+	BatchNarrowphase() : isa(detectNarrowphaseISA()), batchedPairs(0), scalarPairs(0) {}
+
+	// 指定指令集（超过 CPU 支持的指令集时使用 CPU 支持的最高指令集），用于对照验证
+	void setISA(NarrowphaseISA requested);
+	NarrowphaseISA getISA() const { return isa; }
+
+	void collide(const std::vector<Shape*>& shapes, const CandidatePair* pairs, size_t pairCount,
+	             std::vector<NarrowphaseContact>& contacts);
+
+	// 最近一次 collide() 中批量检测和逐对检测的物体对数量
+	size_t getBatchedPairCount() const { return batchedPairs; }
+	size_t getScalarPairCount() const { return scalarPairs; }
+
+	// 每个物体的类型、中心和尺寸（圆：extentX 为半径；矩形：半宽、半高），按物体下标存放
+	struct ShapeData {
+		std::vector<char> kind;
+		std::vector<double> x, y, extentX, extentY;
+	};
+
+	// 圆-圆：两个圆的物体下标（first、second）和候选对下标
+	struct CircleCircleBatch {
+		std::vector<int> a, b, pair;
+		size_t count;         // 有效元素个数；数组只增不减，按下标写入
+		CircleCircleBatch() : count(0) {}
+		void reserve(size_t capacity);
+	};
+
+	// 圆-矩形：圆和矩形的物体下标；circleFirst 表示圆是候选对中的 first
+	struct CircleRectBatch {
+		std::vector<int> circle, rect, pair;
+		std::vector<char> circleFirst;
+		size_t count;
+		CircleRectBatch() : count(0) {}
+		void reserve(size_t capacity);
+	};
+
+private:
+	NarrowphaseISA isa;
+	size_t batchedPairs;
+	size_t scalarPairs;
+
+	ShapeData shapeData;
+	CircleCircleBatch circleCircle;
+	CircleRectBatch circleRect;
+	std::vector<int> otherPairs;
+	std::vector<NarrowphaseContact> circleCircleContacts;
+	std::vector<NarrowphaseContact> circleRectContacts;
+	std::vector<NarrowphaseContact> otherContacts;
+	std::vector<NarrowphaseContact> mergeScratch;
+};
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef _PARTICLES_H_
+#define _PARTICLES_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "broadphase.h"
+#include "island.h"
+#include "fluid.h"
+
+/*=========================================================================================================
+ * 粒子系统（Particle System）
+ *
+ * 大量没有名字、类型的小圆，状态放在平行数组中（位置、速度用 float），数组按容量一次分配。
+ * 通过 PhysicalWorld::addParticleEmitter / spawnParticle 加入粒子：发射器按每秒数量连续发射，
+ * 寿命耗尽或离开世界边界的粒子被回收（用最后一个存活的粒子填补空位）。
+ * 每步按块并行地积分、与地面和静态形状碰撞，结果与线程数无关；粒子不影响动态物体。
+ * 流体、颗粒模式下粒子之间按位置约束相互作用（见 fluid.h）。
+ *=========================================================================================================*/
+
+// 发射器
+struct ParticleEmitter {
+	double x, y;              // 发射位置
+	double width;             // 发射口的宽度：位置在垂直于发射方向、以 (x, y) 为中点的线段上均匀随机（0 为一个点）
+	double angle;             // 发射方向（弧度，0 为 +x，π/2 为 +y）
+	double spread;            // 方向在 angle ± spread 内均匀随机
+	double speedMin, speedMax;
+	double rate;              // 每秒发射的粒子数
+	double lifetime;          // 粒子寿命（秒），不大于 0 时不限
+	double radius;            // 粒子半径
+	double restitution;       // 与地面、静态形状碰撞时的恢复系数（流体、颗粒模式下不起作用）
+	bool enabled;             // 关闭后不再连续发射（emit() 仍然可以一次发射若干个）
+
+	ParticleEmitter() : x(0.0), y(0.0), width(0.0), angle(1.5707963267948966), spread(0.3), speedMin(5.0), speedMax(10.0),
+	                    rate(1000.0), lifetime(5.0), radius(0.05), restitution(0.5), enabled(true) {}
+};
+
+// 粒子碰撞使用的静态形状（由调用方从形状转换）
+struct ParticleCollider {
+	enum Kind { BOX, CIRCLE, SEGMENT };
+	Kind kind;
+	double minX, minY, maxX, maxY;   // 盒子；圆、线段为包围盒
+	double cx, cy, radius;           // 圆
+	double ax, ay, bx, by;           // 线段（斜坡）的两端
+};
+
+/*
+ * 把半径为 r、圆心在 (x, y) 的粒子移出 collider，返回是否移动过，(nx, ny) 为推出的方向。
+ * (lastX, lastY) 为粒子上一次的位置：圆心穿进盒子或穿过线段时推回原来的一侧，薄墙、斜坡不会被穿过
+ */
+bool separateParticle(const ParticleCollider& collider, double& x, double& y, double r, double lastX, double lastY,
+                      double& nx, double& ny);
+
+// 粒子统计信息（每步更新）
+struct ParticleStats {
+	size_t liveCount;         // 本步结束时存活的粒子数
+	size_t emitted;           // 本步发射的粒子数
+	size_t dropped;           // 容量已满而没有发射的粒子数
+	size_t recycled;          // 本步回收的粒子数（寿命耗尽或离开边界）
+	size_t collisions;        // 本步与地面、静态形状的碰撞次数
+
+	ParticleStats() : liveCount(0), emitted(0), dropped(0), recycled(0), collisions(0) {}
+};
+
+/*=========================================================================================================
+ * ParticleSystem - 平行数组中的粒子与发射器
+ *=========================================================================================================*/
+class ParticleSystem {
+public:
+	// 查询与 area 重叠的静态形状，追加到 result；worker 为调用的工作线程（用于选择线程各自的临时数据）
+	typedef std::function<void(const BroadphaseBounds& area, std::vector<ParticleCollider>& result, int worker)> ColliderQuery;
+
+	ParticleSystem() : capacity(1 << 20), count(0), rngState(0x9e3779b97f4a7c15ULL), mode(PARTICLE_BALLISTIC) {
+		groupRestitution.push_back(0.5);
+	}
+
+	// 最多同时存活的粒子数（默认 2^20）；容量不足以容纳现有粒子时多出的粒子被丢弃
+	void setCapacity(size_t maxParticles);
+	size_t getCapacity() const { return capacity; }
+
+	// 发射器：返回编号，之后用编号修改或删除
+	int addEmitter(const ParticleEmitter& emitter);
+	ParticleEmitter* getEmitter(int id);
+	bool removeEmitter(int id);
+	void clearEmitters();
+
+	// 由发射器立即发射 n 个粒子，返回实际发射的数量
+	size_t emit(int emitterId, size_t n);
+	// 直接加入一个粒子（恢复系数为 0.5），容量已满时返回 false
+	bool spawn(double x, double y, double vx, double vy, double lifetime, double radius);
+
+	// 删除所有粒子（发射器保留）
+	void clear() { count = 0; }
+	size_t size() const { return count; }
+
+	// 存活粒子的状态：下标 [0, size())；分组为发射器编号 + 1（spawn 加入的粒子为 0）
+	const float* positionX() const { return px.data(); }
+	const float* positionY() const { return py.data(); }
+	const float* velocityX() const { return vx.data(); }
+	const float* velocityY() const { return vy.data(); }
+	const float* remainingLife() const { return life.data(); }
+	const float* radius() const { return rad.data(); }
+	const uint16_t* group() const { return groups.data(); }
+
+	// 是否有需要计算的内容（存活的粒子或开启的发射器）
+	bool isActive() const;
+
+	// 粒子之间的作用方式（默认互不影响）与流体、颗粒的参数
+	void setMode(ParticleMode m) { mode = m; }
+	ParticleMode getMode() const { return mode; }
+	void setFluidSettings(const FluidSettings& settings) {
+		fluidSettings = settings;
+		if (fluidSettings.iterations < 1) fluidSettings.iterations = 1;
+	}
+	const FluidSettings& getFluidSettings() const { return fluidSettings; }
+	const FluidStats& getFluidStats() const { return fluid.getStats(); }
+
+	/*
+	 * 推进 deltaTime：发射、积分（竖直向下的重力 gravity）、与 y = groundY 的地面和 query 返回的静态形状碰撞，
+	 * 回收寿命耗尽或离开 bounds 的粒子。query 为空时不与静态形状碰撞；pool 不为空时按块并行
+	 */
+	void step(double deltaTime, double gravity, double groundY, const BroadphaseBounds& bounds,
+	          const ColliderQuery& query, ThreadPool* pool = nullptr);
+
+	const ParticleStats& getStats() const { return stats; }
+
+	// 每块的粒子数（并行和查询静态形状的单位）
+	static const size_t kChunkSize = 8192;
+
+private:
+	struct EmitterSlot {
+		ParticleEmitter emitter;
+		double pending;   // 尚未发射的零头
+		bool alive;
+	};
+
+	void reserveArrays();
+	bool push(float x, float y, float vx0, float vy0, float lifetime, float radius, uint16_t group);
+	size_t emitFrom(int id, size_t n);
+	double random01();
+	// 处理 [begin, end) 的粒子，返回碰撞次数；寿命耗尽或离开边界的粒子剩余寿命置为负数
+	size_t updateRange(size_t begin, size_t end, float dt, float gravity, float groundY, const BroadphaseBounds& bounds,
+	                   const ColliderQuery& query, int worker);
+	// 流体、颗粒模式的一步（发射之后）
+	void stepInteracting(double deltaTime, double gravity, double groundY, const BroadphaseBounds& bounds,
+	                     const ColliderQuery& query, ThreadPool* pool);
+	// 回收寿命不大于 0 的粒子；withStart 时本步开始的位置一起移动
+	void recycle(bool withStart);
+	// 按 fluid 给出的顺序重新排列所有粒子数组
+	void applyOrder(const std::vector<uint32_t>& order);
+
+	size_t capacity;
+	size_t count;
+	uint64_t rngState;
+	ParticleStats stats;
+
+	std::vector<float> px, py, vx, vy, life, rad;
+	std::vector<uint16_t> groups;
+	std::vector<float> groupRestitution;   // 分组 -> 恢复系数
+
+	std::vector<EmitterSlot> emitters;
+	std::vector<std::vector<ParticleCollider> > workerColliders;   // workerColliders[worker]：本块的静态形状
+	std::vector<size_t> chunkCollisions;
+
+	// 流体、颗粒模式
+	ParticleMode mode;
+	FluidSettings fluidSettings;
+	ParticleFluid fluid;
+	std::vector<float> startX, startY;          // 本步开始时的位置
+	std::vector<float> correctionX, correctionY;
+	std::vector<float> permuteScratch;
+	std::vector<uint16_t> groupScratch;
+	std::vector<std::vector<ParticleCollider> > chunkColliders;   // chunkColliders[块]：本步的静态形状
+};
+
+#endif
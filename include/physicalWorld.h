@@ -2,8 +2,32 @@
 #define _PHYSICALWORLD_H_
 
 #include <vector>
+#include <deque>
 #include <string>
 #include "shapes.h"
+#include "broadphase.h"
+#include "contact.h"
+#include "island.h"
+#include "narrowphase.h"
+#include "bodyStore.h"
+#include "shapePool.h"
+#include "shapeIndex.h"
+#include "shapeHandle.h"
+#include "integrator.h"
+#include "gravity.h"
+#include "constraint.h"
+#include "particles.h"
+
+// ߼Ľе״λռ߶γȵı fraction  [0, 1]еͱ淨
+// ߶״ڲʱ fraction Ϊ 0߶η෴
+struct RaycastHit {
+	Shape* shape;
+	double fraction;
+	double x, y;
+	double nx, ny;
+
+	RaycastHit() : shape(nullptr), fraction(1.0), x(0.0), y(0.0), nx(0.0), ny(0.0) {}
+};
 
 struct PhysicalWorld {
 public:
@@ -22,6 +46,21 @@ public:
 	// Ĭʱ䲽룩
 	double timeStep;
 	
+	// ַ integrator.h
+	IntegratorType integratorType;
+	
+	// ӦӲ
+	bool adaptiveSubstepping;
+	int maxSubsteps;
+	double substepMotionLimit;
+	double substepPenetrationLimit;
+	int substepCount;
+	double worstPenetration;
+	
+	// ֲʱ䲽 gravity.h
+	bool mutualGravity;
+	bool blockTimestepping;
+	
 	// ı߽ [left, right, bottom, top]
 	double bounds[4];
 	
@@ -34,11 +73,11 @@ public:
 	Ground ground;  // ĵ
 	
 	// 캯ĬΪ9.8Ĭʱ䲽Ϊ1/60루60 FPSĬϱ߽Ϊ [-1000, 1000, -1000, 1000]
-	PhysicalWorld() : gravity(9.8), gravity_vertical(9.8), inclineAngle(0.0), timeStep(1.0/60.0), bounds{-1000.0, 1000.0, -1000.0, 1000.0}, isPaused(false) {}
+	PhysicalWorld() : gravity(9.8), gravity_vertical(9.8), inclineAngle(0.0), timeStep(1.0/60.0), integratorType(INTEGRATOR_SEMI_IMPLICIT_EULER), adaptiveSubstepping(false), maxSubsteps(8), substepMotionLimit(0.5), substepPenetrationLimit(0.02), substepCount(1), worstPenetration(0.0), mutualGravity(false), blockTimestepping(false), bounds{-1000.0, 1000.0, -1000.0, 1000.0}, isPaused(false), broadphaseType(BROADPHASE_SPATIAL_HASH), supportCheckCount(0), staticTreeDirty(true), staticTreeBuildCount(0), staticCollisions(true), staticContactCount(0), contactSolverType(CONTACT_SOLVER_DIRECT), warmStarting(true), contactIterations(8), contactTolerance(1e-6), continuousCollision(true), ccdMotionThreshold(1.0), ccdAdvanceCount(0), sleepingEnabled(true), sleepVelocityThreshold(0.01), sleepSteps(60), sleepingShapeCount(0), awakeListDirty(true), sleepingTreeList(nullptr), sleepingTreeListSize(0), sleepGroupsDeferred(false), blockCacheSourceCount(0), stepContexts(1), narrowphaseISA(detectNarrowphaseISA()), dynamicIndexStale(true) {}
 	
 	// ߽Ĺ캯
 	PhysicalWorld(double left, double right, double bottom, double top) 
-		: gravity(9.8), gravity_vertical(9.8), inclineAngle(0.0), timeStep(1.0/60.0), bounds{left, right, bottom, top}, isPaused(false) {}
+		: gravity(9.8), gravity_vertical(9.8), inclineAngle(0.0), timeStep(1.0/60.0), integratorType(INTEGRATOR_SEMI_IMPLICIT_EULER), adaptiveSubstepping(false), maxSubsteps(8), substepMotionLimit(0.5), substepPenetrationLimit(0.02), substepCount(1), worstPenetration(0.0), mutualGravity(false), blockTimestepping(false), bounds{left, right, bottom, top}, isPaused(false), broadphaseType(BROADPHASE_SPATIAL_HASH), supportCheckCount(0), staticTreeDirty(true), staticTreeBuildCount(0), staticCollisions(true), staticContactCount(0), contactSolverType(CONTACT_SOLVER_DIRECT), warmStarting(true), contactIterations(8), contactTolerance(1e-6), continuousCollision(true), ccdMotionThreshold(1.0), ccdAdvanceCount(0), sleepingEnabled(true), sleepVelocityThreshold(0.01), sleepSteps(60), sleepingShapeCount(0), awakeListDirty(true), sleepingTreeList(nullptr), sleepingTreeListSize(0), sleepGroupsDeferred(false), blockCacheSourceCount(0), stepContexts(1), narrowphaseISA(detectNarrowphaseISA()), dynamicIndexStale(true) {}
 	
 	// 
 	~PhysicalWorld() {}
@@ -50,6 +89,8 @@ public:
 		const double PI = 3.14159265358979323846;
 		double angleRad = inclineAngle * PI / 180.0;
 		gravity_vertical = gravity * std::cos(angleRad);
+		// ıԭֹܻᶯߵ
+		wakeAll();
 	}
 	
 	// ȡǰٶ
@@ -65,6 +106,8 @@ public:
 			const double PI = 3.14159265358979323846;
 			double angleRad = inclineAngle * PI / 180.0;
 			gravity_vertical = gravity * std::cos(angleRad);
+			// ıԭֹܻᶯߵ
+			wakeAll();
 		}
 	}
 	
@@ -126,7 +169,9 @@ public:
 	void removeDynamicShape(Shape* shape);
 	void removeStaticShape(Shape* shape);
 	
-	// ͨƲ״
+	// ͨƲ״ơͶ ShapeIndex еǼǣΪ O(1)Ͳֻʸ͵״
+	// ֱ޸ dynamicShapeList / staticShapeList һβʱһ»ؽ
+	// ޸ģ滻беԪأ֮ invalidateShapeIndex()
 	Shape* findShapeByName(const std::string& name);
 	Shape* findDynamicShapeByName(const std::string& name);
 	Shape* findStaticShapeByName(const std::string& name);
@@ -135,16 +180,26 @@ public:
 	std::vector<Shape*> findShapesByType(const std::string& type);
 	std::vector<Shape*> findDynamicShapesByType(const std::string& type);
 	std::vector<Shape*> findStaticShapesByType(const std::string& type);
+	void invalidateShapeIndex() { shapeIndex.clear(); }
 	
 	// ȡ״
 	size_t getDynamicShapeCount() const { return dynamicShapeList.size(); }
 	size_t getStaticShapeCount() const { return staticShapeList.size(); }
 	size_t getTotalShapeCount() const { return dynamicShapeList.size() + staticShapeList.size(); }
 	
-	// ״
+	// ״ڴе״ͬʱͷţclearAllShapes һͷأ
 	void clearDynamicShapes();
 	void clearStaticShapes();
 	void clearAllShapes();
+
+	// ========== ״ڴ ==========
+	// ڴд״縺ͷţ delete
+	// removeDynamicShape / removeStaticShape ʱյclearXxxShapes ʱͷ
+	// createShapeplaceXxxShapeByType placeWall ״Ҳ
+	template <class T, class... Args>
+	T* allocateShape(Args&&... args) { return shapePool.create<T>(std::forward<Args>(args)...); }
+	bool ownsShape(const Shape* shape) const { return shapePool.owns(shape); }
+	const ShapePool& getShapePool() const { return shapePool; }
 	
 	// ӡ״Ϣã
 	void printAllShapes() const;
@@ -152,6 +207,7 @@ public:
 	void printStaticShapes() const;
 
 	// ========== 򻯵ķӿ ==========
+	// ص״ڴأ allocateShape縺ͷţ߲ delete
 	// ֱͨͺƴö̬״
 	Shape* placeDynamicShapeByType(const std::string& type, const std::string& name, 
 	                                 double x_pos, double y_pos, 
@@ -182,6 +238,251 @@ public:
 	//   offsetX - ˮƽƫڵײ״ģĬ0ʾж룩
 	void placeShapeOnShape(Shape& topShape, Shape& bottomShape, double offsetX = 0.0);
 
+	// ========== λײ ==========
+	// ѡλ㷨ĬϿռϣ
+	void setBroadphaseType(BroadphaseType type) { broadphaseType = type; }
+	BroadphaseType getBroadphaseType() const { return broadphaseType; }
+	
+	// ȡһĿλͳƣѡʡĲԴȣ
+	const BroadphaseStats& getBroadphaseStats() const;
+	
+	// ÿռϣĵԪС 0 ʾ״ߴԶ㣨Ĭϣ
+	void setBroadphaseCellSize(double size) { spatialHashBroadphase.setCellSize(size); }
+	double getBroadphaseCellSize() const { return spatialHashBroadphase.getCellSize(); }
+	
+	// ȡһ֧ż checkSupportStatus ĴԼΪѡ 2 
+	size_t getSupportCheckCount() const { return supportCheckCount; }
+	
+	// ========== ̬״Χ ==========
+	// ѯΧ״صľ̬״ staticShapeList е˳׷ӵ result
+	// ̬״ֻ addStaticShape / removeStaticShape / placeWall ֮ĵһβѯʱؽ
+	void queryStaticShapes(const Shape& shape, std::vector<Shape*>& result);
+	void queryStaticShapes(const BroadphaseBounds& area, std::vector<Shape*>& result);
+	
+	// ̬״ؽĴ
+	size_t getStaticTreeBuildCount() const { return staticTreeBuildCount; }
+	
+	// ÿԶ̬뾲̬״ǽڡ̬κԲײĬϿ
+	// ÿ̬ԼİΧвѯ̬״Ϊ O(log s)رպҪԼ handleWallCollision
+	void setStaticCollisions(bool enabled) { staticCollisions = enabled; }
+	bool getStaticCollisions() const { return staticCollisions; }
+	
+	// һĶ̬뾲̬״ײ
+	size_t getStaticContactCount() const { return staticContactCount; }
+
+	// ̬״̬洢addDynamicShape ʱ룬removeDynamicShape / clearDynamicShapes ʱƳ
+	// ֱӷŽ״бһ update() ʱ
+	const BodyStore& getBodyStore() const { return bodyStore; }
+
+	// ״addDynamicShape / addStaticShape ʱ䣨ֱӷŽб״һ update() ʱ䣩
+	// ƳʧЧresolveShape Ϊ O(1)ʧЧʱ nullptr
+	Shape* resolveShape(ShapeHandle handle) const { return handleTable.resolve(handle); }
+	bool isValidShape(ShapeHandle handle) const { return handleTable.isValid(handle); }
+
+	// ==========  ==========
+	// ѡַĬ INTEGRATOR_SEMI_IMPLICIT_EULERԭ"ٶȡλ"
+	// еÿֻһΣַԳٶȸȷ⣬塢бڽϴ timeStep Ҳһ
+	void setIntegrator(IntegratorType type) { integratorType = type; }
+	IntegratorType getIntegrator() const { return integratorType; }
+
+	// ========== ӦӲ ==========
+	//  update() һ֡ deltaTime ֳӲÿӲ֮ٶߴ֮ȡ
+	// Ӳײʱ͸ȣʣʱ仹Ҫֳɼƽĳֻһҵĳ߸ಽ
+	// ÿ֡ maxSubsteps ĬϹرգÿ update() ֻһ
+	void setAdaptiveSubstepping(bool enabled) { adaptiveSubstepping = enabled; }
+	bool getAdaptiveSubstepping() const { return adaptiveSubstepping; }
+	void setMaxSubsteps(int count) { if (count >= 1) maxSubsteps = count; }
+	int getMaxSubsteps() const { return maxSubsteps; }
+	
+	// ÿӲλƲߴ磨Բİ뾶״Χн϶̱ߵһ룩Ĭ 0.5
+	void setSubstepMotionLimit(double fraction) { if (fraction > 0.0) substepMotionLimit = fraction; }
+	double getSubstepMotionLimit() const { return substepMotionLimit; }
+	
+	// Ӳײ͸ȳֵףʱıʣӲĬ 0.02
+	void setSubstepPenetrationLimit(double depth) { if (depth > 0.0) substepPenetrationLimit = depth; }
+	double getSubstepPenetrationLimit() const { return substepPenetrationLimit; }
+	
+	// һ update() ߵӲԼһӲײʱ͸
+	int getSubstepCount() const { return substepCount; }
+	double getWorstPenetration() const { return worstPenetration; }
+
+	// ==========  ==========
+	// ÿԲ̬;̬ģ壺ڿеĶ̬岻ܾ gravityΪԲ
+	// ֧ŵ԰ gravity ѹĦÿʼʱһĬϹرգ
+	// Ĭ Barnes-Hut ĲÿؽO(n log n)GRAVITY_SOLVER_DIRECT Ϊ͵Ķս
+	void setMutualGravity(bool enabled) { mutualGravity = enabled; }
+	bool getMutualGravity() const { return mutualGravity; }
+	void setGravitySolver(GravitySolverType type) { gravitySolver.setType(type); }
+	GravitySolverType getGravitySolver() const { return gravitySolver.getType(); }
+	void setGravitationalConstant(double g) { gravitySolver.setGravitationalConstant(g); }
+	double getGravitationalConstant() const { return gravitySolver.getGravitationalConstant(); }
+	
+	// Ž ȣĬ 0.5ԽСԽȷԽ0 ʱ͵Ľֻ
+	void setGravityOpeningAngle(double angle) { gravitySolver.setOpeningAngle(angle); }
+	double getGravityOpeningAngle() const { return gravitySolver.getOpeningAngle(); }
+	
+	// ȣĬ 0ǳӽʱᷢɢ
+	void setGravitySoftening(double length) { gravitySolver.setSoftening(length); }
+	double getGravitySoftening() const { return gravitySolver.getSoftening(); }
+	
+	// һͳƣĲڵ໥ôȣ
+	const GravityStats& getGravityStats() const { return gravitySolver.getStats(); }
+	
+	// ========== ֲʱ䲽ģʽ==========
+	// ͬʱڿеĶ̬԰ t / 2^k Ĳ kick-drift-kick ֣
+	// k ļٶȺٶѡȦĿٹСȦٹߴ󲽣֡ĩͬĬϹرգ
+	void setBlockTimestepping(bool enabled) { blockTimestepping = enabled; }
+	bool getBlockTimestepping() const { return blockTimestepping; }
+	
+	// ʱ߶ |v|/|a| + sqrt(ߴ/|a|) ֮ȣĬ 0.02ԽСԽСԽ
+	void setBlockTimestepAccuracy(double eta) { blockTimestepper.setAccuracy(eta); }
+	double getBlockTimestepAccuracy() const { return blockTimestepper.getAccuracy(); }
+	
+	// Ĭ 10һֳ֡ 1024 
+	void setMaxBlockRung(int rung) { blockTimestepper.setMaxRung(rung); }
+	int getMaxBlockRung() const { return blockTimestepper.getMaxRung(); }
+	
+	// һͳƣٶȵĴ
+	const BlockStepStats& getBlockStepStats() const { return blockTimestepper.getStats(); }
+
+	// ========== Լڡӡ==========
+	// Լе״һ״̶㣨 constraint.hÿе֮ XPBD ⡣
+	// length С 0 ʱȡ˵ǰľ룻compliance Ϊȣ0 ΪԣԼţ״лϷʱ -1
+	int addDistanceConstraint(Shape* a, Shape* b, double length = -1.0, double compliance = 0.0);
+	int addRopeConstraint(Shape* a, Shape* b, double maxLength = -1.0, double compliance = 0.0);
+	
+	// ״̶ (x, y) ľ뱣Ϊ length0 ʱ״ڸõ㣬Ĭȡǰ루ڣ
+	int addPinConstraint(Shape* shape, double x, double y, double length = -1.0, double compliance = 0.0);
+	// ״̶ (x, y) ֮ӣ벻 maxLength
+	int addAnchoredRopeConstraint(Shape* shape, double x, double y, double maxLength = -1.0, double compliance = 0.0);
+	
+	bool removeConstraint(int id) { return constraintSolver.remove(id); }
+	void clearConstraints() { constraintSolver.clear(); }
+	size_t getConstraintCount() const { return constraintSolver.size(); }
+	
+	// ÿĵĬ 10ԽҪԽֱֲ
+	void setConstraintIterations(int count) { constraintSolver.setIterations(count); }
+	int getConstraintIterations() const { return constraintSolver.getIterations(); }
+	
+	// һͳƣԼɫʣԼԼѯȡɫ
+	const ConstraintStats& getConstraintStats() const { return constraintSolver.getStats(); }
+	const ConstraintSolver& getConstraintSolver() const { return constraintSolver; }
+
+	// ==========  ==========
+	// ƽû֡͵СԲ particles.hɷ䣬ֻ;̬״ǽڡΡԲб£ײ
+	// ľ뿪߽աÿ֮ƽûӺͷʱκμ
+	int addParticleEmitter(const ParticleEmitter& emitter) { return particleSystem.addEmitter(emitter); }
+	ParticleEmitter* getParticleEmitter(int id) { return particleSystem.getEmitter(id); }
+	bool removeParticleEmitter(int id) { return particleSystem.removeEmitter(id); }
+	
+	// ɷ count ӣһ緢ʵʷ
+	size_t emitParticles(int emitterId, size_t count) { return particleSystem.emit(emitterId, count); }
+	// ֱӼһӣڳһˮɳʱ false
+	bool spawnParticle(double x, double y, double vx, double vy, double lifetime, double radius) {
+		return particleSystem.spawn(x, y, vx, vy, lifetime, radius);
+	}
+	// ɾӺͷ
+	void clearParticles() { particleSystem.clear(); particleSystem.clearEmitters(); }
+	
+	// ͬʱĬ 2^20ʱٷ
+	void setMaxParticles(size_t count) { particleSystem.setCapacity(count); }
+	size_t getMaxParticles() const { return particleSystem.getCapacity(); }
+	
+	// ӣλáٶȵƽ飬ʱʹãһͳ
+	size_t getParticleCount() const { return particleSystem.size(); }
+	const ParticleSystem& getParticleSystem() const { return particleSystem; }
+	const ParticleStats& getParticleStats() const { return particleSystem.getStats(); }
+	
+	// ֮÷ʽ fluid.hĬϻӰ죻PARTICLE_FLUID ΪˮܶԼPARTICLE_GRANULAR Ϊɳ͸Ħ
+	void setParticleMode(ParticleMode mode) { particleSystem.setMode(mode); }
+	ParticleMode getParticleMode() const { return particleSystem.getMode(); }
+	void setFluidSettings(const FluidSettings& settings) { particleSystem.setFluidSettings(settings); }
+	const FluidSettings& getFluidSettings() const { return particleSystem.getFluidSettings(); }
+	// 塢ģʽһͳƣԪھʣѹص
+	const FluidStats& getFluidStats() const { return particleSystem.getFluidStats(); }
+
+	// ========== ײӦ ==========
+	// ѡײӦʽĬ CONTACT_SOLVER_DIRECTԭԵײʽ
+	void setContactSolver(ContactSolverType type) { contactSolverType = type; }
+	ContactSolverType getContactSolver() const { return contactSolverType; }
+	
+	// ʱǷһ֡ۻĬϿ
+	void setWarmStarting(bool enabled) { warmStarting = enabled; }
+	bool getWarmStarting() const { return warmStarting; }
+	
+	// ٶȺλøô֣Ĭ 8ԽԽȷԽ
+	void setContactIterations(int iterations) { if (iterations >= 1) contactIterations = iterations; }
+	int getContactIterations() const { return contactIterations; }
+	
+	// ֵһʣഩ͸ȣСڸֵʱǰĬ 1e-6
+	void setContactTolerance(double tolerance) { if (tolerance >= 0.0) contactTolerance = tolerance; }
+	double getContactTolerance() const { return contactTolerance; }
+	
+	// Ӵ棺һͳϢԼѯĳһ嵱ǰĽӴûнӴʱ nullptr
+	const ContactStats& getContactStats() const { return contactCache.getStats(); }
+	const ContactManifold* findContact(const Shape* a, const Shape* b) const { return contactCache.find(a, b); }
+	
+	// ========== ײ⣨CCD==========
+	// һλƳ ccdMotionThreshold  뾶ԲλɨӼ붯̬;̬ײ
+	// ֻƽһνӴλãƽ崩ǽĬϿֵΪ 1 뾶
+	void setContinuousCollision(bool enabled) { continuousCollision = enabled; }
+	bool getContinuousCollision() const { return continuousCollision; }
+	void setCCDMotionThreshold(double fraction) { if (fraction > 0.0) ccdMotionThreshold = fraction; }
+	double getCCDMotionThreshold() const { return ccdMotionThreshold; }
+	
+	// һƽײλã
+	size_t getContinuousCollisionCount() const { return ccdAdvanceCount; }
+	
+	// ==========  ==========
+	// ֧ٶȵ sleepVelocityThreshold 壬 sleepSteps ڵͨӴ֧źԼһ壩
+	// еȫߣκν׶Σλûѵʱ
+	// ӴͨԼ߱ setVelocity / setCentre / applyImpulse ʱѡ
+	void setSleepingEnabled(bool enabled);
+	bool getSleepingEnabled() const { return sleepingEnabled; }
+	void setSleepVelocityThreshold(double speed) { if (speed >= 0.0) sleepVelocityThreshold = speed; }
+	double getSleepVelocityThreshold() const { return sleepVelocityThreshold; }
+	void setSleepSteps(int steps) { if (steps >= 1) sleepSteps = steps; }
+	int getSleepSteps() const { return sleepSteps; }
+	
+	// һʱߵ
+	size_t getSleepingShapeCount() const { return sleepingShapeCount; }
+	
+	// 
+	void wakeAll();
+	
+	// ========== Ӵ벢 ==========
+	// ÿѡ԰ѵ廮ΪӰĵ㣨֧š֡CCDײߣ
+	// ù߳Ĭ 1ڵ߳μ߳޹أλͬ
+	void setWorkerThreads(int count);
+	int getWorkerThreads() const { return threadPool.getThreadCount(); }
+	
+	// һĵĵ
+	size_t getIslandCount() const { return islandBuilder.getIslandCount(); }
+	size_t getLargestIslandSize() const { return islandBuilder.getLargestIslandSize(); }
+	
+	// ========== խλ ==========
+	// ײǰкѡԣԲ-ԲԲ-ΰ SIMD һ 2 / 4 ԣĬʹ CPU ֵָ֧
+	// κָĽλͬΪ NARROWPHASE_SCALAR ڶ
+	void setNarrowphaseISA(NarrowphaseISA isa);
+	NarrowphaseISA getNarrowphaseISA() const { return narrowphaseISA; }
+	
+	// ========== ռѯ ==========
+	// ڶ̬;̬״вң׷ӵ÷ṩ飬׷ӵ
+	// ȶ̬壨 dynamicShapeList ˳򣩺̬״ staticShapeList ˳򣩡
+	// Բʵ״жϣ״ΧжϣԾκǽǾȷģ
+	// ̬屣һÿ֡İΧУÿ֮󣨻ɾ̬֮󣩵ĵһβѯʱ£
+	// βѯĴΪ O(log n + k)ֱ֮ƶ壨setCentreʱȵ invalidateSpatialIndex()
+	size_t queryPoint(double x, double y, std::vector<Shape*>& result);
+	size_t queryAABB(const BroadphaseBounds& area, std::vector<Shape*>& result);        // Χص
+	size_t queryRadius(double x, double y, double radius, std::vector<Shape*>& result);  // Բཻ
+	
+	// ߶ (x0, y0)  (x1, y1) ߼⣺raycast Уûʱ false
+	// raycastAll а fraction С׷ӵ hits
+	bool raycast(double x0, double y0, double x1, double y1, RaycastHit& hit);
+	size_t raycastAll(double x0, double y0, double x1, double y1, std::vector<RaycastHit>& hits);
+	
+	void invalidateSpatialIndex() { dynamicIndexStale = true; }
+
 	//==========бǶȲΪ0ʱҪбǶͶ䵽׼==========
 	std::vector<double> inclineToStandard(double x_rel, double y_rel) const;
 
@@ -195,13 +496,202 @@ private:
 		double vx, vy;         // ٶ
 		double mass;           // 
 		bool isSupported;      // ֧״̬
-		Shape* supporter;      // ֧
+		ShapeHandle supporter; // ֧ͣڼ֧ﱻɾҲգ
 		double normalForce[2]; // ѹ
 	};
 	
 	// ͣʱ״̬
 	std::vector<ShapeState> savedStates;
 	
+	// ========== λײ ==========
+	BroadphaseType broadphaseType;                 // ǰʹõĿλ㷨
+	BruteForceBroadphase bruteForceBroadphase;     // ȫԣ֤ã
+	SpatialHashGrid spatialHashBroadphase;         // ռϣÿؽ
+	SweepAndPrune sweepAndPruneBroadphase;         // ʽɨ裨֡˵㣩
+	AABBTreeBroadphase aabbTreeBroadphase;         // ̬Χ֡Ҷӣ
+	std::vector<CandidatePair> candidatePairs;     // ĺѡԣ֧żײã
+	size_t supportCheckCount;                      // һ֧ż֮ͣ
+	
+	// ȡǰѡĿλ㷨
+	Broadphase& activeBroadphase();
+	
+	// ̬״Ҷӵ userData Ϊ staticShapeList е±
+	DynamicAABBTree staticTree;
+	std::vector<int> unboundedStaticShapes;        // Χ޴ľ̬״
+	std::vector<int> staticQueryResult;
+	std::vector<int> staticQueryStack;
+	bool staticTreeDirty;                          // ̬״б޸ģҪؽ
+	size_t staticTreeBuildCount;
+	bool staticCollisions;                         // ÿԶ뾲̬״ײ
+	size_t staticContactCount;
+	
+	// ؽ̬״ staticTreeDirty ʱã
+	void rebuildStaticTree();
+	
+	// ========== ־ýӴʱʹã==========
+	ContactSolverType contactSolverType;
+	bool warmStarting;
+	int contactIterations;
+	double contactTolerance;
+	ContactCache contactCache;                     // Ϊ֡
+	
+	// ========== ײ ==========
+	bool continuousCollision;
+	double ccdMotionThreshold;
+	size_t ccdAdvanceCount;
+	
+	// ==========  ==========
+	bool sleepingEnabled;
+	double sleepVelocityThreshold;
+	int sleepSteps;
+	size_t sleepingShapeCount;
+	std::vector<Shape*> awakeShapes;               // ģѵģ壬б˳
+	bool awakeListDirty;                           // ˯ɾawakeShapes Ҫռ
+	// İΧߵ岻ҲÿĿλֻѵԼİΧвѯ
+	struct SleepingProxy {
+		int proxy;                                 // sleepingTree еҶӣΪ NULL_NODE
+		Shape* shape;
+	};
+	DynamicAABBTree sleepingTree;                  // Ҷӵ userData Ϊλ
+	std::vector<SleepingProxy> sleepingProxies;    // λ -> Ҷ
+	const std::vector<Shape*>* sleepingTreeList;   // Ӧ״бĳȣֱ޸бͷؽ
+	size_t sleepingTreeListSize;
+	std::vector<int> sleepQueryResult;
+	std::vector<Shape*> wakeStack;
+	// ԼʱֻõĲ鼯 linkConstrainedSleepGroups ԼϲͳһǷ˯
+	bool sleepGroupsDeferred;
+	std::vector<int> sleepGroupParent;             // BodyStore λ -> 鼯ĸڵ
+	std::vector<int> sleepGroupMin;                // 鼯ĸ -> Сĵٲ
+	
+	// ==========  ==========
+	GravitySolver gravitySolver;
+	std::vector<double> gravitySourcePositions;    // ԴеԲ
+	std::vector<double> gravitySourceMasses;
+	std::vector<double> gravityTargetPositions;    // 壨ѵĶ̬壩
+	std::vector<double> gravityTargetAccelerations;
+	std::vector<double> gravityField;              //  BodyStore λŵٶ (ax, ay)
+	
+	// ÿʼʱѵĶ̬ܵٶȣд gravityField
+	void computeMutualGravity(const std::vector<Shape*>& shapeList, const std::vector<Shape*>& activeShapes);
+	
+	// ========== ֲʱ䲽 ==========
+	BlockTimestepper blockTimestepper;
+	std::vector<unsigned char> blockStepped;       // λɷֲʱ䲽֣׶
+	std::vector<double> blockStartPositions;       // λǰλãײã
+	std::vector<double> blockCachedAcceleration;   // λһ֡ĩļٶȣһ֡׵ kick ֱʹ
+	std::vector<double> blockCachedPosition;       // λٶʱλã屻ƶʱ¼㣩
+	std::vector<unsigned char> blockCacheValid;
+	size_t blockCacheSourceCount;                  // ٶʱԴɾʱȫ¼㣩
+	std::vector<int> blockSlots;                   // 壨λԼе״̬
+	std::vector<double> blockPosition, blockVelocity, blockAcceleration, blockMass, blockSize;
+	std::vector<unsigned char> blockValid, blockIsSource;
+	
+	// ÿʼʱ÷ֲʱ䲽ѵġڿеĶ̬壨 computeMutualGravity ͵׶εĻ֣
+	void integrateGravityBlocks(const std::vector<Shape*>& shapeList, const std::vector<Shape*>& activeShapes, double deltaTime);
+	
+	// ========== Լ ==========
+	ConstraintSolver constraintSolver;
+	
+	// Լ״ڱ磬length С 0 ʱȡǰ
+	int addConstraint(ConstraintType type, Shape* a, Shape* b, double x, double y, double length, double compliance);
+	
+	// ==========  ==========
+	ParticleSystem particleSystem;
+	
+	// ƽӣÿԼİΧвѯһξ̬״
+	void stepParticles(double deltaTime, const Ground& ground);
+	
+	// ========== һһʹõʱݣÿ߳һݣ==========
+	struct StepContext {
+		std::vector<Shape*> islandShapes;          // ڵ壨ֻһʱʹãֱ״б
+		std::vector<int> islandSlots;
+		std::vector<CandidatePair> islandPairs;
+		const std::vector<CandidatePair>* pairs;   // ĺѡԣ±Ӧ׶ε״б
+		const int* bodySlots;                      // ״бÿ BodyStore еĲλ
+		
+		// ֧ɭ֣ÿؽ
+		std::vector<int> supportParent;            // ֧״бе±꣨-1 ʾ֧ţ
+		std::vector<int> supportChildStart;        // CSR i ѹŵΪ supportChildren[start[i], start[i+1])
+		std::vector<int> supportChildren;
+		std::vector<int> supportPending;           // ۼʱδӽڵ
+		std::vector<int> supportStack;
+		
+		// ײ
+		std::vector<double> stepStartPositions;    // ǰλ (x0, y0, x1, y1, ...)
+		std::vector<double> ccdTimeOfImpact;       // Բײʱ䣨λƱ 1 ʾҪ CCD
+		std::vector<const Shape*> ccdStaticHit;    // ľ̬״
+		std::vector<Shape*> ccdStaticQuery;
+		std::vector<int> staticQueryResult;
+		std::vector<int> staticQueryStack;
+		
+		// ̬ײ
+		std::vector<Shape*> staticContactQuery;
+		
+		// 
+		std::vector<ContactManifold*> activeContacts;  // ҪĽӴѡ˳
+		std::deque<ContactManifold> newContacts;   // ½ĽӴеӴ
+		ContactStats contactStats;
+		
+		// 
+		std::vector<CandidatePair> touchingPairs;  // ʵʽӴ
+		
+		// խλ
+		BatchNarrowphase narrowphase;
+		std::vector<NarrowphaseContact> narrowContacts;
+		std::vector<char> pairTouching;            // ѡײʼʱǷӴ
+		std::vector<char> shapeMoved;              // ѱǰײƶ
+		std::vector<int> sleepParent;              // 鼯
+		std::vector<int> sleepMinCounter;          // Сĵٲ
+		
+		// еۼӵ磩
+		size_t supportCheckCount;
+		size_t ccdAdvanceCount;
+		size_t staticContactCount;
+		size_t newlySleeping;
+		double maxPenetration;                     // ײʱ֧ŹϵģӴ͸
+		
+		StepContext() : pairs(nullptr), bodySlots(nullptr), supportCheckCount(0), ccdAdvanceCount(0), staticContactCount(0), newlySleeping(0), maxPenetration(0.0) {}
+		void resetCounters();
+	};
+	
+	// ========== ״̬洢 ==========
+	ShapePool shapePool;                           //  bodyStore ֮ǰʱ bodyStore ȰƳ
+	BodyStore bodyStore;
+	std::vector<int> activeSlots;                  //  BodyStore еĲλ
+	ShapeIndex shapeIndex;                         // ơ shapePool ֮ڳе״
+	HandleTable handleTable;                       // ״ͬϣ
+	
+	IslandBuilder islandBuilder;
+	ThreadPool threadPool;
+	std::vector<StepContext> stepContexts;         // stepContexts[worker]
+	NarrowphaseISA narrowphaseISA;
+	
+	// ========== ռѯ ==========
+	DynamicAABBTree dynamicIndex;                  // ̬ΧҶӵ userData Ϊ dynamicShapeList е±
+	std::vector<int> dynamicIndexProxies;          // ӦҶӣ޴Ϊ NULL_NODE
+	std::vector<int> unboundedDynamicShapes;
+	std::vector<Shape*> indexedDynamicShapes;      // ʱĶ̬бڼɾ
+	bool dynamicIndexStale;                        // ƶɾһβѯǰҪ
+	std::vector<int> spatialQueryIndices;
+	std::vector<int> spatialQueryStack;
+	std::vector<Shape*> rayCandidates;
+	
+	// ¶̬ΧбɾʱؽֻƶƳְΧеҶ
+	void refreshDynamicIndex();
+	// ѰΧ򣨻߶Σཻĺѡ״׷ӵ resultȶ̬̬״԰б˳
+	void collectAreaCandidates(const BroadphaseBounds& area, std::vector<Shape*>& result);
+	void collectRayCandidates(double x0, double y0, double dx, double dy, std::vector<Shape*>& result);
+	
+	// һԭ update()λֽӴ㣩
+	void step(std::vector<Shape*>& shapeList, double deltaTime, const Ground& ground);
+	// ӦӲٶߴ֮ȡһӲĴ͸ȣʣʱҪӲ current
+	int estimateSubsteps(const std::vector<Shape*>& shapeList, double remainingTime, int current) const;
+	
+	// һ㣨λ֮н׶Σ
+	void stepIsland(std::vector<Shape*>& shapeList, StepContext& ctx, double deltaTime, const Ground& ground);
+	void queryStaticShapes(const BroadphaseBounds& area, std::vector<Shape*>& result,
+	                       std::vector<int>& indexScratch, std::vector<int>& stackScratch);
+	
 	// ״̬ͻָ
 	void saveStates();
 	void restoreStates();
@@ -210,15 +700,35 @@ private:
 	// һ׶Σ֧״̬
 	void resetSupportStates(std::vector<Shape*>& shapeList);
 	
+	// һ׶Σλɱĺѡ
+	void generateCandidatePairs(std::vector<Shape*>& shapeList, double deltaTime);
+	
+	// ߣӴ壬رб
+	std::vector<Shape*>& collectAwakeShapes(std::vector<Shape*>& shapeList);
+	void gatherAwakeShapes(const std::vector<Shape*>& shapeList);
+	// 롢Ƴһߵ壻ͷؽ
+	void addSleepingProxy(Shape* shape);
+	void removeSleepingProxy(Shape* shape);
+	void rebuildSleepingTree(const std::vector<Shape*>& shapeList);
+	void resetSleepingTree();
+	//  seed ӴͨԼ壬Լ壻屻ʱ true
+	bool wakeTouchingSleepers(Shape* seed);
+	// ߣ״̬ÿã
+	void updateSleepStates(std::vector<Shape*>& shapeList, StepContext& ctx);
+	// ߣе֮󣬰Լ˵ϲȫʱһ˯˯
+	size_t linkConstrainedSleepGroups(std::vector<Shape*>& activeShapes);
+	
 	// ڶ׶Σ֧Źϵ
-	void detectSupportRelations(std::vector<Shape*>& shapeList, const Ground& ground);
+	void detectSupportRelations(std::vector<Shape*>& shapeList, StepContext& ctx, const Ground& ground);
 	
 	// ڶ׶Σѹۻ
-	void calculateNormalForces(std::vector<Shape*>& shapeList);
-	void calculateNormalForceRecursive(Shape* shape, std::vector<Shape*>& shapeList);
+	void calculateNormalForces(std::vector<Shape*>& shapeList, StepContext& ctx);
+	void buildSupportForest(std::vector<Shape*>& shapeList, StepContext& ctx);
 	
-	// ׶Σ
-	void updatePhysics(std::vector<Shape*>& shapeList, double deltaTime, const Ground& ground);
+	// ׶Σ£ integratorType ѡʵ updatePhysicsWith
+	void updatePhysics(std::vector<Shape*>& shapeList, StepContext& ctx, double deltaTime, const Ground& ground);
+	template <IntegratorType Type>
+	void updatePhysicsWith(std::vector<Shape*>& shapeList, StepContext& ctx, double deltaTime, const Ground& ground);
 	
 	// ׶εӲ裨ͳһ
 	void handleSupportedShapeWithGravity(Shape* shape, double deltaTime, const Ground& ground);
@@ -230,22 +740,34 @@ private:
 	
 	void applyFrictionOnSupporter(Shape* shape, Shape* supporter, double normalForce, double friction, double static_friction, double drivingForce);
 	
+	// ׶Σײ⣨ԲƽһνӴλã
+	void handleContinuousCollisions(std::vector<Shape*>& shapeList, StepContext& ctx);
+	
 	// Ľ׶Σײʹ
-	void handleAllCollisions(std::vector<Shape*>& shapeList);
+	void handleAllCollisions(std::vector<Shape*>& shapeList, StepContext& ctx);
+	
+	// ĵ׶Σ̬뾲̬״ײ
+	void handleStaticCollisions(std::vector<Shape*>& shapeList, StepContext& ctx);
 	void separateOverlappingShapes(Shape& shape1, Shape& shape2, double nx, double ny, double distance);
+	void solveContacts(StepContext& ctx);          // ⣺ + ٶȵ + λõ
 	
 	// ײڲã
 	void Collisions(Shape& shape1, Shape& shape2);
 	void resolveCollision(Shape& shape1, Shape& shape2);
-	void resolveCollisionWithWall(Shape& dynamicShape, const Wall& wall);  // ̬ǽײ
+	void resolveCollisionWithWall(Shape& dynamicShape, const Shape& wall);  // ̬ǽڣ̬״ײ
 	
 	// ߽ײ
 	void handleBoundaryCollision(Shape& shape);
 	bool isInBounds(const Shape& shape) const;
 	bool checkBoundaryCollision(const Shape& shape) const;
+	static bool getHalfExtents(const Shape& shape, double& halfWidth, double& halfHeight);
 
 	// ==========  ==========
+	//  shape Ϊ֧Ķ̬¼֧ţɾ shape ֮ǰã
+	void releaseSupporter(const Shape* shape);
+	
 	// ͡ƺͲ״
+	// ״ڴط䣬縺ͷ
 	Shape* createShape(const std::string& type, const std::string& name,
 	                   double mass, double size1, double size2, bool isDynamic);
 	
@@ -256,7 +778,13 @@ private:
 	std::string generateUniqueName(const std::string& type);
 	
 	// ǷѴ
-	bool isNameExists(const std::string& name) const;
+	bool isNameExists(const std::string& name);
+	
+	// ״бֱ޸Ĺһ£ʱؽơ
+	void syncShapeIndex();
+	
+	// ΪֱӷŽб״
+	void syncHandles(const std::vector<Shape*>& shapeList);
 
 
 	//===========б========
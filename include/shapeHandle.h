@@ -0,0 +1,78 @@
+#ifndef _SHAPEHANDLE_H_
+#define _SHAPEHANDLE_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct Shape;
+
+/*=========================================================================================================
+ * 形状句柄（ShapeHandle）与句柄表（HandleTable）
+ *
+ * 句柄是 32 位整数（低 22 位为槽位，高 10 位为代数），代替长期保存的 Shape*：形状加入世界时分配槽位，
+ * 移出时代数加一，resolve() O(1) 得到形状，旧句柄得到 nullptr，不会访问已经释放的内存。
+ * 释放的槽位先进先出、积累到 kMinFreeSlots 个之后才复用，代数用完后从 1 重新开始。
+ * 句柄不记录物体状态的存储位置，BodyStore 重新排列不会让句柄失效。值为 0 的句柄表示"没有形状"。
+ *=========================================================================================================*/
+struct ShapeHandle {
+	static const uint32_t kIndexBits = 22;
+	static const uint32_t kIndexMask = (1u << kIndexBits) - 1;
+	static const uint32_t kMaxGeneration = (1u << (32 - kIndexBits)) - 1;
+
+	uint32_t value;
+
+	ShapeHandle() : value(0) {}
+	explicit ShapeHandle(uint32_t v) : value(v) {}
+	ShapeHandle(uint32_t index, uint32_t generation) : value((generation << kIndexBits) | index) {}
+
+	uint32_t index() const { return value & kIndexMask; }
+	uint32_t generation() const { return value >> kIndexBits; }
+	bool isNull() const { return value == 0; }
+
+	bool operator==(const ShapeHandle& other) const { return value == other.value; }
+	bool operator!=(const ShapeHandle& other) const { return value != other.value; }
+};
+
+class HandleTable {
+public:
+	static const size_t kMinFreeSlots = 1024;
+
+	HandleTable() : freeHead(0), liveCount(0) {}
+	~HandleTable();   // 仍在其中的形状被移出
+
+	// 分配句柄，写入 shape 的 handle；已在其他 HandleTable 中时先从那里移出
+	// 槽位超过 kIndexMask + 1 个（约 419 万个同时存在的形状）时抛出 std::length_error
+	ShapeHandle acquire(Shape* shape);
+	// 释放句柄：旧句柄失效，槽位放到空闲队列的末尾
+	void release(Shape* shape);
+	void clear();
+
+	// 句柄对应的形状，句柄已失效时返回 nullptr
+	Shape* resolve(ShapeHandle handle) const {
+		const uint32_t index = handle.index();
+		if (index >= slots.size()) return nullptr;
+		const Slot& slot = slots[index];
+		return slot.generation == handle.generation() ? slot.shape : nullptr;
+	}
+	bool isValid(ShapeHandle handle) const { return resolve(handle) != nullptr; }
+
+	size_t size() const { return liveCount; }        // 有效句柄数量
+	size_t slotCount() const { return slots.size(); }
+
+private:
+	struct Slot {
+		Shape* shape;
+		uint32_t generation;   // 当前代数；有效句柄的代数从 1 开始
+	};
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> freeSlots;   // 空闲队列：[freeHead, size) 是排队中的槽位，先进先出
+	size_t freeHead;
+	size_t liveCount;
+
+	HandleTable(const HandleTable&);
+	HandleTable& operator=(const HandleTable&);
+};
+
+#endif
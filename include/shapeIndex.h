@@ -0,0 +1,83 @@
+#ifndef _SHAPEINDEX_H_
+#define _SHAPEINDEX_H_
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include "shapes.h"
+
+/*=========================================================================================================
+ * 名称与类型索引（ShapeIndex）
+ *
+ * 把形状的名称和类型登记成整数编号，供 findShapeByName、findShapesByType、isNameExists、generateUniqueName 使用：
+ * 按名称查找 O(1)，按类型查找只访问该类型的形状（按加入顺序返回），每个名称前缀记录下一个要尝试的编号。
+ * 形状记录自己所在的索引：Shape::setName 改名时同步更新，析构时自动移出；没有形状使用的名称会被回收。
+ *=========================================================================================================*/
+class ShapeIndex {
+public:
+	ShapeIndex() : registered(0), nextOrder(0) {}
+	~ShapeIndex();   // 仍在其中的形状被移出
+
+	// 加入：已在其他 ShapeIndex 中时先从那里移出
+	void add(Shape* shape, bool isDynamic);
+	void remove(Shape* shape);
+	// 移出所有动态（或静态）形状，另一类形状和名称计数器保持不变
+	void removeAll(bool isDynamic);
+	// 移出所有形状，名称计数器保持不变（之后自动生成的名称不会与之前的重复）
+	void clear();
+	// 移出所有形状并重置名称计数器（世界清空所有形状时使用）
+	void reset();
+	size_t size() const { return registered; }
+
+	// 使用这个名称的第一个动态（或静态）形状，没有时返回 nullptr
+	Shape* findByName(const std::string& name, bool isDynamic) const;
+	bool containsName(const std::string& name) const { return nameIds.find(name) != nameIds.end(); }
+	// 这个类型的动态（或静态）形状，按加入顺序（移出形状之后的第一次查询先把桶重新排序）
+	const std::vector<Shape*>& findByType(const std::string& type, bool isDynamic);
+
+	// 生成 "前缀_编号" 形式的唯一名称：每个前缀的编号只增不减，跳过已被使用的名称
+	std::string makeUniqueName(const std::string& prefix);
+
+	// 由 Shape::setName 调用
+	void rename(Shape* shape, const std::string& newName);
+
+	size_t nameCount() const { return nameIds.size(); }   // 正在使用的不同名称数量
+
+private:
+	// 移出时与最后一个形状交换后删除，桶内顺序被打乱，查询时再按加入顺序排序
+	struct ShapeBucket {
+		std::vector<Shape*> shapes;
+		bool ordered;
+		ShapeBucket() : ordered(true) {}
+	};
+	struct TypeBucket {
+		ShapeBucket dynamicShapes;
+		ShapeBucket staticShapes;
+	};
+
+	std::unordered_map<std::string, int> nameIds;
+	std::vector<std::vector<Shape*> > nameShapes;   // nameShapes[nameId]
+	std::vector<int> freeNameIds;
+
+	std::unordered_map<std::string, int> typeIds;
+	std::vector<TypeBucket> typeBuckets;             // typeBuckets[typeId]
+
+	std::unordered_map<std::string, int> nameCounters;
+	size_t registered;
+	size_t nextOrder;
+
+	int internName(const std::string& name);
+	void releaseName(int nameId, const std::string& name);
+	void unlink(Shape* shape);
+	static void eraseShape(std::vector<Shape*>& shapes, Shape* shape);
+	static void swapRemove(ShapeBucket& bucket, Shape* shape);
+	static void sortBucket(ShapeBucket& bucket);
+	static bool addedBefore(const Shape* a, const Shape* b);
+	static void insertInOrder(std::vector<Shape*>& shapes, Shape* shape);
+
+	ShapeIndex(const ShapeIndex&);
+	ShapeIndex& operator=(const ShapeIndex&);
+};
+
+#endif
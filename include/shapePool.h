@@ -0,0 +1,80 @@
+#ifndef _SHAPEPOOL_H_
+#define _SHAPEPOOL_H_
+
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include "shapes.h"
+
+/*=========================================================================================================
+ * 形状内存池（ShapePool）
+ *
+ * PhysicalWorld 自己创建的形状（createShape、placeWall、allocateShape）从按大小分级（64 字节一级）的内存池分配：
+ * destroy() 析构后把槽位放回空闲链表供同级别复用，releaseAll() 析构所有存活的形状并保留内存块。
+ * 池中的形状由 PhysicalWorld 释放，调用者不能 delete；用户自己 new 再加入世界的形状仍由用户释放（owns() 返回 false）。
+ *=========================================================================================================*/
+class ShapePool {
+public:
+	ShapePool() : liveCount(0) {}
+	~ShapePool();
+
+	// 在池中构造一个 T（Circle、AABB、Slope、Wall ...）
+	template <class T, class... Args>
+	T* create(Args&&... args) {
+		static_assert(alignof(T) <= kSlotAlign, "ShapePool: 对齐要求过高");
+		T* shape = new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+		shape->ownerPool = this;
+		return shape;
+	}
+
+	// 析构形状并回收槽位（形状必须来自这个池）
+	void destroy(Shape* shape);
+	// 析构所有存活的形状，保留内存块
+	void releaseAll();
+	// 形状是否由这个池分配并且仍然存活（读形状上的记录，O(1)）
+	bool owns(const Shape* shape) const { return shape != nullptr && shape->ownerPool == this; }
+
+	size_t size() const { return liveCount; }   // 存活的形状数量
+	size_t capacity() const;                      // 所有内存块的槽位总数
+	size_t reservedBytes() const;                 // 所有内存块占用的字节数
+
+private:
+	static const size_t kSlotAlign = alignof(std::max_align_t);
+	static const size_t kClassBytes = 64;         // 大小级别的粒度
+	static const size_t kFirstChunkSlots = 64;
+	static const size_t kMaxChunkSlots = 4096;
+
+	// 每个槽位开头的记录，对象紧跟在后面
+	struct SlotHeader {
+		SlotHeader* nextFree;
+		unsigned short sizeClass;
+		bool live;
+	};
+	static const size_t kHeaderBytes = (sizeof(SlotHeader) + kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+
+	struct Chunk {
+		char* memory;
+		size_t slotCount;
+	};
+
+	struct SizeClass {
+		size_t stride;                // 槽位大小：记录 + 对象
+		std::vector<Chunk> chunks;
+		SlotHeader* freeList;
+		size_t nextChunkSlots;
+		SizeClass() : stride(0), freeList(nullptr), nextChunkSlots(kFirstChunkSlots) {}
+	};
+
+	std::vector<SizeClass> classes;
+	size_t liveCount;
+
+	void* allocate(size_t bytes);
+	void addChunk(SizeClass& sizeClass);
+	static SlotHeader* headerOf(const Shape* shape);
+
+	ShapePool(const ShapePool&);
+	ShapePool& operator=(const ShapePool&);
+};
+
+#endif
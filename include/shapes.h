@@ -4,25 +4,67 @@
 #include <iostream>
 #include <cmath>
 #include <string>
+#include <array>
+#include "shapeHandle.h"
 
 extern const double PI;
 
+/*=========================================================================================================
+ * 形状类型标记与双重分派表
+ *
+ * 每个形状携带一个 ShapeKind，碰撞检测和重叠分离通过 [kind1][kind2] 查表直接找到对应的处理函数（内核），
+ * 不再在最内层的物体对循环中逐个尝试 dynamic_cast。
+ * 表在编译期由 shapes.cpp 中的模板特化生成：新增形状时只需增加枚举值并特化对应的内核，
+ * 未特化的组合视为不碰撞、无重叠。
+ *=========================================================================================================*/
+enum ShapeKind {
+    SHAPE_CIRCLE,
+    SHAPE_AABB,
+    SHAPE_SLOPE,
+    SHAPE_GROUND,
+    SHAPE_WALL,
+    SHAPE_UNKNOWN,       // 未登记的形状类型（只会与任何形状"不碰撞"）
+    SHAPE_KIND_COUNT
+};
+
+struct Shape;
+class BodyStore;
+class ShapeIndex;
+class ShapePool;
+
+// 碰撞检测内核：a.check_collision(b)
+typedef bool (*CollisionKernel)(const Shape& a, const Shape& b);
+
+// 重叠分离内核：返回重叠量；(nx, ny) 传入时为 a 指向 b 的单位法向量，内核可改写为实际的分离方向
+typedef double (*SeparationKernel)(const Shape& a, const Shape& b, double& nx, double& ny, double distance);
+
+typedef std::array<CollisionKernel, SHAPE_KIND_COUNT> CollisionRow;
+typedef std::array<CollisionRow, SHAPE_KIND_COUNT> CollisionDispatchTable;
+typedef std::array<SeparationKernel, SHAPE_KIND_COUNT> SeparationRow;
+typedef std::array<SeparationRow, SHAPE_KIND_COUNT> SeparationDispatchTable;
+
+extern const CollisionDispatchTable collisionTable;
+extern const SeparationDispatchTable separationTable;
+
 struct Shape {
 public:
     
     std::string name;
     std::string type;
     
-    double mass;
-    double mass_centre[2]; // mass_centre[0]: x, mass_centre[1]: y
-    double velocity[2];    // velocity[0]: vx, velocity[1]: vy
+    // 位置、速度、合力是指向 BodyStore 中连续数组的视图（加入 PhysicalWorld 后），未加入时指向物体自己的 ownState；
+    // 下标写法不变：mass_centre[0]、velocity[1] ...
+    double* mass_centre;   // mass_centre[0]: x, mass_centre[1]: y
+    double* velocity;      // velocity[0]: vx, velocity[1]: vy
 	double fraction;      // 动摩擦系数 (kinetic friction)
     double static_fraction; // 静摩擦系数 (static friction)
 	double restitution = 1; // 恢复系数，默认值为1
-    double totalforce[2];  // 合力累加器: totalforce[0]: fx, totalforce[1]: fy
+    ShapeKind kind = SHAPE_UNKNOWN; // 类型标记（由具体形状的构造函数设置，用于查分派表）
+    double* totalforce;    // 合力累加器: totalforce[0]: fx, totalforce[1]: fy
     double normalforce[2]; // 给下方物体施加的弹力: normalforce[0]: fx, normalforce[1]: fy
-    bool isSupported;      // 是否被支撑（是否在地面或其他物体上）
-    Shape* supporter;      // 支撑物指针（记录是什么在支撑我）
+    ShapeHandle supporter; // 支撑物的句柄（记录是什么在支撑我；支撑物被删除后自动失效）
+    bool sleeping = false; // 是否休眠（休眠的物体不参与每步的计算，见 PhysicalWorld::setSleepingEnabled）
+    int sleepCounter = 0;  // 连续低速且被支撑的步数
 	  
     /*Constructors:Shape()
     默认构造函数，质量为1，质心在原点,速度为0
@@ -30,27 +72,36 @@ public:
     */
     
     // 默认构造函数：质量为1，质心在原点，速度为0，合力为0
-    Shape() : name("Shape"), type("Shape"), mass(1.0), mass_centre{0.0, 0.0}, velocity{0.0, 0.0}, totalforce{0.0, 0.0}, normalforce{0.0, 0.0}, fraction(0.0), static_fraction(0.0), isSupported(false), supporter(nullptr) {}
+    Shape() : name("Shape"), type("Shape"), fraction(0.0), static_fraction(0.0), normalforce{0.0, 0.0}, supporter(), mass(1.0), isSupported(false) { initState(0.0, 0.0, 0.0, 0.0); }
     
     // 单参数构造函数：指定质量，质心在原点，速度为0，合力为0
-    Shape(double m) : name("Shape"), type("Shape"), mass(m), mass_centre{0.0, 0.0}, velocity{0.0, 0.0}, totalforce{0.0, 0.0}, normalforce{0.0, 0.0}, fraction(0.0), static_fraction(0.0), isSupported(false), supporter(nullptr) {}
+    Shape(double m) : name("Shape"), type("Shape"), fraction(0.0), static_fraction(0.0), normalforce{0.0, 0.0}, supporter(), mass(m), isSupported(false) { initState(0.0, 0.0, 0.0, 0.0); }
     
     // 三参数构造函数：指定质量和质心坐标，速度为0，合力为0
-    Shape(double m, double x, double y) : name("Shape"), type("Shape"), mass(m), mass_centre{x, y}, velocity{0.0, 0.0}, totalforce{0.0, 0.0}, normalforce{0.0, 0.0}, fraction(0.0), static_fraction(0.0), isSupported(false), supporter(nullptr) {}
+    Shape(double m, double x, double y) : name("Shape"), type("Shape"), fraction(0.0), static_fraction(0.0), normalforce{0.0, 0.0}, supporter(), mass(m), isSupported(false) { initState(x, y, 0.0, 0.0); }
     
     // 五参数构造函数：完全指定所有属性，合力为0
-    Shape(double m, double x, double y, double vx, double vy) : name("Shape"), type("Shape"), mass(m), mass_centre{x, y}, velocity{vx, vy}, totalforce{0.0, 0.0}, normalforce{0.0, 0.0}, fraction(0.0), static_fraction(0.0), isSupported(false), supporter(nullptr) {}
+    Shape(double m, double x, double y, double vx, double vy) : name("Shape"), type("Shape"), fraction(0.0), static_fraction(0.0), normalforce{0.0, 0.0}, supporter(), mass(m), isSupported(false) { initState(x, y, vx, vy); }
 
-    // 虚析构函数
-    virtual ~Shape() {}
+    // 复制时只复制数值：副本使用自己的 ownState，不加入原物体所在的 BodyStore
+    Shape(const Shape& other);
+    Shape& operator=(const Shape& other);
+
+    // 虚析构函数：仍在 BodyStore 中时先移出
+    virtual ~Shape();
 
 public:
     // 公有方法 - 可以被子类覆写
     virtual void move(double dx, double dy);
     virtual void turn(double angle);
     
-    // 纯虚函数 - 必须在子类中实现
-    virtual bool check_collision(const Shape& other) const = 0;
+    // 碰撞检测：按 (kind, other.kind) 查表分派到对应的内核
+    bool check_collision(const Shape& other) const { return collisionTable[kind][other.kind](*this, other); }
+
+    // 重叠分离：返回与 other 的重叠量，必要时改写分离方向 (nx, ny)
+    double computeOverlap(const Shape& other, double& nx, double& ny, double distance) const {
+        return separationTable[kind][other.kind](*this, other, nx, ny, distance);
+    }
     
     // 信息获取方法（const方法，不修改对象状态）
     double getMass() const;
@@ -63,23 +114,27 @@ public:
     void getNormalForce(double& fx, double& fy) const;
     bool getIsSupported() const { return isSupported; }
 
-    std::string getName() const { return name; }
-    std::string getType() const { return type; }
+    const std::string& getName() const { return name; }
+    const std::string& getType() const { return type; }
+    ShapeKind getKind() const { return kind; }
     
     // 几何查询方法 - 获取物体底部Y坐标（由子类实现）"
     virtual double getBottom() const = 0;
 	virtual double getTop() const = 0;
 
+    // 包围盒查询方法 - 获取物体的轴对齐包围盒 [minX, minY, maxX, maxY]（宽相位碰撞检测使用）
+    virtual void getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const = 0;
+
     // 设置方法
-    void setName(const std::string& n) { name = n; }
+    void setName(const std::string& n);   // 已加入世界时同步更新名称索引
 
     void setMass(double m);
     void setCentre(double x, double y);
     void setVelocity(double vx, double vy);
-	void setFraction(double f) { fraction = f; }
-    void setStaticFraction(double sf) { static_fraction = sf; }
+	void setFraction(double f) { if (sleeping) wakeUp(); fraction = f; }
+    void setStaticFraction(double sf) { if (sleeping) wakeUp(); static_fraction = sf; }
 	void setRestitution(double r) { restitution = r; }
-    void setIsSupported(bool supported) { isSupported = supported; } // 设置支撑状态
+    void setIsSupported(bool supported);  // 设置支撑状态
 
     // 力相关方法
     void addToTotalForce(double fx, double fy);   // 累加力到合力
@@ -97,11 +152,60 @@ public:
 	
     // 支撑状态判定方法
     void checkSupportStatus(const Shape& supporter);  // 检查是否被特定物体支撑
-    void resetSupportStatus() { isSupported = false; supporter = nullptr; } // 重置支撑状态（每帧开始时调用）
-    Shape* getSupporter() const { return supporter; }  // 获取支撑物
-    void setSupporter(Shape* sup) { supporter = sup; } // 设置支撑物
+    void resetSupportStatus();  // 重置支撑状态（每帧开始时调用）
+    // 获取支撑物：双方都在世界中时通过句柄查找（已被删除时为 nullptr），不在世界中时返回记下的指针
+    Shape* getSupporter() const {
+        if (supporter.isNull() || handleTable == nullptr) return supporterShape;
+        return handleTable->resolve(supporter);
+    }
+    void setSupporter(Shape* sup) { supporter = sup != nullptr ? sup->handle : ShapeHandle(); supporterShape = sup; } // 设置支撑物
+
+    // 休眠状态：setVelocity / setCentre / applyImpulse 会唤醒休眠的物体
+    bool isSleeping() const { return sleeping; }
+    void wakeUp();   // 休眠的物体醒来时通知所在的 BodyStore
+    void putToSleep() { sleeping = true; velocity[0] = 0.0; velocity[1] = 0.0; }
 
 	bool HasCollidedWithGround(double ground_y) const;
+
+    // 在世界中的句柄（未加入世界时为空句柄），PhysicalWorld::resolveShape 可由句柄 O(1) 找回形状
+    ShapeHandle getHandle() const { return handle; }
+
+    // 所在的 BodyStore 和槽位（未加入时为 nullptr / -1）
+    BodyStore* getBodyStore() const { return bodyStore; }
+    int getBodySlot() const { return bodySlot; }
+
+protected:
+    // 质量和支撑状态在 BodyStore 中各有一份副本（updatePhysics 读的是副本），
+    // 所以不公开：只能通过 setMass / setIsSupported 修改，由它们同步到 BodyStore；读取用 getMass / getIsSupported
+    double mass;
+    bool isSupported;      // 是否被支撑（是否在地面或其他物体上）
+
+private:
+    friend class BodyStore;
+    friend class ShapeIndex;
+    friend class HandleTable;
+    friend class ShapePool;
+
+    double ownState[6];          // 未加入 BodyStore 时的位置、速度、合力
+    BodyStore* bodyStore = nullptr;
+    int bodySlot = -1;
+
+    ShapeIndex* shapeIndex = nullptr;   // 所在的名称、类型索引（未加入时为 nullptr）
+    int nameId = -1;
+    int typeId = -1;
+    bool indexedDynamic = false;
+    size_t indexOrder = 0;              // 加入索引的顺序，同名形状按它排序（与形状列表的顺序一致）
+    size_t typeSlot = 0;                // 在类型桶中的位置，移出时 O(1) 交换删除
+
+    Shape* supporterShape = nullptr;    // 支撑物的指针：形状不在世界中（没有句柄表）时 getSupporter 使用它
+
+    ShapePool* ownerPool = nullptr;     // 分配这个形状的内存池（用户 new 的形状为 nullptr；复制时不复制）
+
+    HandleTable* handleTable = nullptr; // 分配句柄的句柄表（未加入世界时为 nullptr）
+    ShapeHandle handle;
+
+    void initState(double x, double y, double vx, double vy);
+    void bindState(double* position, double* vel, double* force);
 };
 
 /*=========================================================================================================
@@ -182,16 +286,16 @@ public:
     double radius;
 
     // 构造函数
-    Circle() : DynamicShape(), radius(1.0) { type = "Circle"; name = "Circle"; }
-    Circle(double r) : DynamicShape(), radius(r) { type = "Circle"; name = "Circle"; }
-    Circle(double r, double x, double y) : DynamicShape(1.0, x, y), radius(r) { type = "Circle"; name = "Circle"; }
-    Circle(double m, double r, double x, double y) : DynamicShape(m, x, y), radius(r) { type = "Circle"; name = "Circle"; }
-    Circle(double m, double r, double x, double y, double vx, double vy) : DynamicShape(m, x, y, vx, vy), radius(r) { type = "Circle"; name = "Circle"; }
+    Circle() : DynamicShape(), radius(1.0) { type = "Circle"; kind = SHAPE_CIRCLE; name = "Circle"; }
+    Circle(double r) : DynamicShape(), radius(r) { type = "Circle"; kind = SHAPE_CIRCLE; name = "Circle"; }
+    Circle(double r, double x, double y) : DynamicShape(1.0, x, y), radius(r) { type = "Circle"; kind = SHAPE_CIRCLE; name = "Circle"; }
+    Circle(double m, double r, double x, double y) : DynamicShape(m, x, y), radius(r) { type = "Circle"; kind = SHAPE_CIRCLE; name = "Circle"; }
+    Circle(double m, double r, double x, double y, double vx, double vy) : DynamicShape(m, x, y, vx, vy), radius(r) { type = "Circle"; kind = SHAPE_CIRCLE; name = "Circle"; }
 
     // 覆写父类的方法
-    virtual bool check_collision(const Shape& other) const override;
     virtual double getBottom() const override { return mass_centre[1] - radius; }
 	virtual double getTop() const override { return mass_centre[1] + radius; }
+    virtual void getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const override;
     
     // Circle特有的getter方法
     double getRadius() const;
@@ -210,15 +314,15 @@ public:
     double height;
 
     // 构造函数
-    AABB() : DynamicShape(), width(1.0), height(1.0) { type = "AABB"; name = "AABB"; }
-    AABB(double w, double h) : DynamicShape(), width(w), height(h) { type = "AABB"; name = "AABB"; }
-    AABB(double w, double h, double x, double y) : DynamicShape(1.0, x, y), width(w), height(h) { type = "AABB"; name = "AABB"; }
-    AABB(double m, double w, double h, double x, double y) : DynamicShape(m, x, y), width(w), height(h) { type = "AABB"; name = "AABB"; }
-    AABB(double m, double w, double h, double x, double y, double vx, double vy) : DynamicShape(m, x, y, vx, vy), width(w), height(h) { type = "AABB"; name = "AABB"; }
+    AABB() : DynamicShape(), width(1.0), height(1.0) { type = "AABB"; kind = SHAPE_AABB; name = "AABB"; }
+    AABB(double w, double h) : DynamicShape(), width(w), height(h) { type = "AABB"; kind = SHAPE_AABB; name = "AABB"; }
+    AABB(double w, double h, double x, double y) : DynamicShape(1.0, x, y), width(w), height(h) { type = "AABB"; kind = SHAPE_AABB; name = "AABB"; }
+    AABB(double m, double w, double h, double x, double y) : DynamicShape(m, x, y), width(w), height(h) { type = "AABB"; kind = SHAPE_AABB; name = "AABB"; }
+    AABB(double m, double w, double h, double x, double y, double vx, double vy) : DynamicShape(m, x, y, vx, vy), width(w), height(h) { type = "AABB"; kind = SHAPE_AABB; name = "AABB"; }
 
     // 覆写父类的方法
-    virtual bool check_collision(const Shape& other) const override;
     virtual double getBottom() const override { return mass_centre[1] - height / 2.0; }
+    virtual void getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const override;
 
     // AABB特有的getter方法
     double getWidth() const { return width; }
@@ -250,16 +354,16 @@ public:
     double angle; // 斜坡与水平线的夹角，单位为弧度
     
     // 构造函数
-    Slope() : DynamicShape(), length(1.0), angle(0.0) { type = "Slope"; name = "Slope"; }
-    Slope(double l, double a) : DynamicShape(), length(l), angle(a) { type = "Slope"; name = "Slope"; }
-    Slope(double l, double a, double x, double y) : DynamicShape(1.0, x, y), length(l), angle(a) { type = "Slope"; name = "Slope"; }
-    Slope(double m, double l, double a, double x, double y) : DynamicShape(m, x, y), length(l), angle(a) { type = "Slope"; name = "Slope"; }
-    Slope(double m, double l, double a, double x, double y, double vx, double vy) : DynamicShape(m, x, y, vx, vy), length(l), angle(a) { type = "Slope"; name = "Slope"; }
+    Slope() : DynamicShape(), length(1.0), angle(0.0) { type = "Slope"; kind = SHAPE_SLOPE; name = "Slope"; }
+    Slope(double l, double a) : DynamicShape(), length(l), angle(a) { type = "Slope"; kind = SHAPE_SLOPE; name = "Slope"; }
+    Slope(double l, double a, double x, double y) : DynamicShape(1.0, x, y), length(l), angle(a) { type = "Slope"; kind = SHAPE_SLOPE; name = "Slope"; }
+    Slope(double m, double l, double a, double x, double y) : DynamicShape(m, x, y), length(l), angle(a) { type = "Slope"; kind = SHAPE_SLOPE; name = "Slope"; }
+    Slope(double m, double l, double a, double x, double y, double vx, double vy) : DynamicShape(m, x, y, vx, vy), length(l), angle(a) { type = "Slope"; kind = SHAPE_SLOPE; name = "Slope"; }
 
     // 覆写父类的方法
-    virtual bool check_collision(const Shape& other) const override;
     virtual double getBottom() const override { return mass_centre[1]; }  // 简化：使用质心作为底部
     virtual double getTop() const override { return mass_centre[1] + getHeight(); }  // 顶部 = 质心 + 高度
+    virtual void getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const override;
     
     // Slope特有的getter方法
     double getLength() const { return length; }
@@ -279,10 +383,10 @@ public:
 	double y_level;   // 地面的y坐标（与mass_centre[1]同步）"
 
     // 构造函数
-	Ground() : StaticShape(0.0, 0.0), y_level(0.0) { type = "Ground"; name = "Ground"; fraction = 0.0; static_fraction = 0.0; }
-	Ground(double y) : StaticShape(0.0, y), y_level(y) { type = "Ground"; name = "Ground"; fraction = 0.0; static_fraction = 0.0; }
-	Ground(double y, double f) : StaticShape(0.0, y), y_level(y) { type = "Ground"; name = "Ground"; fraction = f; static_fraction = f; }
-	Ground(double y, double f, double sf) : StaticShape(0.0, y), y_level(y) { type = "Ground"; name = "Ground"; fraction = f; static_fraction = sf; }
+	Ground() : StaticShape(0.0, 0.0), y_level(0.0) { type = "Ground"; kind = SHAPE_GROUND; name = "Ground"; fraction = 0.0; static_fraction = 0.0; }
+	Ground(double y) : StaticShape(0.0, y), y_level(y) { type = "Ground"; kind = SHAPE_GROUND; name = "Ground"; fraction = 0.0; static_fraction = 0.0; }
+	Ground(double y, double f) : StaticShape(0.0, y), y_level(y) { type = "Ground"; kind = SHAPE_GROUND; name = "Ground"; fraction = f; static_fraction = f; }
+	Ground(double y, double f, double sf) : StaticShape(0.0, y), y_level(y) { type = "Ground"; kind = SHAPE_GROUND; name = "Ground"; fraction = f; static_fraction = sf; }
 
 	// Getter方法
 	double getYLevel() const { return y_level; }
@@ -296,9 +400,9 @@ public:
     void setFriction(double f, double sf) { fraction = f; static_fraction = sf; }
     
     // 覆写父类方法
-    virtual bool check_collision(const Shape& other) const override;
     virtual double getBottom() const override { return y_level; }
     virtual double getTop() const override { return y_level; }  // 地面顶部就是地面本身
+    virtual void getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const override;
     
     // 支撑相关方法
     bool isPointOnGround(double x, double y) const { return y <= y_level; }
@@ -322,24 +426,28 @@ public:
     // 构造函数
     Wall() : StaticShape(), width(1.0), height(1.0) { 
         type = "Wall"; 
+        kind = SHAPE_WALL;
         name = "Wall"; 
         fraction = 0.0;  // 默认无摩擦
     }
     
     Wall(double w, double h) : StaticShape(), width(w), height(h) { 
         type = "Wall"; 
+        kind = SHAPE_WALL;
         name = "Wall"; 
         fraction = 0.0;
     }
     
     Wall(double w, double h, double x, double y) : StaticShape(x, y), width(w), height(h) { 
         type = "Wall"; 
+        kind = SHAPE_WALL;
         name = "Wall"; 
         fraction = 0.0;
     }
     
     Wall(double w, double h, double x, double y, double f) : StaticShape(x, y), width(w), height(h) { 
         type = "Wall"; 
+        kind = SHAPE_WALL;
         name = "Wall"; 
         fraction = f;
         static_fraction = f; // 静摩擦系数默认等于动摩擦系数
@@ -347,15 +455,16 @@ public:
     
     Wall(double w, double h, double x, double y, double f, double sf) : StaticShape(x, y), width(w), height(h) { 
         type = "Wall"; 
+        kind = SHAPE_WALL;
         name = "Wall"; 
         fraction = f;
         static_fraction = sf;
     }
 
     // 覆写父类方法
-    virtual bool check_collision(const Shape& other) const override;
     virtual double getBottom() const override { return mass_centre[1] - height / 2.0; }
     virtual double getTop() const override { return mass_centre[1] + height / 2.0; }
+    virtual void getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const override;
     
     // Wall特有的getter方法
     double getWidth() const { return width; }
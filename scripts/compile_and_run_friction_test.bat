@@ -3,7 +3,7 @@ echo ========================================
 echo Ħв
 echo ========================================
 
-g++ -o tests\test_friction_sliding.exe tests\test_friction_sliding.cpp src\physicalWorld.cpp src\shapes.cpp -Iinclude -std=c++11
+g++ -o tests\test_friction_sliding.exe tests\test_friction_sliding.cpp src\physicalWorld.cpp src\shapes.cpp src\broadphase.cpp src\contact.cpp src\island.cpp src\narrowphase.cpp src\bodyStore.cpp src\shapePool.cpp src\shapeIndex.cpp src\shapeHandle.cpp src\gravity.cpp src\constraint.cpp src\particles.cpp src\fluid.cpp -Iinclude -std=c++11
 
 if %ERRORLEVEL% EQU 0 (
     echo.
@@ -16,7 +16,7 @@ set TOTAL=0
 REM 
 set COMPILER=g++
 set CFLAGS=-std=c++11 -Iinclude
-set SOURCES=src/physicalWorld.cpp src/shapes.cpp
+set SOURCES=src/physicalWorld.cpp src/shapes.cpp src/broadphase.cpp src/contact.cpp src/island.cpp src/narrowphase.cpp src/bodyStore.cpp src/shapePool.cpp src/shapeIndex.cpp src/shapeHandle.cpp src/gravity.cpp src/constraint.cpp src/particles.cpp src/fluid.cpp
 
 echo [1/11] 벢 test_slope_friction.exe...
 %COMPILER% %CFLAGS% -o tests/test_slope_friction.exe tests/test_slope_friction.cpp %SOURCES%
@@ -11,7 +11,7 @@ echo.
 
 set COMPILER=g++
 set CFLAGS=-std=c++11 -Iinclude
-set SOURCES=src/physicalWorld.cpp src/shapes.cpp
+set SOURCES=src/physicalWorld.cpp src/shapes.cpp src/broadphase.cpp src/contact.cpp src/island.cpp src/narrowphase.cpp src/bodyStore.cpp src/shapePool.cpp src/shapeIndex.cpp src/shapeHandle.cpp src/gravity.cpp src/constraint.cpp src/particles.cpp src/fluid.cpp
 
 echo [1/2]  test_block_models.exe...
 %COMPILER% %CFLAGS% -o tests/test_block_models.exe tests/test_block_models.cpp %SOURCES%
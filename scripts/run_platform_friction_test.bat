@@ -25,7 +25,7 @@ if errorlevel 1 (
 )
 
 echo [3/3] 벢 test_platform_friction.cpp...
-g++ -std=c++11 -Iinclude tests/test_platform_friction.cpp obj/shapes.o obj/physicalWorld.o -o bin/test_platform.exe
+g++ -std=c++11 -Iinclude tests/test_platform_friction.cpp obj/shapes.o obj/physicalWorld.o src/broadphase.cpp src/contact.cpp src/island.cpp src/narrowphase.cpp src/bodyStore.cpp src/shapePool.cpp src/shapeIndex.cpp src/shapeHandle.cpp src/gravity.cpp src/constraint.cpp src/particles.cpp src/fluid.cpp -o bin/test_platform.exe
 if errorlevel 1 (
     echo : test_platform_friction.cpp ʧ
     pause
@@ -57,7 +57,7 @@ goto menu
 :compile_full
 echo.
 echo [] ׼...
-g++ -std=c++11 -Wall -I include tests/test_physicalWorld.cpp src/physicalWorld.cpp src/shapes.cpp -o build/test_engine.exe
+g++ -std=c++11 -Wall -I include tests/test_physicalWorld.cpp src/physicalWorld.cpp src/shapes.cpp src/broadphase.cpp src/contact.cpp src/island.cpp src/narrowphase.cpp src/bodyStore.cpp src/shapePool.cpp src/shapeIndex.cpp src/shapeHandle.cpp src/gravity.cpp src/constraint.cpp src/particles.cpp src/fluid.cpp -o build/test_engine.exe
 if %errorlevel% equ 0 (
     echo [ɹ] : build/test_engine.exe
 ) else (
@@ -70,7 +70,7 @@ goto menu
 :compile_quick
 echo.
 echo [] ٲ...
-g++ -std=c++11 -Wall -I include tests/quick_test.cpp src/physicalWorld.cpp src/shapes.cpp -o build/quick_test.exe
+g++ -std=c++11 -Wall -I include tests/quick_test.cpp src/physicalWorld.cpp src/shapes.cpp src/broadphase.cpp src/contact.cpp src/island.cpp src/narrowphase.cpp src/bodyStore.cpp src/shapePool.cpp src/shapeIndex.cpp src/shapeHandle.cpp src/gravity.cpp src/constraint.cpp src/particles.cpp src/fluid.cpp -o build/quick_test.exe
 if %errorlevel% equ 0 (
     echo [ɹ] : build/quick_test.exe
 ) else (
@@ -93,6 +93,19 @@ void Renderer::DrawBlock(const BlockData& blk) {
     DrawRotatedRect(blk.cx, blk.cy, blk.width, blk.height, blk.angle, blk.color);
 }
 
+void Renderer::DrawParticles(const float* x, const float* y, size_t count, COLORREF color) {
+    // putpixel per particle is far too slow for ~10^5 points; write the buffer directly
+    DWORD* buffer = GetImageBuffer();
+    if (!buffer) return;
+    DWORD pixel = BGR(color);
+    for (size_t i = 0; i < count; i++) {
+        int sx = WorldToScreenX(x[i]);
+        int sy = WorldToScreenY(y[i]);
+        if (sx < 0 || sx >= width || sy < 0 || sy >= height) continue;
+        buffer[sy * width + sx] = pixel;
+    }
+}
+
 int Renderer::WorldToScreenX(double wx) const {
     return static_cast<int>(wx * scale + 0.5);
 }
@@ -4,24 +4,37 @@
 #include <cmath>
 #include <sstream>
 
+// 双星、太阳系场景的引力常数（场景单位：米、千克、秒）
+static const double kSceneGravitationalConstant = 5.0;
+
+// 球体生成场景中粒子的颜色
+static const COLORREF kParticleColor = RGB(0, 128, 255);
+
 // ==================== ObjectConnection 方法实现 ====================
 
-void ObjectConnection::updateFromPhysics() {
-    if (!physicsObject) return;
+bool ObjectConnection::updateFromPhysics(const PhysicalWorld& world) {
+    Shape* shape = world.resolveShape(physicsObject);
+    if (!shape) {
+        isVisible = false;
+        return false;
+    }
     
     // 获取当前位置和速度
-    physicsObject->getCentre(lastX, lastY);
-    physicsObject->getVelocity(lastVx, lastVy);
+    shape->getCentre(lastX, lastY);
+    shape->getVelocity(lastVx, lastVy);
+    mass = shape->getMass();
+    shape->getFraction(friction);
     
     // 根据类型获取特定属性
     switch (type) {
-        case OBJ_CIRCLE: {
-            Circle* circle = dynamic_cast<Circle*>(physicsObject);
+        case OBJ_CIRCLE:
+        case OBJ_PENDULUM: {
+            Circle* circle = dynamic_cast<Circle*>(shape);
             if (circle) radius = circle->getRadius();
             break;
         }
         case OBJ_AABB: {
-            AABB* aabb = dynamic_cast<AABB*>(physicsObject);
+            AABB* aabb = dynamic_cast<AABB*>(shape);
             if (aabb) {
                 width = aabb->getWidth();
                 height = aabb->getHeight();
@@ -29,7 +42,7 @@ void ObjectConnection::updateFromPhysics() {
             break;
         }
         case OBJ_SLOPE: {
-            Slope* slope = dynamic_cast<Slope*>(physicsObject);
+            Slope* slope = dynamic_cast<Slope*>(shape);
             if (slope) {
                 length = slope->getLength();
                 slopeAngle = slope->getAngle();
@@ -39,6 +52,7 @@ void ObjectConnection::updateFromPhysics() {
         default:
             break;
     }
+    return true;
 }
 
 BallData ObjectConnection::getBallData() const {
@@ -48,7 +62,7 @@ BallData ObjectConnection::getBallData() const {
     ball.radius = radius;
     ball.vx = lastVx;
     ball.vy = lastVy;
-    ball.mass = physicsObject ? physicsObject->getMass() : 1.0;
+    ball.mass = mass;
     ball.color = color;
     return ball;
 }
@@ -62,7 +76,7 @@ BlockData ObjectConnection::getBlockData() const {
     block.angle = lastAngle;
     block.vx = lastVx;
     block.vy = lastVy;
-    block.mass = physicsObject ? physicsObject->getMass() : 1.0;
+    block.mass = mass;
     block.color = color;
     return block;
 }
@@ -76,14 +90,8 @@ RampData ObjectConnection::getRampData() const {
     ramp.x2 = lastX + halfLength * cos(slopeAngle);
     ramp.y2 = lastY + halfLength * sin(slopeAngle);
     
-    // 获取摩擦系数
-    if (physicsObject) {
-        double frac;
-        physicsObject->getFraction(frac);
-        ramp.mu = frac;
-    } else {
-        ramp.mu = 0.1;
-    }
+    // 摩擦系数（updateFromPhysics 时缓存）
+    ramp.mu = friction;
     
     return ramp;
 }
@@ -190,7 +198,7 @@ void PhysicsVisualAdapter::updateFrame(float deltaTime) {
             ObjectConnection& conn = pair.second;
             
             // 更新物理状态
-            conn.updateFromPhysics();
+            conn.updateFromPhysics(*physicsWorld);
         }
     }
     
@@ -224,7 +232,8 @@ void PhysicsVisualAdapter::renderFrame() {
         if (!conn.isVisible) continue;
         
         switch (conn.type) {
-            case OBJ_CIRCLE: {
+            case OBJ_CIRCLE:
+            case OBJ_PENDULUM: {
                 BallData ball = conn.getBallData();
                 renderer->DrawBall(ball);
                 break;
@@ -258,6 +267,12 @@ void PhysicsVisualAdapter::renderFrame() {
         }
     }
     
+    // 粒子没有对应的 ObjectConnection，直接按位置数组逐点绘制
+    if (physicsWorld && physicsWorld->getParticleCount() > 0) {
+        const ParticleSystem& particles = physicsWorld->getParticleSystem();
+        renderer->DrawParticles(particles.positionX(), particles.positionY(), particles.size(), kParticleColor);
+    }
+    
     // 4. 绘制UI按钮
     // 这里需要调用 allbuttons.h 中的绘制函数
     // drawButtons(...);
@@ -359,17 +374,19 @@ void PhysicsVisualAdapter::onMouseDragUpdate(int screenX, int screenY) {
     if (it == objectConnections.end()) return;
     
     ObjectConnection& conn = it->second;
-    if (!conn.physicsObject) return;
+    Shape* shape = physicsWorld->resolveShape(conn.physicsObject);
+    if (!shape) return;
     
     // 将屏幕坐标转换为世界坐标
     double worldX = renderer->ScreenToWorldX(screenX);
     double worldY = renderer->ScreenToWorldY(screenY);
     
     // 更新物体位置
-    conn.physicsObject->setCentre(worldX, worldY);
+    shape->setCentre(worldX, worldY);
+    physicsWorld->invalidateSpatialIndex();
     
     // 拖拽时设置速度为零
-    conn.physicsObject->setVelocity(0, 0);
+    shape->setVelocity(0, 0);
     
     // 更新连接状态
     conn.lastX = worldX;
@@ -439,6 +456,15 @@ void PhysicsVisualAdapter::onKeyPress(char key) {
         case 'D':
             // 切换调试信息显示
             break;
+            
+        case 'w':  // W键：粒子在互不影响（喷泉）、水、沙之间切换
+        case 'W':
+            if (physicsWorld) {
+                ParticleMode mode = physicsWorld->getParticleMode();
+                physicsWorld->setParticleMode(mode == PARTICLE_BALLISTIC ? PARTICLE_FLUID :
+                                              mode == PARTICLE_FLUID ? PARTICLE_GRANULAR : PARTICLE_BALLISTIC);
+            }
+            break;
     }
 }
 
@@ -470,10 +496,19 @@ void PhysicsVisualAdapter::initializeScene(SceneMode scene) {
     
     // 清除所有现有物体
     objectConnections.clear();
+    objectIdByHandle.clear();
     nextObjectId = 1;
     
     if (physicsWorld) {
         physicsWorld->clearAllShapes();
+        physicsWorld->clearParticles();
+        
+        // 双星、太阳系场景中的圆互相吸引（万有引力），其他场景使用均匀重力
+        physicsWorld->setMutualGravity(scene == SCENE_TWO_STARS || scene == SCENE_SOLAR_SYS);
+        physicsWorld->setGravitationalConstant(kSceneGravitationalConstant);
+        
+        // 太阳系中内外圈行星的周期相差很大：各自按自己的步长积分
+        physicsWorld->setBlockTimestepping(scene == SCENE_SOLAR_SYS);
     }
     
     // 根据场景类型创建物体
@@ -490,25 +525,58 @@ void PhysicsVisualAdapter::initializeScene(SceneMode scene) {
             createPhysicsObject(OBJ_CIRCLE, 10, 0, 1.5, 0.0, 2.0, RGB(0, 0, 255), true);
             break;
             
-        case SCENE_SPHERE_CREATION:
-            // 创建多个球体
-            for (int i = 0; i < 5; i++) {
-                createPhysicsObject(OBJ_CIRCLE, -20 + i * 8, 10, 1.0, 0.0, 1.0, 
-                                   RGB(rand() % 256, rand() % 256, rand() % 256), true);
+        case SCENE_SPHERE_CREATION: {
+            // 两面墙之间的喷泉：球体是粒子（没有名字、没有 ObjectConnection），每秒喷出 20000 个，4 秒后回收
+            createPhysicsObject(OBJ_WALL, -30, 20, 1.0, 40.0, 0.0, RGB(100, 100, 100), false);
+            createPhysicsObject(OBJ_WALL, 30, 20, 1.0, 40.0, 0.0, RGB(100, 100, 100), false);
+            if (physicsWorld) {
+                ParticleEmitter fountain;
+                fountain.x = 0.0;
+                fountain.y = 1.0;
+                fountain.spread = 0.6;
+                fountain.speedMin = 10.0;
+                fountain.speedMax = 25.0;
+                fountain.rate = 20000.0;
+                fountain.lifetime = 4.0;
+                fountain.radius = 0.1;
+                fountain.restitution = 0.6;
+                physicsWorld->addParticleEmitter(fountain);
             }
             break;
+        }
             
-        case SCENE_TWO_STARS:
-            // 创建双星系统
-            createPhysicsObject(OBJ_CIRCLE, -15, 0, 3.0, 0.0, 100.0, RGB(255, 255, 0), true);
-            createPhysicsObject(OBJ_CIRCLE, 15, 0, 2.0, 0.0, 50.0, RGB(0, 255, 255), true);
+        case SCENE_TWO_STARS: {
+            // 创建双星系统：相对速度 v = sqrt(G(m1 + m2) / r)，按质量的反比分给两颗星，绕共同质心做圆周运动
+            int starA = createPhysicsObject(OBJ_CIRCLE, -15, 0, 3.0, 0.0, 100.0, RGB(255, 255, 0), true);
+            int starB = createPhysicsObject(OBJ_CIRCLE, 15, 0, 2.0, 0.0, 50.0, RGB(0, 255, 255), true);
+            double v = std::sqrt(kSceneGravitationalConstant * 150.0 / 30.0);
+            setObjectVelocity(starA, 0.0, -v * 50.0 / 150.0);
+            setObjectVelocity(starB, 0.0, v * 100.0 / 150.0);
             break;
+        }
             
-        case SCENE_SOLAR_SYS:
-            // 简化太阳系
+        case SCENE_SOLAR_SYS: {
+            // 简化太阳系：太阳静止，行星以 v = sqrt(G·M / r) 做圆周运动
             createPhysicsObject(OBJ_CIRCLE, 0, 0, 5.0, 0.0, 1000.0, RGB(255, 255, 0), false);
-            createPhysicsObject(OBJ_CIRCLE, 20, 0, 1.0, 0.0, 1.0, RGB(0, 0, 255), true);
+            int planet = createPhysicsObject(OBJ_CIRCLE, 20, 0, 1.0, 0.0, 1.0, RGB(0, 0, 255), true);
+            setObjectVelocity(planet, 0.0, std::sqrt(kSceneGravitationalConstant * 1000.0 / 20.0));
             break;
+        }
+            
+        case SCENE_PENDULUM: {
+            // 单摆：摆球挂在 (-10, 15) 下方 8 米处，以 6 m/s 的水平初速度摆起来
+            int bob = createPhysicsObject(OBJ_PENDULUM, -10, 15, 1.0, 8.0, 1.0, RGB(255, 0, 0), true);
+            setObjectVelocity(bob, 6.0, 0.0);
+            
+            // 链条：10 节从静止的挂钩 (8, 15) 水平伸出，相邻两节之间为距离约束，松手后向下摆动
+            int previous = createPhysicsObject(OBJ_CIRCLE, 8, 15, 0.3, 0.0, 1.0, RGB(100, 100, 100), false);
+            for (int i = 1; i <= 10; i++) {
+                int link = createPhysicsObject(OBJ_CIRCLE, 8 + i * 1.0, 15, 0.4, 0.0, 0.5, RGB(0, 128, 255), true);
+                connectObjects(previous, link);
+                previous = link;
+            }
+            break;
+        }
             
         default:
             std::cout << "未知场景类型" << std::endl;
@@ -522,11 +590,13 @@ void PhysicsVisualAdapter::cleanupScene() {
     
     // 清除所有物体连接
     objectConnections.clear();
+    objectIdByHandle.clear();
     nextObjectId = 1;
     
     // 清除物理世界中的物体
     if (physicsWorld) {
         physicsWorld->clearAllShapes();
+        physicsWorld->clearParticles();
     }
 }
 
@@ -539,29 +609,35 @@ int PhysicsVisualAdapter::createPhysicsObject(PhysicsObjectType type,
                                             bool isDynamic) {
     if (!physicsWorld) return -1;
     
-    // 根据类型创建形状
+    // 根据类型创建形状（从物理世界的内存池分配，切换场景时由 clearAllShapes 释放）
     Shape* shape = nullptr;
     std::string typeStr;
     
     switch (type) {
         case OBJ_CIRCLE:
             typeStr = "Circle";
-            shape = new Circle(mass, param1, x, y);
+            shape = physicsWorld->allocateShape<Circle>(mass, param1, x, y);
             break;
             
         case OBJ_AABB:
             typeStr = "AABB";
-            shape = new AABB(mass, param1, param2, x, y);
+            shape = physicsWorld->allocateShape<AABB>(mass, param1, param2, x, y);
             break;
             
         case OBJ_SLOPE:
             typeStr = "Slope";
-            shape = new Slope(mass, param1, param2, x, y);
+            shape = physicsWorld->allocateShape<Slope>(mass, param1, param2, x, y);
             break;
             
         case OBJ_WALL:
             typeStr = "Wall";
-            shape = new Wall(param1, param2, x, y);
+            shape = physicsWorld->allocateShape<Wall>(param1, param2, x, y);
+            break;
+            
+        case OBJ_PENDULUM:
+            // 摆球（半径 param1）挂在 (x, y) 下方 param2 处
+            typeStr = "Pendulum";
+            shape = physicsWorld->allocateShape<Circle>(mass, param1, x, y - param2);
             break;
             
         default:
@@ -585,18 +661,24 @@ int PhysicsVisualAdapter::createPhysicsObject(PhysicsObjectType type,
         physicsWorld->addStaticShape(shape);
     }
     
+    // 摆球用钉住约束挂在悬挂点上
+    if (type == OBJ_PENDULUM) {
+        physicsWorld->addPinConstraint(shape, x, y, param2);
+    }
+    
     // 创建连接信息
     ObjectConnection conn;
     conn.adapterId = nextObjectId;
-    conn.physicsObject = shape;
+    conn.physicsObject = shape->getHandle();
     conn.type = type;
     conn.color = color;
     
     // 初始化状态
-    conn.updateFromPhysics();
+    conn.updateFromPhysics(*physicsWorld);
     
     // 添加到连接表
     objectConnections[nextObjectId] = conn;
+    objectIdByHandle[conn.physicsObject.value] = nextObjectId;
     
     std::cout << "创建物体: ID=" << nextObjectId 
               << ", 类型=" << typeStr 
@@ -606,45 +688,50 @@ int PhysicsVisualAdapter::createPhysicsObject(PhysicsObjectType type,
     return nextObjectId++;
 }
 
-// 查找屏幕位置的物体
+// 设置物体的初速度
+void PhysicsVisualAdapter::setObjectVelocity(int adapterId, double vx, double vy) {
+    auto it = objectConnections.find(adapterId);
+    if (it == objectConnections.end()) return;
+    
+    Shape* shape = physicsWorld ? physicsWorld->resolveShape(it->second.physicsObject) : nullptr;
+    if (!shape) return;
+    
+    shape->setVelocity(vx, vy);
+    it->second.lastVx = vx;
+    it->second.lastVy = vy;
+}
+
+// 用距离约束连接两个物体（保持当前的距离）
+void PhysicsVisualAdapter::connectObjects(int adapterIdA, int adapterIdB) {
+    auto a = objectConnections.find(adapterIdA);
+    auto b = objectConnections.find(adapterIdB);
+    if (!physicsWorld || a == objectConnections.end() || b == objectConnections.end()) return;
+    
+    Shape* shapeA = physicsWorld->resolveShape(a->second.physicsObject);
+    Shape* shapeB = physicsWorld->resolveShape(b->second.physicsObject);
+    if (shapeA && shapeB) {
+        physicsWorld->addDistanceConstraint(shapeA, shapeB);
+    }
+}
+
+// 查找屏幕位置的物体（使用物理世界的空间查询，不再遍历所有物体）
 int PhysicsVisualAdapter::findObjectAtScreen(int screenX, int screenY) const {
+    if (!physicsWorld) return -1;
+    
     double worldX = renderer->ScreenToWorldX(screenX);
     double worldY = renderer->ScreenToWorldY(screenY);
     
-    // 简单查找：遍历所有物体，检查是否包含该点
-    for (const auto& pair : objectConnections) {
-        const ObjectConnection& conn = pair.second;
+    pickResults.clear();
+    physicsWorld->queryPoint(worldX, worldY, pickResults);
+    for (size_t i = 0; i < pickResults.size(); i++) {
+        auto id = objectIdByHandle.find(pickResults[i]->getHandle().value);
+        if (id == objectIdByHandle.end()) continue;
         
-        if (!conn.physicsObject) continue;
-        
-        switch (conn.type) {
-            case OBJ_CIRCLE: {
-                double dx = worldX - conn.lastX;
-                double dy = worldY - conn.lastY;
-                double distance = sqrt(dx * dx + dy * dy);
-                
-                if (distance <= conn.radius) {
-                    return pair.first;
-                }
-                break;
-            }
-                
-            case OBJ_AABB: {
-                double halfWidth = conn.width / 2;
-                double halfHeight = conn.height / 2;
-                
-                if (worldX >= conn.lastX - halfWidth &&
-                    worldX <= conn.lastX + halfWidth &&
-                    worldY >= conn.lastY - halfHeight &&
-                    worldY <= conn.lastY + halfHeight) {
-                    return pair.first;
-                }
-                break;
-            }
-                
-            default:
-                // 其他类型暂不支持点击检测
-                break;
+        // 目前只支持点选圆形和矩形
+        auto it = objectConnections.find(id->second);
+        if (it != objectConnections.end() &&
+            (it->second.type == OBJ_CIRCLE || it->second.type == OBJ_AABB)) {
+            return id->second;
         }
     }
     
@@ -716,10 +803,14 @@ void PhysicsVisualAdapter::setFriction(float friction) {
     // 当前方案：应用到所有物体
     for (auto& pair : objectConnections) {
         ObjectConnection& conn = pair.second;
-        if (conn.physicsObject) {
-            conn.physicsObject->setFraction(friction);
+        Shape* shape = physicsWorld ? physicsWorld->resolveShape(conn.physicsObject) : nullptr;
+        if (shape) {
+            shape->setFraction(friction);
+            conn.friction = friction;
         }
     }
+    // 摩擦系数变了，原来静止的物体可能需要滑动，休眠的物体要全部唤醒
+    if (physicsWorld) physicsWorld->wakeAll();
     
     std::cout << "设置摩擦系数: " << friction << std::endl;
 }
@@ -756,6 +847,7 @@ void PhysicsVisualAdapter::cleanup() {
     
     // 清理对象连接
     objectConnections.clear();
+    objectIdByHandle.clear();
     
     // 清理物理世界
     if (physicsWorld) {
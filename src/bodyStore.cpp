@@ -0,0 +1,97 @@
+#include "bodyStore.h"
+
+BodyStore::~BodyStore() {
+	clear();
+}
+
+/*=========================================================================================================
+ * 加入与移出
+ *=========================================================================================================*/
+void BodyStore::attach(Shape* shape) {
+	if (shape == nullptr || shape->bodyStore == this) return;
+	if (shape->bodyStore != nullptr) {
+		shape->bodyStore->detach(shape);
+	}
+
+	const double* oldPosition = position.data();
+	const double* oldVelocity = velocity.data();
+	const double* oldForce = force.data();
+	const size_t slot = owners.size();
+	position.push_back(shape->mass_centre[0]);
+	position.push_back(shape->mass_centre[1]);
+	velocity.push_back(shape->velocity[0]);
+	velocity.push_back(shape->velocity[1]);
+	force.push_back(shape->totalforce[0]);
+	force.push_back(shape->totalforce[1]);
+	mass.push_back(shape->mass);
+	unsigned char flag = 0;
+	if (shape->isSupported) flag |= BODY_SUPPORTED;
+	if (dynamic_cast<StaticShape*>(shape) != nullptr) flag |= BODY_STATIC;
+	flags.push_back(flag);
+	owners.push_back(shape);
+
+	shape->bodyStore = this;
+	shape->bodySlot = static_cast<int>(slot);
+	if (position.data() != oldPosition || velocity.data() != oldVelocity || force.data() != oldForce) {
+		// 扩容后数组搬到了新的位置，所有物体的视图都要重新指向
+		rebindAll();
+	} else {
+		rebind(slot);
+	}
+}
+
+void BodyStore::detach(Shape* shape) {
+	if (shape == nullptr || shape->bodyStore != this) return;
+	const size_t slot = static_cast<size_t>(shape->bodySlot);
+
+	// 状态复制回物体自己的存储
+	for (int k = 0; k < 2; k++) {
+		shape->ownState[k] = position[2 * slot + k];
+		shape->ownState[2 + k] = velocity[2 * slot + k];
+		shape->ownState[4 + k] = force[2 * slot + k];
+	}
+	shape->bindState(shape->ownState, shape->ownState + 2, shape->ownState + 4);
+	shape->bodyStore = nullptr;
+	shape->bodySlot = -1;
+
+	// 最后一个物体移到空出的槽位
+	const size_t last = owners.size() - 1;
+	if (slot != last) {
+		for (int k = 0; k < 2; k++) {
+			position[2 * slot + k] = position[2 * last + k];
+			velocity[2 * slot + k] = velocity[2 * last + k];
+			force[2 * slot + k] = force[2 * last + k];
+		}
+		mass[slot] = mass[last];
+		flags[slot] = flags[last];
+		owners[slot] = owners[last];
+		owners[slot]->bodySlot = static_cast<int>(slot);
+		rebind(slot);
+	}
+	position.resize(2 * last);
+	velocity.resize(2 * last);
+	force.resize(2 * last);
+	mass.resize(last);
+	flags.resize(last);
+	owners.resize(last);
+}
+
+void BodyStore::clear() {
+	while (!owners.empty()) {
+		detach(owners.back());
+	}
+	wokenHandles.clear();
+}
+
+/*=========================================================================================================
+ * 视图重新指向槽位
+ *=========================================================================================================*/
+void BodyStore::rebind(size_t slot) {
+	owners[slot]->bindState(&position[2 * slot], &velocity[2 * slot], &force[2 * slot]);
+}
+
+void BodyStore::rebindAll() {
+	for (size_t slot = 0; slot < owners.size(); slot++) {
+		rebind(slot);
+	}
+}
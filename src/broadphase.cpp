@@ -0,0 +1,826 @@
+#include "broadphase.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <cstdlib>
+
+/*=========================================================================================================
+ * 辅助函数：把世界坐标转换为网格坐标（向下取整，并限制在 int 范围内）
+ *=========================================================================================================*/
+static int toCell(double value, double cellSize) {
+	double c = std::floor(value / cellSize);
+	if (c < static_cast<double>(INT_MIN / 2)) return INT_MIN / 2;
+	if (c > static_cast<double>(INT_MAX / 2)) return INT_MAX / 2;
+	return static_cast<int>(c);
+}
+
+/*=========================================================================================================
+ * Broadphase 公共方法
+ *=========================================================================================================*/
+void Broadphase::computeFatBounds(const Shape& shape, BroadphaseBounds& b) const {
+	shape.getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+	double w = b.maxX - b.minX;
+	double h = b.maxY - b.minY;
+	if (std::isfinite(w) && std::isfinite(h)) {
+		double margin = std::max(w, h) * fatMargin;
+		b.minX -= margin;
+		b.minY -= margin;
+		b.maxX += margin;
+		b.maxY += margin;
+
+		if (predictionTime > 0.0) {
+			// 速度在这一步中可能反向（落地反弹、碰撞），所以向四周对称放大
+			double vx, vy;
+			shape.getVelocity(vx, vy);
+			double slack = predictionAcceleration * predictionTime * predictionTime;
+			double sweepX = std::abs(vx) * predictionTime + slack;
+			double sweepY = std::abs(vy) * predictionTime + slack;
+			b.minX -= sweepX;
+			b.minY -= sweepY;
+			b.maxX += sweepX;
+			b.maxY += sweepY;
+		}
+	}
+}
+
+void Broadphase::recordStats(size_t shapeCount, size_t candidateCount) {
+	stats.shapeCount = shapeCount;
+	stats.allPairs = shapeCount > 1 ? shapeCount * (shapeCount - 1) / 2 : 0;
+	stats.candidatePairs = candidateCount;
+	stats.savedPairTests = stats.allPairs > candidateCount ? stats.allPairs - candidateCount : 0;
+}
+
+/*=========================================================================================================
+ * BruteForceBroadphase::computePairs() - 输出所有物体对
+ *=========================================================================================================*/
+void BruteForceBroadphase::computePairs(std::vector<CandidatePair>& pairs) {
+	pairs.clear();
+	for (size_t i = 0; i < shapeCount; i++) {
+		for (size_t j = i + 1; j < shapeCount; j++) {
+			pairs.push_back(CandidatePair(static_cast<int>(i), static_cast<int>(j)));
+		}
+	}
+	recordStats(shapeCount, pairs.size());
+}
+
+/*=========================================================================================================
+ * SpatialHashGrid::update() - 重建网格
+ *=========================================================================================================*/
+void SpatialHashGrid::update(const std::vector<Shape*>& shapes) {
+	const size_t n = shapes.size();
+	proxies.resize(n);
+	entries.clear();
+	oversizedList.clear();
+
+	// 1. 计算（放大后的）包围盒，同时统计有限大小形状的平均尺寸
+	double extentSum = 0.0;
+	size_t extentCount = 0;
+	for (size_t i = 0; i < n; i++) {
+		BroadphaseBounds& b = proxies[i].bounds;
+		computeFatBounds(*shapes[i], b);
+		double w = b.maxX - b.minX;
+		double h = b.maxY - b.minY;
+		if (std::isfinite(w) && std::isfinite(h)) {
+			extentSum += std::max(w, h);
+			extentCount++;
+		}
+	}
+
+	// 2. 确定网格单元大小：默认取（放大后）形状的平均尺寸，使典型形状只覆盖少量单元
+	if (fixedCellSize > 0.0) {
+		cellSize = fixedCellSize;
+	} else if (extentCount > 0 && extentSum > 0.0) {
+		cellSize = extentSum / static_cast<double>(extentCount);
+	} else {
+		cellSize = 1.0;
+	}
+
+	// 3. 登记每个形状覆盖的网格单元
+	entries.reserve(n * 4);
+	for (size_t i = 0; i < n; i++) {
+		Proxy& p = proxies[i];
+		const BroadphaseBounds& b = p.bounds;
+		bool finite = std::isfinite(b.minX) && std::isfinite(b.minY) &&
+		              std::isfinite(b.maxX) && std::isfinite(b.maxY);
+		if (finite) {
+			p.cellMinX = toCell(b.minX, cellSize);
+			p.cellMinY = toCell(b.minY, cellSize);
+			p.cellMaxX = toCell(b.maxX, cellSize);
+			p.cellMaxY = toCell(b.maxY, cellSize);
+			double cellCount = (static_cast<double>(p.cellMaxX) - p.cellMinX + 1.0) *
+			                   (static_cast<double>(p.cellMaxY) - p.cellMinY + 1.0);
+			p.oversized = cellCount > maxCellsPerShape;
+		} else {
+			p.oversized = true;
+		}
+
+		if (p.oversized) {
+			oversizedList.push_back(static_cast<int>(i));
+			continue;
+		}
+
+		for (int cx = p.cellMinX; cx <= p.cellMaxX; cx++) {
+			for (int cy = p.cellMinY; cy <= p.cellMaxY; cy++) {
+				CellEntry e;
+				e.key = cellKey(cx, cy);
+				e.index = static_cast<int>(i);
+				entries.push_back(e);
+			}
+		}
+	}
+
+	// 4. 按单元排序，同一单元的登记项连续存放（单元内按下标升序）
+	std::sort(entries.begin(), entries.end());
+}
+
+/*=========================================================================================================
+ * SpatialHashGrid::computePairs() - 输出候选物体对
+ *=========================================================================================================*/
+void SpatialHashGrid::computePairs(std::vector<CandidatePair>& pairs) {
+	pairs.clear();
+
+	// 1. 网格内的物体对：同一单元中两两测试
+	size_t runStart = 0;
+	while (runStart < entries.size()) {
+		size_t runEnd = runStart + 1;
+		while (runEnd < entries.size() && entries[runEnd].key == entries[runStart].key) {
+			runEnd++;
+		}
+
+		int cx = static_cast<int>(static_cast<uint32_t>(entries[runStart].key >> 32));
+		int cy = static_cast<int>(static_cast<uint32_t>(entries[runStart].key & 0xFFFFFFFFu));
+
+		for (size_t a = runStart; a < runEnd; a++) {
+			const Proxy& pa = proxies[entries[a].index];
+			for (size_t b = a + 1; b < runEnd; b++) {
+				const Proxy& pb = proxies[entries[b].index];
+
+				// 只在两者共同覆盖的第一个单元中输出，避免同一对被重复输出
+				if (std::max(pa.cellMinX, pb.cellMinX) != cx ||
+				    std::max(pa.cellMinY, pb.cellMinY) != cy) {
+					continue;
+				}
+				if (pa.bounds.overlaps(pb.bounds)) {
+					pairs.push_back(CandidatePair(entries[a].index, entries[b].index));
+				}
+			}
+		}
+		runStart = runEnd;
+	}
+
+	// 2. 超大形状：与所有其他形状做包围盒测试
+	for (size_t k = 0; k < oversizedList.size(); k++) {
+		int o = oversizedList[k];
+		for (int i = 0; i < static_cast<int>(proxies.size()); i++) {
+			if (i == o) continue;
+			// 两个都是超大形状时只输出一次
+			if (proxies[i].oversized && i < o) continue;
+			if (proxies[o].bounds.overlaps(proxies[i].bounds)) {
+				pairs.push_back(o < i ? CandidatePair(o, i) : CandidatePair(i, o));
+			}
+		}
+	}
+
+	// 3. 按 (i, j) 排序，保持与双重循环相同的处理顺序
+	std::sort(pairs.begin(), pairs.end());
+	recordStats(proxies.size(), pairs.size());
+}
+
+/*=========================================================================================================
+ * SweepAndPrune::update() - 更新端点坐标，并用插入排序恢复有序
+ *=========================================================================================================*/
+void SweepAndPrune::update(const std::vector<Shape*>& shapes) {
+	const size_t n = shapes.size();
+	bounds.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		computeFatBounds(*shapes[i], bounds[i]);
+	}
+
+	// 形状列表发生变化（增删或重排）时从头重建；否则增量更新
+	if (shapes != trackedShapes) {
+		trackedShapes = shapes;
+		rebuild();
+		stats.endpointSwaps = 0;
+		return;
+	}
+
+	refreshEndpoints(endpoints[0], 0);
+	refreshEndpoints(endpoints[1], 1);
+	stats.endpointSwaps = insertionSort(endpoints[0]) + insertionSort(endpoints[1]);
+}
+
+/*=========================================================================================================
+ * SweepAndPrune::rebuild() - 从头生成并排序端点数组
+ *=========================================================================================================*/
+void SweepAndPrune::rebuild() {
+	for (int axis = 0; axis < 2; axis++) {
+		std::vector<Endpoint>& list = endpoints[axis];
+		list.resize(bounds.size() * 2);
+		for (size_t i = 0; i < bounds.size(); i++) {
+			list[2 * i].index = static_cast<int>(i);
+			list[2 * i].isMax = false;
+			list[2 * i + 1].index = static_cast<int>(i);
+			list[2 * i + 1].isMax = true;
+		}
+		refreshEndpoints(list, axis);
+		std::sort(list.begin(), list.end());
+	}
+}
+
+/*=========================================================================================================
+ * SweepAndPrune::refreshEndpoints() - 把本步的包围盒坐标写入端点（顺序保持上一步的结果）
+ *=========================================================================================================*/
+void SweepAndPrune::refreshEndpoints(std::vector<Endpoint>& axis, int axisIndex) {
+	for (size_t k = 0; k < axis.size(); k++) {
+		const BroadphaseBounds& b = bounds[axis[k].index];
+		if (axisIndex == 0) {
+			axis[k].value = axis[k].isMax ? b.maxX : b.minX;
+		} else {
+			axis[k].value = axis[k].isMax ? b.maxY : b.minY;
+		}
+	}
+}
+
+/*=========================================================================================================
+ * SweepAndPrune::insertionSort() - 插入排序，返回交换次数
+ * 上一步已经有序，物体只移动一点点时每个端点只需要很少的交换
+ *=========================================================================================================*/
+size_t SweepAndPrune::insertionSort(std::vector<Endpoint>& axis) {
+	size_t swaps = 0;
+	for (size_t k = 1; k < axis.size(); k++) {
+		Endpoint key = axis[k];
+		size_t pos = k;
+		while (pos > 0 && key < axis[pos - 1]) {
+			axis[pos] = axis[pos - 1];
+			pos--;
+			swaps++;
+		}
+		axis[pos] = key;
+	}
+	return swaps;
+}
+
+/*=========================================================================================================
+ * SweepAndPrune::computePairs() - 沿分布更分散的轴扫描，输出候选物体对
+ *=========================================================================================================*/
+void SweepAndPrune::computePairs(std::vector<CandidatePair>& pairs) {
+	pairs.clear();
+
+	// 1. 选择扫描轴：比较两个轴上有限大小形状中心的方差
+	double sum[2] = {0.0, 0.0};
+	double sumSq[2] = {0.0, 0.0};
+	size_t finiteCount = 0;
+	for (size_t i = 0; i < bounds.size(); i++) {
+		const BroadphaseBounds& b = bounds[i];
+		double cx = 0.5 * (b.minX + b.maxX);
+		double cy = 0.5 * (b.minY + b.maxY);
+		if (!std::isfinite(cx) || !std::isfinite(cy)) continue;
+		sum[0] += cx;
+		sum[1] += cy;
+		sumSq[0] += cx * cx;
+		sumSq[1] += cy * cy;
+		finiteCount++;
+	}
+	sweepAxis = 0;
+	if (finiteCount > 0) {
+		double varX = sumSq[0] / finiteCount - (sum[0] / finiteCount) * (sum[0] / finiteCount);
+		double varY = sumSq[1] / finiteCount - (sum[1] / finiteCount) * (sum[1] / finiteCount);
+		sweepAxis = varY > varX ? 1 : 0;
+	}
+
+	// 2. 沿扫描轴遍历端点：遇到 min 端点时与活动列表中的形状做另一轴的测试，遇到 max 端点时移出活动列表
+	const std::vector<Endpoint>& list = endpoints[sweepAxis];
+	activeList.clear();
+	activeSlot.assign(bounds.size(), -1);
+	for (size_t k = 0; k < list.size(); k++) {
+		const Endpoint& e = list[k];
+		if (e.isMax) {
+			// 交换删除：用活动列表末尾的形状填补空位
+			int slot = activeSlot[e.index];
+			if (slot >= 0) {
+				int last = activeList.back();
+				activeList[slot] = last;
+				activeSlot[last] = slot;
+				activeList.pop_back();
+				activeSlot[e.index] = -1;
+			}
+			continue;
+		}
+
+		const BroadphaseBounds& b = bounds[e.index];
+		for (size_t a = 0; a < activeList.size(); a++) {
+			int other = activeList[a];
+			if (b.overlaps(bounds[other])) {
+				pairs.push_back(e.index < other ? CandidatePair(e.index, other) : CandidatePair(other, e.index));
+			}
+		}
+		activeSlot[e.index] = static_cast<int>(activeList.size());
+		activeList.push_back(e.index);
+	}
+
+	// 3. 按 (i, j) 排序，保持与双重循环相同的处理顺序
+	std::sort(pairs.begin(), pairs.end());
+	recordStats(bounds.size(), pairs.size());
+}
+
+/*=========================================================================================================
+ * BroadphaseBounds::isFinite() - 包围盒是否为有限大小
+ *=========================================================================================================*/
+bool BroadphaseBounds::isFinite() const {
+	return std::isfinite(minX) && std::isfinite(minY) && std::isfinite(maxX) && std::isfinite(maxY);
+}
+
+/*=========================================================================================================
+ * BroadphaseBounds::intersectsSegment() - 线段与包围盒相交（逐轴裁剪参数区间）
+ *=========================================================================================================*/
+bool BroadphaseBounds::intersectsSegment(double x0, double y0, double dx, double dy, double& tEnter) const {
+	double tMin = 0.0, tMax = 1.0;
+	const double origin[2] = {x0, y0};
+	const double delta[2] = {dx, dy};
+	const double lower[2] = {minX, minY};
+	const double upper[2] = {maxX, maxY};
+	for (int axis = 0; axis < 2; axis++) {
+		if (delta[axis] == 0.0) {
+			// 与该轴平行：起点必须在这一轴的范围内
+			if (origin[axis] < lower[axis] || origin[axis] > upper[axis]) return false;
+			continue;
+		}
+		double t1 = (lower[axis] - origin[axis]) / delta[axis];
+		double t2 = (upper[axis] - origin[axis]) / delta[axis];
+		if (t1 > t2) std::swap(t1, t2);
+		tMin = std::max(tMin, t1);
+		tMax = std::min(tMax, t2);
+		if (tMin > tMax) return false;
+	}
+	tEnter = tMin;
+	return true;
+}
+
+/*=========================================================================================================
+ * 辅助函数：包围盒并集、周长（二维中用周长代替表面积作为插入代价）
+ *=========================================================================================================*/
+static BroadphaseBounds combineBounds(const BroadphaseBounds& a, const BroadphaseBounds& b) {
+	BroadphaseBounds c;
+	c.minX = std::min(a.minX, b.minX);
+	c.minY = std::min(a.minY, b.minY);
+	c.maxX = std::max(a.maxX, b.maxX);
+	c.maxY = std::max(a.maxY, b.maxY);
+	return c;
+}
+
+static double perimeter(const BroadphaseBounds& b) {
+	return 2.0 * ((b.maxX - b.minX) + (b.maxY - b.minY));
+}
+
+const int DynamicAABBTree::NULL_NODE;
+
+/*=========================================================================================================
+ * DynamicAABBTree - 节点分配与释放
+ *=========================================================================================================*/
+int DynamicAABBTree::allocateNode() {
+	int nodeId;
+	if (freeList != NULL_NODE) {
+		nodeId = freeList;
+		freeList = nodes[nodeId].parent;
+	} else {
+		nodeId = static_cast<int>(nodes.size());
+		nodes.push_back(TreeNode());
+	}
+	TreeNode& node = nodes[nodeId];
+	node.parent = NULL_NODE;
+	node.child1 = NULL_NODE;
+	node.child2 = NULL_NODE;
+	node.height = 0;
+	node.userData = -1;
+	return nodeId;
+}
+
+void DynamicAABBTree::freeNode(int nodeId) {
+	nodes[nodeId].parent = freeList;
+	nodes[nodeId].height = -1;
+	freeList = nodeId;
+}
+
+void DynamicAABBTree::clear() {
+	nodes.clear();
+	root = NULL_NODE;
+	freeList = NULL_NODE;
+	proxyCount = 0;
+}
+
+/*=========================================================================================================
+ * DynamicAABBTree::createProxy() / destroyProxy() / moveProxy()
+ *=========================================================================================================*/
+int DynamicAABBTree::createProxy(const BroadphaseBounds& bounds, int userData, double margin) {
+	int proxyId = allocateNode();
+	TreeNode& node = nodes[proxyId];
+	node.bounds.minX = bounds.minX - margin;
+	node.bounds.minY = bounds.minY - margin;
+	node.bounds.maxX = bounds.maxX + margin;
+	node.bounds.maxY = bounds.maxY + margin;
+	node.userData = userData;
+	insertLeaf(proxyId);
+	proxyCount++;
+	return proxyId;
+}
+
+void DynamicAABBTree::destroyProxy(int proxyId) {
+	removeLeaf(proxyId);
+	freeNode(proxyId);
+	proxyCount--;
+}
+
+bool DynamicAABBTree::moveProxy(int proxyId, const BroadphaseBounds& bounds, double margin) {
+	// 仍在胖包围盒内：树不需要任何修改
+	if (nodes[proxyId].bounds.contains(bounds)) {
+		return false;
+	}
+
+	removeLeaf(proxyId);
+	TreeNode& node = nodes[proxyId];
+	node.bounds.minX = bounds.minX - margin;
+	node.bounds.minY = bounds.minY - margin;
+	node.bounds.maxX = bounds.maxX + margin;
+	node.bounds.maxY = bounds.maxY + margin;
+	insertLeaf(proxyId);
+	return true;
+}
+
+/*=========================================================================================================
+ * DynamicAABBTree::insertLeaf() - 按周长增量最小的原则选择兄弟节点并插入
+ *=========================================================================================================*/
+void DynamicAABBTree::insertLeaf(int leaf) {
+	if (root == NULL_NODE) {
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	// 1. 从根往下寻找最合适的兄弟节点
+	const BroadphaseBounds leafBounds = nodes[leaf].bounds;
+	int index = root;
+	while (!nodes[index].isLeaf()) {
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+
+		double area = perimeter(nodes[index].bounds);
+		double combinedArea = perimeter(combineBounds(nodes[index].bounds, leafBounds));
+
+		// 在这里新建父节点的代价
+		double cost = 2.0 * combinedArea;
+		// 继续往下走时，祖先节点包围盒增大的代价
+		double inheritanceCost = 2.0 * (combinedArea - area);
+
+		double cost1 = perimeter(combineBounds(leafBounds, nodes[child1].bounds)) + inheritanceCost;
+		if (!nodes[child1].isLeaf()) {
+			cost1 -= perimeter(nodes[child1].bounds);
+		}
+		double cost2 = perimeter(combineBounds(leafBounds, nodes[child2].bounds)) + inheritanceCost;
+		if (!nodes[child2].isLeaf()) {
+			cost2 -= perimeter(nodes[child2].bounds);
+		}
+
+		if (cost < cost1 && cost < cost2) {
+			break;
+		}
+		index = cost1 < cost2 ? child1 : child2;
+	}
+	int sibling = index;
+
+	// 2. 新建父节点，把兄弟节点和新叶子挂在下面
+	int oldParent = nodes[sibling].parent;
+	int newParent = allocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].bounds = combineBounds(leafBounds, nodes[sibling].bounds);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent != NULL_NODE) {
+		if (nodes[oldParent].child1 == sibling) {
+			nodes[oldParent].child1 = newParent;
+		} else {
+			nodes[oldParent].child2 = newParent;
+		}
+	} else {
+		root = newParent;
+	}
+
+	// 3. 沿路径向上更新包围盒和高度，并做旋转平衡
+	refitAncestors(nodes[leaf].parent);
+}
+
+/*=========================================================================================================
+ * DynamicAABBTree::removeLeaf() - 删除叶子，兄弟节点顶替父节点的位置
+ *=========================================================================================================*/
+void DynamicAABBTree::removeLeaf(int leaf) {
+	if (leaf == root) {
+		root = NULL_NODE;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent != NULL_NODE) {
+		if (nodes[grandParent].child1 == parent) {
+			nodes[grandParent].child1 = sibling;
+		} else {
+			nodes[grandParent].child2 = sibling;
+		}
+		nodes[sibling].parent = grandParent;
+		freeNode(parent);
+		refitAncestors(grandParent);
+	} else {
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+		freeNode(parent);
+	}
+}
+
+/*=========================================================================================================
+ * DynamicAABBTree::refitAncestors() - 从 nodeId 开始向上重新计算包围盒和高度
+ *=========================================================================================================*/
+void DynamicAABBTree::refitAncestors(int nodeId) {
+	int index = nodeId;
+	while (index != NULL_NODE) {
+		index = balance(index);
+
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+		nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		nodes[index].bounds = combineBounds(nodes[child1].bounds, nodes[child2].bounds);
+
+		index = nodes[index].parent;
+	}
+}
+
+/*=========================================================================================================
+ * DynamicAABBTree::balance() - 旋转平衡
+ *
+ * 如果 A 的某个子节点比另一个高 2 层以上，就把较高的子节点旋转上来代替 A，
+ * 并把它较高的孙节点留在自己下面、较矮的孙节点交给 A。返回旋转后该位置上的节点。
+ *
+ *         A                 C
+ *        / \               / \
+ *       B   C     =>      A   F      （F 比 G 高时）
+ *          / \           / \
+ *         F   G         B   G
+ *=========================================================================================================*/
+int DynamicAABBTree::balance(int iA) {
+	if (nodes[iA].isLeaf() || nodes[iA].height < 2) {
+		return iA;
+	}
+
+	int iB = nodes[iA].child1;
+	int iC = nodes[iA].child2;
+	int diff = nodes[iC].height - nodes[iB].height;
+
+	// C 较高：把 C 旋转上来
+	if (diff > 1) {
+		int iF = nodes[iC].child1;
+		int iG = nodes[iC].child2;
+
+		nodes[iC].child1 = iA;
+		nodes[iC].parent = nodes[iA].parent;
+		nodes[iA].parent = iC;
+
+		if (nodes[iC].parent != NULL_NODE) {
+			if (nodes[nodes[iC].parent].child1 == iA) {
+				nodes[nodes[iC].parent].child1 = iC;
+			} else {
+				nodes[nodes[iC].parent].child2 = iC;
+			}
+		} else {
+			root = iC;
+		}
+
+		if (nodes[iF].height > nodes[iG].height) {
+			nodes[iC].child2 = iF;
+			nodes[iA].child2 = iG;
+			nodes[iG].parent = iA;
+			nodes[iA].bounds = combineBounds(nodes[iB].bounds, nodes[iG].bounds);
+			nodes[iC].bounds = combineBounds(nodes[iA].bounds, nodes[iF].bounds);
+			nodes[iA].height = 1 + std::max(nodes[iB].height, nodes[iG].height);
+			nodes[iC].height = 1 + std::max(nodes[iA].height, nodes[iF].height);
+		} else {
+			nodes[iC].child2 = iG;
+			nodes[iA].child2 = iF;
+			nodes[iF].parent = iA;
+			nodes[iA].bounds = combineBounds(nodes[iB].bounds, nodes[iF].bounds);
+			nodes[iC].bounds = combineBounds(nodes[iA].bounds, nodes[iG].bounds);
+			nodes[iA].height = 1 + std::max(nodes[iB].height, nodes[iF].height);
+			nodes[iC].height = 1 + std::max(nodes[iA].height, nodes[iG].height);
+		}
+		return iC;
+	}
+
+	// B 较高：把 B 旋转上来
+	if (diff < -1) {
+		int iD = nodes[iB].child1;
+		int iE = nodes[iB].child2;
+
+		nodes[iB].child1 = iA;
+		nodes[iB].parent = nodes[iA].parent;
+		nodes[iA].parent = iB;
+
+		if (nodes[iB].parent != NULL_NODE) {
+			if (nodes[nodes[iB].parent].child1 == iA) {
+				nodes[nodes[iB].parent].child1 = iB;
+			} else {
+				nodes[nodes[iB].parent].child2 = iB;
+			}
+		} else {
+			root = iB;
+		}
+
+		if (nodes[iD].height > nodes[iE].height) {
+			nodes[iB].child2 = iD;
+			nodes[iA].child1 = iE;
+			nodes[iE].parent = iA;
+			nodes[iA].bounds = combineBounds(nodes[iC].bounds, nodes[iE].bounds);
+			nodes[iB].bounds = combineBounds(nodes[iA].bounds, nodes[iD].bounds);
+			nodes[iA].height = 1 + std::max(nodes[iC].height, nodes[iE].height);
+			nodes[iB].height = 1 + std::max(nodes[iA].height, nodes[iD].height);
+		} else {
+			nodes[iB].child2 = iE;
+			nodes[iA].child1 = iD;
+			nodes[iD].parent = iA;
+			nodes[iA].bounds = combineBounds(nodes[iC].bounds, nodes[iD].bounds);
+			nodes[iB].bounds = combineBounds(nodes[iA].bounds, nodes[iE].bounds);
+			nodes[iA].height = 1 + std::max(nodes[iC].height, nodes[iD].height);
+			nodes[iB].height = 1 + std::max(nodes[iA].height, nodes[iE].height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+/*=========================================================================================================
+ * DynamicAABBTree::query() - 查询与包围盒重叠的叶子
+ *=========================================================================================================*/
+void DynamicAABBTree::query(const BroadphaseBounds& bounds, std::vector<int>& result) const {
+	query(bounds, result, queryStack);
+}
+
+void DynamicAABBTree::query(const BroadphaseBounds& bounds, std::vector<int>& result, std::vector<int>& stack) const {
+	if (root == NULL_NODE) {
+		return;
+	}
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty()) {
+		int nodeId = stack.back();
+		stack.pop_back();
+
+		const TreeNode& node = nodes[nodeId];
+		if (!node.bounds.overlaps(bounds)) {
+			continue;
+		}
+		if (node.isLeaf()) {
+			result.push_back(node.userData);
+		} else {
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+}
+
+/*=========================================================================================================
+ * DynamicAABBTree::raycast() - 查询与线段相交的叶子
+ * 只进入与线段相交的子树，细长的斜线段也不会像用线段的包围盒查询那样覆盖大量无关的叶子。
+ *=========================================================================================================*/
+void DynamicAABBTree::raycast(double x0, double y0, double dx, double dy, std::vector<int>& result, std::vector<int>& stack) const {
+	if (root == NULL_NODE) {
+		return;
+	}
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty()) {
+		int nodeId = stack.back();
+		stack.pop_back();
+
+		const TreeNode& node = nodes[nodeId];
+		double tEnter;
+		if (!node.bounds.intersectsSegment(x0, y0, dx, dy, tEnter)) {
+			continue;
+		}
+		if (node.isLeaf()) {
+			result.push_back(node.userData);
+		} else {
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+}
+
+/*=========================================================================================================
+ * DynamicAABBTree::getMaxBalance() - 左右子树高度差的最大值
+ *=========================================================================================================*/
+int DynamicAABBTree::getMaxBalance() const {
+	int maxBalance = 0;
+	for (size_t i = 0; i < nodes.size(); i++) {
+		const TreeNode& node = nodes[i];
+		if (node.height <= 1) {
+			continue;
+		}
+		int diff = std::abs(nodes[node.child2].height - nodes[node.child1].height);
+		maxBalance = std::max(maxBalance, diff);
+	}
+	return maxBalance;
+}
+
+/*=========================================================================================================
+ * AABBTreeBroadphase::update() - 更新叶子；只有移出胖包围盒的形状才重新插入
+ *=========================================================================================================*/
+double AABBTreeBroadphase::leafMargin(const BroadphaseBounds& b) const {
+	return std::max(b.maxX - b.minX, b.maxY - b.minY) * displacementMargin;
+}
+
+void AABBTreeBroadphase::update(const std::vector<Shape*>& shapes) {
+	const size_t n = shapes.size();
+	bounds.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		computeFatBounds(*shapes[i], bounds[i]);
+	}
+
+	// 形状列表发生变化（增删或重排）时从头重建；否则增量更新
+	if (shapes != trackedShapes) {
+		trackedShapes = shapes;
+		rebuild();
+		stats.proxyReinserts = 0;
+		return;
+	}
+
+	size_t reinserts = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (proxyIds[i] == DynamicAABBTree::NULL_NODE) {
+			continue;
+		}
+		if (tree.moveProxy(proxyIds[i], bounds[i], leafMargin(bounds[i]))) {
+			reinserts++;
+		}
+	}
+	stats.proxyReinserts = reinserts;
+}
+
+/*=========================================================================================================
+ * AABBTreeBroadphase::rebuild() - 清空并重新插入所有形状
+ *=========================================================================================================*/
+void AABBTreeBroadphase::rebuild() {
+	tree.clear();
+	proxyIds.assign(bounds.size(), DynamicAABBTree::NULL_NODE);
+	unboundedList.clear();
+	for (size_t i = 0; i < bounds.size(); i++) {
+		if (bounds[i].isFinite()) {
+			proxyIds[i] = tree.createProxy(bounds[i], static_cast<int>(i), leafMargin(bounds[i]));
+		} else {
+			unboundedList.push_back(static_cast<int>(i));
+		}
+	}
+}
+
+/*=========================================================================================================
+ * AABBTreeBroadphase::computePairs() - 每个形状查询一次树，输出候选物体对
+ *=========================================================================================================*/
+void AABBTreeBroadphase::computePairs(std::vector<CandidatePair>& pairs) {
+	pairs.clear();
+
+	// 1. 树中的形状：查询结果中只保留下标更大的一方，每对只输出一次
+	for (size_t i = 0; i < bounds.size(); i++) {
+		if (proxyIds[i] == DynamicAABBTree::NULL_NODE) {
+			continue;
+		}
+		queryResult.clear();
+		tree.query(bounds[i], queryResult);
+		for (size_t k = 0; k < queryResult.size(); k++) {
+			int j = queryResult[k];
+			if (j > static_cast<int>(i) && bounds[i].overlaps(bounds[j])) {
+				pairs.push_back(CandidatePair(static_cast<int>(i), j));
+			}
+		}
+	}
+
+	// 2. 无限大的形状：与所有其他形状做包围盒测试
+	for (size_t k = 0; k < unboundedList.size(); k++) {
+		int u = unboundedList[k];
+		for (int i = 0; i < static_cast<int>(bounds.size()); i++) {
+			if (i == u) continue;
+			// 两个都是无限大形状时只输出一次
+			if (proxyIds[i] == DynamicAABBTree::NULL_NODE && i < u) continue;
+			if (bounds[u].overlaps(bounds[i])) {
+				pairs.push_back(u < i ? CandidatePair(u, i) : CandidatePair(i, u));
+			}
+		}
+	}
+
+	// 3. 按 (i, j) 排序，保持与双重循环相同的处理顺序
+	std::sort(pairs.begin(), pairs.end());
+	recordStats(bounds.size(), pairs.size());
+}
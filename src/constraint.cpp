@@ -0,0 +1,650 @@
+#include "constraint.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 同一颜色的约束分块并行时每块的数量
+const size_t kConstraintChunk = 1024;
+
+// 端点距离小于该值时方向不确定，跳过这个约束
+const double kMinSeparation = 1e-12;
+
+// 链条的残差（约束误差，以及未平衡的力折算成的位移，单位米）小于该值时认为已经收敛
+const double kChainTolerance = 1e-10;
+
+// 对称 3×3 矩阵 (a00 a01 a02 a11 a12 a22) 求逆，结果写回 a；奇异时写入 0（这一块不做修正）
+void invertSymmetric(double* a) {
+	const double c00 = a[3] * a[5] - a[4] * a[4];
+	const double c01 = a[2] * a[4] - a[1] * a[5];
+	const double c02 = a[1] * a[4] - a[2] * a[3];
+	const double det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+	if (det == 0.0) {
+		std::fill(a, a + 6, 0.0);
+		return;
+	}
+	const double inv = 1.0 / det;
+	const double c11 = a[0] * a[5] - a[2] * a[2];
+	const double c12 = a[1] * a[2] - a[0] * a[4];
+	const double c22 = a[0] * a[3] - a[1] * a[1];
+	a[0] = c00 * inv;
+	a[1] = c01 * inv;
+	a[2] = c02 * inv;
+	a[3] = c11 * inv;
+	a[4] = c12 * inv;
+	a[5] = c22 * inv;
+}
+
+}
+
+/*=========================================================================================================
+ * 加入、删除约束
+ *=========================================================================================================*/
+int ConstraintSolver::add(ConstraintType type, ShapeHandle a, ShapeHandle b, double anchorX, double anchorY,
+                          double length, double complianceValue) {
+	if (a.isNull() || a == b || length < 0.0 || complianceValue < 0.0) return -1;
+	if (type == CONSTRAINT_PIN) b = ShapeHandle();
+
+	Constraint c;
+	c.type = type;
+	c.a = a;
+	c.b = b;
+	c.anchorX = anchorX;
+	c.anchorY = anchorY;
+	c.length = length;
+	c.compliance = complianceValue;
+	c.color = -1;
+	c.force = 0.0;
+	c.alive = true;
+
+	int id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+		constraints[id] = c;
+	} else {
+		id = static_cast<int>(constraints.size());
+		constraints.push_back(c);
+	}
+	liveCount++;
+	colorsDirty = true;
+	linksDirty = true;
+	return id;
+}
+
+bool ConstraintSolver::remove(int id) {
+	if (!isValid(id)) return false;
+	constraints[id].alive = false;
+	constraints[id].color = -1;
+	freeIds.push_back(id);
+	liveCount--;
+	colorsDirty = true;
+	linksDirty = true;
+	return true;
+}
+
+void ConstraintSolver::clear() {
+	constraints.clear();
+	freeIds.clear();
+	colorOrder.clear();
+	colorStart.clear();
+	liveCount = 0;
+	colorsDirty = true;   // 下一次求解时清除物体的 BODY_CONSTRAINED 标志
+	linksDirty = true;
+	stats = ConstraintStats();
+}
+
+/*=========================================================================================================
+ * 约束连接的形状：links 按约束编号排列，邻接表按句柄槽位做计数排序
+ * 端点的形状被移出世界后，句柄失效，resolve 返回 nullptr，使用者跳过即可
+ *=========================================================================================================*/
+const std::vector<std::pair<ShapeHandle, ShapeHandle> >& ConstraintSolver::getLinks() {
+	if (linksDirty) rebuildLinks();
+	return links;
+}
+
+const ShapeHandle* ConstraintSolver::getLinkedShapes(ShapeHandle handle, size_t& count) {
+	if (linksDirty) rebuildLinks();
+	const size_t index = handle.index();
+	if (handle.isNull() || index + 1 >= linkStart.size()) {
+		count = 0;
+		return nullptr;
+	}
+	count = linkStart[index + 1] - linkStart[index];
+	return linked.data() + linkStart[index];
+}
+
+void ConstraintSolver::rebuildLinks() {
+	links.clear();
+	uint32_t maxIndex = 0;
+	for (size_t id = 0; id < constraints.size(); id++) {
+		const Constraint& c = constraints[id];
+		if (!c.alive || c.b.isNull()) continue;
+		links.push_back(std::make_pair(c.a, c.b));
+		maxIndex = std::max(maxIndex, std::max(c.a.index(), c.b.index()));
+	}
+
+	linkStart.assign(links.empty() ? 0 : maxIndex + 2, 0);
+	for (size_t k = 0; k < links.size(); k++) {
+		linkStart[links[k].first.index() + 1]++;
+		linkStart[links[k].second.index() + 1]++;
+	}
+	for (size_t i = 1; i < linkStart.size(); i++) {
+		linkStart[i] += linkStart[i - 1];
+	}
+	linked.resize(links.size() * 2);
+	std::vector<size_t> cursor(linkStart.begin(), linkStart.empty() ? linkStart.end() : linkStart.end() - 1);
+	for (size_t k = 0; k < links.size(); k++) {
+		linked[cursor[links[k].first.index()]++] = links[k].second;
+		linked[cursor[links[k].second.index()]++] = links[k].first;
+	}
+	linksDirty = false;
+}
+
+/*=========================================================================================================
+ * buildColors() - 约束图着色
+ * 按编号依次给每个约束取两端的动态物体都没有用过的最小颜色（位掩码，最多 64 种）；
+ * 静态形状不会被移动，多个约束可以同时连接同一个静态形状，不参与着色。
+ * 之后按颜色做计数排序，同一颜色的约束在 colorOrder 中连续存放。
+ *=========================================================================================================*/
+void ConstraintSolver::buildColors(const HandleTable& handles, BodyStore& store) {
+	for (size_t slot = 0; slot < store.size(); slot++) {
+		store.setFlag(static_cast<int>(slot), BODY_CONSTRAINED, false);
+	}
+	usedColors.assign(handles.slotCount(), 0);
+	std::vector<size_t> counts(kMaxColors + 1, 0);
+	int colorCount = 0;
+
+	for (size_t id = 0; id < constraints.size(); id++) {
+		Constraint& c = constraints[id];
+		if (!c.alive) continue;
+
+		uint64_t* masks[2] = { nullptr, nullptr };
+		const ShapeHandle ends[2] = { c.a, c.b };
+		for (int e = 0; e < 2; e++) {
+			Shape* shape = ends[e].isNull() ? nullptr : handles.resolve(ends[e]);
+			if (shape != nullptr && shape->getBodyStore() == &store) {
+				masks[e] = &usedColors[ends[e].index()];
+			}
+		}
+
+		const uint64_t used = (masks[0] ? *masks[0] : 0) | (masks[1] ? *masks[1] : 0);
+		int color = kMaxColors;
+		for (int k = 0; k < kMaxColors; k++) {
+			if (!(used & (1ULL << k))) {
+				color = k;
+				break;
+			}
+		}
+		if (color < kMaxColors) {
+			for (int e = 0; e < 2; e++) {
+				if (masks[e]) *masks[e] |= (1ULL << color);
+			}
+		}
+		c.color = color;
+		counts[color]++;
+		colorCount = std::max(colorCount, color + 1);
+	}
+
+	colorStart.assign(colorCount + 1, 0);
+	for (int k = 0; k < colorCount; k++) {
+		colorStart[k + 1] = colorStart[k] + counts[k];
+	}
+	colorOrder.resize(colorStart[colorCount]);
+	std::vector<size_t> cursor(colorStart.begin(), colorStart.end() - 1);
+	for (size_t id = 0; id < constraints.size(); id++) {
+		if (constraints[id].alive) {
+			colorOrder[cursor[constraints[id].color]++] = static_cast<int>(id);
+		}
+	}
+	colorsDirty = false;
+}
+
+/*=========================================================================================================
+ * particleFor() - 约束端点对应的粒子
+ * 清醒的、质量大于 0 的动态物体按 BodyStore 槽位共用一个粒子；其他形状（静态、休眠）和固定点各自一个粒子，质量的倒数为 0
+ *=========================================================================================================*/
+int ConstraintSolver::particleFor(const HandleTable& handles, BodyStore& store, ShapeHandle handle,
+                                  double x, double y, bool& valid) {
+	bool movable = false;
+	int slot = -1;
+	if (!handle.isNull()) {
+		Shape* shape = handles.resolve(handle);
+		if (shape == nullptr) {
+			valid = false;
+			return -1;
+		}
+		if (shape->getBodyStore() == &store) {
+			slot = shape->getBodySlot();
+			store.setFlag(slot, BODY_CONSTRAINED, true);
+			movable = !shape->isSleeping() && store.massData()[slot] > 0.0 &&
+			          !(store.flagData()[slot] & BODY_STATIC);
+			if (movable && slotParticle[slot] >= 0) {
+				return slotParticle[slot];
+			}
+		}
+		shape->getCentre(x, y);
+	}
+
+	const int index = static_cast<int>(particleInvMass.size());
+	particlePosition.push_back(x);
+	particlePosition.push_back(y);
+	if (movable) {
+		particleInvMass.push_back(1.0 / store.massData()[slot]);
+		particleSlot.push_back(slot);
+		slotParticle[slot] = index;
+	} else {
+		particleInvMass.push_back(0.0);
+		particleSlot.push_back(-1);
+	}
+	return index;
+}
+
+/*=========================================================================================================
+ * solveRange() - 一批中 [begin, end) 的约束求解一轮（同一批的约束没有公共的可移动粒子，可以并行）
+ *   C = |xb - xa| - L，n = (xb - xa) / |xb - xa|，α~ = α / Δt²（α 为柔度）
+ *   Δλ = (-C - α~·λ) / (wa + wb + α~)，xa -= wa·Δλ·n，xb += wb·Δλ·n（w 为质量的倒数）
+ *=========================================================================================================*/
+void ConstraintSolver::solveRange(size_t begin, size_t end, double alphaScale) {
+	double* p = particlePosition.data();
+	const double* w = particleInvMass.data();
+	for (size_t k = begin; k < end; k++) {
+		const int ia = endA[k];
+		if (ia < 0 || inChain[k]) continue;
+		const int ib = endB[k];
+		const double wa = w[ia];
+		const double wb = w[ib];
+		const double wSum = wa + wb;
+		if (wSum <= 0.0) continue;
+
+		const double dx = p[2 * ib] - p[2 * ia];
+		const double dy = p[2 * ib + 1] - p[2 * ia + 1];
+		const double len = std::sqrt(dx * dx + dy * dy);
+		const double C = len - restLength[k];
+		if ((unilateral[k] && C <= 0.0) || len < kMinSeparation) continue;
+
+		const double alphaTilde = compliance[k] * alphaScale;
+		const double dLambda = (-C - alphaTilde * lambda[k]) / (wSum + alphaTilde);
+		lambda[k] += dLambda;
+
+		const double nx = dx / len;
+		const double ny = dy / len;
+		if (wa > 0.0) {
+			p[2 * ia] -= wa * dLambda * nx;
+			p[2 * ia + 1] -= wa * dLambda * ny;
+		}
+		if (wb > 0.0) {
+			p[2 * ib] += wb * dLambda * nx;
+			p[2 * ib + 1] += wb * dLambda * ny;
+		}
+	}
+}
+
+/*=========================================================================================================
+ * buildChains() - 找出可以直接求解的链条
+ * 可移动的粒子最多连接两个约束、且都是等式约束时，称为链上的粒子；两端可移动的粒子都在链上的等式约束可以放进链条。
+ * 从只有一个相邻约束的约束（链的一端）出发，经过共用的粒子依次走到另一端；成环的约束找不到起点，仍按颜色求解。
+ *=========================================================================================================*/
+void ConstraintSolver::buildChains() {
+	const size_t count = endA.size();
+	const double* w = particleInvMass.data();
+	particleDegree.assign(particleInvMass.size(), 0);
+	particleEdges.assign(2 * particleInvMass.size(), -1);
+	for (size_t k = 0; k < count; k++) {
+		if (endA[k] < 0) continue;
+		const int ends[2] = { endA[k], endB[k] };
+		for (int e = 0; e < 2; e++) {
+			const int i = ends[e];
+			if (w[i] <= 0.0) continue;
+			if (particleDegree[i] < 2) particleEdges[2 * i + particleDegree[i]] = static_cast<int>(k);
+			particleDegree[i] = unilateral[k] ? 3 : particleDegree[i] + 1;   // 绳子两端的粒子不在链上
+		}
+	}
+
+	inChain.assign(count, 0);
+	chainOrder.clear();
+	chainParticle.clear();
+	chainStart.assign(1, 0);
+	for (size_t start = 0; start < count; start++) {
+		if (!isChainable(static_cast<int>(start)) || inChain[start]) continue;
+		// 只从链的一端出发
+		int neighbours = 0;
+		const int ends[2] = { endA[start], endB[start] };
+		for (int e = 0; e < 2; e++) {
+			if (chainNeighbour(static_cast<int>(start), ends[e]) >= 0) neighbours++;
+		}
+		if (neighbours == 2) continue;
+
+		int current = static_cast<int>(start);
+		int enteredVia = -1;
+		while (true) {
+			chainOrder.push_back(current);
+			inChain[current] = 1;
+			int next = -1, via = -1;
+			const int currentEnds[2] = { endA[current], endB[current] };
+			for (int e = 0; e < 2 && next < 0; e++) {
+				if (currentEnds[e] == enteredVia) continue;
+				const int neighbour = chainNeighbour(current, currentEnds[e]);
+				if (neighbour >= 0 && !inChain[neighbour]) {
+					next = neighbour;
+					via = currentEnds[e];
+				}
+			}
+			if (enteredVia < 0) {
+				// 链头的粒子：第一个约束不与下一个约束共用的一端
+				chainParticle.push_back((via >= 0 && endA[current] == via) ? endB[current] : endA[current]);
+			}
+			if (next < 0) {
+				chainParticle.push_back((enteredVia < 0 || endA[current] == enteredVia) ? endB[current] : endA[current]);
+				break;
+			}
+			chainParticle.push_back(via);
+			current = next;
+			enteredVia = via;
+		}
+		chainStart.push_back(chainOrder.size());
+	}
+}
+
+bool ConstraintSolver::isChainable(int k) const {
+	if (endA[k] < 0 || unilateral[k]) return false;
+	const int ends[2] = { endA[k], endB[k] };
+	bool movable = false;
+	for (int e = 0; e < 2; e++) {
+		if (particleInvMass[ends[e]] <= 0.0) continue;
+		if (particleDegree[ends[e]] > 2) return false;
+		movable = true;
+	}
+	return movable;
+}
+
+int ConstraintSolver::chainNeighbour(int k, int particle) const {
+	if (particleInvMass[particle] <= 0.0 || particleDegree[particle] != 2) return -1;
+	const int other = (particleEdges[2 * particle] == k) ? particleEdges[2 * particle + 1] : particleEdges[2 * particle];
+	return isChainable(other) ? other : -1;
+}
+
+/*=========================================================================================================
+ * solveChain() - 一条链做一次牛顿迭代
+ * 未知量为链上可移动粒子的位置 x 和各约束的 λ，要同时满足（x~ 为求解前的位置，α~ = α / Δt²）：
+ *   g = M·(x - x~) - Jᵀ·λ = 0，h = C(x) + α~·λ = 0
+ * 线性化得到 [K  Jᵀ; J  -α~]·[Δx; -Δλ] = [-g; -h]，其中 K = M - Σ λ·∇²C 含几何刚度：
+ * 链条承受的拉力远大于每节的重量时，只按 J·W·Jᵀ 求 Δλ（忽略几何刚度）会在链条弯折处来回振荡、无法收敛。
+ * 第 b 块的未知量为 (链上第 b 个粒子的 x、y，第 b - 1 个约束的 -Δλ)，只与相邻的块耦合，按分块追赶法 O(n) 求解：
+ *   对角块对称，存 6 个数 (d00 d01 d02 d11 d12 d22)；上方的块只有前两行非零：几何刚度 (a00 a01 a11) 和 J (v0 v1)。
+ * 固定点与链头的空位用单位行代替。压缩（λ > 0）时不计几何刚度，K 保持正定。
+ *=========================================================================================================*/
+double ConstraintSolver::solveChain(size_t chain, double alphaScale) {
+	const size_t begin = chainStart[chain];
+	const size_t end = chainStart[chain + 1];
+	const size_t blocks = end - begin + 1;
+	const int* particle = chainParticle.data() + begin + chain;
+	double* diag = chainDiag.data() + 6 * (begin + chain);
+	double* upper = chainUpper.data() + 5 * (begin + chain);
+	double* rhs = chainRhs.data() + 3 * (begin + chain);
+	double* p = particlePosition.data();
+	const double* start = particleStart.data();
+	const double* w = particleInvMass.data();
+
+	// ========== 组装：第 b 块先放质量与 -g，再加上连接第 b - 1、b 块的约束；第 b - 1 块随之完整，统计残差（折算成米）==========
+	double residual = 0.0;
+	for (size_t b = 0; b < blocks; b++) {
+		double* d = diag + 6 * b;
+		double* r = rhs + 3 * b;
+		const int i = particle[b];
+		if (w[i] > 0.0) {
+			const double mass = 1.0 / w[i];
+			d[0] = d[3] = mass;
+			r[0] = -mass * (p[2 * i] - start[2 * i]);
+			r[1] = -mass * (p[2 * i + 1] - start[2 * i + 1]);
+		} else {
+			d[0] = d[3] = 1.0;
+			r[0] = r[1] = 0.0;
+		}
+		d[1] = d[2] = d[4] = 0.0;
+		d[5] = 1.0;   // 链头没有约束；约束方向不确定时保持单位行，Δλ = 0
+		r[2] = 0.0;
+		double* u0 = upper + 5 * b;
+		u0[0] = u0[1] = u0[2] = u0[3] = u0[4] = 0.0;
+		if (b == 0) continue;
+
+		const int k = chainOrder[begin + b - 1];
+		const int i0 = particle[b - 1];
+		const double dx = p[2 * endB[k]] - p[2 * endA[k]];
+		const double dy = p[2 * endB[k] + 1] - p[2 * endA[k] + 1];
+		const double len = std::sqrt(dx * dx + dy * dy);
+		double* d0 = diag + 6 * (b - 1);
+		double* r0 = rhs + 3 * (b - 1);
+		if (len >= kMinSeparation) {
+			const double inverseLen = 1.0 / len;
+			const double nx = dx * inverseLen, ny = dy * inverseLen;
+			const double s0 = (endB[k] == i0) ? 1.0 : -1.0;
+			const double s1 = (endB[k] == i) ? 1.0 : -1.0;
+			const double alphaTilde = compliance[k] * alphaScale;
+			const bool movable0 = w[i0] > 0.0;
+			const bool movable1 = w[i] > 0.0;
+			double* u = upper + 5 * (b - 1);
+
+			// 约束行：J 与 -α~，右端 -h
+			d[5] = -alphaTilde;
+			r[2] = -(len - restLength[k]) - alphaTilde * lambda[k];
+
+			// 几何刚度 -λ·∇²C = γ·(I - n·nᵀ)·[1 -1; -1 1]
+			const double gamma = std::max(-lambda[k], 0.0) * inverseLen;
+			const double pxx = gamma * ny * ny;
+			const double pxy = -gamma * nx * ny;
+			const double pyy = gamma * nx * nx;
+			if (movable0) {
+				u[3] = s0 * nx;
+				u[4] = s0 * ny;
+				r0[0] += s0 * nx * lambda[k];
+				r0[1] += s0 * ny * lambda[k];
+				d0[0] += pxx; d0[1] += pxy; d0[3] += pyy;
+			}
+			if (movable1) {
+				d[2] = s1 * nx;
+				d[4] = s1 * ny;
+				r[0] += s1 * nx * lambda[k];
+				r[1] += s1 * ny * lambda[k];
+				d[0] += pxx; d[1] += pxy; d[3] += pyy;
+			}
+			if (movable0 && movable1) {
+				u[0] = -pxx; u[1] = -pxy; u[2] = -pyy;
+			}
+		}
+		residual = std::max(residual, std::max(std::fabs(r0[2]), (std::fabs(r0[0]) + std::fabs(r0[1])) * w[i0]));
+	}
+	const double* last = rhs + 3 * (blocks - 1);
+	residual = std::max(residual, std::max(std::fabs(last[2]), (std::fabs(last[0]) + std::fabs(last[1])) * w[particle[blocks - 1]]));
+	if (residual < kChainTolerance) return residual;
+
+	// ========== 分块追赶法：消元（下方的块为 upperᵀ），对角块换成它的逆供回代使用 ==========
+	for (size_t b = 0; b + 1 < blocks; b++) {
+		double* e = diag + 6 * b;
+		invertSymmetric(e);
+		const double* u = upper + 5 * b;
+		const double* r = rhs + 3 * b;
+		// 上方的块 U 的前两行为 Qᵀ，Q = [a00 a01; a01 a11; v0 v1]：D[b+1] -= Q·E·Qᵀ，r[b+1] -= Q·(D⁻¹·r)，E 为 D⁻¹ 的左上角
+		const double q[6] = { u[0], u[1], u[1], u[2], u[3], u[4] };
+		double qe[6];
+		for (int row = 0; row < 3; row++) {
+			qe[2 * row] = q[2 * row] * e[0] + q[2 * row + 1] * e[1];
+			qe[2 * row + 1] = q[2 * row] * e[1] + q[2 * row + 1] * e[3];
+		}
+		const double z0 = e[0] * r[0] + e[1] * r[1] + e[2] * r[2];
+		const double z1 = e[1] * r[0] + e[3] * r[1] + e[4] * r[2];
+		double* d = diag + 6 * (b + 1);
+		double* rn = rhs + 3 * (b + 1);
+		d[0] -= qe[0] * q[0] + qe[1] * q[1];
+		d[1] -= qe[0] * q[2] + qe[1] * q[3];
+		d[2] -= qe[0] * q[4] + qe[1] * q[5];
+		d[3] -= qe[2] * q[2] + qe[3] * q[3];
+		d[4] -= qe[2] * q[4] + qe[3] * q[5];
+		d[5] -= qe[4] * q[4] + qe[5] * q[5];
+		rn[0] -= q[0] * z0 + q[1] * z1;
+		rn[1] -= q[2] * z0 + q[3] * z1;
+		rn[2] -= q[4] * z0 + q[5] * z1;
+	}
+	invertSymmetric(diag + 6 * (blocks - 1));
+
+	// ========== 回代，同时修正位置和 λ ==========
+	for (size_t b = blocks; b-- > 0;) {
+		const double* e = diag + 6 * b;
+		double* r = rhs + 3 * b;
+		double v0 = r[0], v1 = r[1];
+		const double v2 = r[2];
+		if (b + 1 < blocks) {
+			const double* u = upper + 5 * b;
+			const double* next = rhs + 3 * (b + 1);
+			v0 -= u[0] * next[0] + u[1] * next[1] + u[3] * next[2];
+			v1 -= u[1] * next[0] + u[2] * next[1] + u[4] * next[2];
+		}
+		r[0] = e[0] * v0 + e[1] * v1 + e[2] * v2;
+		r[1] = e[1] * v0 + e[3] * v1 + e[4] * v2;
+		r[2] = e[2] * v0 + e[4] * v1 + e[5] * v2;
+
+		const int i = particle[b];
+		if (w[i] > 0.0) {
+			p[2 * i] += r[0];
+			p[2 * i + 1] += r[1];
+		}
+		if (b > 0) lambda[chainOrder[begin + b - 1]] -= r[2];
+	}
+	return residual;
+}
+
+/*=========================================================================================================
+ * solve() - 求解所有约束
+ * 1. 约束有增删时重新着色
+ * 2. 按颜色顺序取出各约束两端的粒子（此时物体已经完成本步的积分和碰撞）
+ * 3. 找出可以直接求解的链条
+ * 4. 迭代 iterations 轮，每轮先直接求解各条链，再依次求解各个颜色，一个颜色内分块并行
+ * 5. 动态物体的位置写回 BodyStore，速度加上 位置修正量 / Δt
+ *=========================================================================================================*/
+void ConstraintSolver::solve(const HandleTable& handles, BodyStore& store, double deltaTime, ThreadPool* pool) {
+	stats = ConstraintStats();
+	stats.iterations = iterations;
+	if (colorsDirty) {
+		buildColors(handles, store);
+	}
+	if (liveCount == 0 || deltaTime <= 0.0) return;
+
+	// ========== 取出粒子和批次数据 ==========
+	const size_t count = colorOrder.size();
+	slotParticle.assign(store.size(), -1);
+	particlePosition.clear();
+	particleInvMass.clear();
+	particleSlot.clear();
+	endA.resize(count);
+	endB.resize(count);
+	restLength.resize(count);
+	compliance.resize(count);
+	lambda.assign(count, 0.0);
+	unilateral.resize(count);
+
+	for (size_t k = 0; k < count; k++) {
+		const int id = colorOrder[k];
+		Constraint& c = constraints[id];
+		endA[k] = -1;
+		if (!c.alive) continue;
+
+		bool valid = true;
+		const int ia = particleFor(handles, store, c.a, 0.0, 0.0, valid);
+		const int ib = valid ? particleFor(handles, store, c.b, c.anchorX, c.anchorY, valid) : -1;
+		if (!valid) {
+			remove(id);   // 形状已被移出世界
+			continue;
+		}
+		endA[k] = ia;
+		endB[k] = ib;
+		restLength[k] = c.length;
+		compliance[k] = c.compliance;
+		unilateral[k] = (c.type == CONSTRAINT_ROPE) ? 1 : 0;
+		stats.constraintCount++;
+	}
+	particleStart = particlePosition;
+	for (size_t i = 0; i < particleSlot.size(); i++) {
+		if (particleSlot[i] >= 0) stats.bodyCount++;
+	}
+	stats.colorCount = colorStart.empty() ? 0 : colorStart.size() - 1;
+	buildChains();
+	const size_t chainCount = chainStart.size() - 1;
+	stats.chainCount = chainCount;
+	stats.chainConstraints = chainOrder.size();
+	// 链条做牛顿迭代：λ 从上一步的约束力开始（拉力决定几何刚度，从 0 开始时第一轮会大幅越过约束）
+	const double alphaScale = 1.0 / (deltaTime * deltaTime);
+	for (size_t i = 0; i < chainOrder.size(); i++) {
+		const int k = chainOrder[i];
+		lambda[k] = constraints[colorOrder[k]].force / alphaScale;
+		const int ia = endA[k], ib = endB[k];
+		const double dx = particlePosition[2 * ib] - particlePosition[2 * ia];
+		const double dy = particlePosition[2 * ib + 1] - particlePosition[2 * ia + 1];
+		const double len = std::sqrt(dx * dx + dy * dy);
+		if (len < kMinSeparation) continue;
+		const double fx = lambda[k] * dx / len, fy = lambda[k] * dy / len;
+		particlePosition[2 * ia] -= particleInvMass[ia] * fx;
+		particlePosition[2 * ia + 1] -= particleInvMass[ia] * fy;
+		particlePosition[2 * ib] += particleInvMass[ib] * fx;
+		particlePosition[2 * ib + 1] += particleInvMass[ib] * fy;
+	}
+	chainDiag.resize(6 * chainParticle.size());
+	chainUpper.resize(5 * chainParticle.size());
+	chainRhs.resize(3 * chainParticle.size());
+	chainConverged.assign(chainCount, 0);
+
+	// ========== 迭代求解 ==========
+	const bool parallel = (pool != nullptr && pool->getThreadCount() > 1);
+	for (int it = 0; it < iterations; it++) {
+		// 各条链互不相交，可以同时求解
+		// 牛顿迭代二次收敛：残差小于 kChainTolerance 之后这条链不再迭代
+		if (parallel && chainCount > 1) {
+			pool->parallelFor(chainCount, [&](size_t chain, int) {
+				if (!chainConverged[chain]) chainConverged[chain] = solveChain(chain, alphaScale) < kChainTolerance;
+			});
+		} else {
+			for (size_t chain = 0; chain < chainCount; chain++) {
+				if (!chainConverged[chain]) chainConverged[chain] = solveChain(chain, alphaScale) < kChainTolerance;
+			}
+		}
+		for (size_t color = 0; color < stats.colorCount; color++) {
+			const size_t begin = colorStart[color];
+			const size_t end = colorStart[color + 1];
+			// 最后一批（颜色用完后剩下的约束）之间可能有公共物体，只能依次求解
+			if (parallel && color < static_cast<size_t>(kMaxColors) && end - begin >= 2 * kConstraintChunk) {
+				const size_t chunks = (end - begin + kConstraintChunk - 1) / kConstraintChunk;
+				pool->parallelFor(chunks, [&](size_t chunk, int) {
+					const size_t chunkBegin = begin + chunk * kConstraintChunk;
+					solveRange(chunkBegin, std::min(end, chunkBegin + kConstraintChunk), alphaScale);
+				});
+			} else {
+				solveRange(begin, end, alphaScale);
+			}
+		}
+	}
+
+	// ========== 写回位置和速度，统计剩余误差 ==========
+	double* position = store.positionData();
+	double* velocity = store.velocityData();
+	const double inverseDt = 1.0 / deltaTime;
+	for (size_t i = 0; i < particleSlot.size(); i++) {
+		const int slot = particleSlot[i];
+		if (slot < 0) continue;
+		const double dx = particlePosition[2 * i] - particleStart[2 * i];
+		const double dy = particlePosition[2 * i + 1] - particleStart[2 * i + 1];
+		position[2 * slot] = particlePosition[2 * i];
+		position[2 * slot + 1] = particlePosition[2 * i + 1];
+		velocity[2 * slot] += dx * inverseDt;
+		velocity[2 * slot + 1] += dy * inverseDt;
+	}
+
+	for (size_t k = 0; k < count; k++) {
+		const int ia = endA[k];
+		if (ia < 0) continue;
+		const int ib = endB[k];
+		double error = std::hypot(particlePosition[2 * ib] - particlePosition[2 * ia],
+		                          particlePosition[2 * ib + 1] - particlePosition[2 * ia + 1]) - restLength[k];
+		if (unilateral[k]) error = std::max(error, 0.0);
+		stats.maxError = std::max(stats.maxError, std::fabs(error));
+		constraints[colorOrder[k]].force = inChain[k] ? lambda[k] * alphaScale : 0.0;
+	}
+}
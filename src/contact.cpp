@@ -0,0 +1,326 @@
+#include "contact.h"
+#include <algorithm>
+#include <cmath>
+
+/*=========================================================================================================
+ * ContactCache 方法实现
+ *=========================================================================================================*/
+void ContactStats::accumulate(const ContactStats& other) {
+	contactCount += other.contactCount;
+	newContacts += other.newContacts;
+	persistentContacts += other.persistentContacts;
+	removedContacts += other.removedContacts;
+	setupSkipped += other.setupSkipped;
+	velocityIterations = std::max(velocityIterations, other.velocityIterations);
+	positionIterations = std::max(positionIterations, other.positionIterations);
+}
+
+void ContactCache::beginStep() {
+	for (auto& entry : contacts) {
+		entry.second.touched = false;
+	}
+	stats = ContactStats();
+}
+
+ContactManifold& ContactCache::findOrCreate(Shape* a, Shape* b) {
+	ContactManifold* existing = touch(a, b, stats);
+	if (existing != nullptr) {
+		return *existing;
+	}
+
+	ContactManifold& contact = contacts[makeKey(a, b)];
+	initContact(contact, a, b, stats);
+	return contact;
+}
+
+ContactManifold* ContactCache::touch(Shape* a, Shape* b, ContactStats& stepStats) {
+	auto it = contacts.find(makeKey(a, b));
+	if (it == contacts.end()) {
+		return nullptr;
+	}
+
+	ContactManifold& contact = it->second;
+	// 同一帧内重复出现时不重复计数
+	if (!contact.touched) {
+		contact.touched = true;
+		contact.age++;
+		stepStats.persistentContacts++;
+		stepStats.contactCount++;
+	}
+	// 接触方向以本次调用的顺序为准；顺序反过来时累积冲量的方向也随之翻转，数值不变
+	if (contact.shapeA != a) {
+		contact.shapeA = a;
+		contact.shapeB = b;
+		std::swap(contact.massA, contact.massB);
+		std::swap(contact.invMassA, contact.invMassB);
+		contact.normal[0] = -contact.normal[0];
+		contact.normal[1] = -contact.normal[1];
+	}
+	return &contact;
+}
+
+void ContactCache::initContact(ContactManifold& contact, Shape* a, Shape* b, ContactStats& stepStats) {
+	contact.shapeA = a;
+	contact.shapeB = b;
+	contact.touched = true;
+	contact.age = 0;
+	stepStats.newContacts++;
+	stepStats.contactCount++;
+}
+
+void ContactCache::insert(const ContactManifold& contact) {
+	contacts[makeKey(contact.shapeA, contact.shapeB)] = contact;
+}
+
+void ContactCache::endStep() {
+	for (auto it = contacts.begin(); it != contacts.end(); ) {
+		if (!it->second.touched) {
+			it = contacts.erase(it);
+			stats.removedContacts++;
+		} else {
+			++it;
+		}
+	}
+}
+
+void ContactCache::removeShape(const Shape* shape) {
+	for (auto it = contacts.begin(); it != contacts.end(); ) {
+		if (it->first.first == shape || it->first.second == shape) {
+			it = contacts.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void ContactCache::clear() {
+	contacts.clear();
+	stats = ContactStats();
+}
+
+const ContactManifold* ContactCache::find(const Shape* a, const Shape* b) const {
+	auto it = contacts.find(makeKey(a, b));
+	return it != contacts.end() ? &it->second : nullptr;
+}
+
+/*=========================================================================================================
+ * 冲量求解
+ *=========================================================================================================*/
+static double inverseMass(double mass) {
+	return std::isinf(mass) ? 0.0 : 1.0 / mass;
+}
+
+bool prepareContact(ContactManifold& contact, double restitutionThreshold, bool& reusedSetup) {
+	Shape& a = *contact.shapeA;
+	Shape& b = *contact.shapeB;
+	reusedSetup = false;
+
+	double x1, y1, x2, y2;
+	a.getCentre(x1, y1);
+	b.getCentre(x2, y2);
+
+	double nx = x2 - x1;
+	double ny = y2 - y1;
+	double distance = std::sqrt(nx * nx + ny * ny);
+	if (distance < 0.0001) return false;  // 中心重合，法向不确定
+	nx /= distance;
+	ny /= distance;
+
+	// 法向和穿透深度由分离内核给出（矩形之间会改写为坐标轴方向）
+	contact.penetration = a.computeOverlap(b, nx, ny, distance);
+	contact.normal[0] = nx;
+	contact.normal[1] = ny;
+
+	// 有效质量和弹性系数：持久接触且质量没变时直接复用
+	double mA = a.getMass();
+	double mB = b.getMass();
+	if (contact.age > 0 && mA == contact.massA && mB == contact.massB) {
+		reusedSetup = true;
+	} else {
+		contact.massA = mA;
+		contact.massB = mB;
+		contact.invMassA = inverseMass(mA);
+		contact.invMassB = inverseMass(mB);
+		double r1, r2, f1, f2, sf1, sf2;
+		a.getRestitution(r1);
+		b.getRestitution(r2);
+		a.getFraction(f1);
+		b.getFraction(f2);
+		a.getStaticFraction(sf1);
+		b.getStaticFraction(sf2);
+		contact.restitution = (r1 + r2) / 2.0;
+		contact.friction = (f1 + f2) / 2.0;
+		contact.staticFriction = (sf1 + sf2) / 2.0;
+		double invMassSum = contact.invMassA + contact.invMassB;
+		contact.normalMass = invMassSum > 0.0 ? 1.0 / invMassSum : 0.0;
+	}
+	if (contact.normalMass == 0.0) return false;  // 两个物体质量都是无穷大
+
+	// 弹性反弹的目标速度：用热启动之前的相对速度计算，接近速度很小时不反弹（静止接触不抖动）
+	double v1x, v1y, v2x, v2y;
+	a.getVelocity(v1x, v1y);
+	b.getVelocity(v2x, v2y);
+	double vn = (v2x - v1x) * nx + (v2y - v1y) * ny;
+	contact.velocityBias = vn < -restitutionThreshold ? -contact.restitution * vn : 0.0;
+
+	// 相对静止（切向速度很小）时使用静摩擦系数
+	const double staticSpeedThreshold = 1e-3;
+	double vt = -(v2x - v1x) * ny + (v2y - v1y) * nx;
+	contact.frictionLimit = std::abs(vt) < staticSpeedThreshold ? std::max(contact.staticFriction, contact.friction) : contact.friction;
+	return true;
+}
+
+static void applyContactImpulse(ContactManifold& contact, double px, double py) {
+	double v1x, v1y, v2x, v2y;
+	contact.shapeA->getVelocity(v1x, v1y);
+	contact.shapeB->getVelocity(v2x, v2y);
+	contact.shapeA->setVelocity(v1x - px * contact.invMassA, v1y - py * contact.invMassA);
+	contact.shapeB->setVelocity(v2x + px * contact.invMassB, v2y + py * contact.invMassB);
+}
+
+void warmStartContact(ContactManifold& contact) {
+	if (contact.normalImpulse == 0.0 && contact.tangentImpulse == 0.0) return;
+	double nx = contact.normal[0], ny = contact.normal[1];
+	// 切向 t = (-ny, nx)
+	double px = contact.normalImpulse * nx - contact.tangentImpulse * ny;
+	double py = contact.normalImpulse * ny + contact.tangentImpulse * nx;
+	applyContactImpulse(contact, px, py);
+}
+
+double solveContactFriction(ContactManifold& contact) {
+	double nx = contact.normal[0], ny = contact.normal[1];
+	double v1x, v1y, v2x, v2y;
+	contact.shapeA->getVelocity(v1x, v1y);
+	contact.shapeB->getVelocity(v2x, v2y);
+	double vt = -(v2x - v1x) * ny + (v2y - v1y) * nx;
+
+	// 没有旋转自由度，切向有效质量与法向相同
+	double lambda = -contact.normalMass * vt;
+	double maxFriction = contact.frictionLimit * contact.normalImpulse;
+	double newImpulse = std::max(-maxFriction, std::min(contact.tangentImpulse + lambda, maxFriction));
+	lambda = newImpulse - contact.tangentImpulse;
+	contact.tangentImpulse = newImpulse;
+
+	applyContactImpulse(contact, -lambda * ny, lambda * nx);
+	return std::abs(lambda);
+}
+
+double solveContact(ContactManifold& contact) {
+	double v1x, v1y, v2x, v2y;
+	contact.shapeA->getVelocity(v1x, v1y);
+	contact.shapeB->getVelocity(v2x, v2y);
+	double vn = (v2x - v1x) * contact.normal[0] + (v2y - v1y) * contact.normal[1];
+
+	// 累积冲量限制为非负：本次增量最多把之前的冲量撤回到 0
+	double lambda = -contact.normalMass * (vn - contact.velocityBias);
+	double newImpulse = std::max(contact.normalImpulse + lambda, 0.0);
+	lambda = newImpulse - contact.normalImpulse;
+	contact.normalImpulse = newImpulse;
+
+	applyContactImpulse(contact, lambda * contact.normal[0], lambda * contact.normal[1]);
+	return std::abs(lambda);
+}
+
+double updateContactPenetration(ContactManifold& contact) {
+	double x1, y1, x2, y2;
+	contact.shapeA->getCentre(x1, y1);
+	contact.shapeB->getCentre(x2, y2);
+
+	double nx = x2 - x1;
+	double ny = y2 - y1;
+	double distance = std::sqrt(nx * nx + ny * ny);
+	if (distance < 0.0001) return contact.penetration;  // 中心重合时沿用原来的法向和深度
+	nx /= distance;
+	ny /= distance;
+
+	contact.penetration = contact.shapeA->computeOverlap(*contact.shapeB, nx, ny, distance);
+	contact.normal[0] = nx;
+	contact.normal[1] = ny;
+	return contact.penetration;
+}
+
+void correctContactPosition(ContactManifold& contact, double separationPercent) {
+	if (contact.penetration <= 0.0) return;
+
+	double invMassSum = contact.invMassA + contact.invMassB;
+	double correction = contact.penetration * separationPercent / invMassSum;
+	double cx = correction * contact.normal[0];
+	double cy = correction * contact.normal[1];
+
+	double x1, y1, x2, y2;
+	contact.shapeA->getCentre(x1, y1);
+	contact.shapeB->getCentre(x2, y2);
+	contact.shapeA->setCentre(x1 - cx * contact.invMassA, y1 - cy * contact.invMassA);
+	contact.shapeB->setCentre(x2 + cx * contact.invMassB, y2 + cy * contact.invMassB);
+}
+
+/*=========================================================================================================
+ * 连续碰撞检测（CCD）
+ *=========================================================================================================*/
+// 射线 p + t·d 与圆（圆心 c，半径 r）的第一个交点，起点在圆内时返回 false
+static bool rayCircle(double x, double y, double dx, double dy, double cx, double cy, double r, double& t) {
+	double mx = x - cx;
+	double my = y - cy;
+	double c = mx * mx + my * my - r * r;
+	if (c <= 0.0) return false;
+	double a = dx * dx + dy * dy;
+	double b = mx * dx + my * dy;
+	if (a < 1e-18 || b >= 0.0) return false;  // 没有运动或正在远离
+	double disc = b * b - a * c;
+	if (disc < 0.0) return false;
+	t = (-b - std::sqrt(disc)) / a;
+	return t >= 0.0 && t <= 1.0;
+}
+
+// 射线 p + t·d 与矩形的第一个交点（slab 方法），起点在矩形内时返回 false
+static bool rayBox(double x, double y, double dx, double dy,
+                   double left, double bottom, double right, double top, double& t) {
+	if (x > left && x < right && y > bottom && y < top) return false;
+	double tMin = 0.0, tMax = 1.0;
+	const double origin[2] = {x, y};
+	const double dir[2] = {dx, dy};
+	const double lo[2] = {left, bottom};
+	const double hi[2] = {right, top};
+	for (int axis = 0; axis < 2; axis++) {
+		if (std::abs(dir[axis]) < 1e-18) {
+			if (origin[axis] < lo[axis] || origin[axis] > hi[axis]) return false;
+		} else {
+			double t1 = (lo[axis] - origin[axis]) / dir[axis];
+			double t2 = (hi[axis] - origin[axis]) / dir[axis];
+			if (t1 > t2) std::swap(t1, t2);
+			tMin = std::max(tMin, t1);
+			tMax = std::min(tMax, t2);
+			if (tMin > tMax) return false;
+		}
+	}
+	t = tMin;
+	return true;
+}
+
+bool sweepCircleCircle(double x, double y, double dx, double dy, double radius,
+                       double otherX, double otherY, double otherRadius, double& toi) {
+	return rayCircle(x, y, dx, dy, otherX, otherY, radius + otherRadius, toi);
+}
+
+bool sweepCircleRect(double x, double y, double dx, double dy, double radius,
+                     double left, double bottom, double right, double top, double& toi) {
+	// 开始时已经重叠：交给离散碰撞处理
+	double closestX = std::max(left, std::min(x, right));
+	double closestY = std::max(bottom, std::min(y, top));
+	double ox = x - closestX;
+	double oy = y - closestY;
+	if (ox * ox + oy * oy <= radius * radius) return false;
+
+	// 圆角矩形 = 横向扩大的矩形 ∪ 纵向扩大的矩形 ∪ 四个角上的圆，取最早的交点
+	bool hit = false;
+	double best = 1.0, t;
+	if (rayBox(x, y, dx, dy, left - radius, bottom, right + radius, top, t) && t <= best) { best = t; hit = true; }
+	if (rayBox(x, y, dx, dy, left, bottom - radius, right, top + radius, t) && t <= best) { best = t; hit = true; }
+	const double cornerX[4] = {left, right, left, right};
+	const double cornerY[4] = {bottom, bottom, top, top};
+	for (int k = 0; k < 4; k++) {
+		if (rayCircle(x, y, dx, dy, cornerX[k], cornerY[k], radius, t) && t <= best) { best = t; hit = true; }
+	}
+	if (hit) toi = best;
+	return hit;
+}
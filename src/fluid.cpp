@@ -0,0 +1,376 @@
+#include "fluid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/*=========================================================================================================
+ * 二维的核函数（r < h 时不为 0）
+ *   poly6：W(r) = 4 / (π h^8) · (h² - r²)³
+ *   spiky：∇W(r) = -30 / (π h^5) · (h - r)² · r / |r|（这里返回标量部分 -30 / (π h^5) · (h - r)² / |r|）
+ *=========================================================================================================*/
+namespace {
+	const float kPi = 3.14159265358979323846f;
+
+	inline float poly6(float r2, float h) {
+		const float h2 = h * h;
+		if (r2 >= h2) return 0.0f;
+		const float d = h2 - r2;
+		return 4.0f / (kPi * h2 * h2 * h2 * h2) * d * d * d;
+	}
+
+	inline float spikyGradient(float r, float h) {
+		if (r >= h || r <= 0.0f) return 0.0f;
+		const float d = h - r;
+		return -30.0f / (kPi * h * h * h * h * h) * d * d / r;
+	}
+}
+
+template <typename Body>
+void ParticleFluid::forChunks(size_t n, ThreadPool* pool, const Body& body) {
+	const size_t chunks = (n + kChunkSize - 1) / kChunkSize;
+	auto run = [&](size_t chunk, int) {
+		const size_t begin = chunk * kChunkSize;
+		body(begin, std::min(n, begin + kChunkSize), chunk);
+	};
+	if (pool != nullptr && pool->getThreadCount() > 1 && chunks > 1) {
+		pool->parallelFor(chunks, run);
+	} else {
+		for (size_t c = 0; c < chunks; c++) {
+			run(c, 0);
+		}
+	}
+}
+
+/*=========================================================================================================
+ * 网格排序
+ *=========================================================================================================*/
+const std::vector<uint32_t>& ParticleFluid::sortByCell(const float* x, const float* y, size_t n, float size) {
+	float minX = std::numeric_limits<float>::infinity(), minY = minX;
+	float maxX = -minX, maxY = -minX;
+	for (size_t i = 0; i < n; i++) {
+		minX = std::min(minX, x[i]);
+		maxX = std::max(maxX, x[i]);
+		minY = std::min(minY, y[i]);
+		maxY = std::max(maxY, y[i]);
+	}
+	// 四周各留一格：同一行左右相邻的单元编号不会跨到另一行
+	cellSize = size;
+	gridOriginX = minX - size;
+	gridOriginY = minY - size;
+	gridWidth = static_cast<uint64_t>((maxX - gridOriginX) / size) + 2;
+
+	sortKeys.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		const uint64_t cx = static_cast<uint64_t>((x[i] - gridOriginX) / size);
+		const uint64_t cy = static_cast<uint64_t>((y[i] - gridOriginY) / size);
+		sortKeys[i] = std::make_pair(cy * gridWidth + cx, static_cast<uint32_t>(i));
+	}
+	std::sort(sortKeys.begin(), sortKeys.end());
+
+	order.resize(n);
+	for (size_t k = 0; k < n; k++) {
+		order[k] = sortKeys[k].second;
+	}
+	return order;
+}
+
+/*=========================================================================================================
+ * 邻居列表
+ * 1. 非空单元：排序后编号相同的一段粒子
+ * 2. 每个单元的邻居范围：下、中、上三行中编号为 key - 1 ~ key + 1 的单元在数组中连续，各是一段下标范围
+ * 3. 每块并行地找出邻居，写入块各自的列表；求前缀和之后拷贝到一个连续的数组中
+ *=========================================================================================================*/
+void ParticleFluid::buildNeighbours(const float* x, const float* y, size_t n, ThreadPool* pool) {
+	cellKeys.clear();
+	cellBegin.clear();
+	particleCell.resize(n);
+	for (size_t k = 0; k < n; k++) {
+		if (k == 0 || sortKeys[k].first != sortKeys[k - 1].first) {
+			cellKeys.push_back(sortKeys[k].first);
+			cellBegin.push_back(static_cast<uint32_t>(k));
+		}
+		particleCell[k] = static_cast<uint32_t>(cellKeys.size() - 1);
+	}
+	const size_t cells = cellKeys.size();
+	cellBegin.push_back(static_cast<uint32_t>(n));
+
+	cellRows.resize(6 * cells);
+	forChunks(cells, pool, [&](size_t begin, size_t end, size_t) {
+		for (size_t c = begin; c < end; c++) {
+			for (int row = 0; row < 3; row++) {
+				const uint64_t centre = cellKeys[c] + gridWidth * row - gridWidth;
+				const size_t first = std::lower_bound(cellKeys.begin(), cellKeys.end(), centre - 1) - cellKeys.begin();
+				const size_t last = std::upper_bound(cellKeys.begin(), cellKeys.end(), centre + 1) - cellKeys.begin();
+				cellRows[6 * c + 2 * row] = cellBegin[first];
+				cellRows[6 * c + 2 * row + 1] = cellBegin[last];
+			}
+		}
+	});
+
+	// 每块把邻居写入自己的临时列表并记下每个粒子的个数，求前缀和之后按块整段拷贝（距离只比较一遍）
+	const float reach2 = cellSize * cellSize;
+	const size_t chunks = (n + kChunkSize - 1) / kChunkSize;
+	if (chunkNeighbours.size() < chunks) chunkNeighbours.resize(chunks);
+	neighbourStart.resize(n + 1);
+	neighbourStart[0] = 0;
+	forChunks(n, pool, [&](size_t begin, size_t end, size_t chunk) {
+		std::vector<uint32_t>& list = chunkNeighbours[chunk];
+		list.clear();
+		for (size_t i = begin; i < end; i++) {
+			const uint32_t* rows = &cellRows[6 * particleCell[i]];
+			const size_t before = list.size();
+			for (int row = 0; row < 3; row++) {
+				for (uint32_t j = rows[2 * row]; j < rows[2 * row + 1]; j++) {
+					const float dx = x[i] - x[j], dy = y[i] - y[j];
+					if (j != i && dx * dx + dy * dy < reach2) list.push_back(j);
+				}
+			}
+			neighbourStart[i + 1] = static_cast<uint32_t>(list.size() - before);
+		}
+	});
+	for (size_t i = 0; i < n; i++) {
+		neighbourStart[i + 1] += neighbourStart[i];
+	}
+
+	neighbours.resize(neighbourStart[n]);
+	forChunks(n, pool, [&](size_t begin, size_t, size_t chunk) {
+		const std::vector<uint32_t>& list = chunkNeighbours[chunk];
+		std::copy(list.begin(), list.end(), neighbours.begin() + neighbourStart[begin]);
+	});
+
+	colourOrder.clear();
+	stats.particleCount = n;
+	stats.cellCount = cells;
+	stats.neighbourCount = neighbours.size();
+}
+
+/*=========================================================================================================
+ * 流体：密度约束
+ * C_i = ρ_i / ρ0 - 1 ≥ 0（ρ_i = Σ_j W(x_i - x_j)），每轮先求 λ_i = -C_i / (Σ_k |∇_k C_i|² + ε)，再求
+ * Δx_i = (1/ρ0) Σ_j (λ_i + λ_j + s_corr) ∇W(x_i - x_j)（s_corr 为人工压强，防止表面的粒子聚成团）。
+ * 各轮是 Jacobi 形式：每个粒子只根据上一轮的位置计算自己的修正量；求 λ 时记下每对邻居的核函数值，求 Δx 时不再重算。
+ *=========================================================================================================*/
+void ParticleFluid::updateKernel(float particleRadius) {
+	const float h = 4.0f * particleRadius;
+	if (h == kernelRadius) return;
+	kernelRadius = h;
+
+	// 间距 2r 的方形排列：中心粒子的密度与 Σ|∇_j C|²（中心粒子自己的梯度因为对称为 0）
+	const float spacing = 2.0f * particleRadius;
+	float rho = 0.0f, gradient = 0.0f;
+	for (int i = -3; i <= 3; i++) {
+		for (int j = -3; j <= 3; j++) {
+			const float dx = i * spacing, dy = j * spacing;
+			const float r = std::sqrt(dx * dx + dy * dy);
+			rho += poly6(r * r, h);
+			const float g = spikyGradient(r, h) * r;
+			gradient += g * g;
+		}
+	}
+	restDensity = rho;
+	restGradient = gradient / (rho * rho);
+}
+
+void ParticleFluid::solveDensity(const float* x, const float* y, float* dx, float* dy, size_t n, float particleRadius,
+                                 const FluidSettings& settings, ThreadPool* pool) {
+	updateKernel(particleRadius);
+	const float h = kernelRadius, h2 = h * h;
+	const float poly6Scale = poly6(0.0f, h) / (h2 * h2 * h2);
+	const float spikyScale = -30.0f / (kPi * h2 * h2 * h);
+	const float invRho = 1.0f / restDensity;
+	const float epsilon = static_cast<float>(settings.relaxation) * restGradient;
+	// 人工压强：s_corr = -k (W(r) / W(0.2h))^4，按静止时的 Σ|∇C|² 换算成 λ 的量纲
+	const float invCorrectionBase = 1.0f / poly6(0.04f * h2, h);
+	const float correctionScale = -static_cast<float>(settings.artificialPressure) / restGradient;
+	const float maxStep2 = particleRadius * particleRadius;
+	const size_t chunks = (n + kChunkSize - 1) / kChunkSize;
+	lambda.resize(n);
+	pairGradient.resize(neighbours.size());
+	pairCorrection.resize(neighbours.size());
+	chunkError.assign(chunks, 0.0);
+
+	// ========== λ_i ==========
+	// 每对邻居的 ∇W 标量部分与 s_corr 只取决于这一轮的位置，记下来给下面求 Δx 时使用
+	forChunks(n, pool, [&](size_t begin, size_t end, size_t chunk) {
+		double error = 0.0;
+		for (size_t i = begin; i < end; i++) {
+			float rho = poly6Scale * h2 * h2 * h2;
+			float gx = 0.0f, gy = 0.0f, sum2 = 0.0f;
+			for (uint32_t k = neighbourStart[i]; k < neighbourStart[i + 1]; k++) {
+				const uint32_t j = neighbours[k];
+				const float rx = x[i] - x[j], ry = y[i] - y[j];
+				const float r2 = rx * rx + ry * ry;
+				float w = 0.0f, s = 0.0f;
+				if (r2 < h2) {
+					const float d = h2 - r2;
+					w = poly6Scale * d * d * d;
+					const float r = std::sqrt(r2);
+					if (r > 0.0f) s = spikyScale * (h - r) * (h - r) / r;
+				}
+				rho += w;
+				const float ratio = w * invCorrectionBase;
+				pairGradient[k] = s;
+				pairCorrection[k] = correctionScale * ratio * ratio * ratio * ratio;
+				s *= invRho;
+				gx += s * rx;
+				gy += s * ry;
+				sum2 += s * s * r2;
+			}
+			const float c = std::max(rho * invRho - 1.0f, 0.0f);
+			lambda[i] = -c / (sum2 + gx * gx + gy * gy + epsilon);
+			error += c;
+		}
+		chunkError[chunk] = error;
+	});
+	double error = 0.0;
+	for (size_t c = 0; c < chunks; c++) {
+		error += chunkError[c];
+	}
+	stats.densityError = n > 0 ? error / n : 0.0;
+
+	// ========== Δx_i ==========
+	forChunks(n, pool, [&](size_t begin, size_t end, size_t) {
+		for (size_t i = begin; i < end; i++) {
+			float sx = 0.0f, sy = 0.0f;
+			for (uint32_t k = neighbourStart[i]; k < neighbourStart[i + 1]; k++) {
+				const uint32_t j = neighbours[k];
+				const float s = (lambda[i] + lambda[j] + pairCorrection[k]) * pairGradient[k];
+				sx += s * (x[i] - x[j]);
+				sy += s * (y[i] - y[j]);
+			}
+			// 一轮的修正量不超过粒子半径：邻居很多时 Jacobi 的修正量叠加起来可能过大
+			sx *= invRho;
+			sy *= invRho;
+			const float length2 = sx * sx + sy * sy;
+			if (length2 > maxStep2) {
+				const float scale = particleRadius / std::sqrt(length2);
+				sx *= scale;
+				sy *= scale;
+			}
+			dx[i] = sx;
+			dy[i] = sy;
+		}
+	});
+}
+
+void ParticleFluid::applyViscosity(const float* x, const float* y, float* vx, float* vy, size_t n, float viscosity,
+                                   ThreadPool* pool) {
+	if (viscosity <= 0.0f) return;
+	const float h = kernelRadius;
+	scratchX.resize(n);
+	scratchY.resize(n);
+	forChunks(n, pool, [&](size_t begin, size_t end, size_t) {
+		for (size_t i = begin; i < end; i++) {
+			float weight = poly6(0.0f, h), sx = 0.0f, sy = 0.0f;
+			for (uint32_t k = neighbourStart[i]; k < neighbourStart[i + 1]; k++) {
+				const uint32_t j = neighbours[k];
+				const float rx = x[i] - x[j], ry = y[i] - y[j];
+				const float w = poly6(rx * rx + ry * ry, h);
+				sx += (vx[j] - vx[i]) * w;
+				sy += (vy[j] - vy[i]) * w;
+				weight += w;
+			}
+			scratchX[i] = vx[i] + viscosity * sx / weight;
+			scratchY[i] = vy[i] + viscosity * sy / weight;
+		}
+	});
+	std::copy(scratchX.begin(), scratchX.end(), vx);
+	std::copy(scratchY.begin(), scratchY.end(), vy);
+}
+
+/*=========================================================================================================
+ * 颗粒：不穿透约束与摩擦（按单元着色的 Gauss-Seidel）
+ * 重叠量 d = r_i + r_j - |x_i - x_j| > 0 时，两个粒子各沿连线推开 d/2；
+ * 本步的相对切向位移 Δt 小于 μs·d 时完全消除（静摩擦），否则按 μk·d 减小（动摩擦），两个粒子各承担一半。
+ *
+ * 每对接触求解后立即更新两个粒子的位置（Gauss-Seidel），比各自平均修正量（Jacobi）收敛快得多，
+ * 几十层高的沙堆在几轮之内就不会被压缩。单元按 (cx mod 3, cy mod 3) 分成 9 种颜色：同一颜色的两个单元相隔至少 3 格，
+ * 各自的粒子和它们的邻居（都在相邻的单元中）互不重叠，同一颜色的单元可以并行计算，结果与线程数无关。
+ *=========================================================================================================*/
+void ParticleFluid::solveContacts(float* x, float* y, const float* x0, const float* y0, const float* radius,
+                                  const FluidSettings& settings, ThreadPool* pool) {
+	const float muS = static_cast<float>(settings.staticFriction);
+	const float muK = static_cast<float>(settings.kineticFriction);
+	const size_t cells = cellKeys.size();
+
+	// 各颜色的单元（邻居列表不变时只需要分一次）
+	if (colourOrder.size() != cells) {
+		colourOrder.resize(cells);
+		colourStart.assign(10, 0);
+		for (size_t c = 0; c < cells; c++) {
+			colourStart[cellColour(c) + 1]++;
+		}
+		for (int k = 0; k < 9; k++) {
+			colourStart[k + 1] += colourStart[k];
+		}
+		std::vector<uint32_t> fill(colourStart.begin(), colourStart.end() - 1);
+		for (size_t c = 0; c < cells; c++) {
+			colourOrder[fill[cellColour(c)]++] = static_cast<uint32_t>(c);
+		}
+	}
+
+	const size_t chunkCells = 64;
+	chunkError.assign((cells + chunkCells - 1) / chunkCells, 0.0);
+	for (int colour = 0; colour < 9; colour++) {
+		const size_t first = colourStart[colour], count = colourStart[colour + 1] - first;
+		const size_t tasks = (count + chunkCells - 1) / chunkCells;
+		auto run = [&](size_t task, int) {
+			double worst = chunkError[task];
+			const size_t end = std::min(count, (task + 1) * chunkCells);
+			for (size_t t = task * chunkCells; t < end; t++) {
+				const uint32_t cell = colourOrder[first + t];
+				for (uint32_t i = cellBegin[cell]; i < cellBegin[cell + 1]; i++) {
+					for (uint32_t k = neighbourStart[i]; k < neighbourStart[i + 1]; k++) {
+						const uint32_t j = neighbours[k];
+						if (j <= i) continue;   // 每对只算一次（由下标小的粒子所在的单元计算）
+						const float rx = x[i] - x[j], ry = y[i] - y[j];
+						const float r2 = rx * rx + ry * ry;
+						const float reach = radius[i] + radius[j];
+						if (r2 >= reach * reach) continue;
+						const float r = std::sqrt(r2);
+						float nx, ny;
+						if (r > 0.0f) {
+							nx = rx / r;
+							ny = ry / r;
+						} else {
+							// 完全重合：按下标决定方向，两个粒子向相反方向推开
+							nx = 0.0f;
+							ny = i < j ? 1.0f : -1.0f;
+						}
+						const float overlap = reach - r;
+						worst = std::max(worst, static_cast<double>(overlap));
+						float sx = 0.5f * overlap * nx, sy = 0.5f * overlap * ny;
+
+						const float ux = (x[i] - x0[i]) - (x[j] - x0[j]);
+						const float uy = (y[i] - y0[i]) - (y[j] - y0[j]);
+						const float un = ux * nx + uy * ny;
+						const float tx = ux - un * nx, ty = uy - un * ny;
+						const float tangent = std::sqrt(tx * tx + ty * ty);
+						if (tangent > 0.0f) {
+							const float keep = tangent < muS * overlap ? 1.0f : std::min(muK * overlap / tangent, 1.0f);
+							sx -= 0.5f * keep * tx;
+							sy -= 0.5f * keep * ty;
+						}
+						x[i] += sx;
+						y[i] += sy;
+						x[j] -= sx;
+						y[j] -= sy;
+					}
+				}
+			}
+			chunkError[task] = worst;
+		};
+		if (pool != nullptr && pool->getThreadCount() > 1 && tasks > 1) {
+			pool->parallelFor(tasks, run);
+		} else {
+			for (size_t t = 0; t < tasks; t++) {
+				run(t, 0);
+			}
+		}
+	}
+	double worst = 0.0;
+	for (size_t c = 0; c < chunkError.size(); c++) {
+		worst = std::max(worst, chunkError[c]);
+	}
+	stats.maxOverlap = worst;
+}
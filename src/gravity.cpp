@@ -0,0 +1,427 @@
+#include "gravity.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 把 21 位整数的各位分散到偶数位上（Morton 码的一个坐标）
+uint64_t spreadBits(uint64_t v) {
+	v &= 0x1fffff;
+	v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+	v = (v | (v << 8))  & 0x00ff00ff00ff00ffULL;
+	v = (v | (v << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+	v = (v | (v << 2))  & 0x3333333333333333ULL;
+	v = (v | (v << 1))  & 0x5555555555555555ULL;
+	return v;
+}
+
+// 受力点分块并行时每块的数量
+const size_t kTargetChunk = 256;
+
+}
+
+uint64_t GravitySolver::mortonCode(double x, double y) const {
+	const double maxCell = static_cast<double>((1 << kMortonBits) - 1);
+	double qx = (x - rootMinX) * quantizeScale;
+	double qy = (y - rootMinY) * quantizeScale;
+	qx = qx < 0.0 ? 0.0 : (qx > maxCell ? maxCell : qx);
+	qy = qy < 0.0 ? 0.0 : (qy > maxCell ? maxCell : qy);
+	return spreadBits(static_cast<uint64_t>(qx)) | (spreadBits(static_cast<uint64_t>(qy)) << 1);
+}
+
+/*=========================================================================================================
+ * build() - 设置引力源
+ * Barnes-Hut：引力源的包围正方形量化为 2^21 × 2^21 的网格，按 Morton 码排序后，
+ * 四叉树的每个节点正好是排序数组中连续的一段，子节点按 Morton 码的下两位二分查找划分。
+ *=========================================================================================================*/
+void GravitySolver::build(const double* position, const double* mass, size_t n) {
+	stats = GravityStats();
+	stats.sourceCount = n;
+	nodes.clear();
+	sourceX.resize(n);
+	sourceY.resize(n);
+	sourceMass.resize(n);
+
+	if (type == GRAVITY_SOLVER_DIRECT || n == 0) {
+		for (size_t i = 0; i < n; i++) {
+			sourceX[i] = position[2 * i];
+			sourceY[i] = position[2 * i + 1];
+			sourceMass[i] = mass[i] > 0.0 ? mass[i] : 0.0;
+		}
+		return;
+	}
+
+	// 包围所有引力源的正方形
+	double minX = position[0], maxX = position[0];
+	double minY = position[1], maxY = position[1];
+	for (size_t i = 1; i < n; i++) {
+		minX = std::min(minX, position[2 * i]);
+		maxX = std::max(maxX, position[2 * i]);
+		minY = std::min(minY, position[2 * i + 1]);
+		maxY = std::max(maxY, position[2 * i + 1]);
+	}
+	double size = std::max(maxX - minX, maxY - minY);
+	if (!(size > 0.0)) size = 1.0;
+	rootMinX = minX;
+	rootMinY = minY;
+	quantizeScale = static_cast<double>(1 << kMortonBits) / size;
+
+	// 按 Morton 码排序
+	sortKeys.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		sortKeys[i] = std::make_pair(mortonCode(position[2 * i], position[2 * i + 1]), static_cast<int>(i));
+	}
+	std::sort(sortKeys.begin(), sortKeys.end());
+	sourceCodes.resize(n);
+	for (size_t k = 0; k < n; k++) {
+		const int i = sortKeys[k].second;
+		sourceCodes[k] = sortKeys[k].first;
+		sourceX[k] = position[2 * i];
+		sourceY[k] = position[2 * i + 1];
+		sourceMass[k] = mass[i] > 0.0 ? mass[i] : 0.0;
+	}
+
+	nodes.reserve(2 * (n / kLeafCapacity + 1));
+	nodes.push_back(Node());
+	buildNode(0, 0, static_cast<int>(n), 0);
+	stats.nodeCount = nodes.size();
+}
+
+/*=========================================================================================================
+ * buildNode() - 填写节点 index（引力源为排序后的 [begin, end)，level 为深度）
+ * 子节点先全部分配在 nodes 的末尾，保证连续，再逐个递归填写；质量、质心和包围盒从子节点汇总。
+ *=========================================================================================================*/
+void GravitySolver::buildNode(int index, int begin, int end, int level) {
+	stats.treeDepth = std::max(stats.treeDepth, level);
+	Node node;
+	node.firstChild = -1;
+	node.childCount = 0;
+	node.bodyBegin = begin;
+	node.bodyEnd = end;
+
+	if (end - begin <= kLeafCapacity || level == kMortonBits) {
+		// 叶子：直接汇总其中的引力源
+		node.minX = node.maxX = sourceX[begin];
+		node.minY = node.maxY = sourceY[begin];
+		double m = 0.0, mx = 0.0, my = 0.0;
+		for (int j = begin; j < end; j++) {
+			node.minX = std::min(node.minX, sourceX[j]);
+			node.maxX = std::max(node.maxX, sourceX[j]);
+			node.minY = std::min(node.minY, sourceY[j]);
+			node.maxY = std::max(node.maxY, sourceY[j]);
+			m += sourceMass[j];
+			mx += sourceMass[j] * sourceX[j];
+			my += sourceMass[j] * sourceY[j];
+		}
+		node.mass = m;
+		node.comX = m > 0.0 ? mx / m : 0.5 * (node.minX + node.maxX);
+		node.comY = m > 0.0 ? my / m : 0.5 * (node.minY + node.maxY);
+		nodes[index] = node;
+		stats.leafCount++;
+		return;
+	}
+
+	// 按本层的两位 Morton 码（象限）划分：排序后同一象限的引力源连续
+	const int shift = 2 * (kMortonBits - 1 - level);
+	int split[5];
+	split[0] = begin;
+	split[4] = end;
+	for (int q = 1; q < 4; q++) {
+		split[q] = static_cast<int>(std::partition_point(sourceCodes.begin() + split[q - 1], sourceCodes.begin() + end,
+			[shift, q](uint64_t code) { return static_cast<int>((code >> shift) & 3) < q; }) - sourceCodes.begin());
+	}
+
+	node.firstChild = static_cast<int>(nodes.size());
+	for (int q = 0; q < 4; q++) {
+		if (split[q + 1] > split[q]) node.childCount++;
+	}
+	nodes.resize(nodes.size() + node.childCount);
+
+	int child = node.firstChild;
+	for (int q = 0; q < 4; q++) {
+		if (split[q + 1] > split[q]) {
+			buildNode(child++, split[q], split[q + 1], level + 1);
+		}
+	}
+
+	// 从子节点汇总（递归过程中 nodes 可能重新分配，所以按下标访问）
+	double m = 0.0, mx = 0.0, my = 0.0;
+	for (int c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+		const Node& sub = nodes[c];
+		if (c == node.firstChild) {
+			node.minX = sub.minX; node.maxX = sub.maxX;
+			node.minY = sub.minY; node.maxY = sub.maxY;
+		} else {
+			node.minX = std::min(node.minX, sub.minX);
+			node.maxX = std::max(node.maxX, sub.maxX);
+			node.minY = std::min(node.minY, sub.minY);
+			node.maxY = std::max(node.maxY, sub.maxY);
+		}
+		m += sub.mass;
+		mx += sub.mass * sub.comX;
+		my += sub.mass * sub.comY;
+	}
+	node.mass = m;
+	node.comX = m > 0.0 ? mx / m : 0.5 * (node.minX + node.maxX);
+	node.comY = m > 0.0 ? my / m : 0.5 * (node.minY + node.maxY);
+	nodes[index] = node;
+}
+
+/*=========================================================================================================
+ * evaluate() - 求各受力点的加速度
+ * Barnes-Hut 时受力点先按 Morton 码排序，再按排序后的顺序分块（交给线程池时每块 kTargetChunk 个）。
+ *=========================================================================================================*/
+void GravitySolver::evaluate(const double* position, size_t n, double* acceleration, ThreadPool* pool) {
+	stats.targetCount = n;
+	stats.interactions = 0;
+	if (n == 0) return;
+
+	const bool useTree = (type == GRAVITY_SOLVER_BARNES_HUT && !nodes.empty());
+	targetOrder.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		targetOrder[i].first = useTree ? mortonCode(position[2 * i], position[2 * i + 1]) : 0;
+		targetOrder[i].second = static_cast<int>(i);
+	}
+	if (useTree) {
+		std::sort(targetOrder.begin(), targetOrder.end());
+	}
+
+	const int workers = pool ? pool->getThreadCount() : 1;
+	workerStacks.resize(workers);
+	workerInteractions.assign(workers, 0);
+
+	auto evaluateChunk = [&](size_t chunk, int worker) {
+		const size_t begin = chunk * kTargetChunk;
+		const size_t end = std::min(n, begin + kTargetChunk);
+		size_t interactions = 0;
+		for (size_t k = begin; k < end; k++) {
+			const int i = targetOrder[k].second;
+			double ax = 0.0, ay = 0.0;
+			if (useTree) {
+				interactions += accelerationTree(position[2 * i], position[2 * i + 1], ax, ay, workerStacks[worker]);
+			} else {
+				interactions += accelerationDirect(position[2 * i], position[2 * i + 1], ax, ay);
+			}
+			acceleration[2 * i] = ax;
+			acceleration[2 * i + 1] = ay;
+		}
+		workerInteractions[worker] += interactions;
+	};
+
+	const size_t chunks = (n + kTargetChunk - 1) / kTargetChunk;
+	if (pool && workers > 1 && chunks > 1) {
+		pool->parallelFor(chunks, evaluateChunk);
+	} else {
+		for (size_t c = 0; c < chunks; c++) evaluateChunk(c, 0);
+	}
+	for (int w = 0; w < workers; w++) {
+		stats.interactions += workerInteractions[w];
+	}
+}
+
+size_t GravitySolver::accelerationDirect(double px, double py, double& ax, double& ay) const {
+	const double eps2 = softening * softening;
+	const size_t n = sourceX.size();
+	for (size_t j = 0; j < n; j++) {
+		const double dx = sourceX[j] - px;
+		const double dy = sourceY[j] - py;
+		if (dx == 0.0 && dy == 0.0) continue;   // 自身
+		const double r2 = dx * dx + dy * dy + eps2;
+		const double s = G * sourceMass[j] / (r2 * std::sqrt(r2));
+		ax += s * dx;
+		ay += s * dy;
+	}
+	return n;
+}
+
+/*=========================================================================================================
+ * accelerationTree() - 从根节点向下遍历
+ * 受力点在节点包围盒内时总是打开节点（否则可能把自身计入质心），叶子逐个累加其中的引力源。
+ *=========================================================================================================*/
+size_t GravitySolver::accelerationTree(double px, double py, double& ax, double& ay, std::vector<int>& stack) const {
+	const double eps2 = softening * softening;
+	const double theta2 = theta * theta;
+	size_t interactions = 0;
+
+	stack.clear();
+	stack.push_back(0);
+	while (!stack.empty()) {
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+		if (node.mass <= 0.0) continue;
+
+		if (node.firstChild < 0) {
+			for (int j = node.bodyBegin; j < node.bodyEnd; j++) {
+				const double dx = sourceX[j] - px;
+				const double dy = sourceY[j] - py;
+				if (dx == 0.0 && dy == 0.0) continue;
+				const double r2 = dx * dx + dy * dy + eps2;
+				const double s = G * sourceMass[j] / (r2 * std::sqrt(r2));
+				ax += s * dx;
+				ay += s * dy;
+			}
+			interactions += node.bodyEnd - node.bodyBegin;
+			continue;
+		}
+
+		const double dx = node.comX - px;
+		const double dy = node.comY - py;
+		const double d2 = dx * dx + dy * dy;
+		const double size = std::max(node.maxX - node.minX, node.maxY - node.minY);
+		const bool inside = px >= node.minX && px <= node.maxX && py >= node.minY && py <= node.maxY;
+		if (!inside && size * size < theta2 * d2) {
+			// 足够远：整个节点当作位于质心的一个质点
+			const double r2 = d2 + eps2;
+			const double s = G * node.mass / (r2 * std::sqrt(r2));
+			ax += s * dx;
+			ay += s * dy;
+			interactions++;
+		} else {
+			for (int c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+				stack.push_back(c);
+			}
+		}
+	}
+	return interactions;
+}
+
+/*=========================================================================================================
+ * BlockTimestepper::chooseRung() - 步长 Δt / 2^k 不超过 η·τ 的最小级别 k
+ *=========================================================================================================*/
+int BlockTimestepper::chooseRung(const double* a, const double* v, double size, double deltaTime) const {
+	const double am = std::sqrt(a[0] * a[0] + a[1] * a[1]);
+	if (!(am > 0.0)) return 0;
+	const double vm = std::sqrt(v[0] * v[0] + v[1] * v[1]);
+	const double dt = accuracy * (vm / am + std::sqrt(std::max(size, 0.0) / am));
+	int rung = 0;
+	double h = deltaTime;
+	while (rung < maxRung && h > dt) {
+		h *= 0.5;
+		rung++;
+	}
+	return rung;
+}
+
+void BlockTimestepper::computeAccelerations(GravitySolver& solver, const double* position, double* acceleration, ThreadPool* pool) {
+	for (size_t k = 0; k < movingSources.size(); k++) {
+		const int i = movingSources[k];
+		sourcePosition[2 * (fixedSourceCount + k)] = position[2 * i];
+		sourcePosition[2 * (fixedSourceCount + k) + 1] = position[2 * i + 1];
+	}
+	solver.build(sourcePosition.data(), sourceMass.data(), sourceMass.size());
+
+	const size_t m = active.size();
+	targetPosition.resize(2 * m);
+	targetAcceleration.resize(2 * m);
+	for (size_t k = 0; k < m; k++) {
+		targetPosition[2 * k] = position[2 * active[k]];
+		targetPosition[2 * k + 1] = position[2 * active[k] + 1];
+	}
+	solver.evaluate(targetPosition.data(), m, targetAcceleration.data(), pool);
+	for (size_t k = 0; k < m; k++) {
+		acceleration[2 * active[k]] = targetAcceleration[2 * k];
+		acceleration[2 * active[k] + 1] = targetAcceleration[2 * k + 1];
+	}
+	stats.forceEvaluations += m;
+	stats.forceUpdates++;
+}
+
+/*=========================================================================================================
+ * BlockTimestepper::advance() - 一帧的分层 kick-drift-kick
+ * 时刻用整数 tick 表示（一帧为 2^maxRung 个 tick），每个物体的步长 stepTicks 是 2 的幂并且步首与步长对齐，
+ * 所以每次推进到所有物体中最早的步末，所有物体在帧末（tick = 2^maxRung）同时结束。
+ *=========================================================================================================*/
+void BlockTimestepper::advance(GravitySolver& solver, size_t n, double* position, double* velocity, double* acceleration,
+                               const unsigned char* accelerationValid, const double* mass, const double* size,
+                               const unsigned char* isSource, const double* fixedPosition, const double* fixedMass, size_t fixedCount,
+                               double deltaTime, ThreadPool* pool) {
+	stats = BlockStepStats();
+	stats.bodyCount = n;
+	rungs.resize(n);
+	if (n == 0) return;
+
+	const uint64_t frameTicks = uint64_t(1) << maxRung;
+	const double tickTime = deltaTime / static_cast<double>(frameTicks);
+
+	// 引力源：本帧不动的在前，运动的物体在后（位置在每次求引力前更新）
+	fixedSourceCount = fixedCount;
+	sourcePosition.assign(fixedPosition, fixedPosition + 2 * fixedCount);
+	sourceMass.assign(fixedMass, fixedMass + fixedCount);
+	movingSources.clear();
+	for (size_t i = 0; i < n; i++) {
+		if (!isSource[i]) continue;
+		movingSources.push_back(static_cast<int>(i));
+		sourcePosition.push_back(position[2 * i]);
+		sourcePosition.push_back(position[2 * i + 1]);
+		sourceMass.push_back(mass[i]);
+	}
+
+	// 步首缺少加速度的物体先求一次
+	active.clear();
+	for (size_t i = 0; i < n; i++) {
+		if (!accelerationValid[i]) active.push_back(static_cast<int>(i));
+	}
+	if (!active.empty()) {
+		computeAccelerations(solver, position, acceleration, pool);
+	}
+
+	// 选择级别，第一次半步 kick
+	stepTicks.resize(n);
+	nextTick.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		rungs[i] = chooseRung(acceleration + 2 * i, velocity + 2 * i, size[i], deltaTime);
+		stepTicks[i] = frameTicks >> rungs[i];
+		nextTick[i] = stepTicks[i];
+		const double half = 0.5 * static_cast<double>(stepTicks[i]) * tickTime;
+		velocity[2 * i] += acceleration[2 * i] * half;
+		velocity[2 * i + 1] += acceleration[2 * i + 1] * half;
+		stats.deepestRung = std::max(stats.deepestRung, rungs[i]);
+	}
+
+	uint64_t tick = 0;
+	while (tick < frameTicks) {
+		uint64_t next = frameTicks;
+		for (size_t i = 0; i < n; i++) {
+			next = std::min(next, nextTick[i]);
+		}
+
+		// drift：所有物体一起漂移到 next
+		const double drift = static_cast<double>(next - tick) * tickTime;
+		for (size_t i = 0; i < n; i++) {
+			position[2 * i] += velocity[2 * i] * drift;
+			position[2 * i + 1] += velocity[2 * i + 1] * drift;
+		}
+		tick = next;
+
+		// 步长在此结束的物体求新的加速度
+		active.clear();
+		for (size_t i = 0; i < n; i++) {
+			if (nextTick[i] == tick) active.push_back(static_cast<int>(i));
+		}
+		computeAccelerations(solver, position, acceleration, pool);
+
+		for (size_t k = 0; k < active.size(); k++) {
+			const int i = active[k];
+			double* a = acceleration + 2 * i;
+			double* v = velocity + 2 * i;
+			double half = 0.5 * static_cast<double>(stepTicks[i]) * tickTime;
+			v[0] += a[0] * half;                  // 步末半步 kick
+			v[1] += a[1] * half;
+			if (tick == frameTicks) continue;
+
+			// 下一步的级别：加深立即生效，变浅每次一级且要与较长的步长对齐
+			int rung = chooseRung(a, v, size[i], deltaTime);
+			if (rung < rungs[i]) {
+				rung = (tick % (frameTicks >> (rungs[i] - 1)) == 0) ? rungs[i] - 1 : rungs[i];
+			}
+			rungs[i] = rung;
+			stepTicks[i] = frameTicks >> rung;
+			nextTick[i] = tick + stepTicks[i];
+			stats.deepestRung = std::max(stats.deepestRung, rung);
+
+			half = 0.5 * static_cast<double>(stepTicks[i]) * tickTime;
+			v[0] += a[0] * half;                  // 下一步的半步 kick
+			v[1] += a[1] * half;
+		}
+	}
+}
@@ -0,0 +1,151 @@
+#include "island.h"
+#include <algorithm>
+
+/*=========================================================================================================
+ * 并查集
+ *=========================================================================================================*/
+int findIslandRoot(std::vector<int>& parent, int i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];  // 路径减半
+		i = parent[i];
+	}
+	return i;
+}
+
+void mergeIslandRoots(std::vector<int>& parent, int a, int b) {
+	int rootA = findIslandRoot(parent, a);
+	int rootB = findIslandRoot(parent, b);
+	if (rootA == rootB) return;
+	if (rootA < rootB) parent[rootB] = rootA;
+	else parent[rootA] = rootB;
+}
+
+/*=========================================================================================================
+ * IslandBuilder::build() - 合并候选对，再用两次计数排序得到每个岛的物体和候选对
+ *=========================================================================================================*/
+void IslandBuilder::build(size_t count, const std::vector<CandidatePair>& pairs) {
+	parent.resize(count);
+	for (size_t i = 0; i < count; i++) parent[i] = static_cast<int>(i);
+	for (size_t k = 0; k < pairs.size(); k++) {
+		mergeIslandRoots(parent, pairs[k].first, pairs[k].second);
+	}
+
+	// 根是岛内最小的下标，按下标顺序第一次遇到根时分配岛的编号
+	islandOfBody.resize(count);
+	islandBodyStart.assign(1, 0);
+	for (size_t i = 0; i < count; i++) {
+		int root = findIslandRoot(parent, static_cast<int>(i));
+		if (root == static_cast<int>(i)) {
+			islandOfBody[i] = static_cast<int>(islandBodyStart.size()) - 1;
+			islandBodyStart.push_back(0);
+		} else {
+			islandOfBody[i] = islandOfBody[root];
+		}
+	}
+	const size_t islandCount = islandBodyStart.size() - 1;
+
+	// 物体：按岛计数排序，岛内保持下标升序
+	for (size_t i = 0; i < count; i++) islandBodyStart[islandOfBody[i] + 1]++;
+	largestIsland = 0;
+	for (size_t k = 0; k < islandCount; k++) {
+		largestIsland = std::max(largestIsland, static_cast<size_t>(islandBodyStart[k + 1]));
+		islandBodyStart[k + 1] += islandBodyStart[k];
+	}
+	islandBodies.resize(count);
+	localIndex.resize(count);
+	std::vector<int>& fill = parent;  // 并查集已经用完，复用为填充位置
+	fill.assign(islandBodyStart.begin(), islandBodyStart.end() - 1);
+	for (size_t i = 0; i < count; i++) {
+		int island = islandOfBody[i];
+		localIndex[i] = fill[island] - islandBodyStart[island];
+		islandBodies[fill[island]++] = static_cast<int>(i);
+	}
+
+	// 候选对：按第一个物体所在的岛计数排序，岛内保持原来的顺序；下标映射单调，(i, j) 的排序不变
+	islandPairStart.assign(islandCount + 1, 0);
+	for (size_t k = 0; k < pairs.size(); k++) islandPairStart[islandOfBody[pairs[k].first] + 1]++;
+	for (size_t k = 0; k < islandCount; k++) islandPairStart[k + 1] += islandPairStart[k];
+	islandPairs.resize(pairs.size());
+	fill.assign(islandPairStart.begin(), islandPairStart.end() - 1);
+	for (size_t k = 0; k < pairs.size(); k++) {
+		int island = islandOfBody[pairs[k].first];
+		islandPairs[fill[island]++] = CandidatePair(localIndex[pairs[k].first], localIndex[pairs[k].second]);
+	}
+}
+
+/*=========================================================================================================
+ * ThreadPool
+ *=========================================================================================================*/
+ThreadPool::~ThreadPool() {
+	stopWorkers();
+}
+
+void ThreadPool::setThreadCount(int count) {
+	if (count < 1) count = 1;
+	if (count == getThreadCount()) return;
+	stopWorkers();
+	stopping = false;
+	for (int worker = 1; worker < count; worker++) {
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this, worker, generation));
+	}
+}
+
+void ThreadPool::stopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeCondition.notify_all();
+	for (size_t k = 0; k < workers.size(); k++) {
+		workers[k].join();
+	}
+	workers.clear();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, int)>& task) {
+	if (count == 0) return;
+	if (workers.empty() || count == 1) {
+		for (size_t index = 0; index < count; index++) task(index, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		currentTask = &task;
+		taskCount = count;
+		nextTask.store(0);
+		busyWorkers = static_cast<int>(workers.size());
+		generation++;
+	}
+	wakeCondition.notify_all();
+
+	runTasks(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+	currentTask = nullptr;
+}
+
+void ThreadPool::runTasks(int worker) {
+	for (;;) {
+		size_t index = nextTask.fetch_add(1);
+		if (index >= taskCount) break;
+		(*currentTask)(index, worker);
+	}
+}
+
+void ThreadPool::workerLoop(int worker, size_t seenGeneration) {
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+			if (stopping) return;
+			seenGeneration = generation;
+		}
+
+		runTasks(worker);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--busyWorkers == 0) doneCondition.notify_one();
+	}
+}
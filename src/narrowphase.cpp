@@ -0,0 +1,415 @@
+#include "narrowphase.h"
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NARROWPHASE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define NARROWPHASE_X86 0
+#endif
+
+// GCC / Clang 需要为使用 AVX2 的函数单独打开指令集，其余代码仍按默认指令集编译；MSVC 不需要
+#if NARROWPHASE_X86 && (defined(__GNUC__) || defined(__clang__))
+#define NARROWPHASE_TARGET_SSE2 __attribute__((target("sse2")))
+#define NARROWPHASE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NARROWPHASE_TARGET_SSE2
+#define NARROWPHASE_TARGET_AVX2
+#endif
+
+/*=========================================================================================================
+ * 指令集检测
+ *=========================================================================================================*/
+static NarrowphaseISA detectISAOnce() {
+#if NARROWPHASE_X86
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	// 操作系统需要保存 YMM 寄存器（XCR0 的第 1、2 位）
+	if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5)) return NARROWPHASE_AVX2;
+	}
+	return NARROWPHASE_SSE2;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return NARROWPHASE_AVX2;
+	if (__builtin_cpu_supports("sse2")) return NARROWPHASE_SSE2;
+	return NARROWPHASE_SCALAR;
+#endif
+#else
+	return NARROWPHASE_SCALAR;
+#endif
+}
+
+NarrowphaseISA detectNarrowphaseISA() {
+	static const NarrowphaseISA detected = detectISAOnce();
+	return detected;
+}
+
+const char* getNarrowphaseISAName(NarrowphaseISA isa) {
+	switch (isa) {
+		case NARROWPHASE_SSE2: return "SSE2";
+		case NARROWPHASE_AVX2: return "AVX2";
+		default: return "Scalar";
+	}
+}
+
+void BatchNarrowphase::setISA(NarrowphaseISA requested) {
+	isa = std::min(requested, detectNarrowphaseISA());
+}
+
+// 数组长度至少为 capacity（只增不减），count 归零
+void BatchNarrowphase::CircleCircleBatch::reserve(size_t capacity) {
+	count = 0;
+	if (pair.size() >= capacity) return;
+	a.resize(capacity);
+	b.resize(capacity);
+	pair.resize(capacity);
+}
+
+void BatchNarrowphase::CircleRectBatch::reserve(size_t capacity) {
+	count = 0;
+	if (pair.size() >= capacity) return;
+	circle.resize(capacity);
+	rect.resize(capacity);
+	pair.resize(capacity);
+	circleFirst.resize(capacity);
+}
+
+typedef BatchNarrowphase::ShapeData ShapeData;
+typedef BatchNarrowphase::CircleCircleBatch CircleCircleBatch;
+typedef BatchNarrowphase::CircleRectBatch CircleRectBatch;
+
+/*=========================================================================================================
+ * 接触记录：只对接触的物体对计算（标量，各个指令集共用，保证结果相同）
+ *=========================================================================================================*/
+static void emitCircleCircle(const ShapeData& s, const CircleCircleBatch& b, size_t i, std::vector<NarrowphaseContact>& out) {
+	const int first = b.a[i], second = b.b[i];
+	NarrowphaseContact contact;
+	contact.pair = b.pair[i];
+	double dx = s.x[second] - s.x[first];
+	double dy = s.y[second] - s.y[first];
+	double distance = std::sqrt(dx * dx + dy * dy);
+	if (distance > 0.0) {
+		contact.nx = dx / distance;
+		contact.ny = dy / distance;
+	} else {
+		// 圆心重合：与 resolveCollision 相同，使用默认法向
+		contact.nx = 0.0;
+		contact.ny = 1.0;
+	}
+	contact.depth = (s.extentX[first] + s.extentX[second]) - distance;
+	out.push_back(contact);
+}
+
+static void emitCircleRect(const ShapeData& s, const CircleRectBatch& b, size_t i, std::vector<NarrowphaseContact>& out) {
+	const int circle = b.circle[i], rect = b.rect[i];
+	NarrowphaseContact contact;
+	contact.pair = b.pair[i];
+	double left = s.x[rect] - s.extentX[rect], right = s.x[rect] + s.extentX[rect];
+	double bottom = s.y[rect] - s.extentY[rect], top = s.y[rect] + s.extentY[rect];
+	double cx = s.x[circle], cy = s.y[circle], r = s.extentX[circle];
+	double dx = cx - std::max(left, std::min(cx, right));
+	double dy = cy - std::max(bottom, std::min(cy, top));
+	double distanceSquared = dx * dx + dy * dy;
+
+	// 先求由矩形指向圆的法向
+	double nx, ny;
+	if (distanceSquared > 0.0) {
+		double distance = std::sqrt(distanceSquared);
+		nx = dx / distance;
+		ny = dy / distance;
+		contact.depth = r - distance;
+	} else {
+		// 圆心在矩形内：沿离圆心最近的边推出
+		double best = cx - left;
+		nx = -1.0; ny = 0.0;
+		if (right - cx < best) { best = right - cx; nx = 1.0; ny = 0.0; }
+		if (cy - bottom < best) { best = cy - bottom; nx = 0.0; ny = -1.0; }
+		if (top - cy < best) { best = top - cy; nx = 0.0; ny = 1.0; }
+		contact.depth = r + best;
+	}
+	if (b.circleFirst[i]) {
+		nx = -nx;
+		ny = -ny;
+	}
+	contact.nx = nx;
+	contact.ny = ny;
+	out.push_back(contact);
+}
+
+/*=========================================================================================================
+ * 检测内核：按物体下标从 ShapeData 中取数据
+ * 与 shapes.cpp 中的 check_collision 内核使用相同的运算和顺序：
+ *   圆-圆：dx² + dy² <= (r1 + r2)²
+ *   圆-矩形：圆心到矩形上最近点（逐轴 clamp）的距离平方 <= r²
+ * SIMD 版本处理完整的 2 / 4 个一组，剩下的交给标量版本。
+ *=========================================================================================================*/
+static void circleCircleScalar(const ShapeData& s, const CircleCircleBatch& b, size_t begin, std::vector<NarrowphaseContact>& out) {
+	for (size_t i = begin; i < b.count; i++) {
+		const int first = b.a[i], second = b.b[i];
+		double dx = s.x[first] - s.x[second];
+		double dy = s.y[first] - s.y[second];
+		double radiusSum = s.extentX[first] + s.extentX[second];
+		if (dx * dx + dy * dy <= radiusSum * radiusSum) {
+			emitCircleCircle(s, b, i, out);
+		}
+	}
+}
+
+static void circleRectScalar(const ShapeData& s, const CircleRectBatch& b, size_t begin, std::vector<NarrowphaseContact>& out) {
+	for (size_t i = begin; i < b.count; i++) {
+		const int circle = b.circle[i], rect = b.rect[i];
+		double cx = s.x[circle], cy = s.y[circle], r = s.extentX[circle];
+		double closestX = std::max(s.x[rect] - s.extentX[rect], std::min(cx, s.x[rect] + s.extentX[rect]));
+		double closestY = std::max(s.y[rect] - s.extentY[rect], std::min(cy, s.y[rect] + s.extentY[rect]));
+		double dx = cx - closestX;
+		double dy = cy - closestY;
+		if (dx * dx + dy * dy <= r * r) {
+			emitCircleRect(s, b, i, out);
+		}
+	}
+}
+
+#if NARROWPHASE_X86
+// SSE2 没有 gather 指令，两个通道分别读取
+NARROWPHASE_TARGET_SSE2
+static inline __m128d gather2(const double* base, const int* index) {
+	return _mm_set_pd(base[index[1]], base[index[0]]);
+}
+
+NARROWPHASE_TARGET_SSE2
+static void circleCircleSSE2(const ShapeData& s, const CircleCircleBatch& b, std::vector<NarrowphaseContact>& out) {
+	const double *x = s.x.data(), *y = s.y.data(), *radius = s.extentX.data();
+	const size_t n = b.count;
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		const int *first = &b.a[i], *second = &b.b[i];
+		__m128d dx = _mm_sub_pd(gather2(x, first), gather2(x, second));
+		__m128d dy = _mm_sub_pd(gather2(y, first), gather2(y, second));
+		__m128d radiusSum = _mm_add_pd(gather2(radius, first), gather2(radius, second));
+		__m128d distanceSquared = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+		int mask = _mm_movemask_pd(_mm_cmple_pd(distanceSquared, _mm_mul_pd(radiusSum, radiusSum)));
+		for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+			if (mask & 1) emitCircleCircle(s, b, i + lane, out);
+		}
+	}
+	circleCircleScalar(s, b, i, out);
+}
+
+NARROWPHASE_TARGET_SSE2
+static void circleRectSSE2(const ShapeData& s, const CircleRectBatch& b, std::vector<NarrowphaseContact>& out) {
+	const double *x = s.x.data(), *y = s.y.data(), *extentX = s.extentX.data(), *extentY = s.extentY.data();
+	const size_t n = b.count;
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		const int *circle = &b.circle[i], *rect = &b.rect[i];
+		__m128d cx = gather2(x, circle), cy = gather2(y, circle), r = gather2(extentX, circle);
+		__m128d rx = gather2(x, rect), ry = gather2(y, rect);
+		__m128d hw = gather2(extentX, rect), hh = gather2(extentY, rect);
+		__m128d closestX = _mm_max_pd(_mm_sub_pd(rx, hw), _mm_min_pd(cx, _mm_add_pd(rx, hw)));
+		__m128d closestY = _mm_max_pd(_mm_sub_pd(ry, hh), _mm_min_pd(cy, _mm_add_pd(ry, hh)));
+		__m128d dx = _mm_sub_pd(cx, closestX);
+		__m128d dy = _mm_sub_pd(cy, closestY);
+		__m128d distanceSquared = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+		int mask = _mm_movemask_pd(_mm_cmple_pd(distanceSquared, _mm_mul_pd(r, r)));
+		for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+			if (mask & 1) emitCircleRect(s, b, i + lane, out);
+		}
+	}
+	circleRectScalar(s, b, i, out);
+}
+
+NARROWPHASE_TARGET_AVX2
+static inline __m256d gather4(const double* base, const int* index) {
+	// 带掩码的 gather 显式给出源操作数，避免 GCC 对未初始化源寄存器的 -Wmaybe-uninitialized 警告
+	return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base,
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(index)),
+		_mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+}
+
+NARROWPHASE_TARGET_AVX2
+static void circleCircleAVX2(const ShapeData& s, const CircleCircleBatch& b, std::vector<NarrowphaseContact>& out) {
+	const double *x = s.x.data(), *y = s.y.data(), *radius = s.extentX.data();
+	const size_t n = b.count;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const int *first = &b.a[i], *second = &b.b[i];
+		__m256d dx = _mm256_sub_pd(gather4(x, first), gather4(x, second));
+		__m256d dy = _mm256_sub_pd(gather4(y, first), gather4(y, second));
+		__m256d radiusSum = _mm256_add_pd(gather4(radius, first), gather4(radius, second));
+		__m256d distanceSquared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+		int mask = _mm256_movemask_pd(_mm256_cmp_pd(distanceSquared, _mm256_mul_pd(radiusSum, radiusSum), _CMP_LE_OQ));
+		for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+			if (mask & 1) emitCircleCircle(s, b, i + lane, out);
+		}
+	}
+	circleCircleScalar(s, b, i, out);
+}
+
+NARROWPHASE_TARGET_AVX2
+static void circleRectAVX2(const ShapeData& s, const CircleRectBatch& b, std::vector<NarrowphaseContact>& out) {
+	const double *x = s.x.data(), *y = s.y.data(), *extentX = s.extentX.data(), *extentY = s.extentY.data();
+	const size_t n = b.count;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const int *circle = &b.circle[i], *rect = &b.rect[i];
+		__m256d cx = gather4(x, circle), cy = gather4(y, circle), r = gather4(extentX, circle);
+		__m256d rx = gather4(x, rect), ry = gather4(y, rect);
+		__m256d hw = gather4(extentX, rect), hh = gather4(extentY, rect);
+		__m256d closestX = _mm256_max_pd(_mm256_sub_pd(rx, hw), _mm256_min_pd(cx, _mm256_add_pd(rx, hw)));
+		__m256d closestY = _mm256_max_pd(_mm256_sub_pd(ry, hh), _mm256_min_pd(cy, _mm256_add_pd(ry, hh)));
+		__m256d dx = _mm256_sub_pd(cx, closestX);
+		__m256d dy = _mm256_sub_pd(cy, closestY);
+		__m256d distanceSquared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+		int mask = _mm256_movemask_pd(_mm256_cmp_pd(distanceSquared, _mm256_mul_pd(r, r), _CMP_LE_OQ));
+		for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+			if (mask & 1) emitCircleRect(s, b, i + lane, out);
+		}
+	}
+	circleRectScalar(s, b, i, out);
+}
+#endif
+
+/*=========================================================================================================
+ * BatchNarrowphase::collide()
+ *   1. 把每个物体的类型、中心和尺寸整理成按物体下标存放的数组，之后不再访问 Shape 对象
+ *   2. 每次取 kChunkSize 个候选对，按类型分成圆-圆、圆-矩形两组（只记录物体下标），其余逐对调用 check_collision
+ *   3. 按指令集运行批量检测内核
+ * 最后三组接触各自按候选对顺序排列，归并成一组
+ *=========================================================================================================*/
+static const size_t kChunkSize = 256;
+
+void BatchNarrowphase::collide(const std::vector<Shape*>& shapes, const CandidatePair* pairs, size_t pairCount,
+                               std::vector<NarrowphaseContact>& contacts) {
+	const size_t shapeCount = shapes.size();
+	shapeData.kind.resize(shapeCount);
+	shapeData.x.resize(shapeCount);
+	shapeData.y.resize(shapeCount);
+	shapeData.extentX.resize(shapeCount);
+	shapeData.extentY.resize(shapeCount);
+	for (size_t i = 0; i < shapeCount; i++) {
+		const Shape& shape = *shapes[i];
+		const ShapeKind kind = shape.getKind();
+		shapeData.kind[i] = static_cast<char>(kind);
+		shapeData.x[i] = shape.mass_centre[0];
+		shapeData.y[i] = shape.mass_centre[1];
+		if (kind == SHAPE_CIRCLE) {
+			shapeData.extentX[i] = static_cast<const Circle&>(shape).radius;
+			shapeData.extentY[i] = shapeData.extentX[i];
+		} else if (kind == SHAPE_AABB) {
+			shapeData.extentX[i] = static_cast<const AABB&>(shape).getWidth() / 2;
+			shapeData.extentY[i] = static_cast<const AABB&>(shape).getHeight() / 2;
+		} else {
+			shapeData.extentX[i] = 0.0;
+			shapeData.extentY[i] = 0.0;
+		}
+	}
+
+	circleCircle.reserve(kChunkSize + 1);
+	circleRect.reserve(kChunkSize + 1);
+	otherPairs.resize(kChunkSize + 1);
+	circleCircleContacts.clear();
+	circleRectContacts.clear();
+	otherContacts.clear();
+
+	batchedPairs = 0;
+	const char* kind = shapeData.kind.data();
+	for (size_t chunkBegin = 0; chunkBegin < pairCount; chunkBegin += kChunkSize) {
+		const size_t chunkEnd = std::min(pairCount, chunkBegin + kChunkSize);
+
+		// 分类不用分支：每个物体对都写入三组数组的末尾，只有所属的那一组计数加一（类型混杂时分支难以预测）
+		int *ccFirst = circleCircle.a.data(), *ccSecond = circleCircle.b.data(), *ccPair = circleCircle.pair.data();
+		int *crCircle = circleRect.circle.data(), *crRect = circleRect.rect.data(), *crPair = circleRect.pair.data();
+		char* crCircleFirst = circleRect.circleFirst.data();
+		int* other = otherPairs.data();
+		size_t ccCount = 0, crCount = 0, otherCount = 0;
+		for (size_t k = chunkBegin; k < chunkEnd; k++) {
+			const int first = pairs[k].first, second = pairs[k].second;
+			const int kindA = kind[first], kindB = kind[second];
+			const size_t isCircleCircle = (kindA == SHAPE_CIRCLE) & (kindB == SHAPE_CIRCLE);
+			const size_t isCircleRect = ((kindA == SHAPE_CIRCLE) & (kindB == SHAPE_AABB)) | ((kindA == SHAPE_AABB) & (kindB == SHAPE_CIRCLE));
+			const int circleFirst = (kindA == SHAPE_CIRCLE);
+
+			ccFirst[ccCount] = first;
+			ccSecond[ccCount] = second;
+			ccPair[ccCount] = static_cast<int>(k);
+			ccCount += isCircleCircle;
+
+			crCircle[crCount] = circleFirst ? first : second;
+			crRect[crCount] = circleFirst ? second : first;
+			crPair[crCount] = static_cast<int>(k);
+			crCircleFirst[crCount] = static_cast<char>(circleFirst);
+			crCount += isCircleRect;
+
+			other[otherCount] = static_cast<int>(k);
+			otherCount += 1 - (isCircleCircle | isCircleRect);
+		}
+		circleCircle.count = ccCount;
+		circleRect.count = crCount;
+		batchedPairs += ccCount + crCount;
+
+		switch (isa) {
+#if NARROWPHASE_X86
+			case NARROWPHASE_AVX2:
+				circleCircleAVX2(shapeData, circleCircle, circleCircleContacts);
+				circleRectAVX2(shapeData, circleRect, circleRectContacts);
+				break;
+			case NARROWPHASE_SSE2:
+				circleCircleSSE2(shapeData, circleCircle, circleCircleContacts);
+				circleRectSSE2(shapeData, circleRect, circleRectContacts);
+				break;
+#endif
+			default:
+				circleCircleScalar(shapeData, circleCircle, 0, circleCircleContacts);
+				circleRectScalar(shapeData, circleRect, 0, circleRectContacts);
+				break;
+		}
+
+		// 其余组合逐对检测：法向取两个中心的连线，重叠量由分离内核计算（可能改写为重叠较小的轴）
+		for (size_t o = 0; o < otherCount; o++) {
+			const int k = other[o];
+			const Shape& a = *shapes[pairs[k].first];
+			const Shape& b = *shapes[pairs[k].second];
+			if (!a.check_collision(b)) continue;
+			NarrowphaseContact contact;
+			contact.pair = k;
+			double nx = b.mass_centre[0] - a.mass_centre[0];
+			double ny = b.mass_centre[1] - a.mass_centre[1];
+			double distance = std::sqrt(nx * nx + ny * ny);
+			if (distance < 0.0001) {
+				nx = 0.0;
+				ny = 1.0;
+				distance = 1.0;
+			} else {
+				nx /= distance;
+				ny /= distance;
+			}
+			contact.depth = a.computeOverlap(b, nx, ny, distance);
+			contact.nx = nx;
+			contact.ny = ny;
+			otherContacts.push_back(contact);
+		}
+	}
+	scalarPairs = pairCount - batchedPairs;
+
+	struct ByPair {
+		bool operator()(const NarrowphaseContact& x, const NarrowphaseContact& y) const { return x.pair < y.pair; }
+	};
+	mergeScratch.clear();
+	std::merge(circleCircleContacts.begin(), circleCircleContacts.end(), circleRectContacts.begin(), circleRectContacts.end(),
+	           std::back_inserter(mergeScratch), ByPair());
+	contacts.clear();
+	std::merge(mergeScratch.begin(), mergeScratch.end(), otherContacts.begin(), otherContacts.end(),
+	           std::back_inserter(contacts), ByPair());
+}
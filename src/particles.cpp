@@ -0,0 +1,602 @@
+#include "particles.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/*=========================================================================================================
+ * 容量与发射器
+ *=========================================================================================================*/
+void ParticleSystem::setCapacity(size_t maxParticles) {
+	capacity = maxParticles;
+	if (count > capacity) {
+		count = capacity;
+	}
+	if (!px.empty()) {
+		reserveArrays();
+	}
+}
+
+// 数组按容量一次分配（第一次加入粒子或修改容量时），之后发射、回收都不再分配内存
+void ParticleSystem::reserveArrays() {
+	px.resize(capacity);
+	py.resize(capacity);
+	vx.resize(capacity);
+	vy.resize(capacity);
+	life.resize(capacity);
+	rad.resize(capacity);
+	groups.resize(capacity);
+}
+
+int ParticleSystem::addEmitter(const ParticleEmitter& emitter) {
+	EmitterSlot slot;
+	slot.emitter = emitter;
+	slot.pending = 0.0;
+	slot.alive = true;
+
+	int id = -1;
+	for (size_t i = 0; i < emitters.size(); i++) {
+		if (!emitters[i].alive) {
+			id = static_cast<int>(i);
+			break;
+		}
+	}
+	if (id < 0) {
+		if (emitters.size() + 1 >= 0xffff) return -1;   // 分组编号用完
+		id = static_cast<int>(emitters.size());
+		emitters.push_back(slot);
+		groupRestitution.push_back(0.0);
+	} else {
+		emitters[id] = slot;
+	}
+	groupRestitution[id + 1] = static_cast<float>(emitter.restitution);
+	return id;
+}
+
+ParticleEmitter* ParticleSystem::getEmitter(int id) {
+	if (id < 0 || id >= static_cast<int>(emitters.size()) || !emitters[id].alive) return nullptr;
+	return &emitters[id].emitter;
+}
+
+bool ParticleSystem::removeEmitter(int id) {
+	if (getEmitter(id) == nullptr) return false;
+	emitters[id].alive = false;   // 已经发射的粒子保留，直到寿命耗尽
+	return true;
+}
+
+void ParticleSystem::clearEmitters() {
+	for (size_t i = 0; i < emitters.size(); i++) {
+		emitters[i].alive = false;
+	}
+}
+
+bool ParticleSystem::isActive() const {
+	if (count > 0) return true;
+	for (size_t i = 0; i < emitters.size(); i++) {
+		if (emitters[i].alive && emitters[i].emitter.enabled && emitters[i].emitter.rate > 0.0) return true;
+	}
+	return false;
+}
+
+/*=========================================================================================================
+ * 发射
+ *=========================================================================================================*/
+// xorshift64*：每个系统各自的确定序列，结果与线程数、运行环境无关
+double ParticleSystem::random01() {
+	rngState ^= rngState >> 12;
+	rngState ^= rngState << 25;
+	rngState ^= rngState >> 27;
+	return static_cast<double>((rngState * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+bool ParticleSystem::push(float x, float y, float vx0, float vy0, float lifetime, float radius, uint16_t group) {
+	if (count >= capacity) return false;
+	if (px.size() < capacity) {
+		reserveArrays();
+	}
+	px[count] = x;
+	py[count] = y;
+	vx[count] = vx0;
+	vy[count] = vy0;
+	life[count] = lifetime;
+	rad[count] = radius;
+	groups[count] = group;
+	count++;
+	return true;
+}
+
+size_t ParticleSystem::emitFrom(int id, size_t n) {
+	const ParticleEmitter& e = emitters[id].emitter;
+	const float lifetime = e.lifetime > 0.0 ? static_cast<float>(e.lifetime) : std::numeric_limits<float>::infinity();
+	const uint16_t group = static_cast<uint16_t>(id + 1);
+	size_t emitted = 0;
+	for (; emitted < n; emitted++) {
+		if (count >= capacity) {
+			stats.dropped += n - emitted;
+			break;
+		}
+		const double angle = e.angle + (2.0 * random01() - 1.0) * e.spread;
+		const double speed = e.speedMin + random01() * (e.speedMax - e.speedMin);
+		double x = e.x, y = e.y;
+		if (e.width > 0.0) {
+			// 发射口上的位置：垂直于发射方向
+			const double offset = (random01() - 0.5) * e.width;
+			x -= offset * std::sin(e.angle);
+			y += offset * std::cos(e.angle);
+		}
+		push(static_cast<float>(x), static_cast<float>(y),
+		     static_cast<float>(speed * std::cos(angle)), static_cast<float>(speed * std::sin(angle)),
+		     lifetime, static_cast<float>(e.radius), group);
+	}
+	stats.emitted += emitted;
+	return emitted;
+}
+
+size_t ParticleSystem::emit(int emitterId, size_t n) {
+	if (getEmitter(emitterId) == nullptr) return 0;
+	groupRestitution[emitterId + 1] = static_cast<float>(emitters[emitterId].emitter.restitution);
+	return emitFrom(emitterId, n);
+}
+
+bool ParticleSystem::spawn(double x, double y, double vx0, double vy0, double lifetime, double radius) {
+	const float l = lifetime > 0.0 ? static_cast<float>(lifetime) : std::numeric_limits<float>::infinity();
+	return push(static_cast<float>(x), static_cast<float>(y), static_cast<float>(vx0), static_cast<float>(vy0),
+	            l, static_cast<float>(radius), 0);
+}
+
+/*=========================================================================================================
+ * 与静态形状分离
+ *   盒子   取最近点；圆心在盒子内时推回上一次所在的一侧，上一次也在盒子的范围内时从最近的一边推出
+ *   圆     沿圆心连线推出
+ *   线段   取最近点；圆心从线段的一侧穿到另一侧时推回原来的一侧
+ *=========================================================================================================*/
+bool separateParticle(const ParticleCollider& c, double& x, double& y, double r, double lastX, double lastY,
+                      double& nx, double& ny) {
+	double penetration;
+	if (c.kind == ParticleCollider::BOX) {
+		const double qx = std::min(std::max(x, c.minX), c.maxX);
+		const double qy = std::min(std::max(y, c.minY), c.maxY);
+		const double dx = x - qx, dy = y - qy;
+		const double d2 = dx * dx + dy * dy;
+		if (d2 >= r * r) return false;
+		if (d2 > 0.0) {
+			const double d = std::sqrt(d2);
+			nx = dx / d;
+			ny = dy / d;
+			penetration = r - d;
+		} else {
+			const double left = x - c.minX, right = c.maxX - x, down = y - c.minY, up = c.maxY - y;
+			if (lastX < c.minX || lastX > c.maxX) {
+				nx = lastX < c.minX ? -1.0 : 1.0;
+				ny = 0.0;
+				penetration = (lastX < c.minX ? left : right) + r;
+			} else if (lastY < c.minY || lastY > c.maxY) {
+				nx = 0.0;
+				ny = lastY < c.minY ? -1.0 : 1.0;
+				penetration = (lastY < c.minY ? down : up) + r;
+			} else {
+				const double least = std::min(std::min(left, right), std::min(down, up));
+				nx = (least == left) ? -1.0 : (least == right ? 1.0 : 0.0);
+				ny = (nx != 0.0) ? 0.0 : (least == down ? -1.0 : 1.0);
+				penetration = least + r;
+			}
+		}
+	} else if (c.kind == ParticleCollider::CIRCLE) {
+		const double dx = x - c.cx, dy = y - c.cy;
+		const double reach = r + c.radius;
+		const double d2 = dx * dx + dy * dy;
+		if (d2 >= reach * reach) return false;
+		const double d = std::sqrt(d2);
+		if (d > 0.0) {
+			nx = dx / d;
+			ny = dy / d;
+		} else {
+			nx = 0.0;
+			ny = 1.0;
+		}
+		penetration = reach - d;
+	} else {
+		const double ex = c.bx - c.ax, ey = c.by - c.ay;
+		const double length2 = ex * ex + ey * ey;
+		if (length2 <= 0.0) return false;
+		const double t = std::min(std::max(((x - c.ax) * ex + (y - c.ay) * ey) / length2, 0.0), 1.0);
+		const double qx = c.ax + t * ex, qy = c.ay + t * ey;
+		// 线段的法向（未归一化）与粒子现在、上一次所在的一侧
+		const double sideNow = (y - c.ay) * ex - (x - c.ax) * ey;
+		const double sideLast = (lastY - c.ay) * ex - (lastX - c.ax) * ey;
+		const double dx = x - qx, dy = y - qy;
+		const double d2 = dx * dx + dy * dy;
+		const bool crossed = t > 0.0 && t < 1.0 && ((sideNow < 0.0) != (sideLast < 0.0)) && sideLast != 0.0;
+		if (!crossed && d2 >= r * r) return false;
+		if (crossed || d2 == 0.0) {
+			const double length = std::sqrt(length2);
+			const double sign = sideLast < 0.0 ? -1.0 : 1.0;
+			nx = -sign * ey / length;
+			ny = sign * ex / length;
+		} else {
+			const double d = std::sqrt(d2);
+			nx = dx / d;
+			ny = dy / d;
+		}
+		x = qx + nx * r;
+		y = qy + ny * r;
+		return true;
+	}
+	x += nx * penetration;
+	y += ny * penetration;
+	return true;
+}
+
+/*=========================================================================================================
+ * updateRange() - 一块粒子的积分与碰撞
+ * 1. 剩余寿命减去 Δt，半隐式欧拉积分（与世界中物体的默认积分方法相同），与地面碰撞，离开边界的粒子标记回收
+ * 2. 用本块的包围盒查询一次静态形状，块内每个粒子与查询结果逐个用 separateParticle 推出重叠，再反弹法向速度
+ *=========================================================================================================*/
+size_t ParticleSystem::updateRange(size_t begin, size_t end, float dt, float gravity, float groundY,
+                                   const BroadphaseBounds& bounds, const ColliderQuery& query, int worker) {
+	float* X = px.data();
+	float* Y = py.data();
+	float* VX = vx.data();
+	float* VY = vy.data();
+	float* L = life.data();
+	const float* R = rad.data();
+	const uint16_t* G = groups.data();
+	const float* restitution = groupRestitution.data();
+	size_t collisions = 0;
+
+	BroadphaseBounds area;
+	area.minX = area.minY = std::numeric_limits<double>::infinity();
+	area.maxX = area.maxY = -std::numeric_limits<double>::infinity();
+
+	for (size_t i = begin; i < end; i++) {
+		const float r = R[i];
+		float x = X[i], y = Y[i], u = VX[i], v = VY[i];
+		v -= gravity * dt;
+		x += u * dt;
+		y += v * dt;
+		L[i] -= dt;
+
+		if (y - r < groundY) {
+			y = groundY + r;
+			if (v < 0.0f) {
+				v = -v * restitution[G[i]];
+				collisions++;
+			}
+		}
+		X[i] = x;
+		Y[i] = y;
+		VX[i] = u;
+		VY[i] = v;
+
+		if (x < bounds.minX || x > bounds.maxX || y < bounds.minY || y > bounds.maxY) {
+			L[i] = -1.0f;
+			continue;
+		}
+		area.minX = std::min(area.minX, static_cast<double>(x - r));
+		area.maxX = std::max(area.maxX, static_cast<double>(x + r));
+		area.minY = std::min(area.minY, static_cast<double>(y - r));
+		area.maxY = std::max(area.maxY, static_cast<double>(y + r));
+	}
+
+	if (!query || !(area.minX <= area.maxX)) return collisions;
+	std::vector<ParticleCollider>& colliders = workerColliders[worker];
+	colliders.clear();
+	query(area, colliders, worker);
+	if (colliders.empty()) return collisions;
+
+	for (size_t i = begin; i < end; i++) {
+		if (L[i] < 0.0f) continue;
+		const double r = R[i];
+		double x = X[i], y = Y[i];
+		bool moved = false;
+		for (size_t k = 0; k < colliders.size(); k++) {
+			const ParticleCollider& c = colliders[k];
+			if (x + r < c.minX || x - r > c.maxX || y + r < c.minY || y - r > c.maxY) continue;
+
+			double nx, ny;
+			if (!separateParticle(c, x, y, r, x - VX[i] * dt, y - VY[i] * dt, nx, ny)) continue;
+			moved = true;
+			const double vn = VX[i] * nx + VY[i] * ny;
+			if (vn < 0.0) {
+				const double impulse = (1.0 + restitution[G[i]]) * vn;
+				VX[i] = static_cast<float>(VX[i] - impulse * nx);
+				VY[i] = static_cast<float>(VY[i] - impulse * ny);
+				collisions++;
+			}
+		}
+		if (moved) {
+			X[i] = static_cast<float>(x);
+			Y[i] = static_cast<float>(y);
+		}
+	}
+	return collisions;
+}
+
+/*=========================================================================================================
+ * step() - 推进一步
+ *=========================================================================================================*/
+void ParticleSystem::step(double deltaTime, double gravity, double groundY, const BroadphaseBounds& bounds,
+                          const ColliderQuery& query, ThreadPool* pool) {
+	stats = ParticleStats();
+	if (deltaTime <= 0.0) return;
+
+	// ========== 连续发射（零头留到下一步）==========
+	for (size_t id = 0; id < emitters.size(); id++) {
+		EmitterSlot& slot = emitters[id];
+		if (!slot.alive) continue;
+		groupRestitution[id + 1] = static_cast<float>(slot.emitter.restitution);
+		if (!slot.emitter.enabled || slot.emitter.rate <= 0.0) continue;
+		slot.pending += slot.emitter.rate * deltaTime;
+		const size_t n = static_cast<size_t>(slot.pending);
+		slot.pending -= static_cast<double>(n);
+		emitFrom(static_cast<int>(id), n);
+	}
+	if (mode != PARTICLE_BALLISTIC) {
+		stepInteracting(deltaTime, gravity, groundY, bounds, query, pool);
+		return;
+	}
+	if (count == 0) return;
+
+	// ========== 积分与碰撞（按块并行）==========
+	const size_t chunks = (count + kChunkSize - 1) / kChunkSize;
+	const int workers = pool != nullptr ? pool->getThreadCount() : 1;
+	workerColliders.resize(workers);
+	chunkCollisions.assign(chunks, 0);
+	const float dt = static_cast<float>(deltaTime);
+	const float g = static_cast<float>(gravity);
+	const float ground = static_cast<float>(groundY);
+	auto runChunk = [&](size_t chunk, int worker) {
+		const size_t begin = chunk * kChunkSize;
+		chunkCollisions[chunk] = updateRange(begin, std::min(count, begin + kChunkSize), dt, g, ground, bounds, query, worker);
+	};
+	if (workers > 1 && chunks > 1) {
+		pool->parallelFor(chunks, runChunk);
+	} else {
+		for (size_t c = 0; c < chunks; c++) {
+			runChunk(c, 0);
+		}
+	}
+	for (size_t c = 0; c < chunks; c++) {
+		stats.collisions += chunkCollisions[c];
+	}
+
+	recycle(false);
+	stats.liveCount = count;
+}
+
+// 回收：用最后一个存活的粒子填补空位
+void ParticleSystem::recycle(bool withStart) {
+	size_t i = 0;
+	while (i < count) {
+		if (life[i] > 0.0f) {
+			i++;
+			continue;
+		}
+		count--;
+		if (i != count) {
+			px[i] = px[count];
+			py[i] = py[count];
+			vx[i] = vx[count];
+			vy[i] = vy[count];
+			life[i] = life[count];
+			rad[i] = rad[count];
+			groups[i] = groups[count];
+			if (withStart) {
+				startX[i] = startX[count];
+				startY[i] = startY[count];
+			}
+		}
+		stats.recycled++;
+	}
+}
+
+void ParticleSystem::applyOrder(const std::vector<uint32_t>& order) {
+	permuteScratch.resize(count);
+	float* arrays[] = { px.data(), py.data(), vx.data(), vy.data(), life.data(), rad.data(), startX.data(), startY.data() };
+	for (size_t a = 0; a < sizeof(arrays) / sizeof(arrays[0]); a++) {
+		float* values = arrays[a];
+		for (size_t k = 0; k < count; k++) {
+			permuteScratch[k] = values[order[k]];
+		}
+		std::copy(permuteScratch.begin(), permuteScratch.end(), values);
+	}
+	groupScratch.resize(count);
+	for (size_t k = 0; k < count; k++) {
+		groupScratch[k] = groups[order[k]];
+	}
+	std::copy(groupScratch.begin(), groupScratch.end(), groups.begin());
+}
+
+/*=========================================================================================================
+ * stepInteracting() - 流体、颗粒模式的一步
+ * 1. 预测位置：v += gΔt，x* = x + vΔt，剩余寿命减去 Δt，离开边界的粒子标记回收；然后回收
+ * 2. 按网格单元排序，建邻居列表（流体的邻居半径为核半径 4r，颗粒为 3r，r 为最大的粒子半径）；
+ *    排序后每块粒子在空间上也是聚在一起的，每块用（扩大一个邻居半径的）包围盒查询一次静态形状，各轮迭代共用
+ * 3. 每轮：粒子之间的约束（流体为 Jacobi，颗粒为按颜色的 Gauss-Seidel），再与地面、静态形状分离；第一轮加上与边界的摩擦
+ * 4. v = (x* - x) / Δt，流体再用 XSPH 平滑速度
+ *=========================================================================================================*/
+void ParticleSystem::stepInteracting(double deltaTime, double gravity, double groundY, const BroadphaseBounds& bounds,
+                                     const ColliderQuery& query, ThreadPool* pool) {
+	const float dt = static_cast<float>(deltaTime);
+	const float g = static_cast<float>(gravity);
+	const float ground = static_cast<float>(groundY);
+	const int workers = pool != nullptr ? pool->getThreadCount() : 1;
+	auto forChunks = [&](const std::function<void(size_t, size_t, size_t, int)>& body) {
+		const size_t chunks = (count + kChunkSize - 1) / kChunkSize;
+		auto run = [&](size_t chunk, int worker) {
+			const size_t begin = chunk * kChunkSize;
+			body(begin, std::min(count, begin + kChunkSize), chunk, worker);
+		};
+		if (workers > 1 && chunks > 1) {
+			pool->parallelFor(chunks, run);
+		} else {
+			for (size_t c = 0; c < chunks; c++) {
+				run(c, 0);
+			}
+		}
+	};
+	fluid.resetStats(fluidSettings.iterations);
+
+	// ========== 预测位置 ==========
+	startX.resize(count);
+	startY.resize(count);
+	forChunks([&](size_t begin, size_t end, size_t, int) {
+		for (size_t i = begin; i < end; i++) {
+			startX[i] = px[i];
+			startY[i] = py[i];
+			vy[i] -= g * dt;
+			px[i] += vx[i] * dt;
+			py[i] += vy[i] * dt;
+			life[i] -= dt;
+			if (px[i] < bounds.minX || px[i] > bounds.maxX || py[i] < bounds.minY || py[i] > bounds.maxY) {
+				life[i] = -1.0f;
+			}
+		}
+	});
+	recycle(true);
+	stats.liveCount = count;
+	if (count == 0) return;
+
+	// ========== 排序与邻居列表 ==========
+	float radiusMax = 0.0f;
+	for (size_t i = 0; i < count; i++) {
+		radiusMax = std::max(radiusMax, rad[i]);
+	}
+	const float reach = (mode == PARTICLE_FLUID ? 4.0f : 3.0f) * radiusMax;
+	applyOrder(fluid.sortByCell(px.data(), py.data(), count, reach));
+	fluid.buildNeighbours(px.data(), py.data(), count, pool);
+
+	const size_t chunks = (count + kChunkSize - 1) / kChunkSize;
+	chunkColliders.resize(std::max(chunkColliders.size(), chunks));
+	forChunks([&](size_t begin, size_t end, size_t chunk, int worker) {
+		std::vector<ParticleCollider>& colliders = chunkColliders[chunk];
+		colliders.clear();
+		if (!query) return;
+		BroadphaseBounds area;
+		area.minX = area.minY = std::numeric_limits<double>::infinity();
+		area.maxX = area.maxY = -std::numeric_limits<double>::infinity();
+		for (size_t i = begin; i < end; i++) {
+			area.minX = std::min(area.minX, static_cast<double>(std::min(px[i], startX[i])));
+			area.maxX = std::max(area.maxX, static_cast<double>(std::max(px[i], startX[i])));
+			area.minY = std::min(area.minY, static_cast<double>(std::min(py[i], startY[i])));
+			area.maxY = std::max(area.maxY, static_cast<double>(std::max(py[i], startY[i])));
+		}
+		area.minX -= reach;
+		area.minY -= reach;
+		area.maxX += reach;
+		area.maxY += reach;
+		query(area, colliders, worker);
+	});
+
+	// ========== 约束迭代 ==========
+	correctionX.resize(count);
+	correctionY.resize(count);
+	chunkCollisions.assign(chunks, 0);
+	const bool granular = mode == PARTICLE_GRANULAR;
+	const double muS = fluidSettings.staticFriction;
+	const double muK = fluidSettings.kineticFriction;
+	const double viscosity = std::min(std::max(fluidSettings.viscosity, 0.0), 1.0);
+	// 与地面、本块的静态形状分离，返回是否接触；(nx, ny) 为最后一次接触的法向，penetration 为推出的距离
+	auto separate = [&](size_t i, const std::vector<ParticleCollider>& colliders, double& x, double& y,
+	                    double lastX, double lastY, double& nx, double& ny, double& penetration) {
+		const double r = rad[i];
+		bool touched = false;
+		if (y - r < ground) {
+			penetration = ground + r - y;
+			y = ground + r;
+			nx = 0.0;
+			ny = 1.0;
+			touched = true;
+		}
+		for (size_t k = 0; k < colliders.size(); k++) {
+			const ParticleCollider& c = colliders[k];
+			if (x + r < c.minX || x - r > c.maxX || y + r < c.minY || y - r > c.maxY) continue;
+			const double beforeX = x, beforeY = y;
+			if (!separateParticle(c, x, y, r, lastX, lastY, nx, ny)) continue;
+			penetration = std::sqrt((x - beforeX) * (x - beforeX) + (y - beforeY) * (y - beforeY));
+			touched = true;
+		}
+		return touched;
+	};
+
+	if (granular) {
+		// 预稳定：先在本步开始的位置上分开重叠的粒子，修正量同时加到开始位置和预测位置上，
+		// 不产生速度：上一步没有完全分开的重叠不会变成把粒子弹开的速度
+		for (int pass = 0; pass < fluidSettings.stabilizationIterations; pass++) {
+			std::copy(startX.begin(), startX.end(), correctionX.begin());
+			std::copy(startY.begin(), startY.end(), correctionY.begin());
+			fluid.solveContacts(startX.data(), startY.data(), startX.data(), startY.data(), rad.data(), fluidSettings, pool);
+			forChunks([&](size_t begin, size_t end, size_t chunk, int) {
+				const std::vector<ParticleCollider>& colliders = chunkColliders[chunk];
+				for (size_t i = begin; i < end; i++) {
+					double x = startX[i], y = startY[i];
+					double nx, ny, penetration;
+					separate(i, colliders, x, y, correctionX[i], correctionY[i], nx, ny, penetration);
+					startX[i] = static_cast<float>(x);
+					startY[i] = static_cast<float>(y);
+					px[i] += startX[i] - correctionX[i];
+					py[i] += startY[i] - correctionY[i];
+				}
+			});
+		}
+	}
+	for (int iteration = 0; iteration < fluidSettings.iterations; iteration++) {
+		if (granular) {
+			fluid.solveContacts(px.data(), py.data(), startX.data(), startY.data(), rad.data(), fluidSettings, pool);
+			std::fill(correctionX.begin(), correctionX.end(), 0.0f);
+			std::fill(correctionY.begin(), correctionY.end(), 0.0f);
+		} else {
+			fluid.solveDensity(px.data(), py.data(), correctionX.data(), correctionY.data(), count, radiusMax,
+			                   fluidSettings, pool);
+		}
+		const bool first = iteration == 0;
+		const bool last = iteration + 1 == fluidSettings.iterations;
+		forChunks([&](size_t begin, size_t end, size_t chunk, int) {
+			const std::vector<ParticleCollider>& colliders = chunkColliders[chunk];
+			size_t collisions = 0;
+			for (size_t i = begin; i < end; i++) {
+				double x = px[i] + correctionX[i], y = py[i] + correctionY[i];
+				double nx = 0.0, ny = 0.0, penetration = 0.0;
+				const bool touched = separate(i, colliders, x, y, startX[i], startY[i], nx, ny, penetration);
+				if (touched && (granular || first)) {
+					// 与边界的摩擦：本步的切向位移，按最后一次接触的法向。颗粒每轮都按这一轮推出的距离取静摩擦 / 动摩擦；
+					// 流体只在第一轮按粘性系数减小（在斜坡上仍然会流下去）
+					const double ux = x - startX[i], uy = y - startY[i];
+					const double un = ux * nx + uy * ny;
+					const double tx = ux - un * nx, ty = uy - un * ny;
+					const double t = std::sqrt(tx * tx + ty * ty);
+					if (t > 0.0) {
+						const double keep = !granular ? viscosity
+						                  : t < muS * penetration ? 1.0 : std::min(muK * penetration / t, 1.0);
+						x -= keep * tx;
+						y -= keep * ty;
+					}
+				}
+				if (touched) collisions++;
+				px[i] = static_cast<float>(x);
+				py[i] = static_cast<float>(y);
+			}
+			if (last) chunkCollisions[chunk] = collisions;
+		});
+	}
+	for (size_t c = 0; c < chunks; c++) {
+		stats.collisions += chunkCollisions[c];
+	}
+
+	// ========== 速度 ==========
+	const float invDt = 1.0f / dt;
+	const float sleep = granular ? static_cast<float>(fluidSettings.sleepVelocity) * dt : 0.0f;
+	forChunks([&](size_t begin, size_t end, size_t, int) {
+		for (size_t i = begin; i < end; i++) {
+			const float ux = px[i] - startX[i], uy = py[i] - startY[i];
+			if (ux * ux + uy * uy < sleep * sleep) {
+				px[i] = startX[i];
+				py[i] = startY[i];
+			}
+			vx[i] = (px[i] - startX[i]) * invDt;
+			vy[i] = (py[i] - startY[i]) * invDt;
+		}
+	});
+	if (!granular) {
+		fluid.applyViscosity(px.data(), py.data(), vx.data(), vy.data(), count, static_cast<float>(fluidSettings.viscosity), pool);
+	}
+}
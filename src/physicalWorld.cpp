@@ -1,9 +1,10 @@
-﻿#include "physicalWorld.h"
+#include "physicalWorld.h"
 #include "shapes.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <string>
+#include <cctype>
 
 // PhysicalWorld类的setGravity和getGravity已经在头文件中内联定义，这里不需要重复
 
@@ -12,18 +13,16 @@ void PhysicalWorld::placeDynamicShape(Shape& shape, double x_pos, double y_pos)
 	double f = ground.getFriction();
 	shape.fraction = f;
 
-	// 尝试将shape转换为Circle
-	const Circle* circle = dynamic_cast<const Circle*>(&shape);
-	if (circle) {
-		shape.setCentre(x_pos, y_pos + circle->getRadius());
-		return;
-	}
-
-	// 尝试将shape转换为AABB
-	const AABB* aabb = dynamic_cast<const AABB*>(&shape);
-	if (aabb) {
-		shape.setCentre(x_pos, y_pos + aabb->getHeight() / 2);
-		return;
+	// 按类型标记计算中心到底部的距离
+	switch (shape.getKind()) {
+		case SHAPE_CIRCLE:
+			shape.setCentre(x_pos, y_pos + static_cast<const Circle&>(shape).getRadius());
+			break;
+		case SHAPE_AABB:
+			shape.setCentre(x_pos, y_pos + static_cast<const AABB&>(shape).getHeight() / 2);
+			break;
+		default:
+			break;
 	}
 }
 
@@ -38,18 +37,16 @@ void PhysicalWorld::placeShapeOnGround(Shape& shape, const Ground& ground) {
 	double f = ground.getFriction();
 	shape.fraction = f;
 	
-	// 尝试将shape转换为Circle
-	const Circle* circle = dynamic_cast<const Circle*>(&shape);
-	if (circle) {
-		shape.setCentre(x, ground.getYLevel() + circle->getRadius());
-		return;
-	}
-	
-	// 尝试将shape转换为AABB
-	const AABB* aabb = dynamic_cast<const AABB*>(&shape);
-	if (aabb) {
-		shape.setCentre(x, ground.getYLevel() + aabb->getHeight() / 2);
-		return;
+	// 按类型标记计算中心到底部的距离
+	switch (shape.getKind()) {
+		case SHAPE_CIRCLE:
+			shape.setCentre(x, ground.getYLevel() + static_cast<const Circle&>(shape).getRadius());
+			break;
+		case SHAPE_AABB:
+			shape.setCentre(x, ground.getYLevel() + static_cast<const AABB&>(shape).getHeight() / 2);
+			break;
+		default:
+			break;
 	}
 }
 
@@ -117,28 +114,27 @@ void PhysicalWorld::placeShapeOnShape(Shape& topShape, Shape& bottomShape, doubl
 		// 计算底部形状顶部到上方形状底部的距离
 		double distance = centerToBottom * 2.0;  // 上方形状的高度/直径
 		
-		// 识别上方形状的类型以获取准确的尺寸
-		const Circle* topCircle = dynamic_cast<const Circle*>(&topShape);
-		const AABB* topAABB = dynamic_cast<const AABB*>(&topShape);
-		
-		if (topCircle) {
-			distance = topCircle->getRadius();
-		} else if (topAABB) {
-			distance = topAABB->getHeight() / 2.0;
+		// 按上方形状的类型获取准确的尺寸
+		if (topShape.getKind() == SHAPE_CIRCLE) {
+			distance = static_cast<const Circle&>(topShape).getRadius();
+		} else if (topShape.getKind() == SHAPE_AABB) {
+			distance = static_cast<const AABB&>(topShape).getHeight() / 2.0;
 		}
 		
-		// 识别底部形状的类型
-		const Circle* bottomCircle = dynamic_cast<const Circle*>(&bottomShape);
-		const AABB* bottomAABB = dynamic_cast<const AABB*>(&bottomShape);
-		const Wall* bottomWall = dynamic_cast<const Wall*>(&bottomShape);
-		
+		// 按底部形状的类型获取尺寸
 		double bottomDistance = 0.0;
-		if (bottomCircle) {
-			bottomDistance = bottomCircle->getRadius();
-		} else if (bottomAABB) {
-			bottomDistance = bottomAABB->getHeight() / 2.0;
-		} else if (bottomWall) {
-			bottomDistance = bottomWall->getHeight() / 2.0;
+		switch (bottomShape.getKind()) {
+			case SHAPE_CIRCLE:
+				bottomDistance = static_cast<const Circle&>(bottomShape).getRadius();
+				break;
+			case SHAPE_AABB:
+				bottomDistance = static_cast<const AABB&>(bottomShape).getHeight() / 2.0;
+				break;
+			case SHAPE_WALL:
+				bottomDistance = static_cast<const Wall&>(bottomShape).getHeight() / 2.0;
+				break;
+			default:
+				break;
 		}
 		
 		// 计算总的垂直距离（沿法向量方向）
@@ -221,7 +217,8 @@ void PhysicalWorld::saveStates() {
 		
 		// 保存支撑状态
 		state.isSupported = shape->getIsSupported();
-		state.supporter = shape->getSupporter();
+		Shape* supporter = shape->getSupporter();
+		state.supporter = supporter != nullptr ? supporter->getHandle() : ShapeHandle();
 		
 		// 保存正压力
 		shape->getNormalForce(state.normalForce[0], state.normalForce[1]);
@@ -254,8 +251,11 @@ void PhysicalWorld::restoreStates() {
 		shape->setMass(state.mass);
 		
 		// 恢复支撑状态
-		shape->setIsSupported(state.isSupported);
-		shape->setSupporter(state.supporter);
+		// 暂停期间支撑物被删除时句柄已失效，物体改为不被支撑，下一步重新检测
+		Shape* supporter = handleTable.resolve(state.supporter);
+		bool supporterRemoved = !state.supporter.isNull() && supporter == nullptr;
+		shape->setIsSupported(state.isSupported && !supporterRemoved);
+		shape->setSupporter(supporter);
 		
 		// 恢复正压力
 		shape->normalforce[0] = state.normalForce[0];
@@ -286,20 +286,476 @@ void PhysicalWorld::update(std::vector<Shape*>& shapeList, double deltaTime, con
 		return;
 	}
 	
+	if (!adaptiveSubstepping) {
+		step(shapeList, deltaTime, ground);
+		substepCount = 1;
+		return;
+	}
+	
+	// ========== 自适应子步 ==========
+	// 先按当前速度（和上一帧最后一个子步的穿透深度）估计整帧的子步数，每走一步按新的状态重新估计剩余时间的子步数：
+	// 只增不减，总数不超过 maxSubsteps，最后一步走完剩余的全部时间
+	double remaining = deltaTime;
+	int used = 0;
+	int planned = estimateSubsteps(shapeList, remaining, 1);
+	while (true) {
+		planned = std::min(planned, maxSubsteps - used);
+		const double h = (planned <= 1) ? remaining : remaining / planned;
+		step(shapeList, h, ground);
+		used++;
+		if (planned <= 1) break;
+		remaining -= h;
+		planned = estimateSubsteps(shapeList, remaining, planned - 1);
+	}
+	substepCount = used;
+}
+
+/*=========================================================================================================
+ * 自适应子步：估计剩余时间需要的子步数
+ *   速度：每个子步的位移不超过 substepMotionLimit × 物体尺寸，即 n ≥ max(|v| / 尺寸) × 剩余时间 / substepMotionLimit
+ *   穿透：上一个子步的最大穿透深度超过 substepPenetrationLimit 时，穿透深度大致与步长成正比，子步数按超出的倍数增加
+ *=========================================================================================================*/
+int PhysicalWorld::estimateSubsteps(const std::vector<Shape*>& shapeList, double remainingTime, int current) const {
+	double maxRate = 0.0;
+	for (size_t i = 0; i < shapeList.size(); i++) {
+		const Shape* shape = shapeList[i];
+		if (shape->isSleeping()) continue;
+		double vx, vy, minX, minY, maxX, maxY;
+		shape->getVelocity(vx, vy);
+		shape->getBoundingBox(minX, minY, maxX, maxY);
+		double size = 0.5 * std::min(maxX - minX, maxY - minY);
+		if (size <= 0.0) continue;
+		maxRate = std::max(maxRate, std::sqrt(vx * vx + vy * vy) / size);
+	}
+	
+	double needed = maxRate * remainingTime / substepMotionLimit;
+	if (worstPenetration > substepPenetrationLimit) {
+		needed = std::max(needed, std::max(current, 1) * worstPenetration / substepPenetrationLimit);
+	}
+	// 浮点误差不应让恰好整除的情况多走一步
+	int count = static_cast<int>(std::ceil(needed - 1e-9));
+	return std::max(std::max(count, current), 1);
+}
+
+/*=========================================================================================================
+ * 走一步：宽相位、划分接触岛、各个岛的整步计算，最后汇总各个岛的结果
+ *=========================================================================================================*/
+void PhysicalWorld::step(std::vector<Shape*>& shapeList, double deltaTime, const Ground& ground) {
+	// ========== 句柄：直接放进列表的形状在这里分配（数量一致时不需要逐个检查）==========
+	if (handleTable.size() != shapeList.size() + staticShapeList.size()) {
+		syncHandles(shapeList);
+	}
+	
+	// ========== 休眠：之后的各个阶段（包括宽相位）只处理清醒的物体 ==========
+	std::vector<Shape*>& activeShapes = sleepingEnabled ? collectAwakeShapes(shapeList) : shapeList;
+	if (sleepingEnabled && activeShapes.empty()) {
+		// 没有清醒的物体：整步跳过，只计算粒子（宽相位收到空列表，统计清零）
+		generateCandidatePairs(activeShapes, deltaTime);
+		islandBuilder.build(0, candidatePairs);
+		supportCheckCount = 0;
+		ccdAdvanceCount = 0;
+		staticContactCount = 0;
+		worstPenetration = 0.0;
+		sleepingShapeCount = shapeList.size();
+		if (particleSystem.isActive()) {
+			stepParticles(deltaTime, ground);
+		}
+		return;
+	}
+	
+	// ========== 宽相位（本步的候选物体对，支撑检测和碰撞处理共用）==========
+	generateCandidatePairs(activeShapes, deltaTime);
+	
+	// ========== 物体状态存储：直接放进列表的物体在这里加入，记下各物体的槽位 ==========
+	activeSlots.resize(activeShapes.size());
+	for (size_t i = 0; i < activeShapes.size(); i++) {
+		Shape* shape = activeShapes[i];
+		if (shape->getBodyStore() != &bodyStore) {
+			bodyStore.attach(shape);
+		}
+		activeSlots[i] = shape->getBodySlot();
+	}
+	
+	// ========== 休眠：约束两端的物体可能在不同的岛中，入睡与否在所有岛计算完之后统一决定 ==========
+	sleepGroupsDeferred = sleepingEnabled && constraintSolver.size() > 0;
+	if (sleepGroupsDeferred && sleepGroupParent.size() < bodyStore.size()) {
+		sleepGroupParent.resize(bodyStore.size(), -1);
+		sleepGroupMin.resize(bodyStore.size(), 0);
+	}
+	
+	// ========== 万有引力：所有物体相互吸引，在划分接触岛之前统一求出 ==========
+	if (mutualGravity) {
+		if (blockTimestepping) {
+			integrateGravityBlocks(shapeList, activeShapes, deltaTime);
+		} else {
+			computeMutualGravity(shapeList, activeShapes);
+		}
+	}
+	
+	// ========== 划分接触岛 ==========
+	// 候选对覆盖了本步所有可能的支撑和碰撞，按候选对连通的物体组成一个岛，岛与岛之间互不影响
+	islandBuilder.build(activeShapes.size(), candidatePairs);
+	const size_t islandCount = islandBuilder.getIslandCount();
+	
+	const bool useImpulseSolver = (contactSolverType == CONTACT_SOLVER_IMPULSE);
+	if (useImpulseSolver) {
+		contactCache.beginStep();
+	}
+	for (size_t w = 0; w < stepContexts.size(); w++) {
+		stepContexts[w].resetCounters();
+	}
+	
+	if (islandCount <= 1) {
+		// 只有一个岛：直接在形状列表上计算
+		StepContext& ctx = stepContexts[0];
+		ctx.pairs = &candidatePairs;
+		ctx.bodySlots = activeSlots.data();
+		stepIsland(activeShapes, ctx, deltaTime, ground);
+	} else {
+		// 工作线程会同时查询静态形状树，先在这里建好
+		if (staticTreeDirty && (continuousCollision || staticCollisions) && threadPool.getThreadCount() > 1) {
+			rebuildStaticTree();
+		}
+		threadPool.parallelFor(islandCount, [&](size_t island, int worker) {
+			StepContext& ctx = stepContexts[worker];
+			const int* bodies = islandBuilder.getBodies(island);
+			ctx.islandShapes.resize(islandBuilder.getBodyCount(island));
+			ctx.islandSlots.resize(ctx.islandShapes.size());
+			for (size_t i = 0; i < ctx.islandShapes.size(); i++) {
+				ctx.islandShapes[i] = activeShapes[bodies[i]];
+				ctx.islandSlots[i] = activeSlots[bodies[i]];
+			}
+			ctx.bodySlots = ctx.islandSlots.data();
+			const CandidatePair* pairs = islandBuilder.getPairs(island);
+			ctx.islandPairs.assign(pairs, pairs + islandBuilder.getPairCount(island));
+			ctx.pairs = &ctx.islandPairs;
+			stepIsland(ctx.islandShapes, ctx, deltaTime, ground);
+		});
+	}
+	
+	// ========== 汇总各个岛的结果 ==========
+	supportCheckCount = 0;
+	ccdAdvanceCount = 0;
+	staticContactCount = 0;
+	worstPenetration = 0.0;
+	size_t newlySleeping = 0;
+	for (size_t w = 0; w < stepContexts.size(); w++) {
+		StepContext& ctx = stepContexts[w];
+		worstPenetration = std::max(worstPenetration, ctx.maxPenetration);
+		supportCheckCount += ctx.supportCheckCount;
+		ccdAdvanceCount += ctx.ccdAdvanceCount;
+		staticContactCount += ctx.staticContactCount;
+		newlySleeping += ctx.newlySleeping;
+		if (useImpulseSolver) {
+			contactCache.getStats().accumulate(ctx.contactStats);
+			for (size_t k = 0; k < ctx.newContacts.size(); k++) {
+				contactCache.insert(ctx.newContacts[k]);
+			}
+		}
+	}
+	if (useImpulseSolver) {
+		contactCache.endStep();
+	}
+	if (sleepGroupsDeferred) {
+		newlySleeping = linkConstrainedSleepGroups(activeShapes);
+	}
+	if (sleepingEnabled) {
+		sleepingShapeCount = (shapeList.size() - activeShapes.size()) + newlySleeping;
+		// 本步入睡的物体放进休眠树（各个岛计算时不能修改共享的树）
+		if (newlySleeping > 0) {
+			for (size_t i = 0; i < activeShapes.size(); i++) {
+				if (activeShapes[i]->isSleeping()) addSleepingProxy(activeShapes[i]);
+			}
+		}
+	}
+	
+	// ========== 约束：两端的物体可能在不同的岛中，所有岛计算完之后统一求解 ==========
+	constraintSolver.solve(handleTable, bodyStore, deltaTime, &threadPool);
+	
+	// ========== 粒子：只与地面和静态形状碰撞，与物体互不影响 ==========
+	if (particleSystem.isActive()) {
+		stepParticles(deltaTime, ground);
+	}
+	dynamicIndexStale = true;
+}
+
+/*=========================================================================================================
+ * 万有引力
+ * 引力源为所有的圆（动态物体中休眠的也算，以及静态形状），受力物体为本步清醒的动态物体；
+ * 加速度按物体在 BodyStore 中的槽位存入 gravityField，第三阶段在空中的物体按它累加外力。
+ *=========================================================================================================*/
+void PhysicalWorld::computeMutualGravity(const std::vector<Shape*>& shapeList, const std::vector<Shape*>& activeShapes) {
+	gravitySourcePositions.clear();
+	gravitySourceMasses.clear();
+	const std::vector<Shape*>* sourceLists[2] = {&shapeList, &staticShapeList};
+	for (int l = 0; l < 2; l++) {
+		const std::vector<Shape*>& list = *sourceLists[l];
+		for (size_t i = 0; i < list.size(); i++) {
+			if (list[i]->getKind() != SHAPE_CIRCLE) continue;
+			double x, y;
+			list[i]->getCentre(x, y);
+			gravitySourcePositions.push_back(x);
+			gravitySourcePositions.push_back(y);
+			gravitySourceMasses.push_back(list[i]->getMass());
+		}
+	}
+	gravitySolver.build(gravitySourcePositions.data(), gravitySourceMasses.data(), gravitySourceMasses.size());
+	
+	const double* position = bodyStore.positionData();
+	const size_t count = activeShapes.size();
+	gravityTargetPositions.resize(2 * count);
+	gravityTargetAccelerations.resize(2 * count);
+	for (size_t i = 0; i < count; i++) {
+		gravityTargetPositions[2 * i] = position[2 * activeSlots[i]];
+		gravityTargetPositions[2 * i + 1] = position[2 * activeSlots[i] + 1];
+	}
+	gravitySolver.evaluate(gravityTargetPositions.data(), count, gravityTargetAccelerations.data(), &threadPool);
+	
+	gravityField.resize(2 * bodyStore.size());
+	for (size_t i = 0; i < count; i++) {
+		gravityField[2 * activeSlots[i]] = gravityTargetAccelerations[2 * i];
+		gravityField[2 * activeSlots[i] + 1] = gravityTargetAccelerations[2 * i + 1];
+	}
+}
+
+/*=========================================================================================================
+ * 分层时间步
+ * 参与的物体为本步清醒的、在空中的、有质量的动态物体（支撑状态为上一步的结果），在这里用 BlockTimestepper
+ * 走完整步，第三阶段只对它们做边界检查。其他引力源（静态的圆、休眠或被支撑的圆）在本步内不动。
+ * 帧末的加速度按槽位缓存，下一帧步首的 kick 直接使用；物体在两帧之间被移动过（碰撞分离、setCentre）
+ * 或引力源有增删时重新计算。
+ *=========================================================================================================*/
+void PhysicalWorld::integrateGravityBlocks(const std::vector<Shape*>& shapeList, const std::vector<Shape*>& activeShapes, double deltaTime) {
+	double* position = bodyStore.positionData();
+	double* velocity = bodyStore.velocityData();
+	const double* mass = bodyStore.massData();
+	const unsigned char* flags = bodyStore.flagData();
+	const size_t slotCount = bodyStore.size();
+	blockStepped.assign(slotCount, 0);
+	blockStartPositions.resize(2 * slotCount);
+	blockCachedAcceleration.resize(2 * slotCount);
+	blockCachedPosition.resize(2 * slotCount);
+	blockCacheValid.resize(slotCount, 0);
+	gravityField.assign(2 * slotCount, 0.0);       // 没有质量的物体仍走第三阶段，不受力
+	
+	blockSlots.clear();
+	blockPosition.clear();
+	blockVelocity.clear();
+	blockAcceleration.clear();
+	blockMass.clear();
+	blockSize.clear();
+	blockValid.clear();
+	blockIsSource.clear();
+	for (size_t i = 0; i < activeShapes.size(); i++) {
+		const int slot = activeSlots[i];
+		if ((flags[slot] & (BODY_SUPPORTED | BODY_STATIC)) || mass[slot] <= 0.0) continue;
+		double minX, minY, maxX, maxY;
+		activeShapes[i]->getBoundingBox(minX, minY, maxX, maxY);
+		const double* p = position + 2 * slot;
+		blockStepped[slot] = 1;
+		blockStartPositions[2 * slot] = p[0];
+		blockStartPositions[2 * slot + 1] = p[1];
+		blockSlots.push_back(slot);
+		blockPosition.push_back(p[0]);
+		blockPosition.push_back(p[1]);
+		blockVelocity.push_back(velocity[2 * slot]);
+		blockVelocity.push_back(velocity[2 * slot + 1]);
+		blockAcceleration.push_back(blockCachedAcceleration[2 * slot]);
+		blockAcceleration.push_back(blockCachedAcceleration[2 * slot + 1]);
+		blockValid.push_back(blockCacheValid[slot] && blockCachedPosition[2 * slot] == p[0] && blockCachedPosition[2 * slot + 1] == p[1]);
+		blockMass.push_back(mass[slot]);
+		blockSize.push_back(0.5 * std::min(maxX - minX, maxY - minY));
+		blockIsSource.push_back(activeShapes[i]->getKind() == SHAPE_CIRCLE);
+	}
+	
+	// 本步不动的引力源
+	gravitySourcePositions.clear();
+	gravitySourceMasses.clear();
+	const std::vector<Shape*>* sourceLists[2] = {&shapeList, &staticShapeList};
+	for (int l = 0; l < 2; l++) {
+		const std::vector<Shape*>& list = *sourceLists[l];
+		for (size_t i = 0; i < list.size(); i++) {
+			const Shape* shape = list[i];
+			if (shape->getKind() != SHAPE_CIRCLE) continue;
+			if (shape->getBodyStore() == &bodyStore && blockStepped[shape->getBodySlot()]) continue;
+			double x, y;
+			shape->getCentre(x, y);
+			gravitySourcePositions.push_back(x);
+			gravitySourcePositions.push_back(y);
+			gravitySourceMasses.push_back(shape->getMass());
+		}
+	}
+	const size_t sourceCount = gravitySourceMasses.size() + std::count(blockIsSource.begin(), blockIsSource.end(), 1);
+	if (sourceCount != blockCacheSourceCount) {
+		std::fill(blockValid.begin(), blockValid.end(), 0);
+		blockCacheSourceCount = sourceCount;
+	}
+	
+	const size_t n = blockSlots.size();
+	blockTimestepper.advance(gravitySolver, n, blockPosition.data(), blockVelocity.data(), blockAcceleration.data(),
+	                         blockValid.data(), blockMass.data(), blockSize.data(), blockIsSource.data(),
+	                         gravitySourcePositions.data(), gravitySourceMasses.data(), gravitySourceMasses.size(),
+	                         deltaTime, &threadPool);
+	
+	for (size_t i = 0; i < slotCount; i++) {
+		blockCacheValid[i] = blockStepped[i];
+	}
+	for (size_t k = 0; k < n; k++) {
+		const int slot = blockSlots[k];
+		position[2 * slot] = blockCachedPosition[2 * slot] = blockPosition[2 * k];
+		position[2 * slot + 1] = blockCachedPosition[2 * slot + 1] = blockPosition[2 * k + 1];
+		velocity[2 * slot] = blockVelocity[2 * k];
+		velocity[2 * slot + 1] = blockVelocity[2 * k + 1];
+		blockCachedAcceleration[2 * slot] = blockAcceleration[2 * k];
+		blockCachedAcceleration[2 * slot + 1] = blockAcceleration[2 * k + 1];
+	}
+}
+
+/*=========================================================================================================
+ * 约束
+ * 约束按句柄保存两端的形状，所以形状需要已经加入世界（addDynamicShape / addStaticShape，或已经参与过一步）
+ *=========================================================================================================*/
+int PhysicalWorld::addConstraint(ConstraintType type, Shape* a, Shape* b, double x, double y, double length, double compliance) {
+	if (a == nullptr || handleTable.resolve(a->getHandle()) != a) return -1;
+	if (b != nullptr && handleTable.resolve(b->getHandle()) != b) return -1;
+	
+	double ax, ay;
+	a->getCentre(ax, ay);
+	if (b != nullptr) {
+		b->getCentre(x, y);
+	}
+	if (length < 0.0) {
+		length = std::sqrt((x - ax) * (x - ax) + (y - ay) * (y - ay));
+	}
+	return constraintSolver.add(type, a->getHandle(), b != nullptr ? b->getHandle() : ShapeHandle(), x, y, length, compliance);
+}
+
+int PhysicalWorld::addDistanceConstraint(Shape* a, Shape* b, double length, double compliance) {
+	if (b == nullptr) return -1;
+	return addConstraint(CONSTRAINT_DISTANCE, a, b, 0.0, 0.0, length, compliance);
+}
+
+int PhysicalWorld::addRopeConstraint(Shape* a, Shape* b, double maxLength, double compliance) {
+	if (b == nullptr) return -1;
+	return addConstraint(CONSTRAINT_ROPE, a, b, 0.0, 0.0, maxLength, compliance);
+}
+
+int PhysicalWorld::addPinConstraint(Shape* shape, double x, double y, double length, double compliance) {
+	return addConstraint(CONSTRAINT_PIN, shape, nullptr, x, y, length, compliance);
+}
+
+int PhysicalWorld::addAnchoredRopeConstraint(Shape* shape, double x, double y, double maxLength, double compliance) {
+	return addConstraint(CONSTRAINT_ROPE, shape, nullptr, x, y, maxLength, compliance);
+}
+
+/*=========================================================================================================
+ * 粒子
+ * 静态形状中的墙壁、矩形按盒子处理，圆按圆处理，斜坡按线段处理，地面形状不参与（地面为传入的 ground）；
+ * 关闭 staticCollisions 时粒子也不与静态形状碰撞。
+ *=========================================================================================================*/
+void PhysicalWorld::stepParticles(double deltaTime, const Ground& ground) {
+	ParticleSystem::ColliderQuery query;
+	if (staticCollisions && !staticShapeList.empty()) {
+		// 工作线程会同时查询静态形状树，先在这里建好
+		if (staticTreeDirty) {
+			rebuildStaticTree();
+		}
+		query = [this](const BroadphaseBounds& area, std::vector<ParticleCollider>& result, int worker) {
+			StepContext& ctx = stepContexts[worker];
+			std::vector<Shape*>& shapes = ctx.staticContactQuery;
+			shapes.clear();
+			queryStaticShapes(area, shapes, ctx.staticQueryResult, ctx.staticQueryStack);
+			for (size_t k = 0; k < shapes.size(); k++) {
+				const Shape& shape = *shapes[k];
+				const ShapeKind kind = shape.getKind();
+				if (kind != SHAPE_WALL && kind != SHAPE_AABB && kind != SHAPE_CIRCLE && kind != SHAPE_SLOPE) continue;
+				ParticleCollider c;
+				shape.getBoundingBox(c.minX, c.minY, c.maxX, c.maxY);
+				shape.getCentre(c.cx, c.cy);
+				c.radius = 0.0;
+				c.ax = c.ay = c.bx = c.by = 0.0;
+				if (kind == SHAPE_CIRCLE) {
+					c.kind = ParticleCollider::CIRCLE;
+					c.radius = static_cast<const Circle&>(shape).getRadius();
+				} else if (kind == SHAPE_SLOPE) {
+					// 斜坡按从质心向两边各延伸半个长度的线段处理（与绘制的斜坡一致）
+					const Slope& slope = static_cast<const Slope&>(shape);
+					const double hx = 0.5 * slope.getLength() * std::cos(slope.getAngle());
+					const double hy = 0.5 * slope.getLength() * std::sin(slope.getAngle());
+					c.kind = ParticleCollider::SEGMENT;
+					c.ax = c.cx - hx;
+					c.ay = c.cy - hy;
+					c.bx = c.cx + hx;
+					c.by = c.cy + hy;
+				} else {
+					c.kind = ParticleCollider::BOX;
+				}
+				result.push_back(c);
+			}
+		};
+	}
+	
+	BroadphaseBounds area;
+	area.minX = bounds[0];
+	area.maxX = bounds[1];
+	area.minY = bounds[2];
+	area.maxY = bounds[3];
+	particleSystem.step(deltaTime, gravity, ground.getYLevel(), area, query, &threadPool);
+}
+
+/*=========================================================================================================
+ * 一个岛的整步计算
+ * 传入的形状列表与 ctx.pairs 中的下标对应：只有一个岛时是整个（清醒物体的）列表，否则是岛内的物体。
+ *=========================================================================================================*/
+void PhysicalWorld::stepIsland(std::vector<Shape*>& shapeList, StepContext& ctx, double deltaTime, const Ground& ground) {
 	// ========== 第一阶段：重置支撑状态 ==========
 	resetSupportStates(shapeList);
 	
 	// ========== 第二阶段：检测支撑关系 ==========
-	detectSupportRelations(shapeList, ground);
+	detectSupportRelations(shapeList, ctx, ground);
 	
 	// ========== 第二点五阶段：计算正压力（从上往下累积）==========
-	calculateNormalForces(shapeList);
+	calculateNormalForces(shapeList, ctx);
 	
 	// ========== 第三阶段：物理更新 ==========
-	updatePhysics(shapeList, deltaTime, ground);
+	updatePhysics(shapeList, ctx, deltaTime, ground);
+	
+	// ========== 第三点五阶段：连续碰撞检测（高速圆不穿过薄物体）==========
+	handleContinuousCollisions(shapeList, ctx);
 	
 	// ========== 第四阶段：碰撞检测和处理 ==========
-	handleAllCollisions(shapeList);
+	handleAllCollisions(shapeList, ctx);
+	
+	// ========== 第四点五阶段：与静态形状的碰撞 ==========
+	handleStaticCollisions(shapeList, ctx);
+	
+	// ========== 第五阶段：更新休眠状态 ==========
+	if (sleepingEnabled) {
+		updateSleepStates(shapeList, ctx);
+	}
+}
+
+void PhysicalWorld::StepContext::resetCounters() {
+	supportCheckCount = 0;
+	ccdAdvanceCount = 0;
+	staticContactCount = 0;
+	newlySleeping = 0;
+	maxPenetration = 0.0;
+	contactStats = ContactStats();
+	newContacts.clear();
+}
+
+void PhysicalWorld::setWorkerThreads(int count) {
+	threadPool.setThreadCount(count);
+	stepContexts.resize(threadPool.getThreadCount());
+	setNarrowphaseISA(narrowphaseISA);
+}
+
+void PhysicalWorld::setNarrowphaseISA(NarrowphaseISA isa) {
+	for (size_t w = 0; w < stepContexts.size(); w++) {
+		stepContexts[w].narrowphase.setISA(isa);
+	}
+	narrowphaseISA = stepContexts[0].narrowphase.getISA();
 }
 
 /*=========================================================================================================
@@ -312,99 +768,481 @@ void PhysicalWorld::resetSupportStates(std::vector<Shape*>& shapeList) {
 	}
 }
 
+/*=========================================================================================================
+ * 第一点五阶段：宽相位
+ * 在一步开始时生成一次候选物体对。包围盒按速度和时间步长额外放大，
+ * 覆盖物理更新阶段的位移，所以同一份候选对可以直接用于之后的碰撞处理。
+ *=========================================================================================================*/
+void PhysicalWorld::generateCandidatePairs(std::vector<Shape*>& shapeList, double deltaTime) {
+	// 加速度上限：重力加上同量级的摩擦力
+	Broadphase& broadphase = activeBroadphase();
+	broadphase.setPrediction(deltaTime, 2.0 * gravity);
+	broadphase.update(shapeList);
+	broadphase.computePairs(candidatePairs);
+}
+
+/*=========================================================================================================
+ * 休眠：收集本步参与计算的物体
+ * 
+ * 休眠的物体放在 sleepingTree 中（休眠期间不动，树不需要更新），不参与每步的宽相位。每步：
+ *   1. 在两步之间被 setVelocity、setCentre 等唤醒的物体（BodyStore 记下了它们的句柄）移出休眠树
+ *   2. 只有在有物体入睡、醒来或增删之后，才按列表顺序重新收集清醒的物体
+ *   3. 每个清醒的物体用自己的包围盒查询休眠树，与它实际接触或通过约束相连的休眠物体被唤醒，
+ *      被唤醒的物体继续查询，与它相连的休眠物体也一起醒来（一整摞休眠的方块被碰到底部时一起醒来）
+ * 所有物体都在休眠且没有被唤醒时，每步的开销与休眠物体的数量无关。
+ *=========================================================================================================*/
+std::vector<Shape*>& PhysicalWorld::collectAwakeShapes(std::vector<Shape*>& shapeList) {
+	// 直接修改过形状列表（没有通过 add / remove）：休眠树从头重建
+	if (sleepingTreeList != &shapeList || sleepingTreeListSize != shapeList.size()) {
+		rebuildSleepingTree(shapeList);
+	}
+	
+	// 1. 两步之间醒来的物体
+	std::vector<ShapeHandle>& woken = bodyStore.getWokenHandles();
+	for (size_t k = 0; k < woken.size(); k++) {
+		Shape* shape = handleTable.resolve(woken[k]);
+		if (shape != nullptr && !shape->isSleeping()) removeSleepingProxy(shape);
+	}
+	woken.clear();
+	
+	// 2. 收集清醒的物体
+	if (awakeListDirty) {
+		gatherAwakeShapes(shapeList);
+	}
+	
+	// 3. 接触唤醒
+	if (sleepingTree.getProxyCount() > 0) {
+		bool woke = false;
+		const size_t awakeCount = awakeShapes.size();
+		for (size_t i = 0; i < awakeCount; i++) {
+			if (wakeTouchingSleepers(awakeShapes[i])) woke = true;
+		}
+		if (woke) {
+			bodyStore.getWokenHandles().clear();   // 已经移出休眠树
+			gatherAwakeShapes(shapeList);
+		}
+	}
+	return awakeShapes;
+}
+
+void PhysicalWorld::gatherAwakeShapes(const std::vector<Shape*>& shapeList) {
+	awakeShapes.clear();
+	for (size_t i = 0; i < shapeList.size(); i++) {
+		Shape* shape = shapeList[i];
+		if (!shape->isSleeping()) {
+			awakeShapes.push_back(shape);
+		} else {
+			addSleepingProxy(shape);   // 直接调用 putToSleep 的物体也放进休眠树
+		}
+	}
+	awakeListDirty = false;
+}
+
+bool PhysicalWorld::wakeTouchingSleepers(Shape* seed) {
+	bool woke = false;
+	wakeStack.clear();
+	wakeStack.push_back(seed);
+	while (!wakeStack.empty()) {
+		Shape* shape = wakeStack.back();
+		wakeStack.pop_back();
+		BroadphaseBounds bounds;
+		shape->getBoundingBox(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+		sleepQueryResult.clear();
+		if (bounds.isFinite()) {
+			sleepingTree.query(bounds, sleepQueryResult);
+		}
+		for (size_t k = 0; k < sleepQueryResult.size(); k++) {
+			Shape* other = sleepingProxies[sleepQueryResult[k]].shape;
+			if (other == nullptr || !shape->check_collision(*other)) continue;
+			removeSleepingProxy(other);
+			other->wakeUp();
+			wakeStack.push_back(other);
+			woke = true;
+		}
+		
+		// 通过约束相连的休眠物体
+		size_t linkCount = 0;
+		const ShapeHandle* linked = constraintSolver.getLinkedShapes(shape->getHandle(), linkCount);
+		for (size_t k = 0; k < linkCount; k++) {
+			Shape* other = handleTable.resolve(linked[k]);
+			if (other == nullptr || !other->isSleeping()) continue;
+			removeSleepingProxy(other);
+			other->wakeUp();
+			wakeStack.push_back(other);
+			woke = true;
+		}
+	}
+	return woke;
+}
+
+void PhysicalWorld::addSleepingProxy(Shape* shape) {
+	const ShapeHandle handle = shape->getHandle();
+	if (handle.isNull()) return;
+	const size_t index = handle.index();
+	if (index >= sleepingProxies.size()) {
+		SleepingProxy empty = {DynamicAABBTree::NULL_NODE, nullptr};
+		sleepingProxies.resize(index + 1, empty);
+	}
+	SleepingProxy& entry = sleepingProxies[index];
+	if (entry.proxy != DynamicAABBTree::NULL_NODE) return;
+	BroadphaseBounds bounds;
+	shape->getBoundingBox(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+	if (!bounds.isFinite()) return;
+	entry.proxy = sleepingTree.createProxy(bounds, static_cast<int>(index), 0.0);
+	entry.shape = shape;
+	awakeListDirty = true;
+}
+
+void PhysicalWorld::removeSleepingProxy(Shape* shape) {
+	const ShapeHandle handle = shape->getHandle();
+	if (handle.isNull() || handle.index() >= sleepingProxies.size()) return;
+	SleepingProxy& entry = sleepingProxies[handle.index()];
+	if (entry.proxy == DynamicAABBTree::NULL_NODE || entry.shape != shape) return;
+	sleepingTree.destroyProxy(entry.proxy);
+	entry.proxy = DynamicAABBTree::NULL_NODE;
+	entry.shape = nullptr;
+	awakeListDirty = true;
+}
+
+void PhysicalWorld::rebuildSleepingTree(const std::vector<Shape*>& shapeList) {
+	resetSleepingTree();
+	for (size_t i = 0; i < shapeList.size(); i++) {
+		if (shapeList[i]->isSleeping()) addSleepingProxy(shapeList[i]);
+	}
+	sleepingTreeList = &shapeList;
+	sleepingTreeListSize = shapeList.size();
+}
+
+void PhysicalWorld::resetSleepingTree() {
+	sleepingTree.clear();
+	sleepingProxies.clear();
+	sleepingTreeList = nullptr;
+	sleepingTreeListSize = 0;
+	awakeListDirty = true;
+}
+
+/*=========================================================================================================
+ * 休眠：按岛更新休眠状态
+ * 每个物体记录连续低速且被支撑的步数；本步实际接触的物体对和支撑关系把物体连成岛，
+ * 岛内所有物体都达到 sleepSteps 时，整个岛进入休眠（速度清零）。
+ *=========================================================================================================*/
+void PhysicalWorld::updateSleepStates(std::vector<Shape*>& activeShapes, StepContext& ctx) {
+	const size_t n = activeShapes.size();
+	const double thresholdSquared = sleepVelocityThreshold * sleepVelocityThreshold;
+	
+	for (size_t i = 0; i < n; i++) {
+		Shape* shape = activeShapes[i];
+		double vx, vy;
+		shape->getVelocity(vx, vy);
+		if (shape->getIsSupported() && vx * vx + vy * vy <= thresholdSquared) {
+			shape->sleepCounter++;
+		} else {
+			shape->sleepCounter = 0;
+		}
+	}
+	
+	std::vector<int>& parent = ctx.sleepParent;
+	parent.resize(n);
+	for (size_t i = 0; i < n; i++) parent[i] = static_cast<int>(i);
+	for (size_t k = 0; k < ctx.touchingPairs.size(); k++) {
+		mergeIslandRoots(parent, ctx.touchingPairs[k].first, ctx.touchingPairs[k].second);
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (ctx.supportParent[i] >= 0) mergeIslandRoots(parent, static_cast<int>(i), ctx.supportParent[i]);
+	}
+	
+	ctx.sleepMinCounter.assign(n, sleepSteps);
+	for (size_t i = 0; i < n; i++) {
+		int root = findIslandRoot(parent, static_cast<int>(i));
+		ctx.sleepMinCounter[root] = std::min(ctx.sleepMinCounter[root], activeShapes[i]->sleepCounter);
+	}
+	
+	if (sleepGroupsDeferred) {
+		// 记下各物体所在的组（按 BodyStore 槽位，不同岛的槽位互不相同），由 linkConstrainedSleepGroups 决定
+		for (size_t i = 0; i < n; i++) {
+			const int root = findIslandRoot(parent, static_cast<int>(i));
+			const int slot = ctx.bodySlots[i];
+			sleepGroupParent[slot] = ctx.bodySlots[root];
+			if (root == static_cast<int>(i)) sleepGroupMin[slot] = ctx.sleepMinCounter[root];
+		}
+		return;
+	}
+	
+	for (size_t i = 0; i < n; i++) {
+		if (ctx.sleepMinCounter[findIslandRoot(parent, static_cast<int>(i))] >= sleepSteps) {
+			activeShapes[i]->putToSleep();
+			ctx.newlySleeping++;
+		}
+	}
+}
+
+/*=========================================================================================================
+ * 休眠：按约束合并休眠组
+ * 约束两端都清醒时合并两端所在的组（组内最小的低速步数取两者的较小值），合并后组内全部满足条件才一起入睡，
+ * 不会出现一端休眠、另一端被约束拖动的情况。用过的并查集项恢复为 -1，不在本步计算中的槽位始终为 -1。
+ *=========================================================================================================*/
+size_t PhysicalWorld::linkConstrainedSleepGroups(std::vector<Shape*>& activeShapes) {
+	std::vector<int>& parent = sleepGroupParent;
+	const std::vector<std::pair<ShapeHandle, ShapeHandle> >& links = constraintSolver.getLinks();
+	for (size_t k = 0; k < links.size(); k++) {
+		Shape* a = handleTable.resolve(links[k].first);
+		Shape* b = handleTable.resolve(links[k].second);
+		if (a == nullptr || b == nullptr || a->getBodyStore() != &bodyStore || b->getBodyStore() != &bodyStore) continue;
+		const int slotA = a->getBodySlot();
+		const int slotB = b->getBodySlot();
+		if (parent[slotA] < 0 || parent[slotB] < 0) continue;   // 一端是不在本步计算中的物体
+		const int rootA = findIslandRoot(parent, slotA);
+		const int rootB = findIslandRoot(parent, slotB);
+		if (rootA == rootB) continue;
+		const int minCounter = std::min(sleepGroupMin[rootA], sleepGroupMin[rootB]);
+		mergeIslandRoots(parent, rootA, rootB);
+		sleepGroupMin[findIslandRoot(parent, rootA)] = minCounter;
+	}
+	
+	size_t newlySleeping = 0;
+	for (size_t i = 0; i < activeShapes.size(); i++) {
+		if (sleepGroupMin[findIslandRoot(parent, activeSlots[i])] >= sleepSteps) {
+			activeShapes[i]->putToSleep();
+			newlySleeping++;
+		}
+	}
+	for (size_t i = 0; i < activeShapes.size(); i++) {
+		parent[activeSlots[i]] = -1;
+	}
+	return newlySleeping;
+}
+
+void PhysicalWorld::setSleepingEnabled(bool enabled) {
+	sleepingEnabled = enabled;
+	if (!enabled) wakeAll();
+}
+
+void PhysicalWorld::wakeAll() {
+	for (size_t i = 0; i < dynamicShapeList.size(); i++) {
+		dynamicShapeList[i]->wakeUp();
+	}
+	bodyStore.getWokenHandles().clear();
+	resetSleepingTree();
+	sleepingShapeCount = 0;
+}
+
 /*=========================================================================================================
  * 第二阶段：检测支撑关系
  * 检测每个物体是否被地面或其他物体支撑
+ * 
+ * 只检查宽相位给出的候选物体对（包围盒不重叠的物体不可能互相支撑）。
+ * 候选对按 (i, j) 排序，所以对每个物体来说，候选支撑物仍按列表顺序依次检查，
+ * 与原来的双重循环结果完全相同。
  *=========================================================================================================*/
-void PhysicalWorld::detectSupportRelations(std::vector<Shape*>& shapeList, const Ground& ground) {
+void PhysicalWorld::detectSupportRelations(std::vector<Shape*>& shapeList, StepContext& ctx, const Ground& ground) {
+	const std::vector<CandidatePair>& candidatePairs = *ctx.pairs;
+	
+	// 检查与地面的支撑
 	for (auto& shape : shapeList) {
-		// 检查与地面的支撑
 		if (shape->HasCollidedWithGround(ground.getYLevel())) {
 			shape->setIsSupported(true);
 			shape->setSupporter(nullptr); // 地面没有 Shape 对象，设为 nullptr
 		}
-		
-		// 检查与其他物体的支撑（从下往上检查）
-		for (auto& other : shapeList) {
-			if (shape != other) {
-				shape->checkSupportStatus(*other);
-			}
-		}
 	}
+	
+	// 检查与其他物体的支撑（每个候选对双向检查）
+	for (size_t k = 0; k < candidatePairs.size(); k++) {
+		Shape* shape1 = shapeList[candidatePairs[k].first];
+		Shape* shape2 = shapeList[candidatePairs[k].second];
+		shape1->checkSupportStatus(*shape2);
+		shape2->checkSupportStatus(*shape1);
+	}
+	ctx.supportCheckCount += 2 * candidatePairs.size();
 }
 
 /*=========================================================================================================
  * 第二点五阶段：计算正压力（从上往下累积）
  * 计算每个物体对其支撑物施加的正压力（包括上方所有物体的重力）
+ * 
+ * 先建立支撑森林（每个物体指向自己的支撑物，地面上的物体为根），
+ * 再从叶子往根按拓扑顺序累加一遍，总代价 O(n)。
  *=========================================================================================================*/
-void PhysicalWorld::calculateNormalForces(std::vector<Shape*>& shapeList) {
+void PhysicalWorld::calculateNormalForces(std::vector<Shape*>& shapeList, StepContext& ctx) {
+	const size_t n = shapeList.size();
+	std::vector<int>& supportParent = ctx.supportParent;
+	std::vector<int>& supportChildStart = ctx.supportChildStart;
+	std::vector<int>& supportChildren = ctx.supportChildren;
+	std::vector<int>& supportPending = ctx.supportPending;
+	std::vector<int>& supportStack = ctx.supportStack;
+	
 	// 清空所有物体的 normalforce
 	for (auto& shape : shapeList) {
 		shape->normalforce[0] = 0.0;
 		shape->normalforce[1] = 0.0;
 	}
 	
-	// 从上往下递归计算正压力
-	for (auto& shape : shapeList) {
-		calculateNormalForceRecursive(shape, shapeList);
+	buildSupportForest(shapeList, ctx);
+	
+	// 计算自身在垂直于斜面方向的重力分量
+	const double PI = 3.14159265358979323846;
+	double angleRad = inclineAngle * PI / 180.0;
+	double cosAngle = std::cos(angleRad);
+	
+	// 从叶子（上面没有压着任何物体）开始，子节点全部算完后父节点才入栈
+	supportPending.resize(n);
+	supportStack.clear();
+	for (size_t i = 0; i < n; i++) {
+		supportPending[i] = supportChildStart[i + 1] - supportChildStart[i];
+		if (supportPending[i] == 0) {
+			supportStack.push_back(static_cast<int>(i));
+		}
+	}
+	
+	while (!supportStack.empty()) {
+		int index = supportStack.back();
+		supportStack.pop_back();
+		Shape* shape = shapeList[index];
+		
+		// 自身重力 + 压在上面的物体的正压力（已经包含了它们上方所有物体的重力），按列表顺序累加
+		double totalWeight = shape->getMass() * gravity * cosAngle;
+		for (int k = supportChildStart[index]; k < supportChildStart[index + 1]; k++) {
+			totalWeight += std::abs(shapeList[supportChildren[k]]->normalforce[1]);
+		}
+		
+		// 记录这个物体对下方施加的正压力（向下为负）
+		shape->normalforce[1] = -totalWeight;
+		
+		int parent = supportParent[index];
+		if (parent >= 0 && --supportPending[parent] == 0) {
+			supportStack.push_back(parent);
+		}
 	}
 }
 
 /*=========================================================================================================
- * 递归计算正压力
- * 计算物体及其上方所有物体的总重力，并记录到 normalforce 中
+ * 建立支撑森林
+ * 支撑关系只可能出现在候选物体对之间，所以直接从本步的候选对中找出每个物体的支撑物下标，
+ * 再按 CSR 格式（supportChildStart / supportChildren）记录每个物体上面压着的物体，子节点按列表顺序排列。
  *=========================================================================================================*/
-void PhysicalWorld::calculateNormalForceRecursive(Shape* shape, std::vector<Shape*>& shapeList) {
-	// 如果已经计算过，直接返回
-	if (shape->normalforce[1] != 0.0) {
-		return;
+void PhysicalWorld::buildSupportForest(std::vector<Shape*>& shapeList, StepContext& ctx) {
+	const size_t n = shapeList.size();
+	const std::vector<CandidatePair>& candidatePairs = *ctx.pairs;
+	std::vector<int>& supportParent = ctx.supportParent;
+	std::vector<int>& supportChildStart = ctx.supportChildStart;
+	std::vector<int>& supportChildren = ctx.supportChildren;
+	std::vector<int>& supportPending = ctx.supportPending;
+	supportParent.assign(n, -1);
+	for (size_t k = 0; k < candidatePairs.size(); k++) {
+		int i = candidatePairs[k].first;
+		int j = candidatePairs[k].second;
+		if (shapeList[i]->getSupporter() == shapeList[j]) {
+			supportParent[i] = j;
+		} else if (shapeList[j]->getSupporter() == shapeList[i]) {
+			supportParent[j] = i;
+		}
 	}
 	
-	// 计算自身在垂直于斜面方向的重力分量
-	const double PI = 3.14159265358979323846;
-	double angleRad = inclineAngle * PI / 180.0;
-	double totalWeight = shape->getMass() * gravity * std::cos(angleRad);
-	
-	// 查找压在这个物体上面的所有物体
-	for (auto& other : shapeList) {
-		if (other != shape && other->getSupporter() == shape) {
-			// other 在 shape 上面
-			// 递归计算 other 的正压力
-			calculateNormalForceRecursive(other, shapeList);
-			
-			// ✅ 修复：只累加 other 的 normalforce（已经包含了 other 及其上方所有物体的重力）
-			totalWeight += std::abs(other->normalforce[1]);
+	supportChildStart.assign(n + 1, 0);
+	for (size_t i = 0; i < n; i++) {
+		if (supportParent[i] >= 0) {
+			supportChildStart[supportParent[i] + 1]++;
 		}
 	}
+	for (size_t i = 0; i < n; i++) {
+		supportChildStart[i + 1] += supportChildStart[i];
+	}
 	
-	// 记录这个物体对下方施加的正压力（向下为负）
-	shape->normalforce[1] = -totalWeight;
+	supportChildren.resize(supportChildStart[n]);
+	supportPending.assign(supportChildStart.begin(), supportChildStart.end() - 1);
+	for (size_t i = 0; i < n; i++) {
+		int parent = supportParent[i];
+		if (parent >= 0) {
+			supportChildren[supportPending[parent]++] = static_cast<int>(i);
+		}
+	}
 }
 
 /*=========================================================================================================
  * 第三阶段：物理更新
  * 根据物体的支撑状态，施加相应的力并更新速度和位置
+ *
+ * 位置、速度、合力、质量和支撑标志直接按槽位从 BodyStore 的连续数组中读写：
+ * 在空中的物体只累加重力（开启万有引力时为 gravityField 中的引力），完全不访问 Shape 对象；被支撑的物体（摩擦力需要支撑物的信息）和边界检查仍通过 Shape。
+ * 每个物体依次完成 清空合力 → 施加力 → 积分 → 边界检查，顺序与逐个调用 Shape 方法时相同。
+ * 循环按选定的积分器实例化（integrator.h），循环内部没有按积分器的分支。
  *=========================================================================================================*/
-void PhysicalWorld::updatePhysics(std::vector<Shape*>& shapeList, double deltaTime, const Ground& ground) {
-	for (auto& shape : shapeList) {
+void PhysicalWorld::updatePhysics(std::vector<Shape*>& shapeList, StepContext& ctx, double deltaTime, const Ground& ground) {
+	switch (integratorType) {
+		case INTEGRATOR_VELOCITY_VERLET:
+			updatePhysicsWith<INTEGRATOR_VELOCITY_VERLET>(shapeList, ctx, deltaTime, ground);
+			break;
+		case INTEGRATOR_RK4:
+			updatePhysicsWith<INTEGRATOR_RK4>(shapeList, ctx, deltaTime, ground);
+			break;
+		case INTEGRATOR_LEAPFROG:
+			updatePhysicsWith<INTEGRATOR_LEAPFROG>(shapeList, ctx, deltaTime, ground);
+			break;
+		default:
+			updatePhysicsWith<INTEGRATOR_SEMI_IMPLICIT_EULER>(shapeList, ctx, deltaTime, ground);
+			break;
+	}
+}
+
+template <IntegratorType Type>
+void PhysicalWorld::updatePhysicsWith(std::vector<Shape*>& shapeList, StepContext& ctx, double deltaTime, const Ground& ground) {
+	const int* slots = ctx.bodySlots;
+	double* position = bodyStore.positionData();
+	double* velocity = bodyStore.velocityData();
+	double* force = bodyStore.forceData();
+	const double* mass = bodyStore.massData();
+	const unsigned char* flags = bodyStore.flagData();
+	
+	// 记录更新前的位置，连续碰撞检测用它和更新后的位置得到本步的位移
+	// （已由分层时间步积分的物体取积分前的位置）
+	const bool blockStepping = mutualGravity && blockTimestepping;
+	std::vector<double>& stepStartPositions = ctx.stepStartPositions;
+	stepStartPositions.resize(shapeList.size() * 2);
+	for (size_t i = 0; i < shapeList.size(); i++) {
+		const int slot = slots[i];
+		const double* start = (blockStepping && blockStepped[slot]) ? &blockStartPositions[2 * slot] : position + 2 * slot;
+		stepStartPositions[2 * i] = start[0];
+		stepStartPositions[2 * i + 1] = start[1];
+	}
+	
+	for (size_t i = 0; i < shapeList.size(); i++) {
+		const int slot = slots[i];
+		double* f = force + 2 * slot;
+		double* v = velocity + 2 * slot;
+		double* p = position + 2 * slot;
+		
 		// 清空上一帧的力累加器
-		shape->clearTotalForce();
+		f[0] = 0.0;
+		f[1] = 0.0;
+		
+		// 已由分层时间步积分：只检查边界
+		if (blockStepping && blockStepped[slot]) {
+			handleBoundaryCollision(*shapeList[i]);
+			continue;
+		}
 		
 		// 根据支撑状态分别处理
-		if (shape->getIsSupported()) {
-			handleSupportedShape(shape, deltaTime, ground);
+		if (flags[slot] & BODY_SUPPORTED) {
+			handleSupportedShape(shapeList[i], deltaTime, ground);
+		} else if (mutualGravity) {
+			// 在空中：受所有圆的引力
+			f[0] += gravityField[2 * slot] * mass[slot];
+			f[1] += gravityField[2 * slot + 1] * mass[slot];
 		} else {
-			handleAirborneShape(shape, deltaTime);
+			// 在空中：只施加重力（与 Shape::applyGravity 相同）
+			f[0] += 0.0;
+			f[1] += -gravity * mass[slot];
 		}
 		
-		// 应用累加的力到速度
-		shape->applyTotalForce(deltaTime);
-		
-		// 更新位置
-		shape->update(deltaTime);
+		// 应用累加的力，更新速度和位置（静态形状不移动，与 StaticShape::update 相同）
+		if (flags[slot] & BODY_STATIC) {
+			integrateBodyVelocity(mass[slot], v, f, deltaTime);
+		} else {
+			integrateBodyMotion<Type>(mass[slot], p, v, f, deltaTime, (flags[slot] & BODY_SUPPORTED) != 0,
+			                          (flags[slot] & BODY_CONSTRAINED) != 0);
+		}
 		
 		// 检查与边界的碰撞
-		handleBoundaryCollision(*shape);
+		handleBoundaryCollision(*shapeList[i]);
 	}
 }
 
@@ -474,90 +1312,686 @@ void PhysicalWorld::handleSupportedShape(Shape* shape, double deltaTime, const G
 		applyFrictionOnSupporter(shape, supporter, normalForce, friction, static_friction, drivingForce);
 	}
 	
-	// 4. 最后施加沿斜面的重力分量（驱动力）
-	shape->addToTotalForce(drivingForce, 0.0);
+	// 4. 最后施加沿斜面的重力分量（驱动力）
+	shape->addToTotalForce(drivingForce, 0.0);
+}
+
+/*=========================================================================================================
+ * 处理在空中的物体（自由落体）
+ *=========================================================================================================*/
+void PhysicalWorld::handleAirborneShape(Shape* shape, double deltaTime) {
+	// 在空中：只施加重力
+	shape->applyGravity(gravity);
+}
+
+/*=========================================================================================================
+ * 在支撑物上施加摩擦力（包括牛顿第三定律反作用力）
+ * 使用 Shape 的 applyFrictionRelative() 方法
+ *=========================================================================================================*/
+void PhysicalWorld::applyFrictionOnSupporter(Shape* shape, Shape* supporter, double normalForce, double friction, double static_friction, double drivingForce) {
+	// 获取支撑物速度
+	double supVx, supVy;
+	supporter->getVelocity(supVx, supVy);
+	
+	// ✅ 使用 Shape::applyFrictionRelative() 计算相对摩擦力
+	shape->applyFrictionRelative(normalForce, friction, static_friction, supVx, supVy, drivingForce);
+	
+	// ✅ 计算反作用力（牛顿第三定律）
+	double shapeVx, shapeVy;
+	shape->getVelocity(shapeVx, shapeVy);
+	
+	// 计算相对速度
+	double relVx = shapeVx - supVx;
+	double relSpeed = std::sqrt(relVx * relVx);
+	
+	if (relSpeed > 1e-6) {
+		// 摩擦力大小
+		double frictionMag = friction * normalForce;
+		// 摩擦力方向（与相对速度相反）
+		double dirX = -relVx / relSpeed;
+		
+		// 对支撑物施加反作用力
+		supporter->addToTotalForce(-frictionMag * dirX, 0.0);
+	}
+}
+
+/*=========================================================================================================
+ * 第三点五阶段：连续碰撞检测（保守推进）
+ * 
+ * 只处理本步位移超过 ccdMotionThreshold × 半径的圆：
+ *   1. 动态物体：候选物体对的包围盒已经按速度放大，覆盖了整步的位移，直接用相对位移扫掠
+ *   2. 静态物体：用扫掠区域查询静态形状树
+ * 有碰撞时把圆放回第一次接触的位置（稍微压入一点，保证随后的离散碰撞处理能检测到），剩余的时间不再推进；
+ * 最早碰到的是墙壁时直接按墙壁碰撞处理速度。
+ *=========================================================================================================*/
+// 扫掠目标：以 (x, y) 为中心的圆或矩形；Slope / Ground 不参与
+static bool sweepCircleAgainst(double x, double y, double dx, double dy, double radius,
+                               const Shape& other, double otherX, double otherY, double& toi) {
+	switch (other.getKind()) {
+		case SHAPE_CIRCLE:
+			return sweepCircleCircle(x, y, dx, dy, radius, otherX, otherY, static_cast<const Circle&>(other).getRadius(), toi);
+		case SHAPE_AABB: {
+			const AABB& box = static_cast<const AABB&>(other);
+			double hw = box.getWidth() / 2.0, hh = box.getHeight() / 2.0;
+			return sweepCircleRect(x, y, dx, dy, radius, otherX - hw, otherY - hh, otherX + hw, otherY + hh, toi);
+		}
+		case SHAPE_WALL: {
+			const Wall& wall = static_cast<const Wall&>(other);
+			double hw = wall.getWidth() / 2.0, hh = wall.getHeight() / 2.0;
+			return sweepCircleRect(x, y, dx, dy, radius, otherX - hw, otherY - hh, otherX + hw, otherY + hh, toi);
+		}
+		default:
+			return false;
+	}
+}
+
+void PhysicalWorld::handleContinuousCollisions(std::vector<Shape*>& shapeList, StepContext& ctx) {
+	if (!continuousCollision) return;
+	const std::vector<CandidatePair>& candidatePairs = *ctx.pairs;
+	const std::vector<double>& stepStartPositions = ctx.stepStartPositions;
+	std::vector<double>& ccdTimeOfImpact = ctx.ccdTimeOfImpact;
+	std::vector<const Shape*>& ccdStaticHit = ctx.ccdStaticHit;
+	std::vector<Shape*>& ccdStaticQuery = ctx.ccdStaticQuery;
+	
+	// 找出本步位移超过阈值的圆
+	const size_t n = shapeList.size();
+	ccdTimeOfImpact.assign(n, 2.0);
+	bool anyFast = false;
+	for (size_t i = 0; i < n; i++) {
+		if (shapeList[i]->getKind() != SHAPE_CIRCLE) continue;
+		double x, y;
+		shapeList[i]->getCentre(x, y);
+		double dx = x - stepStartPositions[2 * i];
+		double dy = y - stepStartPositions[2 * i + 1];
+		double limit = ccdMotionThreshold * static_cast<const Circle*>(shapeList[i])->getRadius();
+		if (dx * dx + dy * dy > limit * limit) {
+			ccdTimeOfImpact[i] = 1.0;
+			anyFast = true;
+		}
+	}
+	if (!anyFast) return;
+	ccdStaticHit.assign(n, nullptr);
+	
+	// 1. 动态物体之间：使用相对位移，另一个物体视为停在本步开始时的位置
+	for (size_t k = 0; k < candidatePairs.size(); k++) {
+		const int pair[2] = {candidatePairs[k].first, candidatePairs[k].second};
+		for (int side = 0; side < 2; side++) {
+			int i = pair[side];
+			int j = pair[1 - side];
+			if (ccdTimeOfImpact[i] > 1.0) continue;
+			// 支撑关系由支撑检测处理
+			if (shapeList[i]->getSupporter() == shapeList[j] || shapeList[j]->getSupporter() == shapeList[i]) continue;
+			
+			double xi, yi, xj, yj;
+			shapeList[i]->getCentre(xi, yi);
+			shapeList[j]->getCentre(xj, yj);
+			double dx = (xi - stepStartPositions[2 * i]) - (xj - stepStartPositions[2 * j]);
+			double dy = (yi - stepStartPositions[2 * i + 1]) - (yj - stepStartPositions[2 * j + 1]);
+			double radius = static_cast<const Circle*>(shapeList[i])->getRadius();
+			double toi;
+			if (sweepCircleAgainst(stepStartPositions[2 * i], stepStartPositions[2 * i + 1], dx, dy, radius,
+			                       *shapeList[j], stepStartPositions[2 * j], stepStartPositions[2 * j + 1], toi)
+			    && toi < ccdTimeOfImpact[i]) {
+				ccdTimeOfImpact[i] = toi;
+			}
+		}
+	}
+	
+	// 2. 静态物体：查询扫掠区域内的静态形状
+	for (size_t i = 0; i < n; i++) {
+		if (ccdTimeOfImpact[i] > 1.0) continue;
+		double x0 = stepStartPositions[2 * i], y0 = stepStartPositions[2 * i + 1];
+		double x1, y1;
+		shapeList[i]->getCentre(x1, y1);
+		double radius = static_cast<const Circle*>(shapeList[i])->getRadius();
+		
+		BroadphaseBounds swept;
+		swept.minX = std::min(x0, x1) - radius;
+		swept.minY = std::min(y0, y1) - radius;
+		swept.maxX = std::max(x0, x1) + radius;
+		swept.maxY = std::max(y0, y1) + radius;
+		ccdStaticQuery.clear();
+		queryStaticShapes(swept, ccdStaticQuery, ctx.staticQueryResult, ctx.staticQueryStack);
+		
+		for (size_t k = 0; k < ccdStaticQuery.size(); k++) {
+			const Shape& other = *ccdStaticQuery[k];
+			double ox, oy, toi;
+			other.getCentre(ox, oy);
+			if (sweepCircleAgainst(x0, y0, x1 - x0, y1 - y0, radius, other, ox, oy, toi) && toi < ccdTimeOfImpact[i]) {
+				ccdTimeOfImpact[i] = toi;
+				ccdStaticHit[i] = &other;
+			}
+		}
+	}
+	
+	// 3. 推进到第一次接触的位置
+	for (size_t i = 0; i < n; i++) {
+		if (ccdTimeOfImpact[i] >= 1.0) continue;
+		Shape& shape = *shapeList[i];
+		double x0 = stepStartPositions[2 * i], y0 = stepStartPositions[2 * i + 1];
+		double x1, y1;
+		shape.getCentre(x1, y1);
+		double dx = x1 - x0, dy = y1 - y0;
+		
+		// 沿位移方向多走一点（半径的 1e-4），保证接触被离散碰撞检测到
+		double length = std::sqrt(dx * dx + dy * dy);
+		double slop = 1e-4 * static_cast<const Circle&>(shape).getRadius() / length;
+		double t = std::min(ccdTimeOfImpact[i] + slop, 1.0);
+		shape.setCentre(x0 + dx * t, y0 + dy * t);
+		ctx.ccdAdvanceCount++;
+		
+		if (ccdStaticHit[i] != nullptr && ccdStaticHit[i]->getKind() == SHAPE_WALL) {
+			resolveCollisionWithWall(shape, static_cast<const Wall&>(*ccdStaticHit[i]));
+		}
+	}
+}
+
+/*=========================================================================================================
+ * 碰撞检测和处理函数 - 检测并处理所有物体之间的碰撞
+ * 
+ * 分两步进行：
+ *   1. 宽相位：复用本步开始时 generateCandidatePairs() 生成的候选物体对，避免 O(n²) 的全配对循环
+ *   2. 窄相位：先用 BatchNarrowphase 批量检测所有候选对，再按顺序对接触的物体对调用 resolveCollision
+ * 
+ * 候选物体对按 (i, j) 顺序处理，与原来的双重循环顺序一致。
+ * resolveCollision 会移动两个物体，所以涉及已被移动过的物体的候选对要按当前位置重新调用 check_collision；
+ * 批量检测与 check_collision 的判定相同，结果与逐对检测逐位相同。
+ * 
+ * 使用 CONTACT_SOLVER_IMPULSE 时，碰撞的物体对不立即处理，而是记入接触缓存，
+ * 全部收集完后由 solveContacts() 统一求解。
+ *=========================================================================================================*/
+void PhysicalWorld::handleAllCollisions(std::vector<Shape*>& shapeList, StepContext& ctx) {
+	const double MAX_INTERACTION_DISTANCE = 200.0;
+	const bool useImpulseSolver = (contactSolverType == CONTACT_SOLVER_IMPULSE);
+	const std::vector<CandidatePair>& candidatePairs = *ctx.pairs;
+	
+	ctx.activeContacts.clear();
+	ctx.touchingPairs.clear();
+	
+	// 批量窄相位：按碰撞处理开始时的位置检测所有候选对
+	ctx.narrowphase.collide(shapeList, candidatePairs.data(), candidatePairs.size(), ctx.narrowContacts);
+	ctx.pairTouching.assign(candidatePairs.size(), 0);
+	for (size_t c = 0; c < ctx.narrowContacts.size(); c++) {
+		ctx.pairTouching[ctx.narrowContacts[c].pair] = 1;
+	}
+	ctx.shapeMoved.assign(shapeList.size(), 0);
+	size_t nextContact = 0;   // narrowContacts 按候选对的顺序排列，与 k 同步前进
+	
+	for (size_t k = 0; k < candidatePairs.size(); k++) {
+		const int i = candidatePairs[k].first;
+		const int j = candidatePairs[k].second;
+		Shape* shape1 = shapeList[i];
+		Shape* shape2 = shapeList[j];
+		
+		// 获取两个物体的位置
+		double x1, y1, x2, y2;
+		shape1->getCentre(x1, y1);
+		shape2->getCentre(x2, y2);
+		
+		// 快速距离检查（跳过距离太远的物体对）
+		double dx = x2 - x1;
+		double dy = y2 - y1;
+		double distanceSquared = dx * dx + dy * dy;
+		
+		if (distanceSquared > MAX_INTERACTION_DISTANCE * MAX_INTERACTION_DISTANCE) {
+			continue; // 距离太远，跳过
+		}
+		
+		// 窄相位碰撞检测：两个物体都没有被移动过时直接使用批量检测的结果
+		bool touching = (ctx.shapeMoved[i] || ctx.shapeMoved[j]) ? shape1->check_collision(*shape2) : ctx.pairTouching[k] != 0;
+		if (touching) {
+			if (sleepingEnabled) {
+				ctx.touchingPairs.push_back(candidatePairs[k]);
+			}
+			
+			// 检查是否存在支撑关系
+			bool isSupportRelation = false;
+			
+			if (shape1->getSupporter() == shape2) {
+				isSupportRelation = true;  // shape1 在 shape2 上面
+			} else if (shape2->getSupporter() == shape1) {
+				isSupportRelation = true;  // shape2 在 shape1 上面
+			}
+			
+			// 只有非支撑关系才处理碰撞
+			if (!isSupportRelation) {
+				// 碰撞处理开始时的穿透深度（自适应子步使用）
+				while (nextContact < ctx.narrowContacts.size() && ctx.narrowContacts[nextContact].pair < static_cast<int>(k)) {
+					nextContact++;
+				}
+				if (nextContact < ctx.narrowContacts.size() && ctx.narrowContacts[nextContact].pair == static_cast<int>(k)) {
+					ctx.maxPenetration = std::max(ctx.maxPenetration, ctx.narrowContacts[nextContact].depth);
+				}
+				
+				if (useImpulseSolver) {
+					// 已有的接触直接在缓存中更新；新建的接触先放在本岛的存储中，所有岛算完后再并入缓存
+					ContactManifold* contact = contactCache.touch(shape1, shape2, ctx.contactStats);
+					if (contact == nullptr) {
+						ctx.newContacts.push_back(ContactManifold());
+						contact = &ctx.newContacts.back();
+						ContactCache::initContact(*contact, shape1, shape2, ctx.contactStats);
+					}
+					ctx.activeContacts.push_back(contact);
+				} else {
+					resolveCollision(*shape1, *shape2);
+					ctx.shapeMoved[i] = 1;
+					ctx.shapeMoved[j] = 1;
+				}
+			}
+		}
+	}
+	
+	if (useImpulseSolver) {
+		solveContacts(ctx);
+	}
 }
 
 /*=========================================================================================================
- * 处理在空中的物体（自由落体）
+ * 第四点五阶段：动态物体与静态形状的碰撞
+ * 
+ * 静态形状在静态形状树中，树只在静态形状列表修改后重建，所以每个动态物体只需用自己的包围盒查询一次，
+ * 代价为 O(log s)，不再需要调用方在每步之后对每面墙调用 handleWallCollision（O(n·s)）。
+ * 查询结果按 staticShapeList 的顺序处理，与调用方按列表顺序逐个调用 handleWallCollision 的结果相同。
+ * 
+ * 静态形状视为质量无穷大，按墙壁碰撞处理（resolveCollisionWithWall）；
+ * Slope / Ground 不参与（斜面和地面由支撑检测处理）。
  *=========================================================================================================*/
-void PhysicalWorld::handleAirborneShape(Shape* shape, double deltaTime) {
-	// 在空中：只施加重力
-	shape->applyGravity(gravity);
+void PhysicalWorld::handleStaticCollisions(std::vector<Shape*>& shapeList, StepContext& ctx) {
+	if (!staticCollisions || staticShapeList.empty()) return;
+	std::vector<Shape*>& query = ctx.staticContactQuery;
+	
+	for (size_t i = 0; i < shapeList.size(); i++) {
+		Shape& shape = *shapeList[i];
+		BroadphaseBounds area;
+		shape.getBoundingBox(area.minX, area.minY, area.maxX, area.maxY);
+		query.clear();
+		queryStaticShapes(area, query, ctx.staticQueryResult, ctx.staticQueryStack);
+		
+		for (size_t k = 0; k < query.size(); k++) {
+			const Shape& other = *query[k];
+			ShapeKind kind = other.getKind();
+			if (kind != SHAPE_WALL && kind != SHAPE_AABB && kind != SHAPE_CIRCLE) continue;
+			if (shape.check_collision(other)) {
+				resolveCollisionWithWall(shape, other);
+				ctx.staticContactCount++;
+			}
+		}
+	}
 }
 
 /*=========================================================================================================
- * 在支撑物上施加摩擦力（包括牛顿第三定律反作用力）
- * 使用 Shape 的 applyFrictionRelative() 方法
+ * 冲量求解 - 对本步的所有接触统一求解（Sequential Impulse / 投影 Gauss-Seidel）
+ * 
+ *   1. 预计算：法向、穿透深度、弹性反弹的目标速度、本步的摩擦系数；持久接触复用有效质量等
+ *   2. 热启动：先施加上一帧的累积冲量，静止接触一开始就接近平衡
+ *   3. 速度迭代：每轮对所有接触依次求解摩擦和法向冲量，最多 contactIterations 轮，
+ *      一轮中最大的冲量增量小于 contactTolerance 时提前结束
+ *   4. 位置迭代：每轮按当前位置重新计算穿透深度，分离 80%（与 separateOverlappingShapes 相同），
+ *      最多 contactIterations 轮，最大穿透深度小于 contactTolerance 时提前结束
  *=========================================================================================================*/
-void PhysicalWorld::applyFrictionOnSupporter(Shape* shape, Shape* supporter, double normalForce, double friction, double static_friction, double drivingForce) {
-	// 获取支撑物速度
-	double supVx, supVy;
-	supporter->getVelocity(supVx, supVy);
-	
-	// ✅ 使用 Shape::applyFrictionRelative() 计算相对摩擦力
-	shape->applyFrictionRelative(normalForce, friction, static_friction, supVx, supVy, drivingForce);
+void PhysicalWorld::solveContacts(StepContext& ctx) {
+	const double separationPercent = 0.8;
+	const double restitutionThreshold = 1.0;   // 接近速度低于此值时不反弹：静止接触每步只有 g·dt 的接近速度，不应被弹开
+	
+	ContactStats& stats = ctx.contactStats;
+	std::vector<ContactManifold*>& activeContacts = ctx.activeContacts;
+	size_t solvable = 0;
+	for (size_t k = 0; k < activeContacts.size(); k++) {
+		ContactManifold& contact = *activeContacts[k];
+		bool reusedSetup = false;
+		if (!prepareContact(contact, restitutionThreshold, reusedSetup)) {
+			contact.normalImpulse = 0.0;
+			contact.tangentImpulse = 0.0;
+			continue;
+		}
+		if (reusedSetup) stats.setupSkipped++;
+		if (!warmStarting) {
+			contact.normalImpulse = 0.0;
+			contact.tangentImpulse = 0.0;
+		}
+		activeContacts[solvable++] = &contact;
+	}
+	activeContacts.resize(solvable);
+	if (activeContacts.empty()) return;
 	
-	// ✅ 计算反作用力（牛顿第三定律）
-	double shapeVx, shapeVy;
-	shape->getVelocity(shapeVx, shapeVy);
+	for (size_t k = 0; k < activeContacts.size(); k++) {
+		warmStartContact(*activeContacts[k]);
+	}
 	
-	// 计算相对速度
-	double relVx = shapeVx - supVx;
-	double relSpeed = std::sqrt(relVx * relVx);
+	for (int iteration = 0; iteration < contactIterations; iteration++) {
+		double maxDelta = 0.0;
+		for (size_t k = 0; k < activeContacts.size(); k++) {
+			maxDelta = std::max(maxDelta, solveContactFriction(*activeContacts[k]));
+			maxDelta = std::max(maxDelta, solveContact(*activeContacts[k]));
+		}
+		stats.velocityIterations = iteration + 1;
+		if (maxDelta < contactTolerance) break;
+	}
 	
-	if (relSpeed > 1e-6) {
-		// 摩擦力大小
-		double frictionMag = friction * normalForce;
-		// 摩擦力方向（与相对速度相反）
-		double dirX = -relVx / relSpeed;
-		
-		// 对支撑物施加反作用力
-		supporter->addToTotalForce(-frictionMag * dirX, 0.0);
+	for (int iteration = 0; iteration < contactIterations; iteration++) {
+		double maxPenetration = 0.0;
+		for (size_t k = 0; k < activeContacts.size(); k++) {
+			ContactManifold& contact = *activeContacts[k];
+			// 第一轮直接使用预计算时的穿透深度
+			double penetration = iteration == 0 ? contact.penetration : updateContactPenetration(contact);
+			maxPenetration = std::max(maxPenetration, penetration);
+			correctContactPosition(contact, separationPercent);
+		}
+		stats.positionIterations = iteration + 1;
+		if (maxPenetration * (1.0 - separationPercent) < contactTolerance) break;
 	}
 }
 
 /*=========================================================================================================
- * 碰撞检测和处理函数 - 检测并处理所有物体之间的碰撞
+ * 宽相位算法选择
  *=========================================================================================================*/
-void PhysicalWorld::handleAllCollisions(std::vector<Shape*>& shapeList) {
-	const double MAX_INTERACTION_DISTANCE = 200.0;
-	//请增加详细注释
+Broadphase& PhysicalWorld::activeBroadphase() {
+	switch (broadphaseType) {
+		case BROADPHASE_BRUTE_FORCE:
+			return bruteForceBroadphase;
+		case BROADPHASE_SWEEP_AND_PRUNE:
+			return sweepAndPruneBroadphase;
+		case BROADPHASE_AABB_TREE:
+			return aabbTreeBroadphase;
+		case BROADPHASE_SPATIAL_HASH:
+		default:
+			return spatialHashBroadphase;
+	}
+}
+
+const BroadphaseStats& PhysicalWorld::getBroadphaseStats() const {
+	switch (broadphaseType) {
+		case BROADPHASE_BRUTE_FORCE:
+			return bruteForceBroadphase.getStats();
+		case BROADPHASE_SWEEP_AND_PRUNE:
+			return sweepAndPruneBroadphase.getStats();
+		case BROADPHASE_AABB_TREE:
+			return aabbTreeBroadphase.getStats();
+		case BROADPHASE_SPATIAL_HASH:
+		default:
+			return spatialHashBroadphase.getStats();
+	}
+}
+
+/*=========================================================================================================
+ * 静态形状包围盒树
+ * 
+ * 静态形状不会移动，所以树只在静态形状列表被修改（addStaticShape / removeStaticShape / placeWall）
+ * 后的第一次查询时重建一次，叶子不需要放大。单个形状的查询代价为 O(log n)。
+ *=========================================================================================================*/
+void PhysicalWorld::rebuildStaticTree() {
+	staticTree.clear();
+	unboundedStaticShapes.clear();
+	for (size_t i = 0; i < staticShapeList.size(); i++) {
+		BroadphaseBounds b;
+		staticShapeList[i]->getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+		if (b.isFinite()) {
+			staticTree.createProxy(b, static_cast<int>(i), 0.0);
+		} else {
+			unboundedStaticShapes.push_back(static_cast<int>(i));
+		}
+	}
+	staticTreeDirty = false;
+	staticTreeBuildCount++;
+}
+
+void PhysicalWorld::queryStaticShapes(const Shape& shape, std::vector<Shape*>& result) {
+	BroadphaseBounds area;
+	shape.getBoundingBox(area.minX, area.minY, area.maxX, area.maxY);
+	queryStaticShapes(area, result);
+}
+
+void PhysicalWorld::queryStaticShapes(const BroadphaseBounds& area, std::vector<Shape*>& result) {
+	queryStaticShapes(area, result, staticQueryResult, staticQueryStack);
+}
+
+// 使用调用方的临时数组，不同的岛可以在不同线程中同时查询（静态形状树已在并行计算之前建好）
+void PhysicalWorld::queryStaticShapes(const BroadphaseBounds& area, std::vector<Shape*>& result,
+                                      std::vector<int>& staticQueryResult, std::vector<int>& stackScratch) {
+	if (staticTreeDirty) {
+		rebuildStaticTree();
+	}
 	
-	for (size_t i = 0; i < shapeList.size(); i++) {
-		for (size_t j = i + 1; j < shapeList.size(); j++) {
-			// 获取两个物体的位置
-			double x1, y1, x2, y2;
-			shapeList[i]->getCentre(x1, y1);
-			shapeList[j]->getCentre(x2, y2);
-			
-			// 快速距离检查（优化：跳过距离太远的物体对）
-			double dx = x2 - x1;
-			double dy = y2 - y1;
-			double distanceSquared = dx * dx + dy * dy;
-			
-			if (distanceSquared > MAX_INTERACTION_DISTANCE * MAX_INTERACTION_DISTANCE) {
-				continue; // 距离太远，跳过
-			}
-			
-			// 碰撞检测
-			if (shapeList[i]->check_collision(*shapeList[j])) {
-				// 检查是否存在支撑关系
-				bool isSupportRelation = false;
-				
-				if (shapeList[i]->getSupporter() == shapeList[j]) {
-					isSupportRelation = true;  // i 在 j 上面
-				} else if (shapeList[j]->getSupporter() == shapeList[i]) {
-					isSupportRelation = true;  // j 在 i 上面
-				}
-				
-				// 只有非支撑关系才处理碰撞
-				if (!isSupportRelation) {
-					resolveCollision(*shapeList[i], *shapeList[j]);
-				}
+	staticQueryResult.clear();
+	staticTree.query(area, staticQueryResult, stackScratch);
+	for (size_t k = 0; k < unboundedStaticShapes.size(); k++) {
+		int index = unboundedStaticShapes[k];
+		BroadphaseBounds b;
+		staticShapeList[index]->getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+		if (b.overlaps(area)) {
+			staticQueryResult.push_back(index);
+		}
+	}
+	
+	// 按静态形状列表中的顺序输出，结果与遍历顺序无关
+	std::sort(staticQueryResult.begin(), staticQueryResult.end());
+	for (size_t k = 0; k < staticQueryResult.size(); k++) {
+		result.push_back(staticShapeList[staticQueryResult[k]]);
+	}
+}
+
+/*=========================================================================================================
+ * 空间查询
+ * 
+ * 动态物体包围盒树与宽相位的 AABBTreeBroadphase 类似：叶子按尺寸放大 0.5 倍，物体在胖包围盒内移动时
+ * 不修改树。树不在每步中维护，而是在每步之后的第一次查询时统一更新一次，没有查询时没有任何开销；
+ * 一帧中的大量查询共用一次更新。静态形状使用静态形状树。
+ * 
+ * 树只负责给出候选形状，再按实际形状逐个判断：圆按圆判断，其他形状按包围盒判断。
+ *=========================================================================================================*/
+static double spatialIndexMargin(const BroadphaseBounds& b) {
+	return std::max(b.maxX - b.minX, b.maxY - b.minY) * 0.5;
+}
+
+void PhysicalWorld::refreshDynamicIndex() {
+	if (!dynamicIndexStale && indexedDynamicShapes.size() == dynamicShapeList.size()) return;
+	dynamicIndexStale = false;
+	
+	const size_t n = dynamicShapeList.size();
+	if (indexedDynamicShapes != dynamicShapeList) {
+		// 列表有增删：下标全部变化，重建
+		dynamicIndex.clear();
+		unboundedDynamicShapes.clear();
+		dynamicIndexProxies.assign(n, DynamicAABBTree::NULL_NODE);
+		for (size_t i = 0; i < n; i++) {
+			BroadphaseBounds b;
+			dynamicShapeList[i]->getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+			if (b.isFinite()) {
+				dynamicIndexProxies[i] = dynamicIndex.createProxy(b, static_cast<int>(i), spatialIndexMargin(b));
+			} else {
+				unboundedDynamicShapes.push_back(static_cast<int>(i));
 			}
 		}
+		indexedDynamicShapes = dynamicShapeList;
+		return;
+	}
+	
+	for (size_t i = 0; i < n; i++) {
+		if (dynamicIndexProxies[i] == DynamicAABBTree::NULL_NODE) continue;
+		BroadphaseBounds b;
+		dynamicShapeList[i]->getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+		dynamicIndex.moveProxy(dynamicIndexProxies[i], b, spatialIndexMargin(b));
+	}
+}
+
+void PhysicalWorld::collectAreaCandidates(const BroadphaseBounds& area, std::vector<Shape*>& result) {
+	refreshDynamicIndex();
+	spatialQueryIndices.clear();
+	dynamicIndex.query(area, spatialQueryIndices, spatialQueryStack);
+	for (size_t k = 0; k < unboundedDynamicShapes.size(); k++) {
+		spatialQueryIndices.push_back(unboundedDynamicShapes[k]);
+	}
+	std::sort(spatialQueryIndices.begin(), spatialQueryIndices.end());
+	for (size_t k = 0; k < spatialQueryIndices.size(); k++) {
+		result.push_back(dynamicShapeList[spatialQueryIndices[k]]);
+	}
+	
+	queryStaticShapes(area, result, staticQueryResult, staticQueryStack);
+}
+
+void PhysicalWorld::collectRayCandidates(double x0, double y0, double dx, double dy, std::vector<Shape*>& result) {
+	refreshDynamicIndex();
+	if (staticTreeDirty) {
+		rebuildStaticTree();
+	}
+	
+	const DynamicAABBTree* trees[2] = {&dynamicIndex, &staticTree};
+	const std::vector<int>* unbounded[2] = {&unboundedDynamicShapes, &unboundedStaticShapes};
+	const std::vector<Shape*>* lists[2] = {&dynamicShapeList, &staticShapeList};
+	for (int k = 0; k < 2; k++) {
+		spatialQueryIndices.clear();
+		trees[k]->raycast(x0, y0, dx, dy, spatialQueryIndices, spatialQueryStack);
+		spatialQueryIndices.insert(spatialQueryIndices.end(), unbounded[k]->begin(), unbounded[k]->end());
+		std::sort(spatialQueryIndices.begin(), spatialQueryIndices.end());
+		for (size_t m = 0; m < spatialQueryIndices.size(); m++) {
+			result.push_back((*lists[k])[spatialQueryIndices[m]]);
+		}
+	}
+}
+
+// 点到形状的距离（点在形状内部时为 0）
+static double distanceToShape(const Shape& shape, double x, double y) {
+	double cx, cy;
+	shape.getCentre(cx, cy);
+	if (shape.getKind() == SHAPE_CIRCLE) {
+		double d = std::sqrt((x - cx) * (x - cx) + (y - cy) * (y - cy)) - static_cast<const Circle&>(shape).getRadius();
+		return std::max(d, 0.0);
+	}
+	double minX, minY, maxX, maxY;
+	shape.getBoundingBox(minX, minY, maxX, maxY);
+	double dx = std::max(std::max(minX - x, x - maxX), 0.0);
+	double dy = std::max(std::max(minY - y, y - maxY), 0.0);
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+// 线段与形状的第一个交点，t 为占线段长度的比例
+static bool raycastShape(const Shape& shape, double x0, double y0, double dx, double dy,
+                         double& t, double& nx, double& ny) {
+	const double length = std::sqrt(dx * dx + dy * dy);
+	if (length == 0.0) return false;
+	
+	if (shape.getKind() == SHAPE_CIRCLE) {
+		double cx, cy;
+		shape.getCentre(cx, cy);
+		double radius = static_cast<const Circle&>(shape).getRadius();
+		double fx = x0 - cx, fy = y0 - cy;
+		double c = fx * fx + fy * fy - radius * radius;
+		if (c <= 0.0) {
+			t = 0.0;
+			nx = -dx / length;
+			ny = -dy / length;
+			return true;
+		}
+		double a = dx * dx + dy * dy;
+		double b = fx * dx + fy * dy;
+		double discriminant = b * b - a * c;
+		if (b >= 0.0 || discriminant < 0.0) return false;
+		t = (-b - std::sqrt(discriminant)) / a;
+		if (t > 1.0) return false;
+		nx = (fx + dx * t) / radius;
+		ny = (fy + dy * t) / radius;
+		return true;
+	}
+	
+	BroadphaseBounds b;
+	shape.getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+	if (!b.intersectsSegment(x0, y0, dx, dy, t)) return false;
+	if (t == 0.0) {
+		nx = -dx / length;
+		ny = -dy / length;
+		return true;
+	}
+	// 进入时所在的面：进入时间较晚的那一轴
+	double enterX = dx != 0.0 ? ((dx > 0.0 ? b.minX : b.maxX) - x0) / dx : -1.0;
+	double enterY = dy != 0.0 ? ((dy > 0.0 ? b.minY : b.maxY) - y0) / dy : -1.0;
+	if (enterX >= enterY) {
+		nx = dx > 0.0 ? -1.0 : 1.0;
+		ny = 0.0;
+	} else {
+		nx = 0.0;
+		ny = dy > 0.0 ? -1.0 : 1.0;
+	}
+	return true;
+}
+
+size_t PhysicalWorld::queryPoint(double x, double y, std::vector<Shape*>& result) {
+	return queryRadius(x, y, 0.0, result);
+}
+
+size_t PhysicalWorld::queryAABB(const BroadphaseBounds& area, std::vector<Shape*>& result) {
+	const size_t start = result.size();
+	collectAreaCandidates(area, result);
+	
+	size_t count = start;
+	for (size_t k = start; k < result.size(); k++) {
+		BroadphaseBounds b;
+		result[k]->getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+		if (b.overlaps(area)) result[count++] = result[k];
+	}
+	result.resize(count);
+	return count - start;
+}
+
+size_t PhysicalWorld::queryRadius(double x, double y, double radius, std::vector<Shape*>& result) {
+	const size_t start = result.size();
+	BroadphaseBounds area;
+	area.minX = x - radius;
+	area.minY = y - radius;
+	area.maxX = x + radius;
+	area.maxY = y + radius;
+	collectAreaCandidates(area, result);
+	
+	size_t count = start;
+	for (size_t k = start; k < result.size(); k++) {
+		if (distanceToShape(*result[k], x, y) <= radius) result[count++] = result[k];
+	}
+	result.resize(count);
+	return count - start;
+}
+
+bool PhysicalWorld::raycast(double x0, double y0, double x1, double y1, RaycastHit& hit) {
+	const double dx = x1 - x0, dy = y1 - y0;
+	rayCandidates.clear();
+	collectRayCandidates(x0, y0, dx, dy, rayCandidates);
+	
+	// fraction 相同时保留列表中靠前的形状
+	bool found = false;
+	for (size_t k = 0; k < rayCandidates.size(); k++) {
+		double t, nx, ny;
+		if (raycastShape(*rayCandidates[k], x0, y0, dx, dy, t, nx, ny) && (!found || t < hit.fraction)) {
+			found = true;
+			hit.shape = rayCandidates[k];
+			hit.fraction = t;
+			hit.nx = nx;
+			hit.ny = ny;
+		}
+	}
+	if (found) {
+		hit.x = x0 + dx * hit.fraction;
+		hit.y = y0 + dy * hit.fraction;
+	}
+	return found;
+}
+
+size_t PhysicalWorld::raycastAll(double x0, double y0, double x1, double y1, std::vector<RaycastHit>& hits) {
+	const double dx = x1 - x0, dy = y1 - y0;
+	const size_t start = hits.size();
+	rayCandidates.clear();
+	collectRayCandidates(x0, y0, dx, dy, rayCandidates);
+	
+	for (size_t k = 0; k < rayCandidates.size(); k++) {
+		RaycastHit hit;
+		if (raycastShape(*rayCandidates[k], x0, y0, dx, dy, hit.fraction, hit.nx, hit.ny)) {
+			hit.shape = rayCandidates[k];
+			hit.x = x0 + dx * hit.fraction;
+			hit.y = y0 + dy * hit.fraction;
+			hits.push_back(hit);
+		}
 	}
+	std::stable_sort(hits.begin() + start, hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+		return a.fraction < b.fraction;
+	});
+	return hits.size() - start;
 }
 
 /*=========================================================================================================
@@ -652,65 +2086,18 @@ void PhysicalWorld::resolveCollision(Shape& shape1, Shape& shape2) {
 
 /*=========================================================================================================
  * 分离重叠物体函数 - 根据形状类型计算重叠量并分离
+ * 重叠量由 shapes.cpp 中登记的分离内核计算（Circle/AABB/Wall 之间）
  *=========================================================================================================*/
 void PhysicalWorld::separateOverlappingShapes(Shape& shape1, Shape& shape2, double nx, double ny, double distance) {
 	const double separationPercent = 0.8;
-	double overlap = 0.0;
 	
 	// 获取位置
 	double x1, y1, x2, y2;
 	shape1.getCentre(x1, y1);
 	shape2.getCentre(x2, y2);
 	
-	// 尝试识别形状类型并计算重叠量
-	const Circle* c1 = dynamic_cast<const Circle*>(&shape1);
-	const Circle* c2 = dynamic_cast<const Circle*>(&shape2);
-	const AABB* a1 = dynamic_cast<const AABB*>(&shape1);
-	const AABB* a2 = dynamic_cast<const AABB*>(&shape2);
-	
-	// 情况1：Circle 与 Circle
-	if (c1 && c2) {
-		overlap = c1->getRadius() + c2->getRadius() - distance;
-	}
-	// 情况2：AABB 与 AABB
-	else if (a1 && a2) {
-		double overlapX = (a1->getWidth() + a2->getWidth()) / 2.0 - std::abs(x2 - x1);
-		double overlapY = (a1->getHeight() + a2->getHeight()) / 2.0 - std::abs(y2 - y1);
-		
-		if (overlapX < overlapY) {
-			overlap = overlapX;
-			nx = (x2 > x1) ? 1.0 : -1.0;
-			ny = 0.0;
-		} else {
-			overlap = overlapY;
-			nx = 0.0;
-			ny = (y2 > y1) ? 1.0 : -1.0;
-		}
-	}
-	// 情况3：Circle 与 AABB
-	else if ((c1 && a2) || (a1 && c2)) {
-		const Circle* circle = c1 ? c1 : c2;
-		const AABB* aabb = a1 ? a1 : a2;
-		
-		double circleX, circleY, aabbX, aabbY;
-		circle->getCentre(circleX, circleY);
-		aabb->getCentre(aabbX, aabbY);
-		
-		double closestX = std::max(aabbX - aabb->getWidth() / 2.0,
-		                           std::min(circleX, aabbX + aabb->getWidth() / 2.0));
-		double closestY = std::max(aabbY - aabb->getHeight() / 2.0,
-		                           std::min(circleY, aabbY + aabb->getHeight() / 2.0));
-		
-		double dx = circleX - closestX;
-		double dy = circleY - closestY;
-		double distToClosest = std::sqrt(dx * dx + dy * dy);
-		
-		overlap = circle->getRadius() - distToClosest;
-		
-		if (distToClosest < 0.0001) {
-			overlap = circle->getRadius();
-		}
-	}
+	// 按 (shape1, shape2) 的类型标记查表计算重叠量（矩形之间会改写分离方向）
+	double overlap = shape1.computeOverlap(shape2, nx, ny, distance);
 	
 	// 应用位置修正
 	if (overlap > 0) {
@@ -735,29 +2122,8 @@ void PhysicalWorld::handleBoundaryCollision(Shape& shape) {
 	
 	bool outOfBounds = false;
 	
-	const Circle* circle = dynamic_cast<const Circle*>(&shape);
-	const AABB* aabb = dynamic_cast<const AABB*>(&shape);
-	
-	if (circle) {
-		double radius = circle->getRadius();
-		
-		if (x + radius < bounds[0] || x - radius > bounds[1] ||
-		    y + radius < bounds[2] || y - radius > bounds[3]) {
-			outOfBounds = true;
-			vx = 0.0;
-			vy = 0.0;
-			
-			if (x + radius < bounds[0]) x = bounds[0] - radius;
-			else if (x - radius > bounds[1]) x = bounds[1] + radius;
-			
-			if (y + radius < bounds[2]) y = bounds[2] - radius;
-			else if (y - radius > bounds[3]) y = bounds[3] + radius;
-		}
-	}
-	else if (aabb) {
-		double halfWidth = aabb->getWidth() / 2.0;
-		double halfHeight = aabb->getHeight() / 2.0;
-		
+	double halfWidth, halfHeight;
+	if (getHalfExtents(shape, halfWidth, halfHeight)) {
 		if (x + halfWidth < bounds[0] || x - halfWidth > bounds[1] ||
 		    y + halfHeight < bounds[2] || y - halfHeight > bounds[3]) {
 			outOfBounds = true;
@@ -785,17 +2151,8 @@ bool PhysicalWorld::isInBounds(const Shape& shape) const {
 	double x, y;
 	shape.getCentre(x, y);
 	
-	const Circle* circle = dynamic_cast<const Circle*>(&shape);
-	const AABB* aabb = dynamic_cast<const AABB*>(&shape);
-	
-	if (circle) {
-		double r = circle->getRadius();
-		return (x - r >= bounds[0] && x + r <= bounds[1] &&
-		        y - r >= bounds[2] && y + r <= bounds[3]);
-	}
-	else if (aabb) {
-		double hw = aabb->getWidth() / 2.0;
-		double hh = aabb->getHeight() / 2.0;
+	double hw, hh;
+	if (getHalfExtents(shape, hw, hh)) {
 		return (x - hw >= bounds[0] && x + hw <= bounds[1] &&
 		        y - hh >= bounds[2] && y + hh <= bounds[3]);
 	}
@@ -803,6 +2160,23 @@ bool PhysicalWorld::isInBounds(const Shape& shape) const {
 	return true;
 }
 
+/*=========================================================================================================
+ * 边界处理用的半宽/半高：只有 Circle 和 AABB 参与边界检查，其他类型返回 false
+ *=========================================================================================================*/
+bool PhysicalWorld::getHalfExtents(const Shape& shape, double& halfWidth, double& halfHeight) {
+	switch (shape.getKind()) {
+		case SHAPE_CIRCLE:
+			halfWidth = halfHeight = static_cast<const Circle&>(shape).getRadius();
+			return true;
+		case SHAPE_AABB:
+			halfWidth = static_cast<const AABB&>(shape).getWidth() / 2.0;
+			halfHeight = static_cast<const AABB&>(shape).getHeight() / 2.0;
+			return true;
+		default:
+			return false;
+	}
+}
+
 bool PhysicalWorld::checkBoundaryCollision(const Shape& shape) const {
 	return !isInBounds(shape);
 }
@@ -812,13 +2186,22 @@ bool PhysicalWorld::checkBoundaryCollision(const Shape& shape) const {
  *=========================================================================================================*/
 void PhysicalWorld::addDynamicShape(Shape* shape) {
 	if (shape != nullptr) {
+		handleTable.acquire(shape);   // 先分配句柄：句柄用完时抛出异常，世界保持不变
 		dynamicShapeList.push_back(shape);
+		bodyStore.attach(shape);
+		shapeIndex.add(shape, true);
+		dynamicIndexStale = true;
+		awakeListDirty = true;
+		if (sleepingTreeList == &dynamicShapeList) sleepingTreeListSize = dynamicShapeList.size();
 	}
 }
 
 void PhysicalWorld::addStaticShape(Shape* shape) {
 	if (shape != nullptr) {
+		handleTable.acquire(shape);
 		staticShapeList.push_back(shape);
+		shapeIndex.add(shape, false);
+		staticTreeDirty = true;
 	}
 }
 
@@ -829,6 +2212,23 @@ void PhysicalWorld::removeDynamicShape(Shape* shape) {
 	auto it = std::find(dynamicShapeList.begin(), dynamicShapeList.end(), shape);
 	if (it != dynamicShapeList.end()) {
 		dynamicShapeList.erase(it);
+		removeSleepingProxy(shape);
+		awakeListDirty = true;
+		if (sleepingTreeList == &dynamicShapeList) sleepingTreeListSize = dynamicShapeList.size();
+		
+		// 被它支撑着的休眠物体需要醒来（否则会悬在空中），要在句柄失效之前找出来
+		releaseSupporter(shape);
+		
+		bodyStore.detach(shape);
+		shapeIndex.remove(shape);
+		handleTable.release(shape);   // 指向它的句柄（支撑关系、适配器、暂停时的状态）随即失效
+		contactCache.removeShape(shape);
+		dynamicIndexStale = true;
+		
+		// 世界内存池中的形状回收到空闲链表
+		if (shapePool.owns(shape)) {
+			shapePool.destroy(shape);
+		}
 	}
 }
 
@@ -836,6 +2236,47 @@ void PhysicalWorld::removeStaticShape(Shape* shape) {
 	auto it = std::find(staticShapeList.begin(), staticShapeList.end(), shape);
 	if (it != staticShapeList.end()) {
 		staticShapeList.erase(it);
+		releaseSupporter(shape);
+		shapeIndex.remove(shape);
+		handleTable.release(shape);
+		staticTreeDirty = true;
+		if (shapePool.owns(shape)) {
+			shapePool.destroy(shape);
+		}
+	}
+}
+
+// 以 shape 为支撑物的休眠物体醒来并重新检测支撑
+// 清醒的物体每步都重新检测支撑，不需要处理；休眠的物体与支撑物接触，在休眠树中查询 shape 的包围盒即可找到
+void PhysicalWorld::releaseSupporter(const Shape* shape) {
+	if (sleepingTreeList != &dynamicShapeList) {
+		// 休眠树没有跟踪世界的形状列表（直接计算的是其他列表）：逐个检查
+		if (sleepingShapeCount == 0) return;
+		for (size_t i = 0; i < dynamicShapeList.size(); i++) {
+			if (dynamicShapeList[i]->getSupporter() == shape) {
+				dynamicShapeList[i]->wakeUp();
+				dynamicShapeList[i]->resetSupportStatus();
+			}
+		}
+		return;
+	}
+	if (sleepingTree.getProxyCount() == 0) return;
+	
+	BroadphaseBounds bounds;
+	shape->getBoundingBox(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+	const double margin = 1e-3;   // 支撑检测允许的微小间隙
+	bounds.minX -= margin;
+	bounds.minY -= margin;
+	bounds.maxX += margin;
+	bounds.maxY += margin;
+	sleepQueryResult.clear();
+	sleepingTree.query(bounds, sleepQueryResult);
+	for (size_t k = 0; k < sleepQueryResult.size(); k++) {
+		Shape* other = sleepingProxies[sleepQueryResult[k]].shape;
+		if (other == nullptr || other->getSupporter() != shape) continue;
+		removeSleepingProxy(other);
+		other->wakeUp();
+		other->resetSupportStatus();
 	}
 }
 
@@ -853,74 +2294,126 @@ Shape* PhysicalWorld::findShapeByName(const std::string& name) {
 }
 
 Shape* PhysicalWorld::findDynamicShapeByName(const std::string& name) {
-	for (auto& shape : dynamicShapeList) {
-		if (shape->getName() == name) {
-			return shape;
-		}
-	}
-	return nullptr;
+	syncShapeIndex();
+	return shapeIndex.findByName(name, true);
 }
 
 Shape* PhysicalWorld::findStaticShapeByName(const std::string& name) {
-	for (auto& shape : staticShapeList) {
-		if (shape->getName() == name) {
-			return shape;
-		}
-	}
-	return nullptr;
+	syncShapeIndex();
+	return shapeIndex.findByName(name, false);
 }
 
 /*=========================================================================================================
  * 形状管理方法实现 - 通过类型查找所有形状
  *=========================================================================================================*/
 std::vector<Shape*> PhysicalWorld::findShapesByType(const std::string& type) {
-	std::vector<Shape*> result;
+	syncShapeIndex();
+	const std::vector<Shape*>& dynamicResult = shapeIndex.findByType(type, true);
+	const std::vector<Shape*>& staticResult = shapeIndex.findByType(type, false);
 	
-	// 在动态形状中查找
-	std::vector<Shape*> dynamicResult = findDynamicShapesByType(type);
+	std::vector<Shape*> result;
+	result.reserve(dynamicResult.size() + staticResult.size());
 	result.insert(result.end(), dynamicResult.begin(), dynamicResult.end());
-	
-	// 在静态形状中查找
-	std::vector<Shape*> staticResult = findStaticShapesByType(type);
 	result.insert(result.end(), staticResult.begin(), staticResult.end());
-	
 	return result;
 }
 
 std::vector<Shape*> PhysicalWorld::findDynamicShapesByType(const std::string& type) {
-	std::vector<Shape*> result;
-	for (auto& shape : dynamicShapeList) {
-		if (shape->getType() == type) {
-			result.push_back(shape);
-		}
-	}
-	return result;
+	syncShapeIndex();
+	return shapeIndex.findByType(type, true);
 }
 
 std::vector<Shape*> PhysicalWorld::findStaticShapesByType(const std::string& type) {
-	std::vector<Shape*> result;
-	for (auto& shape : staticShapeList) {
-		if (shape->getType() == type) {
-			result.push_back(shape);
+	syncShapeIndex();
+	return shapeIndex.findByType(type, false);
+}
+
+/*=========================================================================================================
+ * 句柄与形状列表同步：直接放进列表（没有经过 addXxxShape）的形状分配句柄
+ *=========================================================================================================*/
+void PhysicalWorld::syncHandles(const std::vector<Shape*>& shapeList) {
+	for (size_t i = 0; i < shapeList.size(); i++) {
+		if (handleTable.resolve(shapeList[i]->getHandle()) != shapeList[i]) {
+			handleTable.acquire(shapeList[i]);
 		}
 	}
-	return result;
+	for (size_t i = 0; i < staticShapeList.size(); i++) {
+		if (handleTable.resolve(staticShapeList[i]->getHandle()) != staticShapeList[i]) {
+			handleTable.acquire(staticShapeList[i]);
+		}
+	}
+}
+
+/*=========================================================================================================
+ * 名称、类型索引与形状列表同步
+ *=========================================================================================================*/
+void PhysicalWorld::syncShapeIndex() {
+	if (shapeIndex.size() == dynamicShapeList.size() + staticShapeList.size()) {
+		return;
+	}
+	shapeIndex.clear();
+	for (size_t i = 0; i < dynamicShapeList.size(); i++) {
+		shapeIndex.add(dynamicShapeList[i], true);
+	}
+	for (size_t i = 0; i < staticShapeList.size(); i++) {
+		shapeIndex.add(staticShapeList[i], false);
+	}
 }
 
 /*=========================================================================================================
  * 形状管理方法实现 - 清空所有形状
  *=========================================================================================================*/
 void PhysicalWorld::clearDynamicShapes() {
+	bodyStore.clear();
+	shapeIndex.removeAll(true);   // 只移出动态物体，静态形状的名称和名称计数器保留
+	resetSleepingTree();
+	for (size_t i = 0; i < dynamicShapeList.size(); i++) {
+		handleTable.release(dynamicShapeList[i]);
+	}
+	for (size_t i = 0; i < dynamicShapeList.size(); i++) {
+		if (shapePool.owns(dynamicShapeList[i])) {
+			shapePool.destroy(dynamicShapeList[i]);
+		}
+	}
 	dynamicShapeList.clear();
+	contactCache.clear();
+	dynamicIndexStale = true;
 }
 
 void PhysicalWorld::clearStaticShapes() {
+	shapeIndex.removeAll(false);   // 只移出静态形状，动态物体的名称和名称计数器保留
+	for (size_t i = 0; i < staticShapeList.size(); i++) {
+		handleTable.release(staticShapeList[i]);
+	}
+	for (size_t i = 0; i < staticShapeList.size(); i++) {
+		if (shapePool.owns(staticShapeList[i])) {
+			shapePool.destroy(staticShapeList[i]);
+		}
+	}
+	// 剩下的动态物体可能以被删除的静态形状为支撑物
+	for (size_t i = 0; i < dynamicShapeList.size(); i++) {
+		if (dynamicShapeList[i]->getSupporter() != nullptr) {
+			dynamicShapeList[i]->wakeUp();
+			dynamicShapeList[i]->resetSupportStatus();
+		}
+	}
 	staticShapeList.clear();
+	staticTreeDirty = true;
 }
 
 void PhysicalWorld::clearAllShapes() {
-	clearDynamicShapes();
-	clearStaticShapes();
+	// 两个列表都清空后，池中的形状一次性全部释放（不再逐个查找）
+	bodyStore.clear();
+	shapeIndex.reset();
+	resetSleepingTree();
+	handleTable.clear();
+	dynamicShapeList.clear();
+	staticShapeList.clear();
+	contactCache.clear();
+	constraintSolver.clear();
+	dynamicIndexStale = true;
+	staticTreeDirty = true;
+	shapePool.releaseAll();
 }
 
 /*=========================================================================================================
@@ -984,17 +2477,21 @@ void PhysicalWorld::printStaticShapes() const {
  *   ""       - 如果类型无法识别
  *=========================================================================================================*/
 std::string PhysicalWorld::parseShapeType(const std::string& type) const {
-	// 转换为小写进行比较
-	std::string lowerType = type;
-	std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(), ::tolower);
-	
-	// 识别圆形类型
-	if (lowerType == "circle") {
-		return "Circle";
-	}
-	// 识别矩形/盒子类型
-	else if (lowerType == "aabb" || lowerType == "box" || lowerType == "rectangle" || lowerType == "rect") {
-		return "AABB";
+	// 可识别的写法（小写）及对应的标准类型名称；逐字符不区分大小写比较，不再复制、转换字符串
+	static const char* const aliases[][2] = {
+		{"circle", "Circle"},
+		{"aabb", "AABB"}, {"box", "AABB"}, {"rectangle", "AABB"}, {"rect", "AABB"}
+	};
+	for (size_t a = 0; a < sizeof(aliases) / sizeof(aliases[0]); a++) {
+		const char* alias = aliases[a][0];
+		size_t k = 0;
+		while (k < type.size() && alias[k] != '\0' &&
+		       std::tolower(static_cast<unsigned char>(type[k])) == alias[k]) {
+			k++;
+		}
+		if (k == type.size() && alias[k] == '\0') {
+			return aliases[a][1];
+		}
 	}
 	
 	// 未识别的类型
@@ -1014,9 +2511,9 @@ Shape* PhysicalWorld::createShape(const std::string& type, const std::string& na
 	if (standardType == "Circle") {
 		// Circle: size1 = 半径
 		if (isDynamic) {
-			shape = new Circle(mass, size1, 0.0, 0.0);
+			shape = shapePool.create<Circle>(mass, size1, 0.0, 0.0);
 		} else {
-			Circle* circle = new Circle(mass, size1, 0.0, 0.0);
+			Circle* circle = shapePool.create<Circle>(mass, size1, 0.0, 0.0);
 			circle->setMass(INFINITY);  // 静态形状质量为无穷大
 			shape = circle;
 		}
@@ -1027,9 +2524,9 @@ Shape* PhysicalWorld::createShape(const std::string& type, const std::string& na
 			size2 = size1;  // 如果没有提供高度，默认为正方形
 		}
 		if (isDynamic) {
-			shape = new AABB(mass, size1, size2, 0.0, 0.0);
+			shape = shapePool.create<AABB>(mass, size1, size2, 0.0, 0.0);
 		} else {
-			AABB* box = new AABB(mass, size1, size2, 0.0, 0.0);
+			AABB* box = shapePool.create<AABB>(mass, size1, size2, 0.0, 0.0);
 			box->setMass(INFINITY);  // 静态形状质量为无穷大
 			shape = box;
 		}
@@ -1051,37 +2548,17 @@ Shape* PhysicalWorld::createShape(const std::string& type, const std::string& na
  * 私有方法：生成唯一名字
  *=========================================================================================================*/
 std::string PhysicalWorld::generateUniqueName(const std::string& type) {
-	int counter = 1;
-	std::string baseName = type;
-	std::string uniqueName;
-	
-	do {
-		uniqueName = baseName + "_" + std::to_string(counter);
-		counter++;
-	} while (isNameExists(uniqueName));
-	
-	return uniqueName;
+	// 每个前缀的编号保存在 ShapeIndex 中，接着上一次的编号继续，不再每次从 1 开始试探
+	syncShapeIndex();
+	return shapeIndex.makeUniqueName(type);
 }
 
 /*=========================================================================================================
  * 私有方法：检查名字是否已存在
  *=========================================================================================================*/
-bool PhysicalWorld::isNameExists(const std::string& name) const {
-	// 在动态形状中查找
-	for (const auto& shape : dynamicShapeList) {
-		if (shape->getName() == name) {
-			return true;
-		}
-	}
-	
-	// 在静态形状中查找
-	for (const auto& shape : staticShapeList) {
-		if (shape->getName() == name) {
-			return true;
-		}
-	}
-	
-	return false;
+bool PhysicalWorld::isNameExists(const std::string& name) {
+	syncShapeIndex();
+	return shapeIndex.containsName(name);
 }
 
 /*=========================================================================================================
@@ -1146,8 +2623,8 @@ Shape* PhysicalWorld::placeStaticShapeByType(const std::string& type, const std:
  *=========================================================================================================*/
 Wall* PhysicalWorld::placeWall(const std::string& name, double x_pos, double y_pos,
                                  double width, double height, double friction) {
-	// 创建墙壁对象
-	Wall* wall = new Wall(width, height, x_pos, y_pos, friction);
+	// 创建墙壁对象（来自世界的内存池）
+	Wall* wall = shapePool.create<Wall>(width, height, x_pos, y_pos, friction);
 	
 	if (wall == nullptr) {
 		std::cerr << "错误：无法创建墙壁" << std::endl;
@@ -1164,7 +2641,7 @@ Wall* PhysicalWorld::placeWall(const std::string& name, double x_pos, double y_p
 	// 墙壁是静态形状，质量设为无穷大
 	wall->setMass(INFINITY);
 	
-	// 添加到静态形状列表
+	// 添加到静态形状列表（同时标记静态形状树需要重建）
 	addStaticShape(wall);
 	
 	return wall;
@@ -1193,12 +2670,12 @@ void PhysicalWorld::handleWallCollision(Shape& dynamicShape, const Wall& wall) {
  * 
  * 参数说明：
  *   dynamicShape - 动态形状对象
- *   wall         - 墙壁对象
+ *   wall         - 墙壁对象（或其他静态形状，同样视为质量无穷大）
  * 
  * 功能：
  *   计算碰撞响应，应用速度变化和位置修正，使物体从墙壁中分离
  *=========================================================================================================*/
-void PhysicalWorld::resolveCollisionWithWall(Shape& dynamicShape, const Wall& wall) {
+void PhysicalWorld::resolveCollisionWithWall(Shape& dynamicShape, const Shape& wall) {
 	// 获取动态物体的位置和速度
 	double shapeX, shapeY, shapeVx, shapeVy;
 	dynamicShape.getCentre(shapeX, shapeY);
@@ -1246,50 +2723,8 @@ void PhysicalWorld::resolveCollisionWithWall(Shape& dynamicShape, const Wall& wa
 	dynamicShape.setVelocity(shapeVx, shapeVy);
 	
 	// ========== 分离物体，避免重叠 ==========
-	double overlap = 0.0;
-	
-	// 识别动态物体的类型并计算重叠量
-	const Circle* circle = dynamic_cast<const Circle*>(&dynamicShape);
-	const AABB* aabb = dynamic_cast<const AABB*>(&dynamicShape);
-	
-	if (circle) {
-		// 圆形与墙壁（矩形）碰撞
-		double circleX, circleY;
-		circle->getCentre(circleX, circleY);
-		
-		// 找到墙壁上离圆心最近的点
-		double closestX = std::max(wall.getLeft(), std::min(circleX, wall.getRight()));
-		double closestY = std::max(wall.getBottom(), std::min(circleY, wall.getTop()));
-		
-		// 计算圆心到最近点的距离
-		double dx = circleX - closestX;
-		double dy = circleY - closestY;
-		double distToClosest = std::sqrt(dx * dx + dy * dy);
-		
-		// 计算重叠量
-		overlap = circle->getRadius() - distToClosest;
-		
-		// 如果圆心在墙壁内部，使用不同的法向量
-		if (distToClosest < 0.0001) {
-			overlap = circle->getRadius();
-		}
-	}
-	else if (aabb) {
-		// 矩形与墙壁（矩形）碰撞
-		double overlapX = (aabb->getWidth() + wall.getWidth()) / 2.0 - std::abs(shapeX - wallX);
-		double overlapY = (aabb->getHeight() + wall.getHeight()) / 2.0 - std::abs(shapeY - wallY);
-		
-		// 选择较小的重叠量作为分离方向
-		if (overlapX < overlapY) {
-			overlap = overlapX;
-			nx = (shapeX > wallX) ? 1.0 : -1.0;
-			ny = 0.0;
-		} else {
-			overlap = overlapY;
-			nx = 0.0;
-			ny = (shapeY > wallY) ? 1.0 : -1.0;
-		}
-	}
+	// 按类型标记查表计算重叠量（法向量由墙壁指向动态物体，矩形之间会改写为重叠较小的轴）
+	double overlap = wall.computeOverlap(dynamicShape, nx, ny, distance);
 	
 	// 应用位置修正（只修正动态物体）
 	if (overlap > 0) {
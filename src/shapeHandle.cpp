@@ -0,0 +1,67 @@
+#include "shapeHandle.h"
+#include "shapes.h"
+#include <stdexcept>
+
+HandleTable::~HandleTable() {
+	clear();
+}
+
+/*=========================================================================================================
+ * 分配与释放
+ *=========================================================================================================*/
+ShapeHandle HandleTable::acquire(Shape* shape) {
+	if (shape == nullptr) return ShapeHandle();
+	if (shape->handleTable == this) return shape->handle;
+	if (shape->handleTable != nullptr) {
+		shape->handleTable->release(shape);
+	}
+
+	uint32_t index;
+	if (freeSlots.size() - freeHead >= kMinFreeSlots) {
+		index = freeSlots[freeHead++];
+		// 已出队的部分超过一半时整体前移，队列不需要重新分配内存
+		if (freeHead * 2 >= freeSlots.size()) {
+			freeSlots.erase(freeSlots.begin(), freeSlots.begin() + freeHead);
+			freeHead = 0;
+		}
+	} else {
+		// 槽位只有 22 位：超出后编号会写进代数的位，句柄之间会互相混淆，所以直接报错
+		if (slots.size() > ShapeHandle::kIndexMask) {
+			throw std::length_error("HandleTable: 句柄槽位已用完（最多 2^22 个形状）");
+		}
+		index = static_cast<uint32_t>(slots.size());
+		Slot slot;
+		slot.shape = nullptr;
+		slot.generation = 0;
+		slots.push_back(slot);
+	}
+	Slot& slot = slots[index];
+	// 代数从 1 开始，用完后回到 1（代数 0 留给空句柄）
+	slot.generation = (slot.generation >= ShapeHandle::kMaxGeneration) ? 1 : slot.generation + 1;
+	slot.shape = shape;
+	liveCount++;
+
+	shape->handleTable = this;
+	shape->handle = ShapeHandle(index, slot.generation);
+	return shape->handle;
+}
+
+void HandleTable::release(Shape* shape) {
+	if (shape == nullptr || shape->handleTable != this) return;
+	const uint32_t index = shape->handle.index();
+	Slot& slot = slots[index];
+	slot.shape = nullptr;   // 代数在下一次 acquire 时加一
+	freeSlots.push_back(index);
+	liveCount--;
+
+	shape->handleTable = nullptr;
+	shape->handle = ShapeHandle();
+}
+
+void HandleTable::clear() {
+	for (size_t i = 0; i < slots.size(); i++) {
+		if (slots[i].shape != nullptr) {
+			release(slots[i].shape);
+		}
+	}
+}
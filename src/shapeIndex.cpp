@@ -0,0 +1,205 @@
+#include "shapeIndex.h"
+#include <algorithm>
+
+ShapeIndex::~ShapeIndex() {
+	reset();
+}
+
+/*=========================================================================================================
+ * 加入与移出
+ *=========================================================================================================*/
+void ShapeIndex::add(Shape* shape, bool isDynamic) {
+	if (shape == nullptr || shape->shapeIndex == this) return;
+	if (shape->shapeIndex != nullptr) {
+		shape->shapeIndex->remove(shape);
+	}
+
+	shape->shapeIndex = this;
+	shape->indexedDynamic = isDynamic;
+	shape->indexOrder = nextOrder++;
+	shape->nameId = internName(shape->name);
+	nameShapes[shape->nameId].push_back(shape);
+
+	std::unordered_map<std::string, int>::iterator it = typeIds.find(shape->type);
+	if (it == typeIds.end()) {
+		it = typeIds.insert(std::make_pair(shape->type, static_cast<int>(typeBuckets.size()))).first;
+		typeBuckets.push_back(TypeBucket());
+	}
+	shape->typeId = it->second;
+	TypeBucket& bucket = typeBuckets[shape->typeId];
+	std::vector<Shape*>& shapes = (isDynamic ? bucket.dynamicShapes : bucket.staticShapes).shapes;
+	shape->typeSlot = shapes.size();
+	shapes.push_back(shape);
+	registered++;
+}
+
+void ShapeIndex::remove(Shape* shape) {
+	if (shape == nullptr || shape->shapeIndex != this) return;
+	TypeBucket& bucket = typeBuckets[shape->typeId];
+	swapRemove(shape->indexedDynamic ? bucket.dynamicShapes : bucket.staticShapes, shape);
+	eraseShape(nameShapes[shape->nameId], shape);
+	releaseName(shape->nameId, shape->name);
+	unlink(shape);
+	registered--;
+}
+
+void ShapeIndex::removeAll(bool isDynamic) {
+	for (size_t t = 0; t < typeBuckets.size(); t++) {
+		ShapeBucket& bucket = isDynamic ? typeBuckets[t].dynamicShapes : typeBuckets[t].staticShapes;
+		std::vector<Shape*>& shapes = bucket.shapes;
+		for (size_t i = 0; i < shapes.size(); i++) {
+			Shape* shape = shapes[i];
+			eraseShape(nameShapes[shape->nameId], shape);
+			releaseName(shape->nameId, shape->name);
+			unlink(shape);
+		}
+		registered -= shapes.size();
+		shapes.clear();
+		bucket.ordered = true;
+	}
+}
+
+void ShapeIndex::clear() {
+	for (size_t id = 0; id < nameShapes.size(); id++) {
+		for (size_t i = 0; i < nameShapes[id].size(); i++) {
+			unlink(nameShapes[id][i]);
+		}
+	}
+	nameIds.clear();
+	nameShapes.clear();
+	freeNameIds.clear();
+	typeIds.clear();
+	typeBuckets.clear();
+	registered = 0;
+}
+
+void ShapeIndex::reset() {
+	clear();
+	nameCounters.clear();
+	nextOrder = 0;
+}
+
+void ShapeIndex::unlink(Shape* shape) {
+	shape->shapeIndex = nullptr;
+	shape->nameId = -1;
+	shape->typeId = -1;
+}
+
+void ShapeIndex::eraseShape(std::vector<Shape*>& shapes, Shape* shape) {
+	// 保持加入顺序；同名形状通常只有一个，所以名称桶几乎总是直接命中
+	std::vector<Shape*>::iterator it = std::find(shapes.begin(), shapes.end(), shape);
+	if (it != shapes.end()) {
+		shapes.erase(it);
+	}
+}
+
+void ShapeIndex::swapRemove(ShapeBucket& bucket, Shape* shape) {
+	std::vector<Shape*>& shapes = bucket.shapes;
+	const size_t slot = shape->typeSlot;
+	if (slot + 1 != shapes.size()) {
+		shapes[slot] = shapes.back();
+		shapes[slot]->typeSlot = slot;
+		bucket.ordered = false;
+	}
+	shapes.pop_back();
+}
+
+bool ShapeIndex::addedBefore(const Shape* a, const Shape* b) {
+	return a->indexOrder < b->indexOrder;
+}
+
+void ShapeIndex::sortBucket(ShapeBucket& bucket) {
+	std::vector<Shape*>& shapes = bucket.shapes;
+	std::sort(shapes.begin(), shapes.end(), addedBefore);
+	for (size_t i = 0; i < shapes.size(); i++) {
+		shapes[i]->typeSlot = i;
+	}
+	bucket.ordered = true;
+}
+
+void ShapeIndex::insertInOrder(std::vector<Shape*>& shapes, Shape* shape) {
+	// 改名后按加入顺序插入，重名时 findByName 仍返回列表中靠前的形状
+	std::vector<Shape*>::iterator it = shapes.end();
+	while (it != shapes.begin() && (*(it - 1))->indexOrder > shape->indexOrder) {
+		--it;
+	}
+	shapes.insert(it, shape);
+}
+
+/*=========================================================================================================
+ * 名称登记
+ *=========================================================================================================*/
+int ShapeIndex::internName(const std::string& name) {
+	std::unordered_map<std::string, int>::iterator it = nameIds.find(name);
+	if (it != nameIds.end()) {
+		return it->second;
+	}
+	int id;
+	if (!freeNameIds.empty()) {
+		id = freeNameIds.back();
+		freeNameIds.pop_back();
+	} else {
+		id = static_cast<int>(nameShapes.size());
+		nameShapes.push_back(std::vector<Shape*>());
+	}
+	nameIds.insert(std::make_pair(name, id));
+	return id;
+}
+
+void ShapeIndex::releaseName(int nameId, const std::string& name) {
+	// 没有形状再使用这个名称：从名称表删除，编号回收
+	if (nameShapes[nameId].empty()) {
+		nameIds.erase(name);
+		freeNameIds.push_back(nameId);
+	}
+}
+
+void ShapeIndex::rename(Shape* shape, const std::string& newName) {
+	if (shape->name == newName) return;
+	if (shape->shapeIndex != this) {
+		shape->name = newName;
+		return;
+	}
+	eraseShape(nameShapes[shape->nameId], shape);
+	releaseName(shape->nameId, shape->name);
+	shape->name = newName;
+	shape->nameId = internName(newName);
+	insertInOrder(nameShapes[shape->nameId], shape);
+}
+
+/*=========================================================================================================
+ * 查询
+ *=========================================================================================================*/
+Shape* ShapeIndex::findByName(const std::string& name, bool isDynamic) const {
+	std::unordered_map<std::string, int>::const_iterator it = nameIds.find(name);
+	if (it == nameIds.end()) return nullptr;
+	const std::vector<Shape*>& shapes = nameShapes[it->second];
+	for (size_t i = 0; i < shapes.size(); i++) {
+		if (shapes[i]->indexedDynamic == isDynamic) {
+			return shapes[i];
+		}
+	}
+	return nullptr;
+}
+
+const std::vector<Shape*>& ShapeIndex::findByType(const std::string& type, bool isDynamic) {
+	static const std::vector<Shape*> none;
+	std::unordered_map<std::string, int>::const_iterator it = typeIds.find(type);
+	if (it == typeIds.end()) return none;
+	TypeBucket& typeBucket = typeBuckets[it->second];
+	ShapeBucket& bucket = isDynamic ? typeBucket.dynamicShapes : typeBucket.staticShapes;
+	if (!bucket.ordered) {
+		sortBucket(bucket);
+	}
+	return bucket.shapes;
+}
+
+std::string ShapeIndex::makeUniqueName(const std::string& prefix) {
+	int& counter = nameCounters[prefix];
+	std::string candidate;
+	do {
+		counter++;
+		candidate = prefix + "_" + std::to_string(counter);
+	} while (containsName(candidate));
+	return candidate;
+}
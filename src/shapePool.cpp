@@ -0,0 +1,118 @@
+#include "shapePool.h"
+
+ShapePool::~ShapePool() {
+	releaseAll();
+	for (size_t c = 0; c < classes.size(); c++) {
+		for (size_t k = 0; k < classes[c].chunks.size(); k++) {
+			::operator delete(classes[c].chunks[k].memory);
+		}
+	}
+}
+
+/*=========================================================================================================
+ * 分配与回收
+ *=========================================================================================================*/
+void* ShapePool::allocate(size_t bytes) {
+	const size_t index = (bytes + kClassBytes - 1) / kClassBytes - 1;
+	if (index >= classes.size()) {
+		classes.resize(index + 1);
+	}
+	SizeClass& sizeClass = classes[index];
+	if (sizeClass.stride == 0) {
+		sizeClass.stride = kHeaderBytes + (index + 1) * kClassBytes;
+	}
+	if (sizeClass.freeList == nullptr) {
+		addChunk(sizeClass);
+	}
+
+	SlotHeader* header = sizeClass.freeList;
+	sizeClass.freeList = header->nextFree;
+	header->nextFree = nullptr;
+	header->sizeClass = static_cast<unsigned short>(index);
+	header->live = true;
+	liveCount++;
+	return reinterpret_cast<char*>(header) + kHeaderBytes;
+}
+
+void ShapePool::addChunk(SizeClass& sizeClass) {
+	Chunk chunk;
+	chunk.slotCount = sizeClass.nextChunkSlots;
+	chunk.memory = static_cast<char*>(::operator new(chunk.slotCount * sizeClass.stride));
+	if (sizeClass.nextChunkSlots < kMaxChunkSlots) {
+		sizeClass.nextChunkSlots *= 2;
+	}
+
+	// 新槽位按地址顺序串进空闲链表
+	for (size_t s = chunk.slotCount; s-- > 0;) {
+		SlotHeader* header = reinterpret_cast<SlotHeader*>(chunk.memory + s * sizeClass.stride);
+		header->live = false;
+		header->nextFree = sizeClass.freeList;
+		sizeClass.freeList = header;
+	}
+	sizeClass.chunks.push_back(chunk);
+}
+
+ShapePool::SlotHeader* ShapePool::headerOf(const Shape* shape) {
+	// 对象的起始地址（最派生类型），槽位记录在它前面
+	const char* object = static_cast<const char*>(dynamic_cast<const void*>(shape));
+	return reinterpret_cast<SlotHeader*>(const_cast<char*>(object) - kHeaderBytes);
+}
+
+void ShapePool::destroy(Shape* shape) {
+	if (shape == nullptr) return;
+	SlotHeader* header = headerOf(shape);
+	shape->ownerPool = nullptr;
+	shape->~Shape();
+
+	SizeClass& sizeClass = classes[header->sizeClass];
+	header->live = false;
+	header->nextFree = sizeClass.freeList;
+	sizeClass.freeList = header;
+	liveCount--;
+}
+
+void ShapePool::releaseAll() {
+	for (size_t c = 0; c < classes.size(); c++) {
+		SizeClass& sizeClass = classes[c];
+		sizeClass.freeList = nullptr;
+		// 倒序重建空闲链表，之后按地址顺序分配
+		for (size_t k = sizeClass.chunks.size(); k-- > 0;) {
+			const Chunk& chunk = sizeClass.chunks[k];
+			for (size_t s = chunk.slotCount; s-- > 0;) {
+				SlotHeader* header = reinterpret_cast<SlotHeader*>(chunk.memory + s * sizeClass.stride);
+				if (header->live) {
+					Shape* shape = reinterpret_cast<Shape*>(reinterpret_cast<char*>(header) + kHeaderBytes);
+					shape->ownerPool = nullptr;
+					shape->~Shape();
+					header->live = false;
+				}
+				header->nextFree = sizeClass.freeList;
+				sizeClass.freeList = header;
+			}
+		}
+	}
+	liveCount = 0;
+}
+
+/*=========================================================================================================
+ * 查询
+ *=========================================================================================================*/
+size_t ShapePool::capacity() const {
+	size_t slots = 0;
+	for (size_t c = 0; c < classes.size(); c++) {
+		for (size_t k = 0; k < classes[c].chunks.size(); k++) {
+			slots += classes[c].chunks[k].slotCount;
+		}
+	}
+	return slots;
+}
+
+size_t ShapePool::reservedBytes() const {
+	size_t bytes = 0;
+	for (size_t c = 0; c < classes.size(); c++) {
+		for (size_t k = 0; k < classes[c].chunks.size(); k++) {
+			bytes += classes[c].chunks[k].slotCount * classes[c].stride;
+		}
+	}
+	return bytes;
+}
@@ -1,4 +1,6 @@
 #include "shapes.h"
+#include "bodyStore.h"
+#include "shapeIndex.h"
 #include <iostream>
 #include <cmath>
 #include <assert.h>
@@ -11,7 +13,80 @@ const double PI = 3.14159265358979323846;
  * Shape类方法实现
  * 基类形状类
  *=========================================================================================================*/
+void Shape::initState(double x, double y, double vx, double vy) {
+    ownState[0] = x;
+    ownState[1] = y;
+    ownState[2] = vx;
+    ownState[3] = vy;
+    ownState[4] = 0.0;
+    ownState[5] = 0.0;
+    bindState(ownState, ownState + 2, ownState + 4);
+}
+
+void Shape::bindState(double* position, double* vel, double* force) {
+    mass_centre = position;
+    velocity = vel;
+    totalforce = force;
+}
+
+Shape::Shape(const Shape& other)
+    : name(other.name), type(other.type),
+      fraction(other.fraction), static_fraction(other.static_fraction), restitution(other.restitution), kind(other.kind),
+      normalforce{other.normalforce[0], other.normalforce[1]}, supporter(other.supporter),
+      sleeping(other.sleeping), sleepCounter(other.sleepCounter), mass(other.mass), isSupported(other.isSupported),
+      supporterShape(other.supporterShape) {
+    initState(other.mass_centre[0], other.mass_centre[1], other.velocity[0], other.velocity[1]);
+    totalforce[0] = other.totalforce[0];
+    totalforce[1] = other.totalforce[1];
+}
+
+Shape& Shape::operator=(const Shape& other) {
+    if (this == &other) return *this;
+    setName(other.name);
+    type = other.type;
+    setMass(other.mass);
+    fraction = other.fraction;
+    static_fraction = other.static_fraction;
+    restitution = other.restitution;
+    kind = other.kind;
+    normalforce[0] = other.normalforce[0];
+    normalforce[1] = other.normalforce[1];
+    setIsSupported(other.isSupported);
+    supporter = other.supporter;
+    supporterShape = other.supporterShape;
+    sleeping = other.sleeping;
+    sleepCounter = other.sleepCounter;
+    // 通过视图写入：已加入 BodyStore 的物体仍留在原来的槽位
+    for (int k = 0; k < 2; k++) {
+        mass_centre[k] = other.mass_centre[k];
+        velocity[k] = other.velocity[k];
+        totalforce[k] = other.totalforce[k];
+    }
+    return *this;
+}
+
+Shape::~Shape() {
+    if (bodyStore != nullptr) {
+        bodyStore->detach(this);
+    }
+    if (shapeIndex != nullptr) {
+        shapeIndex->remove(this);
+    }
+    if (handleTable != nullptr) {
+        handleTable->release(this);
+    }
+}
+
+void Shape::setName(const std::string& n) {
+    if (shapeIndex != nullptr) {
+        shapeIndex->rename(this, n);
+    } else {
+        name = n;
+    }
+}
+
 void Shape::move(double dx, double dy) {
+    if (sleeping) wakeUp();
     mass_centre[0] += dx;
     mass_centre[1] += dy;
 }
@@ -136,14 +211,34 @@ void Shape::getNormalForce(double& fx, double& fy) const {
 
 void Shape::setMass(double m) {
     mass = m;
+    if (bodyStore != nullptr) bodyStore->setMass(bodySlot, mass);
+}
+
+void Shape::setIsSupported(bool supported) {
+    isSupported = supported;
+    if (bodyStore != nullptr) bodyStore->setFlag(bodySlot, BODY_SUPPORTED, supported);
+}
+
+void Shape::resetSupportStatus() {
+    setIsSupported(false);
+    supporter = ShapeHandle();
+    supporterShape = nullptr;
+}
+
+void Shape::wakeUp() {
+    if (sleeping && bodyStore != nullptr) bodyStore->noteWoken(handle);
+    sleeping = false;
+    sleepCounter = 0;
 }
 
 void Shape::setCentre(double x, double y) {
+    if (sleeping) wakeUp();
     mass_centre[0] = x;
     mass_centre[1] = y;
 }
 
 void Shape::setVelocity(double vx, double vy) {
+    if (sleeping) wakeUp();
     velocity[0] = vx;
     velocity[1] = vy;
 }
@@ -159,54 +254,8 @@ void Shape::clearTotalForce() {
 }
 
 void Shape::applyTotalForce(double deltaTime) {
-    // F = ma => a = F/m => v += (F/m) * dt
-    if (mass > 0.0) {
-        // 计算加速度
-        double ax = totalforce[0] / mass;
-        double ay = totalforce[1] / mass;
-        
-        // 计算速度变化
-        double deltaVx = ax * deltaTime;
-        double deltaVy = ay * deltaTime;
-        
-        // 计算新速度
-        double new_vx = velocity[0] + deltaVx;
-        double new_vy = velocity[1] + deltaVy;
-        
-        // 检查是否由于摩擦力导致速度反向
-        // 只有当速度方向改变，且加速度与原速度方向相反时，才认为是摩擦力导致的过度减速
-        // 这种情况下应该将速度设为0，而不是反向
-        
-        // X方向检查
-        if (velocity[0] != 0.0 && new_vx * velocity[0] < 0) {
-            // 速度反向了
-            // 检查是否是摩擦力导致的（加速度与速度反向）
-            if (ax * velocity[0] < 0) {
-                // 加速度与速度反向，可能是摩擦力过大
-                velocity[0] = 0.0;
-            } else {
-                // 加速度与速度同向或垂直，这是正常的物理行为
-                velocity[0] = new_vx;
-            }
-        } else {
-            velocity[0] = new_vx;
-        }
-        
-        // Y方向检查
-        if (velocity[1] != 0.0 && new_vy * velocity[1] < 0) {
-            // 速度反向了
-            if (ay * velocity[1] < 0) {
-                // 加速度与速度反向，可能是摩擦力过大
-                velocity[1] = 0.0;
-            } else {
-                velocity[1] = new_vy;
-            }
-        } else {
-            velocity[1] = new_vy;
-        }
-    }
-    // 应用后清空合力累加器
-    clearTotalForce();
+    // F = ma => a = F/m => v += (F/m) * dt；摩擦力导致的速度反向置 0，应用后清空合力累加器
+    integrateBodyVelocity(mass, velocity, totalforce, deltaTime);
 }
 
 void Shape::applyNormalForce(double normalForce) {
@@ -235,9 +284,10 @@ void Shape::checkSupportStatus(const Shape& supporter_candidate) {
     
     // 如果相对Y速度很小（接近0或向下速度很小），认为被支撑
     if (std::abs(relVy) < 0.5) {  // 阈值可调整
-        isSupported = true;
-        // ✅ 修复：设置支撑者指针
-        supporter = const_cast<Shape*>(&supporter_candidate);
+        setIsSupported(true);
+        // ✅ 修复：记录支撑者（保存句柄，支撑者被删除后自动失效）
+        supporter = supporter_candidate.handle;
+        supporterShape = const_cast<Shape*>(&supporter_candidate);
     }
 }
 
@@ -269,6 +319,7 @@ void DynamicShape::stop() {
 }
 
 void DynamicShape::applyImpulse(double impulseX, double impulseY) {
+    if (sleeping) wakeUp();
     if (mass > 0.0) {
         velocity[0] += impulseX / mass;
         velocity[1] += impulseY / mass;
@@ -307,7 +358,7 @@ void StaticShape::setVelocity(double vx, double vy) {
 }
 
 void StaticShape::setMass(double m) {
-    mass = INFINITY;
+    Shape::setMass(INFINITY);
 }
 
 void StaticShape::editorMove(double dx, double dy) {
@@ -325,70 +376,6 @@ void StaticShape::editorSetCentre(double x, double y) {
  * 圆形类，继承自DynamicShape
  *=========================================================================================================*/
 
-bool Circle::check_collision(const Shape& other) const {
-    // 尝试将other转换为Circle
-    const Circle* other_circle = dynamic_cast<const Circle*>(&other);
-    if (other_circle) {
-        // Circle与Circle的碰撞检测
-        double dx = mass_centre[0] - other_circle->mass_centre[0];
-        double dy = mass_centre[1] - other_circle->mass_centre[1];
-        double distance = std::sqrt(dx * dx + dy * dy);
-        // ✅ 修复：使用 <= 以包含相切情况
-        return distance <= (radius + other_circle->radius);
-    }
-    
-    // 尝试将other转换为AABB
-    const AABB* other_aabb = dynamic_cast<const AABB*>(&other);
-    if (other_aabb) {
-        // Circle与AABB的碰撞检测
-        double closest_x = std::max(other_aabb->mass_centre[0] - other_aabb->width/2,
-                                   std::min(mass_centre[0], other_aabb->mass_centre[0] + other_aabb->width/2));
-        double closest_y = std::max(other_aabb->mass_centre[1] - other_aabb->height/2,
-                                   std::min(mass_centre[1], other_aabb->mass_centre[1] + other_aabb->height/2));
-        
-        double dx = mass_centre[0] - closest_x;
-        double dy = mass_centre[1] - closest_y;
-        double distance = std::sqrt(dx * dx + dy * dy);
-        
-        // ✅ 修复：使用 <= 以包含相切情况
-        return distance <= radius;
-    }
-    
-    // 尝试将other转换为Wall（静态矩形障害物）
-    const Wall* other_wall = dynamic_cast<const Wall*>(&other);
-    if (other_wall) {
-        // Circle与Wall的碰撞检测
-        double closest_x = std::max(other_wall->getLeft(),
-                                   std::min(mass_centre[0], other_wall->getRight()));
-        double closest_y = std::max(other_wall->getBottom(),
-                                   std::min(mass_centre[1], other_wall->getTop()));
-        
-        double dx = mass_centre[0] - closest_x;
-        double dy = mass_centre[1] - closest_y;
-        double distance = std::sqrt(dx * dx + dy * dy);
-        
-        // 更精确：包含相切
-        return distance <= radius;
-    }
-    
-    // 尝试将other转换为Slope（静态斜坡）
-
-const Slope* other_slope = dynamic_cast<const Slope*>(&other);
-    if (other_slope) {
-        // Circle与Slope的碰撞检测（简化：使用距离判断）
-        double dx = mass_centre[0] - other_slope->mass_centre[0];
-        double dy = mass_centre[1] - other_slope->mass_centre[1];
-        double distance = std::sqrt(dx * dx + dy * dy);
-        
-        // 如果圆心到斜坡质心的距离小于半径+斜坡长度，可能碰撞
-        return distance < (radius + other_slope->getLength() / 2.0);
-    }
-    
-    // 无法识别的类型，报错并返回false
-    assert(false && "Unknown shape type for collision detection");
-    return false;
-}
-
 double Circle::getRadius() const {
     return radius;
 }
@@ -401,71 +388,18 @@ double Circle::getCircumference() const {
     return 2.0 * PI * radius;
 }
 
+void Circle::getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const {
+    minX = mass_centre[0] - radius;
+    minY = mass_centre[1] - radius;
+    maxX = mass_centre[0] + radius;
+    maxY = mass_centre[1] + radius;
+}
+
 /*=========================================================================================================
  * AABB类方法实现
  * 轴对齐包围盒类（矩形），继承自DynamicShape
  *=========================================================================================================*/
 
-bool AABB::check_collision(const Shape& other) const {
-    // 尝试将other转换为AABB
-    const AABB* other_aabb = dynamic_cast<const AABB*>(&other);
-    if (other_aabb) {
-        // AABB与AABB的碰撞检测
-        double left1 = mass_centre[0] - width/2;
-        double right1 = mass_centre[0] + width/2;
-        double top1 = mass_centre[1] + height/2;
-        double bottom1 = mass_centre[1] - height/2;
-        
-        double left2 = other_aabb->mass_centre[0] - other_aabb->width/2;
-        double right2 = other_aabb->mass_centre[0] + other_aabb->width/2;
-        double top2 = other_aabb->mass_centre[1] + other_aabb->height/2;
-        double bottom2 = other_aabb->mass_centre[1] - other_aabb->height/2;
-        
-        return !(left1 > right2 || right1 < left2 || bottom1 > top2 || top1 < bottom2);
-    }
-    
-    // 尝试将other转换为Wall（静态矩形障害物）
-    const Wall* other_wall = dynamic_cast<const Wall*>(&other);
-    if (other_wall) {
-        // AABB与Wall的碰撞检测
-        double left1 = mass_centre[0] - width/2;
-        double right1 = mass_centre[0] + width/2;
-        double top1 = mass_centre[1] + height/2;
-        double bottom1 = mass_centre[1] - height/2;
-        
-        double left2 = other_wall->getLeft();
-        double right2 = other_wall->getRight();
-        double top2 = other_wall->getTop();
-        double bottom2 = other_wall->getBottom();
-        
-        return !(left1 > right2 || right1 < left2 || bottom1 > top2 || top1 < bottom2);
-    }
-    
-    // 尝试将other转换为Circle
-    const Circle* other_circle = dynamic_cast<const Circle*>(&other);
-    if (other_circle) {
-        // AABB与Circle的碰撞检测（复用Circle的方法）
-        return other_circle->check_collision(*this);
-    }
-    
-    // 尝试将other转换为Slope（静态斜坡）
-    const Slope* other_slope = dynamic_cast<const Slope*>(&other);
-    if (other_slope) {
-        // AABB与Slope的碰撞检测（简化版本）
-        double dx = mass_centre[0] - other_slope->mass_centre[0];
-        double dy = mass_centre[1] - other_slope->mass_centre[1];
-        double distance = std::sqrt(dx * dx + dy * dy);
-        
-        // 简化判定：如果距离小于AABB对角线的一半 + 斜坡长度的一半
-        double aabbRadius = std::sqrt(width * width + height * height) / 2.0;
-        return distance < (aabbRadius + other_slope->getLength() / 2.0);
-    }
-    
-    // 无法识别的类型，报错
-    assert(false && "Unknown shape type for collision detection");
-    return false;
-}
-
 double AABB::getArea() const {
     return width * height;
 }
@@ -478,6 +412,13 @@ double AABB::getDiagonal() const {
     return std::sqrt(width * width + height * height);
 }
 
+void AABB::getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const {
+    minX = mass_centre[0] - width / 2.0;
+    minY = mass_centre[1] - height / 2.0;
+    maxX = mass_centre[0] + width / 2.0;
+    maxY = mass_centre[1] + height / 2.0;
+}
+
 Shape* AABB::getCompressedShapeDown() const {
     // TODO: 实现获取下方被压缩物体的逻辑
     // 这需要访问物理世界中的所有物体
@@ -523,11 +464,6 @@ void AABB::applyFrictionDOWN() {
  * 斜坡类，继承自StaticShape（静态物体）
  *=========================================================================================================*/
 
-bool Slope::check_collision(const Shape& other) const {
-    // Slope 不主动检测与动态物体的碰撞
-    return false;
-}
-
 double Slope::getAngleDegrees() const {
     return angle * 180.0 / PI;
 }
@@ -544,15 +480,19 @@ double Slope::getSlope() const {
     return std::tan(angle);
 }
 
+void Slope::getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const {
+    // 与 check_collision 中的简化判定一致：以质心为中心、半长为 length/2 的正方形
+    double half = length / 2.0;
+    minX = mass_centre[0] - half;
+    minY = mass_centre[1] - half;
+    maxX = mass_centre[0] + half;
+    maxY = mass_centre[1] + half;
+}
+
 /*=========================================================================================================
  * Ground类方法实现
  *=========================================================================================================*/
 
-bool Ground::check_collision(const Shape& other) const {
-    // 使用统一的getBottom()方法
-    return other.getBottom() <= y_level;
-}
-
 void Ground::getNormal(double& nx, double& ny) const {
     nx = 0.0;
     ny = 1.0;  // 地面法向量向上
@@ -582,6 +522,14 @@ void Ground::setYLevel(double y) {
     mass_centre[1] = y;  // 同步更新质心Y坐标
 }
 
+void Ground::getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const {
+    // 地面在水平方向无限延伸，地面以下全部视为实体
+    minX = -INFINITY;
+    minY = -INFINITY;
+    maxX = INFINITY;
+    maxY = y_level;
+}
+
 double Wall::getArea() const {
     return width * height;
 }
@@ -594,6 +542,13 @@ double Wall::getDiagonal() const {
     return std::sqrt(width * width + height * height);
 }
 
+void Wall::getBoundingBox(double& minX, double& minY, double& maxX, double& maxY) const {
+    minX = getLeft();
+    minY = getBottom();
+    maxX = getRight();
+    maxY = getTop();
+}
+
 bool Wall::containsPoint(double x, double y) const {
     return (x >= getLeft() && x <= getRight() && 
             y >= getBottom() && y <= getTop());
@@ -606,77 +561,285 @@ double Wall::distanceToPoint(double x, double y) const {
 }
 
 /*=========================================================================================================
- * Wall::check_collision - 检测墙壁与其他形状的碰撞
- * 
- * 墙壁是静态矩形，需要与各种动态形状进行碰撞检测
+ * 碰撞分派表
+ *
+ * CollisionKernelFor<A, B> / SeparationKernelFor<A, B> 的特化就是"登记"的内核，
+ * makeCollisionTable / makeSeparationTable 在编译期把所有 (A, B) 组合展开成 SHAPE_KIND_COUNT × SHAPE_KIND_COUNT 的函数指针表。
+ * 未特化的组合使用主模板：不碰撞、无重叠。
  *=========================================================================================================*/
-bool Wall::check_collision(const Shape& other) const {
-    // 尝试将other转换为Circle
-    const Circle* other_circle = dynamic_cast<const Circle*>(&other);
-    if (other_circle) {
-        // 墙壁（矩形）与圆形的碰撞检测
-        // 找到墙壁上离圆心最近的点
-        double circleX, circleY;
-        other_circle->getCentre(circleX, circleY);
-        
-        double closestX = std::max(getLeft(), std::min(circleX, getRight()));
-        double closestY = std::max(getBottom(), std::min(circleY, getTop()));
-        
-        double dx = circleX - closestX;
-        double dy = circleY - closestY;
-        double distance = std::sqrt(dx * dx + dy * dy);
-        
-        return distance <= other_circle->getRadius();
+
+// 几何辅助函数：矩形（AABB、Wall）之间的重叠测试
+template <class Rect1, class Rect2>
+static bool rectsCollide(const Rect1& a, const Rect2& b) {
+    double left1 = a.mass_centre[0] - a.width/2;
+    double right1 = a.mass_centre[0] + a.width/2;
+    double top1 = a.mass_centre[1] + a.height/2;
+    double bottom1 = a.mass_centre[1] - a.height/2;
+
+    double left2 = b.mass_centre[0] - b.width/2;
+    double right2 = b.mass_centre[0] + b.width/2;
+    double top2 = b.mass_centre[1] + b.height/2;
+    double bottom2 = b.mass_centre[1] - b.height/2;
+
+    return !(left1 > right2 || right1 < left2 || bottom1 > top2 || top1 < bottom2);
+}
+
+// 圆心到矩形上最近点的距离的平方（碰撞判定只比较平方，与 narrowphase.cpp 的批量内核运算相同）
+template <class Rect>
+static double circleRectDistanceSquared(const Circle& circle, const Rect& rect) {
+    double closest_x = std::max(rect.mass_centre[0] - rect.width/2,
+                               std::min(circle.mass_centre[0], rect.mass_centre[0] + rect.width/2));
+    double closest_y = std::max(rect.mass_centre[1] - rect.height/2,
+                               std::min(circle.mass_centre[1], rect.mass_centre[1] + rect.height/2));
+
+    double dx = circle.mass_centre[0] - closest_x;
+    double dy = circle.mass_centre[1] - closest_y;
+    return dx * dx + dy * dy;
+}
+
+// 圆心到矩形上最近点的距离
+template <class Rect>
+static double circleRectDistance(const Circle& circle, const Rect& rect) {
+    return std::sqrt(circleRectDistanceSquared(circle, rect));
+}
+
+// 矩形与斜坡的简化判定：距离小于矩形对角线的一半 + 斜坡长度的一半
+template <class Rect>
+static bool rectSlopeCollide(const Rect& rect, const Slope& slope) {
+    double dx = rect.mass_centre[0] - slope.mass_centre[0];
+    double dy = rect.mass_centre[1] - slope.mass_centre[1];
+    double distance = std::sqrt(dx * dx + dy * dy);
+    double rectRadius = std::sqrt(rect.width * rect.width + rect.height * rect.height) / 2.0;
+    return distance < (rectRadius + slope.getLength() / 2.0);
+}
+
+// 矩形之间的重叠量：选择重叠较小的轴作为分离方向（由 a 指向 b）
+template <class Rect1, class Rect2>
+static double rectRectOverlap(const Rect1& a, const Rect2& b, double& nx, double& ny) {
+    double x1 = a.mass_centre[0], y1 = a.mass_centre[1];
+    double x2 = b.mass_centre[0], y2 = b.mass_centre[1];
+    double overlapX = (a.getWidth() + b.getWidth()) / 2.0 - std::abs(x2 - x1);
+    double overlapY = (a.getHeight() + b.getHeight()) / 2.0 - std::abs(y2 - y1);
+
+    if (overlapX < overlapY) {
+        nx = (x2 > x1) ? 1.0 : -1.0;
+        ny = 0.0;
+        return overlapX;
     }
-    
-    // 尝试将other转换为AABB
-    const AABB* other_aabb = dynamic_cast<const AABB*>(&other);
-    if (other_aabb) {
-        // 墙壁（矩形）与AABB（矩形）的碰撞检测
-        double left1 = getLeft();
-        double right1 = getRight();
-        double top1 = getTop();
-        double bottom1 = getBottom();
-        
-        double left2 = other_aabb->getLeft();
-        double right2 = other_aabb->getRight();
-        double top2 = other_aabb->getTop();
-        double bottom2 = other_aabb->getBottom();
-        
-        return !(left1 > right2 || right1 < left2 || bottom1 > top2 || top1 < bottom2);
+    nx = 0.0;
+    ny = (y2 > y1) ? 1.0 : -1.0;
+    return overlapY;
+}
+
+// 圆与矩形的重叠量（沿传入的法向量分离）
+template <class Rect>
+static double circleRectOverlap(const Circle& circle, const Rect& rect) {
+    double distToClosest = circleRectDistance(circle, rect);
+    if (distToClosest < 0.0001) {
+        return circle.getRadius();
     }
-    
-    // 尝试将other转换为Wall
-    const Wall* other_wall = dynamic_cast<const Wall*>(&other);
-    if (other_wall) {
-        // 墙壁与墙壁的碰撞检测（矩形与矩形）
-        double left1 = getLeft();
-        double right1 = getRight();
-        double top1 = getTop();
-        double bottom1 = getBottom();
-        
-        double left2 = other_wall->getLeft();
-        double right2 = other_wall->getRight();
-        double top2 = other_wall->getTop();
-        double bottom2 = other_wall->getBottom();
-        
-        return !(left1 > right2 || right1 < left2 || bottom1 > top2 || top1 < bottom2);
+    return circle.getRadius() - distToClosest;
+}
+
+// ---------- 碰撞检测内核 ----------
+template <int A, int B>
+struct CollisionKernelFor {
+    static bool run(const Shape&, const Shape&) { return false; }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_CIRCLE, SHAPE_CIRCLE> {
+    static bool run(const Shape& a, const Shape& b) {
+        const Circle& c1 = static_cast<const Circle&>(a);
+        const Circle& c2 = static_cast<const Circle&>(b);
+        double dx = c1.mass_centre[0] - c2.mass_centre[0];
+        double dy = c1.mass_centre[1] - c2.mass_centre[1];
+        double radiusSum = c1.radius + c2.radius;
+        // 比较距离的平方，不开平方；使用 <= 以包含相切情况
+        return dx * dx + dy * dy <= radiusSum * radiusSum;
     }
-    
-    // 尝试将other转换为Slope（静态斜坡）
-    const Slope* other_slope = dynamic_cast<const Slope*>(&other);
-    if (other_slope) {
-        // 墙壁与斜坡的碰撞检测（简化版本）
-        double dx = mass_centre[0] - other_slope->mass_centre[0];
-        double dy = mass_centre[1] - other_slope->mass_centre[1];
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_CIRCLE, SHAPE_AABB> {
+    static bool run(const Shape& a, const Shape& b) {
+        const Circle& circle = static_cast<const Circle&>(a);
+        return circleRectDistanceSquared(circle, static_cast<const AABB&>(b)) <= circle.radius * circle.radius;
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_CIRCLE, SHAPE_WALL> {
+    static bool run(const Shape& a, const Shape& b) {
+        const Circle& circle = static_cast<const Circle&>(a);
+        return circleRectDistanceSquared(circle, static_cast<const Wall&>(b)) <= circle.radius * circle.radius;
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_CIRCLE, SHAPE_SLOPE> {
+    static bool run(const Shape& a, const Shape& b) {
+        // 简化：圆心到斜坡质心的距离小于半径 + 斜坡长度的一半
+        const Circle& circle = static_cast<const Circle&>(a);
+        const Slope& slope = static_cast<const Slope&>(b);
+        double dx = circle.mass_centre[0] - slope.mass_centre[0];
+        double dy = circle.mass_centre[1] - slope.mass_centre[1];
         double distance = std::sqrt(dx * dx + dy * dy);
-        
-        // 简化判定：如果距离小于墙壁对角线的一半 + 斜坡长度的一半
-        double wallRadius = getDiagonal() / 2.0;
-        return distance < (wallRadius + other_slope->getLength() / 2.0);
+        return distance < (circle.radius + slope.getLength() / 2.0);
     }
-    
-    // 无法识别的类型，返回false
-    return false;
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_AABB, SHAPE_CIRCLE> {
+    static bool run(const Shape& a, const Shape& b) {
+        return CollisionKernelFor<SHAPE_CIRCLE, SHAPE_AABB>::run(b, a);
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_AABB, SHAPE_AABB> {
+    static bool run(const Shape& a, const Shape& b) {
+        return rectsCollide(static_cast<const AABB&>(a), static_cast<const AABB&>(b));
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_AABB, SHAPE_WALL> {
+    static bool run(const Shape& a, const Shape& b) {
+        return rectsCollide(static_cast<const AABB&>(a), static_cast<const Wall&>(b));
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_AABB, SHAPE_SLOPE> {
+    static bool run(const Shape& a, const Shape& b) {
+        return rectSlopeCollide(static_cast<const AABB&>(a), static_cast<const Slope&>(b));
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_WALL, SHAPE_CIRCLE> {
+    static bool run(const Shape& a, const Shape& b) {
+        return CollisionKernelFor<SHAPE_CIRCLE, SHAPE_WALL>::run(b, a);
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_WALL, SHAPE_AABB> {
+    static bool run(const Shape& a, const Shape& b) {
+        return rectsCollide(static_cast<const Wall&>(a), static_cast<const AABB&>(b));
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_WALL, SHAPE_WALL> {
+    static bool run(const Shape& a, const Shape& b) {
+        return rectsCollide(static_cast<const Wall&>(a), static_cast<const Wall&>(b));
+    }
+};
+
+template <>
+struct CollisionKernelFor<SHAPE_WALL, SHAPE_SLOPE> {
+    static bool run(const Shape& a, const Shape& b) {
+        return rectSlopeCollide(static_cast<const Wall&>(a), static_cast<const Slope&>(b));
+    }
+};
+
+// 地面与任何形状：形状底部低于地面即为碰撞
+// （Slope 不主动检测碰撞，Slope 这一行全部使用主模板）
+template <int B>
+struct CollisionKernelFor<SHAPE_GROUND, B> {
+    static bool run(const Shape& a, const Shape& b) {
+        return b.getBottom() <= static_cast<const Ground&>(a).y_level;
+    }
+};
+
+// ---------- 重叠分离内核 ----------
+template <int A, int B>
+struct SeparationKernelFor {
+    static double run(const Shape&, const Shape&, double&, double&, double) { return 0.0; }
+};
+
+template <>
+struct SeparationKernelFor<SHAPE_CIRCLE, SHAPE_CIRCLE> {
+    static double run(const Shape& a, const Shape& b, double&, double&, double distance) {
+        return static_cast<const Circle&>(a).getRadius() + static_cast<const Circle&>(b).getRadius() - distance;
+    }
+};
+
+template <>
+struct SeparationKernelFor<SHAPE_AABB, SHAPE_AABB> {
+    static double run(const Shape& a, const Shape& b, double& nx, double& ny, double) {
+        return rectRectOverlap(static_cast<const AABB&>(a), static_cast<const AABB&>(b), nx, ny);
+    }
+};
+
+template <>
+struct SeparationKernelFor<SHAPE_AABB, SHAPE_WALL> {
+    static double run(const Shape& a, const Shape& b, double& nx, double& ny, double) {
+        return rectRectOverlap(static_cast<const AABB&>(a), static_cast<const Wall&>(b), nx, ny);
+    }
+};
+
+template <>
+struct SeparationKernelFor<SHAPE_WALL, SHAPE_AABB> {
+    static double run(const Shape& a, const Shape& b, double& nx, double& ny, double) {
+        return rectRectOverlap(static_cast<const Wall&>(a), static_cast<const AABB&>(b), nx, ny);
+    }
+};
+
+template <>
+struct SeparationKernelFor<SHAPE_CIRCLE, SHAPE_AABB> {
+    static double run(const Shape& a, const Shape& b, double&, double&, double) {
+        return circleRectOverlap(static_cast<const Circle&>(a), static_cast<const AABB&>(b));
+    }
+};
+
+template <>
+struct SeparationKernelFor<SHAPE_AABB, SHAPE_CIRCLE> {
+    static double run(const Shape& a, const Shape& b, double&, double&, double) {
+        return circleRectOverlap(static_cast<const Circle&>(b), static_cast<const AABB&>(a));
+    }
+};
+
+template <>
+struct SeparationKernelFor<SHAPE_CIRCLE, SHAPE_WALL> {
+    static double run(const Shape& a, const Shape& b, double&, double&, double) {
+        return circleRectOverlap(static_cast<const Circle&>(a), static_cast<const Wall&>(b));
+    }
+};
+
+template <>
+struct SeparationKernelFor<SHAPE_WALL, SHAPE_CIRCLE> {
+    static double run(const Shape& a, const Shape& b, double&, double&, double) {
+        return circleRectOverlap(static_cast<const Circle&>(b), static_cast<const Wall&>(a));
+    }
+};
+
+// ---------- 编译期生成分派表 ----------
+template <int... I> struct KindSequence {};
+template <int N, int... I> struct MakeKindSequence : MakeKindSequence<N - 1, N - 1, I...> {};
+template <int... I> struct MakeKindSequence<0, I...> { typedef KindSequence<I...> type; };
+
+template <int A, int... B>
+static constexpr CollisionRow makeCollisionRow(KindSequence<B...>) {
+    return CollisionRow{{ &CollisionKernelFor<A, B>::run... }};
+}
+
+template <int... A>
+static constexpr CollisionDispatchTable makeCollisionTable(KindSequence<A...> kinds) {
+    return CollisionDispatchTable{{ makeCollisionRow<A>(kinds)... }};
+}
+
+template <int A, int... B>
+static constexpr SeparationRow makeSeparationRow(KindSequence<B...>) {
+    return SeparationRow{{ &SeparationKernelFor<A, B>::run... }};
+}
+
+template <int... A>
+static constexpr SeparationDispatchTable makeSeparationTable(KindSequence<A...> kinds) {
+    return SeparationDispatchTable{{ makeSeparationRow<A>(kinds)... }};
 }
 
+const CollisionDispatchTable collisionTable = makeCollisionTable(MakeKindSequence<SHAPE_KIND_COUNT>::type());
+const SeparationDispatchTable separationTable = makeSeparationTable(MakeKindSequence<SHAPE_KIND_COUNT>::type());
@@ -0,0 +1,286 @@
+/*=========================================================================================================
+ * 动态包围盒树测试 - 验证 DynamicAABBTree、AABBTreeBroadphase 和静态形状树
+ *
+ * 测试场景：
+ * 1. 树的平衡：插入/删除大量叶子后，树高接近 log2(n)，左右子树高度差不超过 1
+ * 2. 宽相位一致性：大小悬殊的形状连续运动 20 帧，候选对与空间哈希完全相同，重新插入次数很少
+ * 3. 静态形状树：只在 addStaticShape / removeStaticShape / placeWall 之后重建，查询结果与逐个测试一致
+ * 4. 物理世界集成：堆叠场景下包围盒树与全配对的模拟结果完全一致
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include "physicalWorld.h"
+#include "broadphase.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+double randomRange(double lo, double hi) {
+    return lo + (hi - lo) * (std::rand() / static_cast<double>(RAND_MAX));
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+// 测试1：树的平衡
+bool test_tree_balance() {
+    printSeparator();
+    std::cout << "测试1：树的平衡（插入 10000 个叶子，删除一半）" << std::endl;
+    printSeparator();
+
+    std::srand(2024);
+    DynamicAABBTree tree;
+    std::vector<int> proxies;
+
+    // 按 x 坐标递增插入：不做旋转的话会退化成链表
+    for (int i = 0; i < 10000; i++) {
+        BroadphaseBounds b;
+        b.minX = i * 1.0;
+        b.minY = randomRange(-5.0, 5.0);
+        b.maxX = b.minX + 0.8;
+        b.maxY = b.minY + 0.8;
+        proxies.push_back(tree.createProxy(b, i, 0.1));
+    }
+    int heightFull = tree.getHeight();
+    int balanceFull = tree.getMaxBalance();
+
+    for (size_t i = 0; i < proxies.size(); i += 2) {
+        tree.destroyProxy(proxies[i]);
+    }
+    int heightHalf = tree.getHeight();
+    int balanceHalf = tree.getMaxBalance();
+
+    std::cout << "  10000 个叶子: 树高 " << heightFull << "，最大高度差 " << balanceFull << std::endl;
+    std::cout << "  删除一半后: 叶子 " << tree.getProxyCount() << "，树高 " << heightHalf
+              << "，最大高度差 " << balanceHalf << std::endl;
+
+    // 查询一个区域，结果必须与逐个测试一致
+    BroadphaseBounds area;
+    area.minX = 100.0; area.maxX = 200.0; area.minY = -1.0; area.maxY = 1.0;
+    std::vector<int> found;
+    tree.query(area, found);
+    size_t expected = 0;
+    for (size_t i = 1; i < proxies.size(); i += 2) {
+        if (tree.getFatBounds(proxies[i]).overlaps(area)) expected++;
+    }
+    std::cout << "  区域查询: 找到 " << found.size() << " 个，逐个测试 " << expected << " 个" << std::endl;
+
+    bool ok = heightFull <= 20 && balanceFull <= 1 && balanceHalf <= 1 &&
+              tree.getProxyCount() == 5000 && found.size() == expected;
+    std::cout << "  结果: " << (ok ? "树保持平衡 ✓" : "树不平衡或查询错误 ✗") << std::endl;
+    return ok;
+}
+
+// 测试2：与空间哈希的候选对一致
+bool test_tree_broadphase_coherence() {
+    printSeparator();
+    std::cout << "测试2：包围盒树宽相位（大小悬殊的形状，连续运动 20 帧）" << std::endl;
+    printSeparator();
+
+    std::srand(99);
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < 3000; i++) {
+        double x = randomRange(-100.0, 100.0);
+        double y = randomRange(-100.0, 100.0);
+        if (i % 50 == 0) {
+            shapes.push_back(new AABB(1.0, randomRange(10.0, 30.0), randomRange(10.0, 30.0), x, y));
+        } else {
+            shapes.push_back(new Circle(1.0, randomRange(0.1, 0.6), x, y));
+        }
+    }
+    shapes.push_back(new Wall(200.0, 2.0, 0.0, -100.0));
+    shapes.push_back(new Wall(2.0, 200.0, 100.0, 0.0));
+    Ground* ground = new Ground(-100.0);
+    shapes.push_back(ground);
+
+    SpatialHashGrid grid;
+    AABBTreeBroadphase treePhase;
+    std::vector<CandidatePair> gridPairs;
+    std::vector<CandidatePair> treePairs;
+
+    bool allEqual = true;
+    size_t maxReinserts = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        if (frame > 0) {
+            for (size_t i = 0; i < 3000; i++) {
+                shapes[i]->move(randomRange(-0.05, 0.05), randomRange(-0.05, 0.05));
+            }
+        }
+        grid.update(shapes);
+        grid.computePairs(gridPairs);
+        treePhase.update(shapes);
+        treePhase.computePairs(treePairs);
+
+        if (gridPairs != treePairs) {
+            allEqual = false;
+        }
+        if (frame > 0 && treePhase.getStats().proxyReinserts > maxReinserts) {
+            maxReinserts = treePhase.getStats().proxyReinserts;
+        }
+    }
+
+    const BroadphaseStats& stats = treePhase.getStats();
+    std::cout << "  形状数量: " << stats.shapeCount << "，树中叶子: " << treePhase.getTree().getProxyCount()
+              << "，树高: " << treePhase.getTree().getHeight() << std::endl;
+    std::cout << "  候选对数量: " << stats.candidatePairs << "（节省 " << stats.savedPairTests << " 次测试）" << std::endl;
+    std::cout << "  单帧最多重新插入: " << maxReinserts << std::endl;
+    std::cout << "  与空间哈希候选对一致: " << (allEqual ? "是 ✓" : "否 ✗") << std::endl;
+
+    bool ok = allEqual && maxReinserts < 300;
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试3：静态形状树
+bool test_static_tree() {
+    printSeparator();
+    std::cout << "测试3：静态形状树（只在静态形状列表修改后重建）" << std::endl;
+    printSeparator();
+
+    std::srand(5);
+    PhysicalWorld world;
+    for (int i = 0; i < 2000; i++) {
+        world.placeWall("Wall" + std::to_string(i), randomRange(-500.0, 500.0), randomRange(-500.0, 500.0),
+                        randomRange(1.0, 20.0), randomRange(1.0, 20.0), 0.0);
+    }
+
+    Circle probe(1.0, 3.0, 0.0, 0.0);
+    std::vector<Shape*> found;
+    bool allMatch = true;
+
+    // 多次查询，只应重建一次
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int q = 0; q < 1000; q++) {
+        probe.setCentre(randomRange(-500.0, 500.0), randomRange(-500.0, 500.0));
+        found.clear();
+        world.queryStaticShapes(probe, found);
+
+        // 逐个测试作为对照
+        double pminX, pminY, pmaxX, pmaxY;
+        probe.getBoundingBox(pminX, pminY, pmaxX, pmaxY);
+        std::vector<Shape*> expected;
+        for (size_t i = 0; i < world.staticShapeList.size(); i++) {
+            double minX, minY, maxX, maxY;
+            world.staticShapeList[i]->getBoundingBox(minX, minY, maxX, maxY);
+            if (!(minX > pmaxX || maxX < pminX || minY > pmaxY || maxY < pminY)) {
+                expected.push_back(world.staticShapeList[i]);
+            }
+        }
+        if (found != expected) allMatch = false;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    size_t buildsAfterQueries = world.getStaticTreeBuildCount();
+
+    // 动态物体运动不会触发重建
+    Circle* ball = new Circle(1.0, 1.0, 0.0, 600.0);
+    world.addDynamicShape(ball);
+    for (int i = 0; i < 10; i++) {
+        world.update(world.dynamicShapeList, world.ground);
+        found.clear();
+        world.queryStaticShapes(*ball, found);
+    }
+    size_t buildsAfterSteps = world.getStaticTreeBuildCount();
+
+    // 修改静态形状列表后重建一次
+    Shape* removed = world.staticShapeList[0];
+    world.removeStaticShape(removed);
+    found.clear();
+    world.queryStaticShapes(probe, found);
+    world.placeWall("Extra", 0.0, 0.0, 5.0, 5.0, 0.0);
+    found.clear();
+    world.queryStaticShapes(probe, found);
+    size_t buildsAfterEdits = world.getStaticTreeBuildCount();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "  静态形状: " << world.getStaticShapeCount() << std::endl;
+    std::cout << "  1000 次查询（含逐个对照）耗时: " << std::fixed << std::setprecision(2) << ms << " ms" << std::endl;
+    std::cout << "  查询结果与逐个测试一致: " << (allMatch ? "是 ✓" : "否 ✗") << std::endl;
+    std::cout << "  重建次数: 查询后 " << buildsAfterQueries << "，模拟后 " << buildsAfterSteps
+              << "，删除 + placeWall 后 " << buildsAfterEdits << std::endl;
+
+    bool ok = allMatch && buildsAfterQueries == 1 && buildsAfterSteps == 1 && buildsAfterEdits == 3;
+    std::cout << "  结果: " << (ok ? "只在静态形状修改后重建 ✓" : "重建次数错误 ✗") << std::endl;
+
+    delete ball;   // 墙壁由 placeWall 创建，属于世界
+    return ok;
+}
+
+// 测试4：物理世界集成
+std::vector<double> runStackScene(BroadphaseType type) {
+    PhysicalWorld world;
+    world.setBroadphaseType(type);
+    world.setGravity(10.0);
+    world.ground.setYLevel(0.0);
+    world.ground.setFriction(0.3, 0.4);
+
+    std::vector<Shape*> shapes;
+    for (int column = 0; column < 10; column++) {
+        for (int level = 0; level < 8; level++) {
+            AABB* block = new AABB(1.0, 2.0, 1.0, column * 3.0, 0.5 + level * 1.0);
+            block->setFraction(0.3);
+            block->setStaticFraction(0.4);
+            shapes.push_back(block);
+            world.addDynamicShape(block);
+        }
+    }
+    Circle* ball = new Circle(2.0, 0.5, -10.0, 3.0, 15.0, 0.0);
+    shapes.push_back(ball);
+    world.addDynamicShape(ball);
+
+    for (int i = 0; i < 180; i++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+
+    std::vector<double> state;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double x, y, vx, vy;
+        shapes[i]->getCentre(x, y);
+        shapes[i]->getVelocity(vx, vy);
+        state.push_back(x);
+        state.push_back(y);
+        state.push_back(vx);
+        state.push_back(vy);
+    }
+    deleteShapes(shapes);
+    return state;
+}
+
+bool test_world_integration() {
+    printSeparator();
+    std::cout << "测试4：堆叠场景下包围盒树与全配对结果一致" << std::endl;
+    printSeparator();
+
+    std::vector<double> brute = runStackScene(BROADPHASE_BRUTE_FORCE);
+    std::vector<double> tree = runStackScene(BROADPHASE_AABB_TREE);
+    bool same = (brute == tree);
+    std::cout << "  结果: " << (same ? "完全一致 ✓" : "不一致 ✗") << std::endl;
+    return same;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_tree_balance()) passed++;
+    total++; if (test_tree_broadphase_coherence()) passed++;
+    total++; if (test_static_tree()) passed++;
+    total++; if (test_world_integration()) passed++;
+
+    printSeparator();
+    std::cout << "包围盒树测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+
+    return passed == total ? 0 : 1;
+}
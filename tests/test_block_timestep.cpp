@@ -0,0 +1,258 @@
+/*=========================================================================================================
+ * 分层时间步测试 - 验证每个物体按自己的 2 的幂步长做 kick-drift-kick 蛙跳积分
+ *
+ * 测试场景：
+ * 1. 级别选择：中心天体周围不同半径的圆轨道，内圈的级别更深，外圈的更浅
+ * 2. 吞吐量与能量：分层系统（少数内圈物体 + 大量外圈物体）与"所有物体按最小步长走"的统一蛙跳比较
+ *    求加速度的次数、耗时和相对能量漂移
+ * 3. 世界中的太阳系：较大的帧时间下，关闭分层时间步时内圈行星的轨道发散，开启后内外圈都保持圆轨道
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "gravity.h"
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+const double G = 5.0;
+const double centralMass = 1000.0;
+
+// 绕原点（中心天体）的圆轨道物体
+struct OrbitSystem {
+    std::vector<double> position, velocity, acceleration, mass, size;
+    std::vector<unsigned char> valid, isSource;
+
+    void add(double radius, double angle, double m) {
+        double v = std::sqrt(G * centralMass / radius);
+        position.push_back(radius * std::cos(angle));
+        position.push_back(radius * std::sin(angle));
+        velocity.push_back(-v * std::sin(angle));
+        velocity.push_back(v * std::cos(angle));
+        acceleration.push_back(0.0);
+        acceleration.push_back(0.0);
+        mass.push_back(m);
+        size.push_back(0.1);
+        valid.push_back(0);
+        isSource.push_back(1);
+    }
+    size_t count() const { return mass.size(); }
+};
+
+// 总能量：动能 + 与中心天体的势能 + 物体之间的势能
+double totalEnergy(const OrbitSystem& s) {
+    double energy = 0.0;
+    for (size_t i = 0; i < s.count(); i++) {
+        double vx = s.velocity[2 * i], vy = s.velocity[2 * i + 1];
+        energy += 0.5 * s.mass[i] * (vx * vx + vy * vy);
+        energy -= G * centralMass * s.mass[i] / std::hypot(s.position[2 * i], s.position[2 * i + 1]);
+        for (size_t j = i + 1; j < s.count(); j++) {
+            double r = std::hypot(s.position[2 * i] - s.position[2 * j], s.position[2 * i + 1] - s.position[2 * j + 1]);
+            energy -= G * s.mass[i] * s.mass[j] / r;
+        }
+    }
+    return energy;
+}
+
+// 统一步长的 kick-drift-kick 蛙跳（所有物体每步都求加速度），返回求加速度的物体次数
+size_t uniformLeapfrog(GravitySolver& solver, OrbitSystem& s, double dt, int steps) {
+    const double origin[2] = {0.0, 0.0};
+    const size_t n = s.count();
+    std::vector<double> sourcePosition, sourceMass;
+    size_t evaluations = 0;
+    auto computeAccelerations = [&]() {
+        sourcePosition.assign(origin, origin + 2);
+        sourcePosition.insert(sourcePosition.end(), s.position.begin(), s.position.end());
+        sourceMass.assign(1, centralMass);
+        sourceMass.insert(sourceMass.end(), s.mass.begin(), s.mass.end());
+        solver.build(sourcePosition.data(), sourceMass.data(), sourceMass.size());
+        solver.evaluate(s.position.data(), n, s.acceleration.data());
+        evaluations += n;
+    };
+    computeAccelerations();
+    for (int step = 0; step < steps; step++) {
+        for (size_t k = 0; k < 2 * n; k++) s.velocity[k] += 0.5 * dt * s.acceleration[k];
+        for (size_t k = 0; k < 2 * n; k++) s.position[k] += dt * s.velocity[k];
+        computeAccelerations();
+        for (size_t k = 0; k < 2 * n; k++) s.velocity[k] += 0.5 * dt * s.acceleration[k];
+    }
+    return evaluations;
+}
+
+// 测试1：级别选择
+bool test_rung_selection() {
+    printSeparator();
+    std::cout << "测试1：不同半径的圆轨道的级别（Δt = 0.5 s，η = 0.02）" << std::endl;
+    printSeparator();
+
+    OrbitSystem s;
+    const double radii[] = {5.0, 10.0, 20.0, 40.0, 80.0, 160.0, 320.0};
+    for (int k = 0; k < 7; k++) s.add(radii[k], 0.9 * k, 1e-3);
+
+    GravitySolver solver;
+    solver.setGravitationalConstant(G);
+    BlockTimestepper stepper;
+    const double origin[2] = {0.0, 0.0};
+    stepper.advance(solver, s.count(), s.position.data(), s.velocity.data(), s.acceleration.data(), s.valid.data(),
+                    s.mass.data(), s.size.data(), s.isSource.data(), origin, &centralMass, 1, 0.5);
+
+    bool ok = true;
+    const std::vector<int>& rungs = stepper.getRungs();
+    for (int k = 0; k < 7; k++) {
+        double period = 2.0 * M_PI * std::sqrt(radii[k] * radii[k] * radii[k] / (G * centralMass));
+        std::cout << std::fixed << std::setprecision(1) << "  半径 " << std::setw(6) << radii[k] << " 周期 "
+                  << std::setw(7) << std::setprecision(2) << period << " s  级别 " << rungs[k]
+                  << "（步长 " << std::setprecision(5) << 0.5 / (1 << rungs[k]) << " s）" << std::endl;
+        if (k > 0 && rungs[k] > rungs[k - 1]) ok = false;
+    }
+    const BlockStepStats& stats = stepper.getStats();
+    std::cout << "  求加速度的物体次数: " << stats.forceEvaluations << "（全部按最深级别走需要 "
+              << s.count() * ((size_t(1) << stats.deepestRung) + 1) << "）" << std::endl;
+
+    ok = ok && rungs[0] > rungs[6] && rungs[6] == 0;
+    std::cout << "  结果: " << (ok ? "内圈级别更深，外圈走整帧 ✓" : "级别选择不正确 ✗") << std::endl;
+    return ok;
+}
+
+// 分层系统：20 个内圈物体（半径 5-10，间隔 0.25），400 个外圈物体（半径 100-400）
+void makeHierarchy(OrbitSystem& s) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (int i = 0; i < 20; i++) s.add(5.0 + 0.25 * i, 2.0 * M_PI * uniform(rng), 1e-3);
+    for (int i = 0; i < 400; i++) s.add(100.0 + 300.0 * uniform(rng), 2.0 * M_PI * uniform(rng), 1e-3);
+}
+
+// 测试2：吞吐量与能量漂移
+bool test_throughput_and_energy() {
+    printSeparator();
+    std::cout << "测试2：20 个内圈物体 + 400 个外圈物体，Δt = 0.5 s，共 10 帧（约 5 个内圈周期）" << std::endl;
+    printSeparator();
+
+    const double frame = 0.5;
+    const int frames = 10;
+    const double origin[2] = {0.0, 0.0};
+
+    // 分层时间步
+    OrbitSystem block;
+    makeHierarchy(block);
+    GravitySolver solver;
+    solver.setGravitationalConstant(G);
+    BlockTimestepper stepper;
+    double e0 = totalEnergy(block);
+    double blockDrift = 0.0;
+    size_t blockEvaluations = 0;
+    int deepest = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int f = 0; f < frames; f++) {
+        stepper.advance(solver, block.count(), block.position.data(), block.velocity.data(), block.acceleration.data(),
+                        block.valid.data(), block.mass.data(), block.size.data(), block.isSource.data(),
+                        origin, &centralMass, 1, frame);
+        std::fill(block.valid.begin(), block.valid.end(), 1);
+        blockEvaluations += stepper.getStats().forceEvaluations;
+        deepest = std::max(deepest, stepper.getStats().deepestRung);
+        blockDrift = std::max(blockDrift, std::fabs(totalEnergy(block) - e0) / std::fabs(e0));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double blockMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 统一步长：所有物体按最深级别的步长走
+    OrbitSystem uniform;
+    makeHierarchy(uniform);
+    const int substeps = 1 << deepest;
+    double uniformDrift = 0.0;
+    size_t uniformEvaluations = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (int f = 0; f < frames; f++) {
+        uniformEvaluations += uniformLeapfrog(solver, uniform, frame / substeps, substeps);
+        uniformDrift = std::max(uniformDrift, std::fabs(totalEnergy(uniform) - e0) / std::fabs(e0));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double uniformMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << "  最深级别 " << deepest << "（统一步长 " << std::setprecision(5) << frame / substeps << " s）" << std::endl;
+    std::cout << "  方法        求加速度次数   耗时(ms，含能量计算)   最大相对能量漂移" << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "  分层时间步  " << std::left << std::setw(15) << blockEvaluations
+              << std::setw(23) << blockMs << std::scientific << std::setprecision(2) << blockDrift << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "  统一步长    " << std::setw(15) << uniformEvaluations
+              << std::setw(23) << uniformMs << std::scientific << std::setprecision(2) << uniformDrift << std::endl;
+    std::cout << std::right << std::fixed << std::setprecision(1)
+              << "  求加速度次数之比: " << double(uniformEvaluations) / blockEvaluations << "x" << std::endl;
+
+    // 求加速度的次数少一个数量级；η = 0.02 时相对能量漂移在 1e-6 以内
+    bool ok = uniformEvaluations >= 10 * blockEvaluations && blockDrift < 1e-6;
+    std::cout << "  结果: " << (ok ? "代价少一个数量级，能量漂移在界内 ✓" : "代价或能量漂移超出预期 ✗") << std::endl;
+    return ok;
+}
+
+// 世界中的太阳系：返回内圈、外圈行星的最大轨道半径偏差（相对）
+void runSolarSystem(bool blocks, double frame, double& innerError, double& outerError, int& deepest) {
+    PhysicalWorld world;
+    world.setMutualGravity(true);
+    world.setGravitationalConstant(G);
+    world.setBlockTimestepping(blocks);
+    const double rIn = 8.0, rOut = 60.0;
+    Shape* sun = world.allocateShape<Circle>(centralMass, 3.0, 0.0, 500.0);
+    Shape* inner = world.allocateShape<Circle>(1e-3, 0.5, rIn, 500.0, 0.0, std::sqrt(G * centralMass / rIn));
+    Shape* outer = world.allocateShape<Circle>(1e-3, 1.0, -rOut, 500.0, 0.0, -std::sqrt(G * centralMass / rOut));
+    world.addStaticShape(sun);
+    world.addDynamicShape(inner);
+    world.addDynamicShape(outer);
+    world.start();
+
+    innerError = outerError = 0.0;
+    deepest = 0;
+    const double duration = 2.0 * M_PI * std::sqrt(rOut * rOut * rOut / (G * centralMass));   // 外圈一周
+    const int frames = static_cast<int>(duration / frame);
+    for (int f = 0; f < frames; f++) {
+        world.update(world.dynamicShapeList, frame, world.ground);
+        double x, y;
+        inner->getCentre(x, y);
+        innerError = std::max(innerError, std::fabs(std::hypot(x, y - 500.0) - rIn) / rIn);
+        outer->getCentre(x, y);
+        outerError = std::max(outerError, std::fabs(std::hypot(x, y - 500.0) - rOut) / rOut);
+        deepest = std::max(deepest, world.getBlockStepStats().deepestRung);
+    }
+}
+
+// 测试3：世界中的太阳系
+bool test_world_solar_system() {
+    printSeparator();
+    std::cout << "测试3：世界中的太阳系（内圈半径 8 m，外圈半径 60 m，每帧 0.1 s，外圈转一周）" << std::endl;
+    printSeparator();
+
+    double inPlain, outPlain, inBlock, outBlock;
+    int deepPlain, deepBlock;
+    runSolarSystem(false, 0.1, inPlain, outPlain, deepPlain);
+    runSolarSystem(true, 0.1, inBlock, outBlock, deepBlock);
+    std::cout << std::scientific << std::setprecision(2)
+              << "  关闭分层时间步: 内圈半径偏差 " << inPlain << "，外圈 " << outPlain << std::endl;
+    std::cout << "  开启分层时间步: 内圈半径偏差 " << inBlock << "，外圈 " << outBlock
+              << "，最深级别 " << deepBlock << std::endl;
+
+    bool ok = inBlock < 0.01 && outBlock < 0.01 && inPlain > 10.0 * inBlock && deepBlock > 0;
+    std::cout << "  结果: " << (ok ? "内圈行星按更小的步长积分，保持圆轨道 ✓" : "轨道不正确 ✗") << std::endl;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_rung_selection()) passed++;
+    total++; if (test_throughput_and_energy()) passed++;
+    total++; if (test_world_solar_system()) passed++;
+
+    printSeparator();
+    std::cout << "分层时间步测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,309 @@
+/*=========================================================================================================
+ * 物体状态连续存储测试 - 验证 BodyStore 的视图、加入/移出和结果不变
+ *
+ * 测试场景：
+ * 1. 视图：加入世界后 Shape 的位置、速度读写的是 BodyStore 中的槽位；移出后状态保留在物体自己身上
+ * 2. 扩容与移出：加入 1000 个物体（多次扩容），删除其中一部分后，其余物体的视图仍然正确
+ * 3. 复制：复制出的物体使用自己的存储，不影响原物体
+ * 4. 结果不变：世界中的抛体运动与逐个调用 Shape 方法（applyGravity、applyTotalForce、update）逐位相同
+ * 5. 内存与性能：每个物体的热数据字节数，按数组积分与逐个访问 Shape 对象的耗时
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "bodyStore.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+// 物体的视图是否指向 BodyStore 中自己的槽位
+bool viewMatchesSlot(BodyStore& store, Shape* shape) {
+    int slot = shape->getBodySlot();
+    return shape->getBodyStore() == &store && slot >= 0 && store.getShape(slot) == shape
+           && shape->mass_centre == store.positionData() + 2 * slot
+           && shape->velocity == store.velocityData() + 2 * slot
+           && shape->totalforce == store.forceData() + 2 * slot;
+}
+
+// 测试1：视图
+bool test_views() {
+    printSeparator();
+    std::cout << "测试1：加入世界后 Shape 是 BodyStore 的视图" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    Circle* ball = new Circle(2.0, 0.5, 1.0, 2.0, 3.0, 4.0);
+    world.addDynamicShape(ball);
+    BodyStore& store = const_cast<BodyStore&>(world.getBodyStore());
+
+    bool attached = viewMatchesSlot(store, ball) && store.size() == 1;
+    ball->setCentre(5.0, 6.0);
+    ball->setVelocity(7.0, 8.0);
+    ball->setMass(3.0);
+    int slot = ball->getBodySlot();
+    bool writesThrough = store.positionData()[2 * slot] == 5.0 && store.velocityData()[2 * slot + 1] == 8.0
+                         && store.massData()[slot] == 3.0;
+    ball->setIsSupported(true);
+    bool flagSynced = (store.flagData()[slot] & BODY_SUPPORTED) != 0;
+    ball->resetSupportStatus();
+    flagSynced = flagSynced && (store.flagData()[slot] & BODY_SUPPORTED) == 0;
+
+    world.removeDynamicShape(ball);
+    double x, y, vx, vy;
+    ball->getCentre(x, y);
+    ball->getVelocity(vx, vy);
+    bool detached = ball->getBodyStore() == nullptr && store.size() == 0 && x == 5.0 && y == 6.0 && vx == 7.0 && vy == 8.0;
+
+    std::cout << "  加入后视图指向槽位: " << (attached ? "是" : "否") << std::endl;
+    std::cout << "  setCentre / setVelocity / setMass 写入 BodyStore: " << (writesThrough ? "是" : "否") << std::endl;
+    std::cout << "  支撑状态同步到标志位: " << (flagSynced ? "是" : "否") << std::endl;
+    std::cout << "  移出后状态保留: (" << x << ", " << y << ")，(" << vx << ", " << vy << ")" << std::endl;
+
+    bool ok = attached && writesThrough && flagSynced && detached;
+    std::cout << "  结果: " << (ok ? "视图读写正确 ✓" : "视图错误 ✗") << std::endl;
+    delete ball;
+    return ok;
+}
+
+// 测试2：扩容与移出
+bool test_growth_and_removal() {
+    printSeparator();
+    std::cout << "测试2：加入 1000 个物体后删除其中 1/3" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < 1000; i++) {
+        Shape* shape = (i % 2 == 0) ? static_cast<Shape*>(new Circle(1.0, 0.5, i * 1.0, i * 2.0, i * 3.0, i * 4.0))
+                                    : static_cast<Shape*>(new AABB(1.0, 1.0, 1.0, i * 1.0, i * 2.0, i * 3.0, i * 4.0));
+        shapes.push_back(shape);
+        world.addDynamicShape(shape);
+    }
+    BodyStore& store = const_cast<BodyStore&>(world.getBodyStore());
+
+    bool ok = store.size() == 1000;
+    // 删除 i % 3 == 0 的物体：一部分先移出世界，一部分直接 delete（析构时自动移出）
+    std::vector<Shape*> remaining;
+    std::vector<int> remainingIndex;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        if (i % 3 == 0) {
+            if (i % 2 == 0) world.removeDynamicShape(shapes[i]);
+            else world.dynamicShapeList.erase(std::find(world.dynamicShapeList.begin(), world.dynamicShapeList.end(), shapes[i]));
+            delete shapes[i];
+        } else {
+            remaining.push_back(shapes[i]);
+            remainingIndex.push_back(static_cast<int>(i));
+        }
+    }
+    ok = ok && store.size() == remaining.size();
+    for (size_t k = 0; k < remaining.size(); k++) {
+        double x, y, vx, vy;
+        remaining[k]->getCentre(x, y);
+        remaining[k]->getVelocity(vx, vy);
+        int i = remainingIndex[k];
+        ok = ok && viewMatchesSlot(store, remaining[k]) && x == i * 1.0 && y == i * 2.0 && vx == i * 3.0 && vy == i * 4.0;
+    }
+    std::cout << "  剩余 " << store.size() << " 个物体，视图和状态"
+              << (ok ? "全部正确" : "有错误") << std::endl;
+
+    // 直接放进形状列表的物体在下一次 update() 时加入
+    Circle* late = new Circle(1.0, 0.5, 0.0, 900.0);
+    world.dynamicShapeList.push_back(late);
+    world.update(world.dynamicShapeList, world.ground);
+    bool lateAttached = viewMatchesSlot(store, late);
+    std::cout << "  直接放进列表的物体在 update() 时加入: " << (lateAttached ? "是" : "否") << std::endl;
+    ok = ok && lateAttached;
+
+    std::cout << "  结果: " << (ok ? "扩容、移出后视图正确 ✓" : "视图错误 ✗") << std::endl;
+    remaining.push_back(late);
+    deleteShapes(remaining);
+    return ok;
+}
+
+// 测试3：复制
+bool test_copy() {
+    printSeparator();
+    std::cout << "测试3：复制加入了世界的物体" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    Circle* ball = new Circle(1.0, 0.5, 1.0, 2.0, 3.0, 4.0);
+    world.addDynamicShape(ball);
+
+    Circle copy(*ball);
+    copy.setCentre(10.0, 20.0);
+    double x, y, cx, cy;
+    ball->getCentre(x, y);
+    copy.getCentre(cx, cy);
+    bool ok = copy.getBodyStore() == nullptr && x == 1.0 && y == 2.0 && cx == 10.0 && cy == 20.0
+              && copy.getRadius() == 0.5;
+
+    Circle assigned;
+    assigned = *ball;
+    assigned.setVelocity(-1.0, -1.0);
+    double vx, vy;
+    ball->getVelocity(vx, vy);
+    ok = ok && assigned.getBodyStore() == nullptr && vx == 3.0 && vy == 4.0;
+
+    std::cout << "  原物体 (" << x << ", " << y << ")，副本 (" << cx << ", " << cy << ")" << std::endl;
+    std::cout << "  结果: " << (ok ? "副本使用自己的存储 ✓" : "副本与原物体共享了状态 ✗") << std::endl;
+    delete ball;
+    return ok;
+}
+
+// 测试4：结果不变
+bool test_matches_shape_methods() {
+    printSeparator();
+    std::cout << "测试4：抛体运动与逐个调用 Shape 方法逐位相同" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world(-100000.0, 100000.0, -100000.0, 100000.0);   // 不碰到边界
+    world.setGravity(9.8);
+    world.setSleepingEnabled(false);
+    world.ground.setYLevel(-100000.0);
+    std::vector<Shape*> shapes;
+    std::vector<Circle> reference;
+    // 水平速度相同，各列互不相碰，只受重力
+    for (int i = 0; i < 200; i++) {
+        Circle* ball = new Circle(1.0 + 0.01 * i, 0.5, i * 10.0, 500.0, 15.0, std::cos(i * 1.0) * 20.0);
+        shapes.push_back(ball);
+        reference.push_back(*ball);
+        world.addDynamicShape(ball);
+    }
+
+    const double dt = 1.0 / 60.0;
+    for (int step = 0; step < 300; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        for (size_t i = 0; i < reference.size(); i++) {
+            reference[i].clearTotalForce();
+            reference[i].applyGravity(9.8);
+            reference[i].applyTotalForce(dt);
+            reference[i].update(dt);
+        }
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double x, y, vx, vy, rx, ry, rvx, rvy;
+        shapes[i]->getCentre(x, y);
+        shapes[i]->getVelocity(vx, vy);
+        reference[i].getCentre(rx, ry);
+        reference[i].getVelocity(rvx, rvy);
+        ok = ok && x == rx && y == ry && vx == rvx && vy == rvy;
+    }
+    std::cout << "  200 个抛体，300 步: " << (ok ? "位置和速度逐位相同" : "结果不同") << std::endl;
+    std::cout << "  结果: " << (ok ? "按数组积分与 Shape 方法一致 ✓" : "结果不同 ✗") << std::endl;
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试5：内存与性能
+bool test_footprint_and_performance() {
+    printSeparator();
+    std::cout << "测试5：热数据大小，10 万个物体的重力积分" << std::endl;
+    printSeparator();
+
+    const int count = 100000;
+    const double dt = 1.0 / 60.0, g = 9.8;
+    BodyStore store;
+    std::vector<Shape*> attached;
+    std::vector<Shape*> objects;
+    std::vector<std::string*> clutter;   // 与物体交替分配，模拟真实程序中分散的堆
+    for (int i = 0; i < count; i++) {
+        Circle* a = new Circle(1.0, 0.5, i * 1.0, 0.0, 1.0, 0.0);
+        attached.push_back(a);
+        store.attach(a);
+        objects.push_back(new Circle(1.0, 0.5, i * 1.0, 0.0, 1.0, 0.0));
+        clutter.push_back(new std::string(64, 'x'));
+    }
+
+    const int steps = 50;
+    // 逐个访问 Shape 对象（原来的方式）
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < steps; step++) {
+        for (size_t i = 0; i < objects.size(); i++) {
+            Shape* shape = objects[i];
+            shape->clearTotalForce();
+            shape->applyGravity(g);
+            shape->applyTotalForce(dt);
+            shape->update(dt);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double objectMs = std::chrono::duration<double, std::milli>(end - start).count() / steps;
+
+    // 按槽位在连续数组上计算（updatePhysics 中在空中的物体）
+    double* position = store.positionData();
+    double* velocity = store.velocityData();
+    double* force = store.forceData();
+    const double* mass = store.massData();
+    start = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < steps; step++) {
+        for (size_t slot = 0; slot < store.size(); slot++) {
+            double* f = force + 2 * slot;
+            double* v = velocity + 2 * slot;
+            f[0] = 0.0;
+            f[1] = 0.0;
+            f[0] += 0.0;
+            f[1] += -g * mass[slot];
+            integrateBodyVelocity(mass[slot], v, f, dt);
+            position[2 * slot] += v[0] * dt;
+            position[2 * slot + 1] += v[1] * dt;
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double storeMs = std::chrono::duration<double, std::milli>(end - start).count() / steps;
+
+    bool same = true;
+    for (int i = 0; i < count; i++) {
+        same = same && attached[i]->mass_centre[1] == objects[i]->mass_centre[1]
+               && attached[i]->velocity[1] == objects[i]->velocity[1];
+    }
+
+    std::cout << "  每个物体的热数据: " << BodyStore::hotBytesPerBody() << " 字节（Shape 对象 "
+              << sizeof(Circle) << " 字节）" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  逐个访问 Shape 对象: " << objectMs << " ms/步" << std::endl;
+    std::cout << "  BodyStore 连续数组: " << storeMs << " ms/步（加速比 " << std::setprecision(2)
+              << objectMs / storeMs << "x）" << std::endl;
+    std::cout << "  两种方式结果逐位相同: " << (same ? "是" : "否") << std::endl;
+
+    bool ok = BodyStore::hotBytesPerBody() < 64 && same;
+    std::cout << "  结果: " << (ok ? "热数据小于 64 字节 ✓" : "不满足 ✗") << std::endl;
+
+    deleteShapes(attached);
+    deleteShapes(objects);
+    for (size_t i = 0; i < clutter.size(); i++) delete clutter[i];
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_views()) passed++;
+    total++; if (test_growth_and_removal()) passed++;
+    total++; if (test_copy()) passed++;
+    total++; if (test_matches_shape_methods()) passed++;
+    total++; if (test_footprint_and_performance()) passed++;
+
+    printSeparator();
+    std::cout << "物体状态连续存储测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,374 @@
+/*=========================================================================================================
+ * 宽相位碰撞检测测试 - 验证空间哈希网格和排序扫描输出的候选物体对
+ *
+ * 测试场景：
+ * 1. 正确性：随机圆形 + 矩形 + 墙壁，宽相位候选对必须覆盖所有真实碰撞对
+ * 2. 大规模性能：20000 个圆形，比较宽相位与全配对循环的耗时
+ * 3. 物理世界集成：两球相向碰撞
+ * 4. 排序扫描：连续小幅运动时候选对与空间哈希一致，插入排序交换次数很少
+ * 5. 堆叠场景：三种宽相位算法的模拟结果完全一致，并报告节省的测试次数
+ * 6. 支撑检测：5000 个方块堆叠，支撑检测次数与实际接触数同一量级
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <cstdlib>
+#include "physicalWorld.h"
+#include "broadphase.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+double randomRange(double lo, double hi) {
+    return lo + (hi - lo) * (std::rand() / static_cast<double>(RAND_MAX));
+}
+
+// 生成随机场景：圆形、矩形和少量长墙壁
+std::vector<Shape*> createRandomScene(int count, double worldSize) {
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < count; i++) {
+        double x = randomRange(-worldSize, worldSize);
+        double y = randomRange(-worldSize, worldSize);
+        if (i % 3 == 0) {
+            shapes.push_back(new AABB(1.0, randomRange(0.5, 3.0), randomRange(0.5, 3.0), x, y));
+        } else {
+            shapes.push_back(new Circle(1.0, randomRange(0.2, 1.5), x, y));
+        }
+    }
+    // 长墙壁会被当作超大形状处理
+    shapes.push_back(new Wall(2.0 * worldSize, 1.0, 0.0, 0.0));
+    shapes.push_back(new Wall(1.0, 2.0 * worldSize, 0.0, 0.0));
+    return shapes;
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+// 测试1：宽相位候选对覆盖所有真实碰撞对
+bool test_broadphase_correctness() {
+    printSeparator();
+    std::cout << "测试1：宽相位正确性（候选对必须覆盖全部碰撞对）" << std::endl;
+    printSeparator();
+
+    std::srand(12345);
+    std::vector<Shape*> shapes = createRandomScene(2000, 60.0);
+
+    SpatialHashGrid grid;
+    std::vector<CandidatePair> pairs;
+    grid.update(shapes);
+    grid.computePairs(pairs);
+
+    std::set<CandidatePair> candidateSet(pairs.begin(), pairs.end());
+
+    int colliding = 0;
+    int missed = 0;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        for (size_t j = i + 1; j < shapes.size(); j++) {
+            if (shapes[i]->check_collision(*shapes[j])) {
+                colliding++;
+                if (candidateSet.count(CandidatePair(static_cast<int>(i), static_cast<int>(j))) == 0) {
+                    missed++;
+                }
+            }
+        }
+    }
+
+    bool sorted = true;
+    for (size_t k = 1; k < pairs.size(); k++) {
+        if (!(pairs[k - 1] < pairs[k])) {
+            sorted = false;
+        }
+    }
+
+    size_t n = shapes.size();
+    std::cout << "  形状数量: " << n << std::endl;
+    std::cout << "  网格单元大小: " << grid.getCellSize() << std::endl;
+    std::cout << "  全配对数量: " << n * (n - 1) / 2 << std::endl;
+    std::cout << "  候选对数量: " << pairs.size() << std::endl;
+    std::cout << "  真实碰撞对: " << colliding << std::endl;
+    std::cout << "  漏检数量: " << missed << (missed == 0 ? " ✓" : " ✗") << std::endl;
+    std::cout << "  候选对有序且无重复: " << (sorted ? "是 ✓" : "否 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return missed == 0 && sorted;
+}
+
+// 测试2：大规模场景性能
+bool test_broadphase_performance() {
+    printSeparator();
+    std::cout << "测试2：20000 个圆形的宽相位性能" << std::endl;
+    printSeparator();
+
+    std::srand(2024);
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < 20000; i++) {
+        shapes.push_back(new Circle(1.0, 0.5, randomRange(-400.0, 400.0), randomRange(-400.0, 400.0)));
+    }
+
+    SpatialHashGrid grid;
+    std::vector<CandidatePair> pairs;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    grid.update(shapes);
+    grid.computePairs(pairs);
+    int hits = 0;
+    for (size_t k = 0; k < pairs.size(); k++) {
+        if (shapes[pairs[k].first]->check_collision(*shapes[pairs[k].second])) {
+            hits++;
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    double gridMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+    // 全配对循环只测前 2000 个形状，再按 n² 比例估算
+    const size_t sampleCount = 2000;
+    auto t2 = std::chrono::high_resolution_clock::now();
+    int sampleHits = 0;
+    for (size_t i = 0; i < sampleCount; i++) {
+        for (size_t j = i + 1; j < sampleCount; j++) {
+            if (shapes[i]->check_collision(*shapes[j])) {
+                sampleHits++;
+            }
+        }
+    }
+    auto t3 = std::chrono::high_resolution_clock::now();
+    double sampleMs = std::chrono::duration<double, std::milli>(t3 - t2).count();
+    double ratio = static_cast<double>(shapes.size()) / sampleCount;
+    double bruteMs = sampleMs * ratio * ratio;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  候选对数量: " << pairs.size() << "，真实碰撞对: " << hits << std::endl;
+    std::cout << "  宽相位 + 窄相位耗时: " << gridMs << " ms" << std::endl;
+    std::cout << "  全配对循环估算耗时: " << bruteMs << " ms（由 " << sampleCount << " 个形状的实测值推算）" << std::endl;
+    std::cout << "  加速比: " << (gridMs > 0.0 ? bruteMs / gridMs : 0.0) << "x" << std::endl;
+
+    bool ok = gridMs < bruteMs;
+    std::cout << "  结果: " << (ok ? "宽相位更快 ✓" : "宽相位未带来加速 ✗") << std::endl;
+
+    (void)sampleHits;
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试3：物理世界中的堆叠与碰撞结果
+bool test_world_integration() {
+    printSeparator();
+    std::cout << "测试3：物理世界集成（两球相向碰撞）" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    world.ground.setYLevel(-100.0);
+
+    Circle* ball1 = new Circle(1.0, 1.0, -3.0, 0.0, 5.0, 0.0);
+    Circle* ball2 = new Circle(1.0, 1.0, 3.0, 0.0, -5.0, 0.0);
+    ball1->setName("Ball1");
+    ball2->setName("Ball2");
+    world.addDynamicShape(ball1);
+    world.addDynamicShape(ball2);
+
+    for (int i = 0; i < 120; i++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+
+    double vx1, vy1, vx2, vy2;
+    ball1->getVelocity(vx1, vy1);
+    ball2->getVelocity(vx2, vy2);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  Ball1 速度: (" << vx1 << ", " << vy1 << ")，期望 (-5, 0)" << std::endl;
+    std::cout << "  Ball2 速度: (" << vx2 << ", " << vy2 << ")，期望 (5, 0)" << std::endl;
+
+    bool ok = std::abs(vx1 + 5.0) < 1e-6 && std::abs(vx2 - 5.0) < 1e-6;
+    std::cout << "  结果: " << (ok ? "弹性碰撞后速度交换 ✓" : "速度不符合预期 ✗") << std::endl;
+
+    delete ball1;
+    delete ball2;
+    return ok;
+}
+
+// 测试4：排序扫描在连续运动中的一致性和增量代价
+bool test_sweep_and_prune_coherence() {
+    printSeparator();
+    std::cout << "测试4：排序扫描（连续小幅运动，20 帧）" << std::endl;
+    printSeparator();
+
+    std::srand(777);
+    std::vector<Shape*> shapes = createRandomScene(3000, 80.0);
+
+    SpatialHashGrid grid;
+    SweepAndPrune sap;
+    std::vector<CandidatePair> gridPairs;
+    std::vector<CandidatePair> sapPairs;
+
+    bool allEqual = true;
+    size_t maxSwaps = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        // 每帧所有形状随机移动一小段距离（墙壁不动）
+        if (frame > 0) {
+            for (size_t i = 0; i + 2 < shapes.size(); i++) {
+                shapes[i]->move(randomRange(-0.05, 0.05), randomRange(-0.05, 0.05));
+            }
+        }
+
+        grid.update(shapes);
+        grid.computePairs(gridPairs);
+        sap.update(shapes);
+        sap.computePairs(sapPairs);
+
+        if (gridPairs != sapPairs) {
+            allEqual = false;
+        }
+        if (frame > 0 && sap.getStats().endpointSwaps > maxSwaps) {
+            maxSwaps = sap.getStats().endpointSwaps;
+        }
+    }
+
+    const BroadphaseStats& stats = sap.getStats();
+    std::cout << "  形状数量: " << stats.shapeCount << std::endl;
+    std::cout << "  候选对数量: " << stats.candidatePairs << std::endl;
+    std::cout << "  节省的窄相位测试: " << stats.savedPairTests << " / " << stats.allPairs << std::endl;
+    std::cout << "  单帧最多端点交换次数: " << maxSwaps << "（端点总数 " << 4 * shapes.size() << "）" << std::endl;
+    std::cout << "  与空间哈希候选对一致: " << (allEqual ? "是 ✓" : "否 ✗") << std::endl;
+
+    bool ok = allEqual && maxSwaps < 4 * shapes.size();
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 运行一个板块堆叠 + 碰撞场景，返回所有形状的最终位置和速度
+std::vector<double> runStackScene(BroadphaseType type, BroadphaseStats& stats) {
+    PhysicalWorld world;
+    world.setBroadphaseType(type);
+    world.setGravity(10.0);
+    world.ground.setYLevel(0.0);
+    world.ground.setFriction(0.3, 0.4);
+
+    std::vector<Shape*> shapes;
+    for (int column = 0; column < 10; column++) {
+        for (int level = 0; level < 8; level++) {
+            AABB* block = new AABB(1.0, 2.0, 1.0, column * 3.0, 0.5 + level * 1.0);
+            block->setFraction(0.3);
+            block->setStaticFraction(0.4);
+            shapes.push_back(block);
+            world.addDynamicShape(block);
+        }
+    }
+    // 一个高速飞来的球
+    Circle* ball = new Circle(2.0, 0.5, -10.0, 3.0, 15.0, 0.0);
+    shapes.push_back(ball);
+    world.addDynamicShape(ball);
+
+    for (int i = 0; i < 180; i++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    stats = world.getBroadphaseStats();
+
+    std::vector<double> state;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double x, y, vx, vy;
+        shapes[i]->getCentre(x, y);
+        shapes[i]->getVelocity(vx, vy);
+        state.push_back(x);
+        state.push_back(y);
+        state.push_back(vx);
+        state.push_back(vy);
+    }
+    deleteShapes(shapes);
+    return state;
+}
+
+// 测试5：三种宽相位算法的模拟结果一致
+bool test_broadphase_types_agree() {
+    printSeparator();
+    std::cout << "测试5：堆叠场景下三种宽相位算法结果一致" << std::endl;
+    printSeparator();
+
+    BroadphaseStats bruteStats, hashStats, sapStats;
+    std::vector<double> brute = runStackScene(BROADPHASE_BRUTE_FORCE, bruteStats);
+    std::vector<double> hash = runStackScene(BROADPHASE_SPATIAL_HASH, hashStats);
+    std::vector<double> sap = runStackScene(BROADPHASE_SWEEP_AND_PRUNE, sapStats);
+
+    bool hashSame = (brute == hash);
+    bool sapSame = (brute == sap);
+
+    std::cout << "  全配对候选对数量: " << bruteStats.candidatePairs << std::endl;
+    std::cout << "  空间哈希候选对数量: " << hashStats.candidatePairs
+              << "（节省 " << hashStats.savedPairTests << " 次测试）" << std::endl;
+    std::cout << "  排序扫描候选对数量: " << sapStats.candidatePairs
+              << "（节省 " << sapStats.savedPairTests << " 次测试，本帧交换 "
+              << sapStats.endpointSwaps << " 次）" << std::endl;
+    std::cout << "  空间哈希结果与全配对一致: " << (hashSame ? "是 ✓" : "否 ✗") << std::endl;
+    std::cout << "  排序扫描结果与全配对一致: " << (sapSame ? "是 ✓" : "否 ✗") << std::endl;
+
+    return hashSame && sapSame;
+}
+
+// 测试6：支撑检测复用候选对（5000 个方块堆叠）
+bool test_support_detection_scale() {
+    printSeparator();
+    std::cout << "测试6：支撑检测复用宽相位候选对（5000 个方块堆叠）" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(10.0);
+    world.ground.setYLevel(0.0);
+
+    std::vector<Shape*> shapes;
+    for (int column = 0; column < 50; column++) {
+        for (int level = 0; level < 100; level++) {
+            AABB* block = new AABB(1.0, 2.0, 1.0, column * 3.0, 0.5 + level * 1.0);
+            shapes.push_back(block);
+            world.addDynamicShape(block);
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    world.update(world.dynamicShapeList, world.ground);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    size_t supported = 0;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        if (shapes[i]->getIsSupported()) supported++;
+    }
+    size_t n = shapes.size();
+    size_t oldChecks = n * (n - 1);
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << "  形状数量: " << n << "，被支撑的形状: " << supported << std::endl;
+    std::cout << "  支撑检测次数: " << world.getSupportCheckCount()
+              << "（原来的双重循环: " << oldChecks << "）" << std::endl;
+    std::cout << "  单步耗时: " << std::fixed << std::setprecision(2) << ms << " ms" << std::endl;
+
+    // 每个方块只与上下相邻的方块接触，检测次数应与接触数同一量级
+    bool ok = supported == n && world.getSupportCheckCount() < 10 * n;
+    deleteShapes(shapes);
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_broadphase_correctness()) passed++;
+    total++; if (test_broadphase_performance()) passed++;
+    total++; if (test_world_integration()) passed++;
+    total++; if (test_sweep_and_prune_coherence()) passed++;
+    total++; if (test_broadphase_types_agree()) passed++;
+    total++; if (test_support_detection_scale()) passed++;
+
+    printSeparator();
+    std::cout << "宽相位测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
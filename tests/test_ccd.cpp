@@ -0,0 +1,235 @@
+/*=========================================================================================================
+ * 连续碰撞检测测试 - 验证高速圆在大时间步长下不会穿过薄物体
+ *
+ * 测试场景：
+ * 1. 扫掠函数：圆对圆、圆对矩形（正面 / 角 / 错过 / 开始时已重叠）的碰撞时间
+ * 2. 薄墙：30 Hz 下以 60 m/s 飞向 0.2 m 厚的墙壁，关闭 CCD 会穿过，开启后被弹回
+ * 3. 动态圆：30 Hz 下高速圆撞向静止的圆，开启 CCD 后发生碰撞并交换速度
+ * 4. 薄板：高速圆撞向 0.2 m 宽的动态方块
+ * 5. 低速物体：位移小于阈值的物体不做扫掠
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+bool near(double a, double b, double eps = 1e-9) {
+    return std::abs(a - b) < eps;
+}
+
+// 测试1：扫掠函数
+bool test_sweep_functions() {
+    printSeparator();
+    std::cout << "测试1：扫掠求碰撞时间" << std::endl;
+    printSeparator();
+
+    bool ok = true;
+    double toi = -1.0;
+
+    // 圆心从 (0,0) 移动到 (10,0)，半径 1；另一个圆在 (6,0)，半径 1 → 在 x = 4 处接触
+    bool hit = sweepCircleCircle(0.0, 0.0, 10.0, 0.0, 1.0, 6.0, 0.0, 1.0, toi);
+    std::cout << "  圆对圆: " << (hit ? "命中" : "未命中") << "，toi = " << toi << "（期望 0.4）" << std::endl;
+    ok = ok && hit && near(toi, 0.4);
+
+    // 矩形 [5, 5.2] × [-2, 2]，半径 0.5 → 在 x = 4.5 处接触
+    hit = sweepCircleRect(0.0, 0.0, 10.0, 0.0, 0.5, 5.0, -2.0, 5.2, 2.0, toi);
+    std::cout << "  圆对矩形（正面）: " << (hit ? "命中" : "未命中") << "，toi = " << toi << "（期望 0.45）" << std::endl;
+    ok = ok && hit && near(toi, 0.45);
+
+    // 沿 y = 2.3 水平运动，擦过矩形的右上角 (5, 2)：与角上的圆相交
+    hit = sweepCircleRect(0.0, 2.3, 10.0, 0.0, 0.5, 5.0, -2.0, 5.2, 2.0, toi);
+    double expected = (5.0 - std::sqrt(0.25 - 0.09)) / 10.0;
+    std::cout << "  圆对矩形（角）: " << (hit ? "命中" : "未命中") << "，toi = " << toi << "（期望 " << expected << "）" << std::endl;
+    ok = ok && hit && near(toi, expected);
+
+    // 从角外侧错过
+    hit = sweepCircleRect(0.0, 2.6, 10.0, 0.0, 0.5, 5.0, -2.0, 5.2, 2.0, toi);
+    std::cout << "  圆对矩形（错过）: " << (hit ? "命中 ✗" : "未命中 ✓") << std::endl;
+    ok = ok && !hit;
+
+    // 开始时已经重叠：交给离散碰撞处理
+    hit = sweepCircleCircle(0.0, 0.0, 10.0, 0.0, 1.0, 1.5, 0.0, 1.0, toi);
+    std::cout << "  开始时已重叠: " << (hit ? "命中 ✗" : "未命中 ✓") << std::endl;
+    ok = ok && !hit;
+
+    std::cout << "  结果: " << (ok ? "扫掠结果正确 ✓" : "扫掠结果错误 ✗") << std::endl;
+    return ok;
+}
+
+// 测试2：薄墙（调用方在每步之后对墙壁调用 handleWallCollision）
+double runThinWall(bool ccd, double& finalVx) {
+    PhysicalWorld world;
+    world.setTimeStep(1.0 / 30.0);
+    world.setContinuousCollision(ccd);
+    world.ground.setYLevel(0.0);
+
+    Wall* wall = world.placeWall("ThinWall", 10.0, 5.0, 0.2, 10.0);
+    Circle* ball = new Circle(1.0, 0.5, 0.0, 5.0, 60.0, 0.0);
+    ball->setName("Ball");
+    world.addDynamicShape(ball);
+
+    for (int step = 0; step < 15; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        world.handleWallCollision(*ball, *wall);
+    }
+
+    double x, y, vy;
+    ball->getCentre(x, y);
+    ball->getVelocity(finalVx, vy);
+    delete ball;
+    return x;
+}
+
+bool test_thin_wall() {
+    printSeparator();
+    std::cout << "测试2：30 Hz 下 60 m/s 的圆飞向 0.2 m 厚的墙壁（x = 10）" << std::endl;
+    printSeparator();
+
+    double vxOff, vxOn;
+    double xOff = runThinWall(false, vxOff);
+    double xOn = runThinWall(true, vxOn);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  关闭 CCD: x = " << xOff << "，vx = " << vxOff << (xOff > 10.0 ? "（穿墙）" : "") << std::endl;
+    std::cout << "  开启 CCD: x = " << xOn << "，vx = " << vxOn << (xOn < 10.0 ? "（被弹回）" : "") << std::endl;
+
+    bool ok = xOff > 10.0 && xOn < 10.0 && vxOn < 0.0;
+    std::cout << "  结果: " << (ok ? "开启 CCD 后不再穿墙 ✓" : "仍然穿墙 ✗") << std::endl;
+    return ok;
+}
+
+// 测试3：动态圆
+bool test_fast_circle() {
+    printSeparator();
+    std::cout << "测试3：30 Hz 下 90 m/s 的圆撞向静止的圆" << std::endl;
+    printSeparator();
+
+    bool ok = true;
+    for (int mode = 0; mode < 2; mode++) {
+        PhysicalWorld world;
+        world.setGravity(0.0);
+        world.setTimeStep(1.0 / 30.0);
+        world.setContinuousCollision(mode == 1);
+
+        Circle* bullet = new Circle(1.0, 0.5, 0.0, 500.0, 90.0, 0.0);
+        Circle* target = new Circle(1.0, 0.5, 10.5, 500.0);
+        bullet->setName("Bullet");
+        target->setName("Target");
+        world.addDynamicShape(bullet);
+        world.addDynamicShape(target);
+
+        size_t advanced = 0;
+        for (int step = 0; step < 10; step++) {
+            world.update(world.dynamicShapeList, world.ground);
+            advanced += world.getContinuousCollisionCount();
+        }
+
+        double v1x, v1y, v2x, v2y;
+        bullet->getVelocity(v1x, v1y);
+        target->getVelocity(v2x, v2y);
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "  " << (mode == 1 ? "开启" : "关闭") << " CCD: 子弹 vx = " << v1x << "，目标 vx = " << v2x
+                  << "，推进次数 " << advanced << std::endl;
+        if (mode == 0) {
+            ok = ok && near(v1x, 90.0) && near(v2x, 0.0);
+        } else {
+            ok = ok && near(v1x, 0.0, 1e-6) && near(v2x, 90.0, 1e-6) && advanced > 0;
+        }
+
+        delete bullet;
+        delete target;
+    }
+    std::cout << "  结果: " << (ok ? "开启 CCD 后发生碰撞 ✓" : "碰撞结果错误 ✗") << std::endl;
+    return ok;
+}
+
+// 测试4：薄板
+bool test_thin_box() {
+    printSeparator();
+    std::cout << "测试4：30 Hz 下 60 m/s 的圆撞向 0.2 m 宽的动态方块" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    world.setTimeStep(1.0 / 30.0);
+
+    Circle* bullet = new Circle(1.0, 0.5, 0.0, 500.0, 60.0, 0.0);
+    AABB* plate = new AABB(5.0, 0.2, 4.0, 9.0, 500.0);
+    bullet->setName("Bullet");
+    plate->setName("Plate");
+    world.addDynamicShape(bullet);
+    world.addDynamicShape(plate);
+
+    for (int step = 0; step < 10; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+
+    double bx, by, px, py, bvx, bvy, pvx, pvy;
+    bullet->getCentre(bx, by);
+    plate->getCentre(px, py);
+    bullet->getVelocity(bvx, bvy);
+    plate->getVelocity(pvx, pvy);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  子弹 x = " << bx << "，vx = " << bvx << "；方块 x = " << px << "，vx = " << pvx << std::endl;
+
+    bool ok = bx < px && pvx > 0.0;
+    std::cout << "  结果: " << (ok ? "子弹没有穿过方块 ✓" : "子弹穿过了方块 ✗") << std::endl;
+
+    delete bullet;
+    delete plate;
+    return ok;
+}
+
+// 测试5：低速物体
+bool test_slow_bodies_skipped() {
+    printSeparator();
+    std::cout << "测试5：低速物体不做扫掠" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+
+    Circle* a = new Circle(1.0, 1.0, 0.0, 500.0, 10.0, 0.0);
+    Circle* b = new Circle(1.0, 1.0, 5.0, 500.0);
+    a->setName("A");
+    b->setName("B");
+    world.addDynamicShape(a);
+    world.addDynamicShape(b);
+
+    size_t advanced = 0;
+    for (int step = 0; step < 60; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        advanced += world.getContinuousCollisionCount();
+    }
+
+    bool ok = advanced == 0;
+    std::cout << "  每步位移 " << 10.0 / 60.0 << " m（半径 1 m），推进次数: " << advanced << std::endl;
+    std::cout << "  结果: " << (ok ? "没有额外开销 ✓" : "低速物体也做了扫掠 ✗") << std::endl;
+
+    delete a;
+    delete b;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_sweep_functions()) passed++;
+    total++; if (test_thin_wall()) passed++;
+    total++; if (test_fast_circle()) passed++;
+    total++; if (test_thin_box()) passed++;
+    total++; if (test_slow_bodies_skipped()) passed++;
+
+    printSeparator();
+    std::cout << "连续碰撞检测测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+/*=========================================================================================================
+ * 碰撞分派表测试 - 验证按类型标记查表的碰撞检测与原来的 dynamic_cast 链结果一致，并比较单对耗时
+ *
+ * 测试场景：
+ * 1. 正确性：随机生成五种形状的所有组合，查表结果与 dynamic_cast 链完全一致
+ * 2. 重叠量：Circle/AABB 之间的分离内核与原来的重叠量计算一致
+ * 3. 微基准：同一批物体对分别用 dynamic_cast 链和分派表检测，比较每对的平均耗时
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+double randomRange(double lo, double hi) {
+    return lo + (hi - lo) * (std::rand() / static_cast<double>(RAND_MAX));
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+/*=========================================================================================================
+ * 原来的实现（dynamic_cast 链），作为对照
+ *=========================================================================================================*/
+bool legacyCircleCollision(const Circle& self, const Shape& other) {
+    if (const Circle* c = dynamic_cast<const Circle*>(&other)) {
+        double dx = self.mass_centre[0] - c->mass_centre[0];
+        double dy = self.mass_centre[1] - c->mass_centre[1];
+        return std::sqrt(dx * dx + dy * dy) <= (self.radius + c->radius);
+    }
+    if (const AABB* a = dynamic_cast<const AABB*>(&other)) {
+        double cx = std::max(a->mass_centre[0] - a->width/2, std::min(self.mass_centre[0], a->mass_centre[0] + a->width/2));
+        double cy = std::max(a->mass_centre[1] - a->height/2, std::min(self.mass_centre[1], a->mass_centre[1] + a->height/2));
+        double dx = self.mass_centre[0] - cx;
+        double dy = self.mass_centre[1] - cy;
+        return std::sqrt(dx * dx + dy * dy) <= self.radius;
+    }
+    if (const Wall* w = dynamic_cast<const Wall*>(&other)) {
+        double cx = std::max(w->getLeft(), std::min(self.mass_centre[0], w->getRight()));
+        double cy = std::max(w->getBottom(), std::min(self.mass_centre[1], w->getTop()));
+        double dx = self.mass_centre[0] - cx;
+        double dy = self.mass_centre[1] - cy;
+        return std::sqrt(dx * dx + dy * dy) <= self.radius;
+    }
+    if (const Slope* s = dynamic_cast<const Slope*>(&other)) {
+        double dx = self.mass_centre[0] - s->mass_centre[0];
+        double dy = self.mass_centre[1] - s->mass_centre[1];
+        return std::sqrt(dx * dx + dy * dy) < (self.radius + s->getLength() / 2.0);
+    }
+    return false;
+}
+
+bool legacyRectOverlap(double l1, double r1, double t1, double b1, double l2, double r2, double t2, double b2) {
+    return !(l1 > r2 || r1 < l2 || b1 > t2 || t1 < b2);
+}
+
+bool legacyAABBCollision(const AABB& self, const Shape& other) {
+    if (const AABB* a = dynamic_cast<const AABB*>(&other)) {
+        return legacyRectOverlap(self.getLeft(), self.getRight(), self.getTop(), self.getBottom(),
+                                 a->getLeft(), a->getRight(), a->getTop(), a->getBottom());
+    }
+    if (const Wall* w = dynamic_cast<const Wall*>(&other)) {
+        return legacyRectOverlap(self.getLeft(), self.getRight(), self.getTop(), self.getBottom(),
+                                 w->getLeft(), w->getRight(), w->getTop(), w->getBottom());
+    }
+    if (const Circle* c = dynamic_cast<const Circle*>(&other)) {
+        return legacyCircleCollision(*c, self);
+    }
+    if (const Slope* s = dynamic_cast<const Slope*>(&other)) {
+        double dx = self.mass_centre[0] - s->mass_centre[0];
+        double dy = self.mass_centre[1] - s->mass_centre[1];
+        double r = std::sqrt(self.width * self.width + self.height * self.height) / 2.0;
+        return std::sqrt(dx * dx + dy * dy) < (r + s->getLength() / 2.0);
+    }
+    return false;
+}
+
+bool legacyWallCollision(const Wall& self, const Shape& other) {
+    if (const Circle* c = dynamic_cast<const Circle*>(&other)) {
+        return legacyCircleCollision(*c, self);
+    }
+    if (const AABB* a = dynamic_cast<const AABB*>(&other)) {
+        return legacyRectOverlap(self.getLeft(), self.getRight(), self.getTop(), self.getBottom(),
+                                 a->getLeft(), a->getRight(), a->getTop(), a->getBottom());
+    }
+    if (const Wall* w = dynamic_cast<const Wall*>(&other)) {
+        return legacyRectOverlap(self.getLeft(), self.getRight(), self.getTop(), self.getBottom(),
+                                 w->getLeft(), w->getRight(), w->getTop(), w->getBottom());
+    }
+    if (const Slope* s = dynamic_cast<const Slope*>(&other)) {
+        double dx = self.mass_centre[0] - s->mass_centre[0];
+        double dy = self.mass_centre[1] - s->mass_centre[1];
+        return std::sqrt(dx * dx + dy * dy) < (self.getDiagonal() / 2.0 + s->getLength() / 2.0);
+    }
+    return false;
+}
+
+bool legacyCheckCollision(const Shape& self, const Shape& other) {
+    if (const Circle* c = dynamic_cast<const Circle*>(&self)) return legacyCircleCollision(*c, other);
+    if (const AABB* a = dynamic_cast<const AABB*>(&self)) return legacyAABBCollision(*a, other);
+    if (const Wall* w = dynamic_cast<const Wall*>(&self)) return legacyWallCollision(*w, other);
+    if (const Ground* g = dynamic_cast<const Ground*>(&self)) return other.getBottom() <= g->y_level;
+    return false;  // Slope
+}
+
+double legacyOverlap(const Shape& shape1, const Shape& shape2, double& nx, double& ny, double distance) {
+    const Circle* c1 = dynamic_cast<const Circle*>(&shape1);
+    const Circle* c2 = dynamic_cast<const Circle*>(&shape2);
+    const AABB* a1 = dynamic_cast<const AABB*>(&shape1);
+    const AABB* a2 = dynamic_cast<const AABB*>(&shape2);
+    if (c1 && c2) {
+        return c1->getRadius() + c2->getRadius() - distance;
+    }
+    if (a1 && a2) {
+        double x1 = a1->mass_centre[0], y1 = a1->mass_centre[1];
+        double x2 = a2->mass_centre[0], y2 = a2->mass_centre[1];
+        double overlapX = (a1->getWidth() + a2->getWidth()) / 2.0 - std::abs(x2 - x1);
+        double overlapY = (a1->getHeight() + a2->getHeight()) / 2.0 - std::abs(y2 - y1);
+        if (overlapX < overlapY) {
+            nx = (x2 > x1) ? 1.0 : -1.0;
+            ny = 0.0;
+            return overlapX;
+        }
+        nx = 0.0;
+        ny = (y2 > y1) ? 1.0 : -1.0;
+        return overlapY;
+    }
+    if ((c1 && a2) || (a1 && c2)) {
+        const Circle* circle = c1 ? c1 : c2;
+        const AABB* aabb = a1 ? a1 : a2;
+        double cx = std::max(aabb->getLeft(), std::min(circle->mass_centre[0], aabb->getRight()));
+        double cy = std::max(aabb->getBottom(), std::min(circle->mass_centre[1], aabb->getTop()));
+        double dx = circle->mass_centre[0] - cx;
+        double dy = circle->mass_centre[1] - cy;
+        double dist = std::sqrt(dx * dx + dy * dy);
+        return dist < 0.0001 ? circle->getRadius() : circle->getRadius() - dist;
+    }
+    return 0.0;
+}
+
+// 随机生成五种形状（世界范围较小，保证有相当比例的物体对发生碰撞）
+std::vector<Shape*> createMixedShapes(int count, bool withStatic) {
+    std::vector<Shape*> shapes;
+    int kinds = withStatic ? 5 : 2;
+    for (int i = 0; i < count; i++) {
+        double x = randomRange(-10.0, 10.0);
+        double y = randomRange(-10.0, 10.0);
+        switch (i % kinds) {
+            case 0: shapes.push_back(new Circle(1.0, randomRange(0.5, 3.0), x, y)); break;
+            case 1: shapes.push_back(new AABB(1.0, randomRange(0.5, 4.0), randomRange(0.5, 4.0), x, y)); break;
+            case 2: shapes.push_back(new Wall(randomRange(0.5, 6.0), randomRange(0.5, 6.0), x, y)); break;
+            case 3: shapes.push_back(new Slope(1.0, randomRange(1.0, 5.0), 0.5, x, y)); break;
+            default: shapes.push_back(new Ground(y)); break;
+        }
+    }
+    return shapes;
+}
+
+// 测试1：正确性
+bool test_dispatch_matches_legacy() {
+    printSeparator();
+    std::cout << "测试1：分派表与 dynamic_cast 链的碰撞结果一致（五种形状的全部组合）" << std::endl;
+    printSeparator();
+
+    std::srand(7);
+    std::vector<Shape*> shapes = createMixedShapes(400, true);
+    size_t tested = 0, collided = 0, mismatches = 0;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        for (size_t j = 0; j < shapes.size(); j++) {
+            if (i == j) continue;
+            // 原来的 Circle/AABB 遇到 Ground 会触发 assert，跳过这些组合
+            bool selfDynamic = shapes[i]->getKind() == SHAPE_CIRCLE || shapes[i]->getKind() == SHAPE_AABB;
+            if (selfDynamic && shapes[j]->getKind() == SHAPE_GROUND) continue;
+
+            bool expected = legacyCheckCollision(*shapes[i], *shapes[j]);
+            bool actual = shapes[i]->check_collision(*shapes[j]);
+            tested++;
+            if (actual) collided++;
+            if (expected != actual) mismatches++;
+        }
+    }
+    std::cout << "  测试物体对: " << tested << "，其中碰撞: " << collided << "，不一致: " << mismatches << std::endl;
+    deleteShapes(shapes);
+    return mismatches == 0 && collided > 0;
+}
+
+// 测试2：重叠量
+bool test_separation_matches_legacy() {
+    printSeparator();
+    std::cout << "测试2：分离内核与原来的重叠量计算一致" << std::endl;
+    printSeparator();
+
+    std::srand(11);
+    std::vector<Shape*> shapes = createMixedShapes(300, false);
+    size_t tested = 0, mismatches = 0;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        for (size_t j = 0; j < shapes.size(); j++) {
+            if (i == j) continue;
+            double x1, y1, x2, y2;
+            shapes[i]->getCentre(x1, y1);
+            shapes[j]->getCentre(x2, y2);
+            double distance = std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+            if (distance < 0.0001) continue;
+            double nx1 = (x2 - x1) / distance, ny1 = (y2 - y1) / distance;
+            double nx2 = nx1, ny2 = ny1;
+
+            double expected = legacyOverlap(*shapes[i], *shapes[j], nx1, ny1, distance);
+            double actual = shapes[i]->computeOverlap(*shapes[j], nx2, ny2, distance);
+            tested++;
+            if (expected != actual || nx1 != nx2 || ny1 != ny2) mismatches++;
+        }
+    }
+    std::cout << "  测试物体对: " << tested << "，不一致: " << mismatches << std::endl;
+    deleteShapes(shapes);
+    return mismatches == 0;
+}
+
+// 测试3：微基准
+bool test_dispatch_benchmark() {
+    printSeparator();
+    std::cout << "测试3：单对碰撞检测耗时（Circle / AABB 混合，200 万对）" << std::endl;
+    printSeparator();
+
+    std::srand(3);
+    std::vector<Shape*> shapes = createMixedShapes(2000, false);
+    std::vector<std::pair<int, int> > pairs;
+    for (int k = 0; k < 2000000; k++) {
+        pairs.push_back(std::make_pair(std::rand() % 2000, std::rand() % 2000));
+    }
+
+    size_t legacyHits = 0, tableHits = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t k = 0; k < pairs.size(); k++) {
+        if (legacyCheckCollision(*shapes[pairs[k].first], *shapes[pairs[k].second])) legacyHits++;
+    }
+    auto middle = std::chrono::high_resolution_clock::now();
+    for (size_t k = 0; k < pairs.size(); k++) {
+        if (shapes[pairs[k].first]->check_collision(*shapes[pairs[k].second])) tableHits++;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double legacyNs = std::chrono::duration<double, std::nano>(middle - start).count() / pairs.size();
+    double tableNs = std::chrono::duration<double, std::nano>(end - middle).count() / pairs.size();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  dynamic_cast 链: " << legacyNs << " ns/对" << std::endl;
+    std::cout << "  分派表:          " << tableNs << " ns/对" << std::endl;
+    std::cout << "  加速比: " << legacyNs / tableNs << "x" << std::endl;
+
+    deleteShapes(shapes);
+    return legacyHits == tableHits;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_dispatch_matches_legacy()) passed++;
+    total++; if (test_separation_matches_legacy()) passed++;
+    total++; if (test_dispatch_benchmark()) passed++;
+
+    printSeparator();
+    std::cout << "碰撞分派测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,387 @@
+/*=========================================================================================================
+ * 约束测试 - 验证距离约束、绳子约束、钉住约束（XPBD，按约束图着色分批求解）
+ *
+ * 测试场景：
+ * 1. 着色：同一颜色的约束没有公共的动态物体；链条只用 2 种颜色，连到同一个静态形状的约束不增加颜色
+ * 2. 单摆：小角度摆动的周期与 2π·sqrt(L/g) 一致，摆长保持不变
+ * 3. 绳子：物体向固定点运动时绳子松弛，不限制物体；下落拉直后距离不超过绳长
+ * 4. 刚性杆：失重时两个物体连成的杆旋转、平移，杆长和总动量保持不变
+ * 5. 长链条：10000 节的链条作为一条链直接求解，每步的耗时、相邻两节的最大伸长，以及多线程结果与单线程相同
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <ctime>
+#include <random>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+double distanceBetween(Shape* a, double x, double y) {
+    double ax, ay;
+    a->getCentre(ax, ay);
+    return std::hypot(ax - x, ay - y);
+}
+
+double distanceBetween(Shape* a, Shape* b) {
+    double bx, by;
+    b->getCentre(bx, by);
+    return distanceBetween(a, bx, by);
+}
+
+// 检查同一颜色的约束没有公共的动态物体
+bool colorsAreIndependent(const PhysicalWorld& world, const std::vector<int>& ids,
+                          const std::vector<std::pair<Shape*, Shape*> >& ends) {
+    const ConstraintSolver& solver = world.getConstraintSolver();
+    for (size_t i = 0; i < ids.size(); i++) {
+        for (size_t j = i + 1; j < ids.size(); j++) {
+            if (solver.getColor(ids[i]) != solver.getColor(ids[j])) continue;
+            Shape* a[2] = { ends[i].first, ends[i].second };
+            Shape* b[2] = { ends[j].first, ends[j].second };
+            for (int p = 0; p < 2; p++) {
+                for (int q = 0; q < 2; q++) {
+                    if (a[p] != nullptr && a[p] == b[q] && a[p]->getBodyStore() != nullptr) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/*=========================================================================================================
+ * 测试 1：约束图着色
+ *=========================================================================================================*/
+bool testColoring() {
+    printSeparator();
+    std::cout << "测试 1：约束图着色" << std::endl;
+    printSeparator('-');
+
+    bool ok = true;
+
+    // 链条：相邻两节之间一个距离约束
+    {
+        PhysicalWorld world;
+        world.gravity = 0.0;
+        std::vector<Shape*> links;
+        std::vector<int> ids;
+        std::vector<std::pair<Shape*, Shape*> > ends;
+        for (int i = 0; i < 200; i++) {
+            Shape* link = world.allocateShape<Circle>(1.0, 0.1, 0.3 * i, 500.0);
+            world.addDynamicShape(link);
+            links.push_back(link);
+            if (i > 0) {
+                ids.push_back(world.addDistanceConstraint(links[i - 1], link));
+                ends.push_back(std::make_pair(links[i - 1], link));
+            }
+        }
+        world.start();
+        world.update(world.dynamicShapeList, 1.0 / 60.0, world.ground);
+        const ConstraintStats& stats = world.getConstraintStats();
+        bool independent = colorsAreIndependent(world, ids, ends);
+        std::cout << "  链条：" << stats.constraintCount << " 个约束，" << stats.colorCount << " 种颜色，"
+                  << (independent ? "同色约束互不相交" : "同色约束有公共物体") << std::endl;
+        ok = ok && stats.colorCount == 2 && independent;
+    }
+
+    // 随机图：500 个物体之间 2000 个约束，另外每个物体都连到同一个静态形状
+    {
+        PhysicalWorld world;
+        world.gravity = 0.0;
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> pick(0, 499);
+        std::vector<Shape*> bodies;
+        for (int i = 0; i < 500; i++) {
+            Shape* body = world.allocateShape<Circle>(1.0, 0.05, (i % 25) * 1.0, 400.0 + (i / 25) * 1.0);
+            world.addDynamicShape(body);
+            bodies.push_back(body);
+        }
+        Shape* post = world.allocateShape<Circle>(1.0, 0.5, 12.0, 380.0);
+        world.addStaticShape(post);
+
+        std::vector<int> ids;
+        std::vector<std::pair<Shape*, Shape*> > ends;
+        int maxDegree = 0;
+        std::vector<int> degree(500, 0);
+        while (ids.size() < 2000) {
+            int a = pick(rng), b = pick(rng);
+            if (a == b) continue;
+            ids.push_back(world.addRopeConstraint(bodies[a], bodies[b]));
+            ends.push_back(std::make_pair(bodies[a], bodies[b]));
+            maxDegree = std::max(maxDegree, std::max(++degree[a], ++degree[b]));
+        }
+        size_t colorsWithoutPost;
+        world.start();
+        world.update(world.dynamicShapeList, 1.0 / 60.0, world.ground);
+        colorsWithoutPost = world.getConstraintStats().colorCount;
+        for (int i = 0; i < 500; i++) {
+            ids.push_back(world.addDistanceConstraint(bodies[i], post));
+            ends.push_back(std::make_pair(bodies[i], static_cast<Shape*>(nullptr)));
+        }
+        world.update(world.dynamicShapeList, 1.0 / 60.0, world.ground);
+        const ConstraintStats& stats = world.getConstraintStats();
+        bool independent = colorsAreIndependent(world, ids, ends);
+        std::cout << "  随机图：" << stats.constraintCount << " 个约束，最大度数 " << maxDegree << "，"
+                  << colorsWithoutPost << " 种颜色；每个物体再连到同一个静态形状后 " << stats.colorCount << " 种，"
+                  << (independent ? "同色约束互不相交" : "同色约束有公共物体") << std::endl;
+        // 贪心着色最多用 最大度数 × 2 - 1 种颜色；连到静态形状的约束每个物体只多一个
+        ok = ok && independent && colorsWithoutPost <= static_cast<size_t>(2 * maxDegree - 1) &&
+             stats.colorCount <= colorsWithoutPost + 1;
+    }
+
+    std::cout << (ok ? "✓ 着色正确" : "✗ 着色错误") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 2：单摆的周期
+ *=========================================================================================================*/
+bool testPendulumPeriod() {
+    printSeparator();
+    std::cout << "测试 2：单摆的周期" << std::endl;
+    printSeparator('-');
+
+    const double length = 2.0;
+    const double amplitude = 0.1;   // 弧度
+    const double pivotX = 0.0, pivotY = 500.0;
+    const double dt = 1.0 / 240.0;
+
+    PhysicalWorld world;
+    world.setSleepingEnabled(false);
+    Shape* bob = world.allocateShape<Circle>(1.0, 0.1, pivotX + length * std::sin(amplitude),
+                                             pivotY - length * std::cos(amplitude));
+    world.addDynamicShape(bob);
+    int id = world.addPinConstraint(bob, pivotX, pivotY);
+    world.start();
+
+    // 记录摆过最低点（x 由负变正）的时刻
+    std::vector<double> crossings;
+    double previousX = length * std::sin(amplitude);
+    double maxLengthError = 0.0;
+    const int steps = static_cast<int>(12.0 / dt);
+    for (int i = 1; i <= steps; i++) {
+        world.update(world.dynamicShapeList, dt, world.ground);
+        double x, y;
+        bob->getCentre(x, y);
+        maxLengthError = std::max(maxLengthError, std::fabs(distanceBetween(bob, pivotX, pivotY) - length));
+        if (previousX < 0.0 && x >= 0.0) {
+            crossings.push_back((i - 1 + previousX / (previousX - x)) * dt);
+        }
+        previousX = x;
+    }
+
+    double period = (crossings.back() - crossings.front()) / (crossings.size() - 1);
+    // 有限振幅的周期：T ≈ 2π·sqrt(L/g)·(1 + θ²/16)
+    double expected = 2.0 * PI * std::sqrt(length / world.gravity) * (1.0 + amplitude * amplitude / 16.0);
+    double relError = std::fabs(period - expected) / expected;
+    std::cout << std::fixed << std::setprecision(5);
+    std::cout << "  约束编号 " << id << "，摆长 " << length << " m，振幅 " << amplitude << " rad，步长 1/240 s" << std::endl;
+    std::cout << "  周期：" << period << " s（理论 " << expected << " s，相对误差 "
+              << std::scientific << std::setprecision(2) << relError << "）" << std::endl;
+    std::cout << "  摆长的最大误差：" << maxLengthError << " m" << std::endl;
+
+    bool ok = id >= 0 && crossings.size() >= 3 && relError < 0.01 && maxLengthError < 1e-9;
+    std::cout << (ok ? "✓ 周期与理论值一致，摆长不变" : "✗ 周期或摆长不正确") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 3：绳子
+ *=========================================================================================================*/
+bool testRope() {
+    printSeparator();
+    std::cout << "测试 3：绳子只限制最大距离" << std::endl;
+    printSeparator('-');
+
+    const double ropeLength = 3.0;
+    const double anchorX = 0.0, anchorY = 500.0;
+    const double dt = 1.0 / 120.0;
+
+    PhysicalWorld world;
+    world.setSleepingEnabled(false);
+    // 物体在悬挂点正下方 3 m，以 6 m/s 向上抛出：上升阶段绳子松弛
+    Shape* body = world.allocateShape<Circle>(1.0, 0.1, anchorX + 0.3, anchorY - ropeLength, 0.0, 6.0);
+    world.addDynamicShape(body);
+    world.addAnchoredRopeConstraint(body, anchorX, anchorY, ropeLength);
+    world.start();
+
+    double minDistance = 1e9, maxDistance = 0.0, peakY = -1e9;
+    for (int i = 0; i < 360; i++) {
+        world.update(world.dynamicShapeList, dt, world.ground);
+        double x, y;
+        body->getCentre(x, y);
+        double d = distanceBetween(body, anchorX, anchorY);
+        minDistance = std::min(minDistance, d);
+        maxDistance = std::max(maxDistance, d);
+        peakY = std::max(peakY, y);
+    }
+    // 不受约束时的上抛高度为 v² / 2g
+    double freeRise = 36.0 / (2.0 * world.gravity);
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "  最高点上升 " << peakY - (anchorY - ropeLength) << " m（自由上抛 " << freeRise << " m）" << std::endl;
+    std::cout << "  到悬挂点的距离：最小 " << minDistance << " m，最大 " << maxDistance << " m（绳长 " << ropeLength << " m）" << std::endl;
+
+    bool ok = std::fabs(peakY - (anchorY - ropeLength) - freeRise) < 0.05 && minDistance < 1.5 &&
+              maxDistance < ropeLength + 1e-9;
+    std::cout << (ok ? "✓ 松弛时不受限制，拉直后不超过绳长" : "✗ 绳子约束不正确") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 4：失重时旋转的刚性杆
+ *=========================================================================================================*/
+bool testRigidRod() {
+    printSeparator();
+    std::cout << "测试 4：失重时旋转的刚性杆" << std::endl;
+    printSeparator('-');
+
+    PhysicalWorld world;
+    world.gravity = 0.0;
+    world.gravity_vertical = 0.0;
+    world.setSleepingEnabled(false);
+    Shape* a = world.allocateShape<Circle>(1.0, 0.1, -1.0, 500.0, 1.0, 3.0);
+    Shape* b = world.allocateShape<Circle>(3.0, 0.1, 1.0, 500.0, 1.0, -1.0);
+    world.addDynamicShape(a);
+    world.addDynamicShape(b);
+    world.addDistanceConstraint(a, b);
+    world.start();
+
+    auto momentum = [&](double& px, double& py) {
+        double vax, vay, vbx, vby;
+        a->getVelocity(vax, vay);
+        b->getVelocity(vbx, vby);
+        px = 1.0 * vax + 3.0 * vbx;
+        py = 1.0 * vay + 3.0 * vby;
+    };
+    double px0, py0;
+    momentum(px0, py0);
+
+    double maxLengthError = 0.0, maxMomentumError = 0.0;
+    for (int i = 0; i < 600; i++) {
+        world.update(world.dynamicShapeList, 1.0 / 60.0, world.ground);
+        double px, py;
+        momentum(px, py);
+        maxLengthError = std::max(maxLengthError, std::fabs(distanceBetween(a, b) - 2.0));
+        maxMomentumError = std::max(maxMomentumError, std::hypot(px - px0, py - py0));
+    }
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "  10 秒内杆长的最大误差 " << maxLengthError << " m，总动量的最大变化 " << maxMomentumError << " kg·m/s" << std::endl;
+
+    bool ok = maxLengthError < 1e-9 && maxMomentumError < 1e-9;
+    std::cout << (ok ? "✓ 杆长和总动量保持不变" : "✗ 杆长或总动量发生变化") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 5：10000 节的链条
+ *=========================================================================================================*/
+struct ChainResult {
+    double msPerStep;
+    double cpuMsPerStep;      // 进程的 CPU 时间（不受同时运行的其他程序影响）
+    double maxStretch;        // 各节到悬挂点的距离与链长之比的最大值 - 1
+    double medianLinkStretch; // 相邻两节距离的相对伸长：中位数和最大值
+    double maxLinkStretch;
+    size_t colors;
+    size_t chains;
+    std::vector<double> positions;
+};
+
+ChainResult simulateChain(int links, int threads, int frames) {
+    const double linkLength = 0.05;
+    const double anchorX = 0.0, anchorY = 900.0;
+
+    PhysicalWorld world;
+    world.setWorkerThreads(threads);
+    world.setSleepingEnabled(false);
+    std::vector<Shape*> chain;
+    for (int i = 0; i < links; i++) {
+        // 链条从悬挂点水平伸出，松手后向下摆动
+        Shape* link = world.allocateShape<Circle>(0.01, 0.02, anchorX + linkLength * (i + 1), anchorY);
+        world.addDynamicShape(link);
+        if (i == 0) {
+            world.addPinConstraint(link, anchorX, anchorY, linkLength);
+        } else {
+            world.addDistanceConstraint(chain.back(), link, linkLength);
+        }
+        chain.push_back(link);
+    }
+    world.start();
+
+    ChainResult result;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::clock_t cpuStart = std::clock();
+    for (int f = 0; f < frames; f++) {
+        world.update(world.dynamicShapeList, 1.0 / 60.0, world.ground);
+    }
+    std::clock_t cpuEnd = std::clock();
+    auto end = std::chrono::high_resolution_clock::now();
+    result.msPerStep = std::chrono::duration<double, std::milli>(end - start).count() / frames;
+    result.cpuMsPerStep = 1000.0 * (cpuEnd - cpuStart) / CLOCKS_PER_SEC / frames;
+    result.colors = world.getConstraintStats().colorCount;
+    result.chains = world.getConstraintStats().chainCount;
+
+    result.maxStretch = 0.0;
+    std::vector<double> linkStretch;
+    for (int i = 0; i < links; i++) {
+        double x, y;
+        chain[i]->getCentre(x, y);
+        result.positions.push_back(x);
+        result.positions.push_back(y);
+        result.maxStretch = std::max(result.maxStretch, distanceBetween(chain[i], anchorX, anchorY) / (linkLength * (i + 1)) - 1.0);
+        if (i > 0) {
+            linkStretch.push_back(distanceBetween(chain[i - 1], chain[i]) / linkLength - 1.0);
+        }
+    }
+    std::sort(linkStretch.begin(), linkStretch.end());
+    result.medianLinkStretch = linkStretch[linkStretch.size() / 2];
+    result.maxLinkStretch = linkStretch.back();
+    return result;
+}
+
+bool testLongChain() {
+    printSeparator();
+    std::cout << "测试 5：10000 节的链条" << std::endl;
+    printSeparator('-');
+
+    const int links = 10000;
+    const int frames = 120;
+    ChainResult single = simulateChain(links, 1, frames);
+    ChainResult multi = simulateChain(links, 4, frames);
+
+    bool identical = single.positions == multi.positions;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  " << links << " 节，" << links << " 个约束，整条链作为 " << single.chains << " 条链直接求解（牛顿迭代，每步最多 10 轮），共 " << frames << " 帧" << std::endl;
+    std::cout << "  每帧耗时：单线程 " << single.msPerStep << " ms（CPU 时间 " << single.cpuMsPerStep << " ms），4 线程 "
+              << multi.msPerStep << " ms（实时需要 < 16.67 ms）" << std::endl;
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "  各节到悬挂点的距离超出链长的最大比例 " << single.maxStretch << std::endl;
+    std::cout << "  相邻两节的相对伸长：中位数 " << single.medianLinkStretch << "，最大 " << single.maxLinkStretch << std::endl;
+    std::cout << "  多线程结果与单线程" << (identical ? "逐位相同" : "不同") << std::endl;
+
+    bool ok = single.cpuMsPerStep < 1000.0 / 60.0 && identical && single.chains == 1 &&
+              single.maxStretch < 1e-3 && single.maxLinkStretch < 1e-3;
+    std::cout << (ok ? "✓ 链条实时模拟，多线程结果确定" : "✗ 链条模拟过慢或结果不正确") << std::endl;
+    return ok;
+}
+
+int main() {
+    std::cout << "约束测试（距离、绳子、钉住约束）" << std::endl;
+
+    int passed = 0, total = 0;
+    total++; if (testColoring()) passed++;
+    total++; if (testPendulumPeriod()) passed++;
+    total++; if (testRope()) passed++;
+    total++; if (testRigidRod()) passed++;
+    total++; if (testLongChain()) passed++;
+
+    printSeparator();
+    std::cout << "结果：" << passed << " / " << total << " 通过" << std::endl;
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+/*=========================================================================================================
+ * 接触缓存测试 - 验证持久接触与热启动
+ *
+ * 测试场景：
+ * 1. 持久性：两个挤在一起的圆在多帧内保持同一个接触，age 递增，分开后接触被删除
+ * 2. 移除形状：removeDynamicShape 之后与该形状有关的接触立即删除
+ * 3. 热启动：一排圆被持续推向固定的圆，热启动时每帧一次求解就能静止，不热启动时持续抖动
+ * 4. 默认方式：CONTACT_SOLVER_DIRECT 下不使用接触缓存，结果与原来相同
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+void deleteShapes(std::vector<Circle*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+// 测试1：持久性
+bool test_contact_persistence() {
+    printSeparator();
+    std::cout << "测试1：接触在多帧内保持，分开后删除" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    world.setContactSolver(CONTACT_SOLVER_IMPULSE);
+
+    Circle* a = new Circle(1.0, 1.0, 0.0, 500.0);
+    Circle* b = new Circle(1.0, 1.0, 1.9, 500.0);
+    a->setName("A");
+    b->setName("B");
+    world.addDynamicShape(a);
+    world.addDynamicShape(b);
+
+    world.update(world.dynamicShapeList, world.ground);
+    const ContactStats& stats = world.getContactStats();
+    bool ok = stats.newContacts == 1 && stats.persistentContacts == 0;
+    std::cout << "  第 1 帧: 新建 " << stats.newContacts << "，延续 " << stats.persistentContacts << std::endl;
+
+    for (int i = 0; i < 9; i++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    const ContactManifold* contact = world.findContact(a, b);
+    ok = ok && contact != nullptr && contact->age == 9 && stats.newContacts == 0 && stats.persistentContacts == 1;
+    std::cout << "  第 10 帧: 接触 age = " << (contact ? contact->age : -1)
+              << "，复用预计算量的接触: " << stats.setupSkipped << std::endl;
+
+    b->setCentre(50.0, 500.0);
+    world.update(world.dynamicShapeList, world.ground);
+    ok = ok && world.findContact(a, b) == nullptr && stats.removedContacts == 1;
+    std::cout << "  分开后: 删除 " << stats.removedContacts << " 个接触" << std::endl;
+    std::cout << "  结果: " << (ok ? "接触正确保持和删除 ✓" : "接触缓存错误 ✗") << std::endl;
+
+    delete a;
+    delete b;
+    return ok;
+}
+
+// 测试2：移除形状
+bool test_remove_shape() {
+    printSeparator();
+    std::cout << "测试2：移除形状时删除相关接触" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    world.setContactSolver(CONTACT_SOLVER_IMPULSE);
+
+    Circle* a = new Circle(1.0, 1.0, 0.0, 500.0);
+    Circle* b = new Circle(1.0, 1.0, 1.9, 500.0);
+    a->setName("A");
+    b->setName("B");
+    world.addDynamicShape(a);
+    world.addDynamicShape(b);
+    world.update(world.dynamicShapeList, world.ground);
+
+    bool before = world.findContact(a, b) != nullptr;
+    world.removeDynamicShape(b);
+    bool after = world.findContact(a, b) == nullptr;
+    bool ok = before && after;
+    std::cout << "  结果: " << (ok ? "移除后接触已删除 ✓" : "接触残留 ✗") << std::endl;
+
+    delete a;
+    delete b;
+    return ok;
+}
+
+// 测试3：热启动
+// 一排圆（最左边的圆质量很大，且每帧速度清零，相当于固定），每帧给其余的圆一个向左的速度增量，
+// 相当于沿 -x 方向的重力。稳定后统计最后一秒内的最大速度和最大穿透深度。
+struct ChainResult {
+    double maxSpeed;
+    double maxPenetration;
+};
+
+ChainResult runChain(ContactSolverType solver, bool warmStarting, int count) {
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    world.setContactSolver(solver);
+    world.setWarmStarting(warmStarting);
+    world.setContactIterations(1);
+
+    std::vector<Circle*> circles;
+    for (int i = 0; i <= count; i++) {
+        Circle* c = new Circle(i == 0 ? 1e6 : 1.0, 1.0, i * 2.0, 500.0);
+        c->setName("C" + std::to_string(i));
+        circles.push_back(c);
+        world.addDynamicShape(c);
+    }
+
+    const double acceleration = 10.0;
+    double dt = world.getTimeStep();
+    ChainResult result = {0.0, 0.0};
+    for (int step = 0; step < 600; step++) {
+        for (int i = 1; i <= count; i++) {
+            double vx, vy;
+            circles[i]->getVelocity(vx, vy);
+            circles[i]->setVelocity(vx - acceleration * dt, vy);
+        }
+        circles[0]->setVelocity(0.0, 0.0);
+
+        world.update(world.dynamicShapeList, world.ground);
+
+        if (step >= 540) {
+            for (int i = 1; i <= count; i++) {
+                double vx, vy, x1, y1, x2, y2;
+                circles[i]->getVelocity(vx, vy);
+                circles[i - 1]->getCentre(x1, y1);
+                circles[i]->getCentre(x2, y2);
+                result.maxSpeed = std::max(result.maxSpeed, std::abs(vx));
+                result.maxPenetration = std::max(result.maxPenetration, 2.0 - (x2 - x1));
+            }
+        }
+    }
+
+    deleteShapes(circles);
+    return result;
+}
+
+bool test_warm_starting() {
+    printSeparator();
+    std::cout << "测试3：一排 10 个圆被持续推向固定的圆（每帧一次求解）" << std::endl;
+    printSeparator();
+
+    ChainResult direct = runChain(CONTACT_SOLVER_DIRECT, false, 10);
+    ChainResult cold = runChain(CONTACT_SOLVER_IMPULSE, false, 10);
+    ChainResult warm = runChain(CONTACT_SOLVER_IMPULSE, true, 10);
+
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "  原来的逐对公式: 最大速度 " << direct.maxSpeed << " m/s，最大穿透 " << direct.maxPenetration << " m" << std::endl;
+    std::cout << "  冲量求解（无热启动）: 最大速度 " << cold.maxSpeed << " m/s，最大穿透 " << cold.maxPenetration << " m" << std::endl;
+    std::cout << "  冲量求解（热启动）: 最大速度 " << warm.maxSpeed << " m/s，最大穿透 " << warm.maxPenetration << " m" << std::endl;
+
+    bool ok = warm.maxSpeed < 0.01 && warm.maxSpeed * 100.0 < cold.maxSpeed && warm.maxPenetration < 0.1;
+    std::cout << "  结果: " << (ok ? "热启动后接近静止 ✓" : "仍在抖动 ✗") << std::endl;
+    return ok;
+}
+
+// 测试4：默认方式
+bool test_direct_solver_default() {
+    printSeparator();
+    std::cout << "测试4：默认碰撞响应不使用接触缓存" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+
+    Circle* a = new Circle(1.0, 1.0, 0.0, 500.0, 1.0, 0.0);
+    Circle* b = new Circle(1.0, 1.0, 1.9, 500.0);
+    a->setName("A");
+    b->setName("B");
+    world.addDynamicShape(a);
+    world.addDynamicShape(b);
+    world.update(world.dynamicShapeList, world.ground);
+
+    bool ok = world.getContactSolver() == CONTACT_SOLVER_DIRECT && world.findContact(a, b) == nullptr
+              && world.getContactStats().contactCount == 0;
+    std::cout << "  结果: " << (ok ? "默认仍使用逐对公式 ✓" : "默认方式被改变 ✗") << std::endl;
+
+    delete a;
+    delete b;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_contact_persistence()) passed++;
+    total++; if (test_remove_shape()) passed++;
+    total++; if (test_warm_starting()) passed++;
+    total++; if (test_direct_solver_default()) passed++;
+
+    printSeparator();
+    std::cout << "接触缓存测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
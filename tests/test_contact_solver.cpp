@@ -0,0 +1,213 @@
+/*=========================================================================================================
+ * 迭代冲量求解测试 - 验证 Sequential Impulse（投影 Gauss-Seidel）接触求解器
+ *
+ * 测试场景：
+ * 1. 迭代次数：一排 30 个圆被持续推向固定的圆，迭代次数越多，静止时的残余速度越小
+ * 2. 提前结束：收敛后实际迭代次数小于设置的最大次数
+ * 3. 弹性碰撞：弹性系数为 1 时等质量的圆交换速度，为 0 时一起运动
+ * 4. 库仑摩擦：方块贴着固定方块滑动，摩擦冲量不超过 μ·法向冲量，减速度为 μ·a
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+// 一排圆（最左边的圆质量很大且每帧速度清零），其余的圆每帧获得向左的速度增量 a·dt。
+// 返回最后一秒内的最大速度，iterationsUsed 为最后一步实际的速度迭代次数
+double runChain(int count, int iterations, int& iterationsUsed) {
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    world.setContactSolver(CONTACT_SOLVER_IMPULSE);
+    world.setContactIterations(iterations);
+
+    std::vector<Circle*> circles;
+    for (int i = 0; i <= count; i++) {
+        Circle* c = new Circle(i == 0 ? 1e6 : 1.0, 1.0, i * 2.0, 500.0);
+        c->setName("C" + std::to_string(i));
+        circles.push_back(c);
+        world.addDynamicShape(c);
+    }
+
+    const double acceleration = 10.0;
+    double dt = world.getTimeStep();
+    double maxSpeed = 0.0;
+    for (int step = 0; step < 600; step++) {
+        for (int i = 1; i <= count; i++) {
+            double vx, vy;
+            circles[i]->getVelocity(vx, vy);
+            circles[i]->setVelocity(vx - acceleration * dt, vy);
+        }
+        circles[0]->setVelocity(0.0, 0.0);
+
+        world.update(world.dynamicShapeList, world.ground);
+
+        if (step >= 540) {
+            for (int i = 1; i <= count; i++) {
+                double vx, vy;
+                circles[i]->getVelocity(vx, vy);
+                maxSpeed = std::max(maxSpeed, std::abs(vx));
+            }
+        }
+    }
+    iterationsUsed = world.getContactStats().velocityIterations;
+
+    for (size_t i = 0; i < circles.size(); i++) {
+        delete circles[i];
+    }
+    return maxSpeed;
+}
+
+// 测试1：迭代次数
+bool test_iteration_count() {
+    printSeparator();
+    std::cout << "测试1：迭代次数与残余速度（30 个圆）" << std::endl;
+    printSeparator();
+
+    const int counts[] = {1, 2, 4, 8, 16};
+    double speeds[5];
+    std::cout << std::scientific << std::setprecision(3);
+    for (int k = 0; k < 5; k++) {
+        int used = 0;
+        speeds[k] = runChain(30, counts[k], used);
+        std::cout << "  迭代 " << std::setw(2) << counts[k] << " 次: 最大残余速度 " << speeds[k] << " m/s" << std::endl;
+    }
+
+    bool ok = speeds[4] < 1e-3 && speeds[4] * 100.0 < speeds[0];
+    for (int k = 1; k < 5; k++) {
+        if (speeds[k] > speeds[k - 1]) ok = false;
+    }
+    std::cout << "  结果: " << (ok ? "迭代越多越接近静止 ✓" : "残余速度没有随迭代次数下降 ✗") << std::endl;
+    return ok;
+}
+
+// 测试2：提前结束
+bool test_early_out() {
+    printSeparator();
+    std::cout << "测试2：收敛后提前结束迭代" << std::endl;
+    printSeparator();
+
+    int used = 0;
+    double speed = runChain(30, 50, used);
+    std::cout << std::scientific << std::setprecision(3);
+    std::cout << "  最大迭代 50 次，最后一步实际迭代 " << used << " 次，残余速度 " << speed << " m/s" << std::endl;
+
+    bool ok = used < 50 && speed < 1e-3;
+    std::cout << "  结果: " << (ok ? "收敛后提前结束 ✓" : "没有提前结束 ✗") << std::endl;
+    return ok;
+}
+
+// 测试3：弹性碰撞
+bool test_restitution() {
+    printSeparator();
+    std::cout << "测试3：等质量的圆正碰（弹性系数 1 和 0）" << std::endl;
+    printSeparator();
+
+    bool ok = true;
+    const double restitutions[] = {1.0, 0.0};
+    for (int k = 0; k < 2; k++) {
+        PhysicalWorld world;
+        world.setGravity(0.0);
+        world.setContactSolver(CONTACT_SOLVER_IMPULSE);
+
+        Circle* a = new Circle(1.0, 1.0, 0.0, 500.0, 5.0, 0.0);
+        Circle* b = new Circle(1.0, 1.0, 2.05, 500.0);
+        a->setName("A");
+        b->setName("B");
+        a->setRestitution(restitutions[k]);
+        b->setRestitution(restitutions[k]);
+        world.addDynamicShape(a);
+        world.addDynamicShape(b);
+
+        for (int step = 0; step < 3; step++) {
+            world.update(world.dynamicShapeList, world.ground);
+        }
+
+        double v1x, v1y, v2x, v2y;
+        a->getVelocity(v1x, v1y);
+        b->getVelocity(v2x, v2y);
+        double expected1 = restitutions[k] == 1.0 ? 0.0 : 2.5;
+        double expected2 = restitutions[k] == 1.0 ? 5.0 : 2.5;
+        bool match = std::abs(v1x - expected1) < 1e-9 && std::abs(v2x - expected2) < 1e-9;
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "  e = " << restitutions[k] << ": vA = " << v1x << "，vB = " << v2x
+                  << "（期望 " << expected1 << "，" << expected2 << "）" << (match ? " ✓" : " ✗") << std::endl;
+        ok = ok && match;
+
+        delete a;
+        delete b;
+    }
+    return ok;
+}
+
+// 测试4：库仑摩擦
+// 方块 B 贴在固定方块 A 的右侧，每帧获得向左的速度增量 a·dt（把 B 压在 A 上），同时以 3 m/s 向下滑动。
+// 滑动摩擦冲量每帧为 μ·m·a·dt，所以 0.5 秒后向下的速度应减少 μ·a·0.5
+bool test_coulomb_friction() {
+    printSeparator();
+    std::cout << "测试4：库仑摩擦（方块贴着固定方块向下滑动 0.5 秒）" << std::endl;
+    printSeparator();
+
+    bool ok = true;
+    const double coefficients[] = {0.0, 0.2};
+    for (int k = 0; k < 2; k++) {
+        PhysicalWorld world;
+        world.setGravity(0.0);
+        world.setContactSolver(CONTACT_SOLVER_IMPULSE);
+
+        AABB* a = new AABB(1e6, 2.0, 2.0, 0.0, 500.0);
+        AABB* b = new AABB(1.0, 2.0, 2.0, 2.0, 500.0, 0.0, -3.0);
+        a->setName("A");
+        b->setName("B");
+        a->setFraction(coefficients[k]);
+        b->setFraction(coefficients[k]);
+        world.addDynamicShape(a);
+        world.addDynamicShape(b);
+
+        const double acceleration = 10.0;
+        double dt = world.getTimeStep();
+        for (int step = 0; step < 30; step++) {
+            double vx, vy;
+            b->getVelocity(vx, vy);
+            b->setVelocity(vx - acceleration * dt, vy);
+            a->setVelocity(0.0, 0.0);
+            world.update(world.dynamicShapeList, world.ground);
+        }
+
+        double vx, vy;
+        b->getVelocity(vx, vy);
+        double expected = -3.0 + coefficients[k] * acceleration * 0.5;
+        bool match = std::abs(vy - expected) < 1e-6;
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "  μ = " << coefficients[k] << ": 向下速度 " << vy << " m/s（期望 " << expected << " m/s）"
+                  << (match ? " ✓" : " ✗") << std::endl;
+        ok = ok && match;
+
+        delete a;
+        delete b;
+    }
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_iteration_count()) passed++;
+    total++; if (test_early_out()) passed++;
+    total++; if (test_restitution()) passed++;
+    total++; if (test_coulomb_friction()) passed++;
+
+    printSeparator();
+    std::cout << "迭代冲量求解测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,324 @@
+/*=========================================================================================================
+ * 粒子流体与颗粒测试 - 验证网格排序与邻居列表、水和沙在地面、墙壁、斜坡之间的行为，以及多线程的确定性和吞吐量
+ *
+ * 测试场景：
+ * 1. 邻居搜索：排序后粒子的单元编号不减；邻居列表与逐对比较的结果相同
+ * 2. 溃坝：箱子中的一块水塌下后铺满箱底，水面变平，没有粒子离开箱子，压缩量很小
+ * 3. 水与沙：同样的一柱水和沙塌下，沙堆比水高、铺开的范围比水小
+ * 4. 斜坡：落在 20° 斜坡上的水流下去，沙留在斜坡上；两种都不会穿过斜坡
+ * 5. 确定性：多线程与单线程的结果逐位相同
+ * 6. 吞吐量：5000 个水粒子、5000 个沙粒子每帧（1/60 秒）的耗时
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+const double frame = 1.0 / 60.0;
+const double radius = 0.05;
+
+// 以 (left, bottom) 为左下角摆一块 cols × rows 个粒子，间距 spacing；位置带一点固定的扰动，避免完全规则的排列
+void spawnBlock(PhysicalWorld& world, int cols, int rows, double left, double bottom, double spacing) {
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            double jitterX = 0.004 * ((r * 7 + c * 13) % 5 - 2);
+            double jitterY = 0.004 * ((r * 11 + c * 3) % 5 - 2);
+            world.spawnParticle(left + radius + c * spacing + jitterX, bottom + radius + r * spacing + jitterY,
+                                0.0, 0.0, 0.0, radius);
+        }
+    }
+}
+
+struct Extent {
+    double minX, maxX, top, maxSpeed;
+};
+
+Extent measure(const PhysicalWorld& world) {
+    const ParticleSystem& ps = world.getParticleSystem();
+    Extent e = { 1e9, -1e9, -1e9, 0.0 };
+    for (size_t i = 0; i < ps.size(); i++) {
+        e.minX = std::min(e.minX, static_cast<double>(ps.positionX()[i]));
+        e.maxX = std::max(e.maxX, static_cast<double>(ps.positionX()[i]));
+        e.top = std::max(e.top, static_cast<double>(ps.positionY()[i]));
+        e.maxSpeed = std::max(e.maxSpeed, std::hypot(static_cast<double>(ps.velocityX()[i]), static_cast<double>(ps.velocityY()[i])));
+    }
+    return e;
+}
+
+void run(PhysicalWorld& world, int frames) {
+    for (int f = 0; f < frames; f++) {
+        world.update(world.dynamicShapeList, frame, world.ground);
+    }
+}
+
+/*=========================================================================================================
+ * 测试 1：网格排序与邻居列表
+ *=========================================================================================================*/
+bool testNeighbourSearch() {
+    printSeparator();
+    std::cout << "测试 1：网格排序与邻居列表" << std::endl;
+    printSeparator('-');
+
+    // 随机散布的 5000 个点（线性同余），其中一部分挤在一起
+    const size_t n = 5000;
+    const float cellSize = 0.2f;
+    std::vector<float> x(n), y(n);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        float u = (seed >> 8) / 16777216.0f;
+        seed = seed * 1664525u + 1013904223u;
+        float v = (seed >> 8) / 16777216.0f;
+        float scale = i % 4 == 0 ? 1.0f : 6.0f;
+        x[i] = -3.0f + scale * u;
+        y[i] = 2.0f + scale * v;
+    }
+
+    ParticleFluid fluid;
+    const std::vector<uint32_t>& order = fluid.sortByCell(x.data(), y.data(), n, cellSize);
+    std::vector<float> sx(n), sy(n);
+    for (size_t k = 0; k < n; k++) {
+        sx[k] = x[order[k]];
+        sy[k] = y[order[k]];
+    }
+    fluid.buildNeighbours(sx.data(), sy.data(), n, nullptr);
+
+    // 单元编号（与 sortByCell 相同的算法：四周各留一格的行优先编号）
+    float minX = *std::min_element(sx.begin(), sx.end()), maxX = *std::max_element(sx.begin(), sx.end());
+    float minY = *std::min_element(sy.begin(), sy.end());
+    uint64_t width = static_cast<uint64_t>((maxX - (minX - cellSize)) / cellSize) + 2;
+    bool sorted = true;
+    uint64_t previous = 0;
+    for (size_t k = 0; k < n; k++) {
+        uint64_t key = static_cast<uint64_t>((sy[k] - (minY - cellSize)) / cellSize) * width +
+                       static_cast<uint64_t>((sx[k] - (minX - cellSize)) / cellSize);
+        sorted = sorted && key >= previous;
+        previous = key;
+    }
+
+    size_t mismatched = 0, total = 0;
+    for (size_t i = 0; i < n; i++) {
+        std::vector<uint32_t> expected, found(fluid.neighboursOf(i), fluid.neighboursOf(i) + fluid.neighbourCountOf(i));
+        for (size_t j = 0; j < n; j++) {
+            float dx = sx[i] - sx[j], dy = sy[i] - sy[j];
+            if (j != i && dx * dx + dy * dy < cellSize * cellSize) expected.push_back(static_cast<uint32_t>(j));
+        }
+        std::sort(found.begin(), found.end());
+        if (found != expected) mismatched++;
+        total += expected.size();
+    }
+    std::cout << "  " << n << " 个点，" << fluid.getStats().cellCount << " 个非空单元，邻居共 " << total
+              << " 个；单元编号" << (sorted ? "不减" : "没有排好") << "，" << mismatched << " 个粒子的邻居与逐对比较不同" << std::endl;
+
+    bool ok = sorted && mismatched == 0 && fluid.getStats().neighbourCount == total;
+    std::cout << (ok ? "✓ 排序正确，邻居列表完整" : "✗ 排序或邻居列表不正确") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 2：溃坝
+ *=========================================================================================================*/
+bool testDamBreak() {
+    printSeparator();
+    std::cout << "测试 2：箱子中的溃坝" << std::endl;
+    printSeparator('-');
+
+    // 宽 6 米的箱子，左侧一块 2 × 2 米的水
+    PhysicalWorld world;
+    world.setParticleMode(PARTICLE_FLUID);
+    world.addStaticShape(world.allocateShape<Wall>(0.5, 10.0, -3.25, 5.0));
+    world.addStaticShape(world.allocateShape<Wall>(0.5, 10.0, 3.25, 5.0));
+    spawnBlock(world, 20, 20, -3.0, 0.0, 0.1);
+    const size_t count = world.getParticleCount();
+    world.start();
+    run(world, 900);
+
+    // 水面：每 0.5 米一格中最高的粒子
+    const ParticleSystem& ps = world.getParticleSystem();
+    std::vector<double> surface(12, 0.0);
+    bool contained = true;
+    for (size_t i = 0; i < ps.size(); i++) {
+        double x = ps.positionX()[i], y = ps.positionY()[i];
+        contained = contained && x > -3.0 && x < 3.0 && y > 0.0;
+        int column = std::min(11, std::max(0, static_cast<int>((x + 3.0) / 0.5)));
+        surface[column] = std::max(surface[column], y);
+    }
+    double lowest = *std::min_element(surface.begin(), surface.end());
+    double highest = *std::max_element(surface.begin(), surface.end());
+    Extent e = measure(world);
+    const FluidStats& stats = world.getFluidStats();
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  " << ps.size() << " / " << count << " 个粒子，" << (contained ? "全部留在箱子内" : "有粒子离开箱子")
+              << "；15 秒后水面高度 " << lowest << " ~ " << highest << " 米，最大速度 " << e.maxSpeed << " 米/秒" << std::endl;
+    std::cout << "  平均压缩量 " << stats.densityError * 100.0 << "%，邻居 " << stats.neighbourCount << " 个" << std::endl;
+
+    bool ok = ps.size() == count && contained && highest - lowest < 0.2 && lowest > 0.4 && e.maxSpeed < 0.3 &&
+              stats.densityError < 0.02;
+    std::cout << (ok ? "✓ 水铺满箱底，水面变平" : "✗ 溃坝的结果不正确") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 3：水与沙
+ *=========================================================================================================*/
+Extent collapseColumn(ParticleMode mode) {
+    PhysicalWorld world;
+    world.setParticleMode(mode);
+    spawnBlock(world, 20, 30, -1.1, 0.0, 0.11);
+    world.start();
+    run(world, 480);
+    return measure(world);
+}
+
+bool testWaterAndSand() {
+    printSeparator();
+    std::cout << "测试 3：一柱水和一柱沙塌下" << std::endl;
+    printSeparator('-');
+
+    Extent water = collapseColumn(PARTICLE_FLUID);
+    Extent sand = collapseColumn(PARTICLE_GRANULAR);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  宽 2.2 米、高 3.3 米的粒子柱，8 秒后：" << std::endl;
+    std::cout << "    水  铺开 " << water.minX << " ~ " << water.maxX << " 米，最高 " << water.top << " 米，最大速度 " << water.maxSpeed << std::endl;
+    std::cout << "    沙  铺开 " << sand.minX << " ~ " << sand.maxX << " 米，最高 " << sand.top << " 米，最大速度 " << sand.maxSpeed << std::endl;
+
+    bool ok = sand.top > 2.0 * water.top && sand.maxX - sand.minX < 0.5 * (water.maxX - water.minX) && sand.maxSpeed < 0.5;
+    std::cout << (ok ? "✓ 沙堆成一堆，水铺开" : "✗ 水和沙的行为没有区别") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 4：斜坡
+ *=========================================================================================================*/
+struct SlopeResult {
+    size_t crossed;      // 圆心在斜坡线段下方的粒子
+    double meanX;        // 粒子的平均横坐标
+};
+
+SlopeResult pourOnSlope(ParticleMode mode) {
+    // 长 6 米、20° 的斜坡，中点在 (0, 2)；一块粒子落在斜坡上半段
+    const double angle = 20.0 * 3.14159265358979323846 / 180.0;
+    PhysicalWorld world;
+    world.setParticleMode(mode);
+    world.addStaticShape(world.allocateShape<Slope>(6.0, angle, 0.0, 2.0));
+    spawnBlock(world, 6, 6, 0.6, 2.0 + std::tan(angle) * 1.5 + 0.2, 0.11);
+    world.start();
+    run(world, 180);
+
+    SlopeResult result = { 0, 0.0 };
+    const ParticleSystem& ps = world.getParticleSystem();
+    for (size_t i = 0; i < ps.size(); i++) {
+        double x = ps.positionX()[i], y = ps.positionY()[i];
+        result.meanX += x / ps.size();
+        // 斜坡覆盖的 x 范围内，圆心应当在线段上方
+        if (std::fabs(x) < 3.0 * std::cos(angle) - radius && y < 2.0 + std::tan(angle) * x) result.crossed++;
+    }
+    return result;
+}
+
+bool testSlope() {
+    printSeparator();
+    std::cout << "测试 4：落在 20° 斜坡上的水和沙" << std::endl;
+    printSeparator('-');
+
+    SlopeResult water = pourOnSlope(PARTICLE_FLUID);
+    SlopeResult sand = pourOnSlope(PARTICLE_GRANULAR);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  3 秒后水的平均横坐标 " << water.meanX << " 米，沙 " << sand.meanX << " 米（落下时约 0.9 米）" << std::endl;
+    std::cout << "  穿过斜坡的粒子：水 " << water.crossed << " 个，沙 " << sand.crossed << " 个" << std::endl;
+
+    bool ok = water.crossed == 0 && sand.crossed == 0 && water.meanX < -1.0 && sand.meanX > 0.0;
+    std::cout << (ok ? "✓ 水流下斜坡，沙留在斜坡上，都没有穿过" : "✗ 斜坡边界不正确") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 5、6：多线程
+ *=========================================================================================================*/
+struct PoolResult {
+    double cpuMsPerFrame;
+    size_t live;
+    std::vector<float> x, y;
+};
+
+// 宽 20 米的箱子中 cols × rows 个粒子塌下
+PoolResult simulatePool(ParticleMode mode, int cols, int rows, int threads, int frames) {
+    PhysicalWorld world;
+    world.setWorkerThreads(threads);
+    world.setParticleMode(mode);
+    world.addStaticShape(world.allocateShape<Wall>(0.5, 30.0, -10.25, 15.0));
+    world.addStaticShape(world.allocateShape<Wall>(0.5, 30.0, 10.25, 15.0));
+    spawnBlock(world, cols, rows, -10.0, 0.0, 0.1);
+    world.start();
+
+    std::clock_t cpuStart = std::clock();
+    run(world, frames);
+    PoolResult result;
+    result.cpuMsPerFrame = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC / frames;
+    const ParticleSystem& ps = world.getParticleSystem();
+    result.live = ps.size();
+    result.x.assign(ps.positionX(), ps.positionX() + ps.size());
+    result.y.assign(ps.positionY(), ps.positionY() + ps.size());
+    return result;
+}
+
+bool testDeterminism() {
+    printSeparator();
+    std::cout << "测试 5：多线程结果与单线程相同" << std::endl;
+    printSeparator('-');
+
+    bool ok = true;
+    const ParticleMode modes[2] = { PARTICLE_FLUID, PARTICLE_GRANULAR };
+    const char* names[2] = { "水", "沙" };
+    for (int m = 0; m < 2; m++) {
+        PoolResult single = simulatePool(modes[m], 100, 100, 1, 60);
+        PoolResult multi = simulatePool(modes[m], 100, 100, 4, 60);
+        bool identical = single.x == multi.x && single.y == multi.y;
+        std::cout << "  " << names[m] << "：1 万个粒子 1 秒，4 线程结果" << (identical ? "逐位相同" : "不同") << std::endl;
+        ok = ok && identical && single.live == 10000;
+    }
+    std::cout << (ok ? "✓ 结果与线程数无关" : "✗ 结果与线程数有关") << std::endl;
+    return ok;
+}
+
+bool testThroughput() {
+    printSeparator();
+    std::cout << "测试 6：5000 个粒子的吞吐量" << std::endl;
+    printSeparator('-');
+
+    PoolResult water = simulatePool(PARTICLE_FLUID, 100, 50, 1, 60);
+    PoolResult sand = simulatePool(PARTICLE_GRANULAR, 100, 50, 1, 60);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  水每帧 " << water.cpuMsPerFrame << " ms，沙每帧 " << sand.cpuMsPerFrame
+              << " ms（单线程 CPU 时间，60 Hz 需要 < 16.67 ms）" << std::endl;
+
+    bool ok = water.live == 5000 && sand.live == 5000 && water.cpuMsPerFrame < 1000.0 / 60.0 && sand.cpuMsPerFrame < 1000.0 / 60.0;
+    std::cout << (ok ? "✓ 5000 个粒子以 60 Hz 运行" : "✗ 吞吐量不足") << std::endl;
+    return ok;
+}
+
+int main() {
+    std::cout << "粒子流体与颗粒测试" << std::endl;
+
+    int passed = 0, total = 0;
+    total++; if (testNeighbourSearch()) passed++;
+    total++; if (testDamBreak()) passed++;
+    total++; if (testWaterAndSand()) passed++;
+    total++; if (testSlope()) passed++;
+    total++; if (testDeterminism()) passed++;
+    total++; if (testThroughput()) passed++;
+
+    printSeparator();
+    std::cout << "结果：" << passed << " / " << total << " 通过" << std::endl;
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,298 @@
+/*=========================================================================================================
+ * 万有引力测试 - 验证 Barnes-Hut 四叉树与逐对求和的一致性、精度与规模，以及世界中的双星、太阳系轨道
+ *
+ * 测试场景：
+ * 1. θ = 0：Barnes-Hut 打开所有节点，与逐对求和只差舍入误差；多线程结果与单线程逐位相同
+ * 2. 精度：不同张角 θ 下的相对误差和每个物体的相互作用次数
+ * 3. 规模：1 000 到 100 000 个物体，Barnes-Hut 与逐对求和的耗时
+ * 4. 双星：两颗星绕共同质心转一周，间距不变并回到起点（两种求解方法逐位相同）
+ * 5. 太阳系：静止的太阳（静态圆）吸引行星做圆周运动
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "gravity.h"
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+// 盘状星系：半径按指数分布，质量在 [0.5, 1.5) 均匀分布
+void makeGalaxy(size_t n, std::vector<double>& position, std::vector<double>& mass) {
+    std::mt19937 rng(2024);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    position.resize(2 * n);
+    mass.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        double r = -100.0 * std::log(1.0 - 0.999 * uniform(rng));
+        double angle = 2.0 * M_PI * uniform(rng);
+        position[2 * i] = r * std::cos(angle);
+        position[2 * i + 1] = r * std::sin(angle);
+        mass[i] = 0.5 + uniform(rng);
+    }
+}
+
+// 加速度误差：返回 sqrt(Σ|Δa|² / Σ|a|²)，medianError 为各物体相对误差 |Δa| / |a| 的中位数，maxError 为最大值
+double relativeError(const std::vector<double>& a, const std::vector<double>& reference, double& medianError, double& maxError) {
+    double errorSum = 0.0, referenceSum = 0.0;
+    size_t n = reference.size() / 2;
+    std::vector<double> errors(n);
+    for (size_t i = 0; i < n; i++) {
+        double dx = a[2 * i] - reference[2 * i];
+        double dy = a[2 * i + 1] - reference[2 * i + 1];
+        double r2 = reference[2 * i] * reference[2 * i] + reference[2 * i + 1] * reference[2 * i + 1];
+        errorSum += dx * dx + dy * dy;
+        referenceSum += r2;
+        errors[i] = std::sqrt((dx * dx + dy * dy) / r2);
+    }
+    std::sort(errors.begin(), errors.end());
+    medianError = errors[n / 2];
+    maxError = errors[n - 1];
+    return std::sqrt(errorSum / referenceSum);
+}
+
+void solve(GravitySolver& solver, const std::vector<double>& position, const std::vector<double>& mass,
+           std::vector<double>& acceleration, ThreadPool* pool = nullptr) {
+    size_t n = mass.size();
+    acceleration.resize(2 * n);
+    solver.build(position.data(), mass.data(), n);
+    solver.evaluate(position.data(), n, acceleration.data(), pool);
+}
+
+// 测试1：θ = 0 与逐对求和一致
+bool test_theta_zero() {
+    printSeparator();
+    std::cout << "测试1：θ = 0 的 Barnes-Hut 与逐对求和（3000 个物体）" << std::endl;
+    printSeparator();
+
+    std::vector<double> position, mass, direct, tree, threaded;
+    makeGalaxy(3000, position, mass);
+
+    GravitySolver solver;
+    solver.setType(GRAVITY_SOLVER_DIRECT);
+    solve(solver, position, mass, direct);
+    size_t directInteractions = solver.getStats().interactions;
+
+    solver.setType(GRAVITY_SOLVER_BARNES_HUT);
+    solver.setOpeningAngle(0.0);
+    solve(solver, position, mass, tree);
+    double medianError, maxError;
+    relativeError(tree, direct, medianError, maxError);
+    std::cout << "  四叉树: " << solver.getStats().nodeCount << " 个节点, " << solver.getStats().leafCount
+              << " 个叶子, 深度 " << solver.getStats().treeDepth << std::endl;
+    std::cout << "  相互作用次数: 逐对 " << directInteractions << ", θ = 0 " << solver.getStats().interactions << std::endl;
+    std::cout << std::scientific << std::setprecision(2) << "  最大相对误差: " << maxError << std::endl;
+
+    ThreadPool pool;
+    pool.setThreadCount(4);
+    solver.setOpeningAngle(0.5);
+    solve(solver, position, mass, tree);
+    solve(solver, position, mass, threaded, &pool);
+    bool identical = (tree == threaded);
+    std::cout << "  θ = 0.5 时 4 个线程与单线程的结果: " << (identical ? "逐位相同" : "不同") << std::endl;
+
+    bool ok = maxError < 1e-12 && identical;
+    std::cout << "  结果: " << (ok ? "与逐对求和一致 ✓" : "结果不一致 ✗") << std::endl;
+    return ok;
+}
+
+// 测试2：精度与张角
+bool test_opening_angle() {
+    printSeparator();
+    std::cout << "测试2：不同张角 θ 下的精度（10000 个物体）" << std::endl;
+    printSeparator();
+
+    std::vector<double> position, mass, direct, tree;
+    makeGalaxy(10000, position, mass);
+    GravitySolver solver;
+    solver.setType(GRAVITY_SOLVER_DIRECT);
+    solve(solver, position, mass, direct);
+
+    solver.setType(GRAVITY_SOLVER_BARNES_HUT);
+    const double thetas[] = {0.3, 0.5, 0.7, 1.0};
+    double rmsAt[4], medianAt[4];
+    bool monotonic = true;
+    size_t lastInteractions = 0;
+    std::cout << "  θ      总体误差      中位数误差    最大误差      每个物体的相互作用" << std::endl;
+    for (int t = 0; t < 4; t++) {
+        solver.setOpeningAngle(thetas[t]);
+        solve(solver, position, mass, tree);
+        double maxError;
+        rmsAt[t] = relativeError(tree, direct, medianAt[t], maxError);
+        size_t interactions = solver.getStats().interactions;
+        std::cout << std::fixed << std::setprecision(1) << "  " << thetas[t] << std::scientific << std::setprecision(2)
+                  << "    " << rmsAt[t] << "      " << medianAt[t] << "      " << maxError << "      "
+                  << std::fixed << std::setprecision(1)
+                  << double(interactions) / mass.size() << std::endl;
+        if (t > 0 && (rmsAt[t] < rmsAt[t - 1] || interactions > lastInteractions)) monotonic = false;
+        lastInteractions = interactions;
+    }
+
+    // θ 越大越快、越不精确；默认 θ = 0.5 时总体误差在 0.1% 以内，一半的物体误差在 2% 以内
+    // （合力接近抵消的物体相对误差较大，最大误差只作参考）
+    bool ok = monotonic && rmsAt[1] < 1e-3 && medianAt[1] < 2e-2;
+    std::cout << "  结果: " << (ok ? "精度随 θ 单调变化，θ = 0.5 总体误差小于 0.1% ✓" : "精度不符合预期 ✗") << std::endl;
+    return ok;
+}
+
+// 测试3：规模
+bool test_scaling() {
+    printSeparator();
+    std::cout << "测试3：Barnes-Hut（θ = 0.5）与逐对求和的耗时" << std::endl;
+    printSeparator();
+
+    const size_t sizes[] = {1000, 10000, 100000};
+    double perBody[3];
+    double directMs10k = 0.0;
+    std::cout << "  物体数     Barnes-Hut(ms)  每个物体的相互作用  逐对求和(ms)" << std::endl;
+    for (int s = 0; s < 3; s++) {
+        std::vector<double> position, mass, acceleration;
+        makeGalaxy(sizes[s], position, mass);
+        GravitySolver solver;
+        auto start = std::chrono::high_resolution_clock::now();
+        solve(solver, position, mass, acceleration);
+        auto end = std::chrono::high_resolution_clock::now();
+        double treeMs = std::chrono::duration<double, std::milli>(end - start).count();
+        perBody[s] = double(solver.getStats().interactions) / sizes[s];
+
+        std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(11) << sizes[s]
+                  << std::setw(16) << treeMs << std::setw(20) << perBody[s];
+        if (sizes[s] <= 10000) {
+            solver.setType(GRAVITY_SOLVER_DIRECT);
+            start = std::chrono::high_resolution_clock::now();
+            solve(solver, position, mass, acceleration);
+            end = std::chrono::high_resolution_clock::now();
+            double directMs = std::chrono::duration<double, std::milli>(end - start).count();
+            if (sizes[s] == 10000) directMs10k = directMs;
+            std::cout << directMs << std::endl;
+        } else {
+            // n² 增长：按 10000 个物体的耗时估计
+            std::cout << "约 " << directMs10k * 100.0 << "（估计）" << std::endl;
+        }
+    }
+    std::cout << std::right;
+
+    // 每个物体的相互作用次数按 log n 增长，远小于逐对求和的 n
+    bool ok = perBody[2] < perBody[1] * 2.0 && perBody[2] < 0.01 * sizes[2];
+    std::cout << "  结果: " << (ok ? "每个物体的代价按 log n 增长 ✓" : "代价增长过快 ✗") << std::endl;
+    return ok;
+}
+
+// 双星在世界中运行一个周期，返回最大间距偏差（相对）和回到起点的距离
+void runBinary(GravitySolverType type, double& separationError, double& returnError, std::vector<double>& finalState) {
+    const double G = 5.0, m1 = 100.0, m2 = 50.0, r = 30.0;
+    const double v = std::sqrt(G * (m1 + m2) / r);
+    const double period = 2.0 * M_PI * r / v;
+
+    PhysicalWorld world;
+    world.setMutualGravity(true);
+    world.setGravitySolver(type);
+    world.setGravitationalConstant(G);
+    Shape* a = world.allocateShape<Circle>(m1, 3.0, -r * m2 / (m1 + m2), 500.0, 0.0, -v * m2 / (m1 + m2));
+    Shape* b = world.allocateShape<Circle>(m2, 2.0, r * m1 / (m1 + m2), 500.0, 0.0, v * m1 / (m1 + m2));
+    world.addDynamicShape(a);
+    world.addDynamicShape(b);
+    world.start();
+
+    double ax0, ay0;
+    a->getCentre(ax0, ay0);
+    const double dt = 1.0 / 600.0;
+    const int steps = static_cast<int>(std::round(period / dt));
+    separationError = 0.0;
+    for (int step = 0; step < steps; step++) {
+        world.update(world.dynamicShapeList, dt, world.ground);
+        double x1, y1, x2, y2;
+        a->getCentre(x1, y1);
+        b->getCentre(x2, y2);
+        separationError = std::max(separationError, std::fabs(std::hypot(x2 - x1, y2 - y1) - r) / r);
+    }
+    double ax, ay, bx, by, avx, avy;
+    a->getCentre(ax, ay);
+    b->getCentre(bx, by);
+    a->getVelocity(avx, avy);
+    returnError = std::hypot(ax - ax0, ay - ay0) / r;
+    finalState.assign({ax, ay, bx, by, avx, avy});
+}
+
+// 测试4：双星
+bool test_binary_orbit() {
+    printSeparator();
+    std::cout << "测试4：双星绕共同质心转一周（m = 100 和 50，间距 30 m，G = 5，dt = 1/600 s）" << std::endl;
+    printSeparator();
+
+    double sepTree, retTree, sepDirect, retDirect;
+    std::vector<double> tree, direct;
+    runBinary(GRAVITY_SOLVER_BARNES_HUT, sepTree, retTree, tree);
+    runBinary(GRAVITY_SOLVER_DIRECT, sepDirect, retDirect, direct);
+    std::cout << std::scientific << std::setprecision(2)
+              << "  Barnes-Hut: 最大间距偏差 " << sepTree << "，一周后偏离起点 " << retTree << "（相对间距）" << std::endl;
+    std::cout << "  逐对求和:   最大间距偏差 " << sepDirect << "，一周后偏离起点 " << retDirect << std::endl;
+    std::cout << "  两种方法的结果: " << (tree == direct ? "逐位相同" : "不同") << std::endl;
+
+    bool ok = sepTree < 0.01 && retTree < 0.02 && tree == direct;
+    std::cout << "  结果: " << (ok ? "双星保持圆轨道 ✓" : "轨道不闭合 ✗") << std::endl;
+    return ok;
+}
+
+// 测试5：太阳系
+bool test_solar_system() {
+    printSeparator();
+    std::cout << "测试5：静止的太阳（静态圆，M = 1000）与半径 20 m 的行星轨道" << std::endl;
+    printSeparator();
+
+    const double G = 5.0, M = 1000.0, r = 20.0;
+    const double v = std::sqrt(G * M / r);
+    PhysicalWorld world;
+    world.setMutualGravity(true);
+    world.setGravitationalConstant(G);
+    Shape* sun = world.allocateShape<Circle>(M, 5.0, 0.0, 500.0);
+    Shape* planet = world.allocateShape<Circle>(1.0, 1.0, r, 500.0, 0.0, v);
+    world.addStaticShape(sun);
+    world.addDynamicShape(planet);
+    world.start();
+
+    const double dt = 1.0 / 600.0;
+    const int steps = static_cast<int>(std::round(2.0 * M_PI * r / v / dt));
+    double radiusError = 0.0, minY = 500.0, maxY = 500.0;
+    for (int step = 0; step < steps; step++) {
+        world.update(world.dynamicShapeList, dt, world.ground);
+        double x, y;
+        planet->getCentre(x, y);
+        radiusError = std::max(radiusError, std::fabs(std::hypot(x, y - 500.0) - r) / r);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+    double sx, sy;
+    sun->getCentre(sx, sy);
+    std::cout << std::scientific << std::setprecision(2) << "  最大轨道半径偏差 " << radiusError << std::endl;
+    std::cout << std::fixed << std::setprecision(2) << "  行星 y 的范围 [" << minY << ", " << maxY
+              << "]，太阳位置 (" << sx << ", " << sy << ")" << std::endl;
+
+    bool ok = radiusError < 0.01 && maxY > 500.0 + 0.99 * r && minY < 500.0 - 0.99 * r && sx == 0.0 && sy == 500.0;
+    std::cout << "  结果: " << (ok ? "行星绕太阳做圆周运动 ✓" : "轨道不正确 ✗") << std::endl;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_theta_zero()) passed++;
+    total++; if (test_opening_angle()) passed++;
+    total++; if (test_scaling()) passed++;
+    total++; if (test_binary_orbit()) passed++;
+    total++; if (test_solar_system()) passed++;
+
+    printSeparator();
+    std::cout << "万有引力测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
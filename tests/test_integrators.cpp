@@ -0,0 +1,297 @@
+/*=========================================================================================================
+ * 积分器测试 - 比较四种积分方法的精度与开销
+ *
+ * 测试场景：
+ * 1. 抛体：各积分器在 timeStep = 1/60 s 和 1/10 s 下与解析轨迹的误差
+ * 2. 地面滑行：摩擦力使物体减速到停止，停止位置与 v²/(2μg) 比较
+ * 3. 收敛阶：简谐振动和圆轨道（加速度与位置有关）中步长减半时误差的缩小倍数
+ * 4. 精度与开销：每种积分器在不同步长下的误差和 CPU 时间，选出满足精度要求的最便宜的积分器
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include "physicalWorld.h"
+#include "shapes.h"
+#include "integrator.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+const IntegratorType kIntegrators[] = {
+    INTEGRATOR_SEMI_IMPLICIT_EULER, INTEGRATOR_VELOCITY_VERLET, INTEGRATOR_RK4, INTEGRATOR_LEAPFROG
+};
+
+// 抛体：在世界中飞行 duration 秒，返回与解析解的位置误差
+double projectileError(IntegratorType type, double dt, double duration) {
+    const double g = 10.0, x0 = 0.0, y0 = 200.0, vx0 = 15.0, vy0 = 20.0;
+    PhysicalWorld world(-1000.0, 1000.0, -1000.0, 1000.0);
+    world.setGravity(g);
+    world.setTimeStep(dt);
+    world.ground.setYLevel(-1000.0);
+    world.setIntegrator(type);
+    Circle* ball = world.allocateShape<Circle>(1.0, 0.5, x0, y0, vx0, vy0);
+    world.addDynamicShape(ball);
+    world.start();
+
+    int steps = static_cast<int>(duration / dt + 0.5);
+    for (int i = 0; i < steps; i++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    double t = steps * dt;
+    double x, y;
+    ball->getCentre(x, y);
+    double ex = x - (x0 + vx0 * t);
+    double ey = y - (y0 + vy0 * t - 0.5 * g * t * t);
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+// 测试1：抛体
+bool test_projectile() {
+    printSeparator();
+    std::cout << "测试1：抛体运动（v0 = (15, 20) m/s，g = 10 m/s²，飞行 3 s）" << std::endl;
+    printSeparator();
+
+    bool ok = true;
+    std::cout << std::left << std::setw(20) << "  积分器" << std::setw(18) << "dt = 1/60 s" << "dt = 1/10 s" << std::endl;
+    for (int k = 0; k < 4; k++) {
+        double fine = projectileError(kIntegrators[k], 1.0 / 60.0, 3.0);
+        double coarse = projectileError(kIntegrators[k], 0.1, 3.0);
+        std::cout << std::scientific << std::setprecision(3)
+                  << "  " << std::setw(18) << getIntegratorName(kIntegrators[k])
+                  << std::setw(18) << fine << coarse << " m" << std::endl;
+        if (kIntegrators[k] == INTEGRATOR_SEMI_IMPLICIT_EULER) {
+            // 半隐式欧拉的误差为 g·t·dt/2
+            ok = ok && std::abs(fine - 0.25) < 1e-6 && std::abs(coarse - 1.5) < 1e-6;
+        } else {
+            // 常加速度下是精确解，只剩舍入误差
+            ok = ok && fine < 1e-9 && coarse < 1e-9;
+        }
+    }
+    std::cout << std::fixed;
+    std::cout << "  结果: " << (ok ? "二阶及以上的积分器与解析轨迹一致 ✓" : "误差不符合预期 ✗") << std::endl;
+    return ok;
+}
+
+// 测试2：地面滑行
+bool test_ground_sliding() {
+    printSeparator();
+    std::cout << "测试2：地面滑行（v0 = 10 m/s，μ = 0.2，dt = 0.05 s）" << std::endl;
+    printSeparator();
+
+    const double g = 10.0, mu = 0.2, v0 = 10.0;
+    const double expected = v0 * v0 / (2.0 * mu * g);
+    bool ok = true;
+    for (int k = 0; k < 4; k++) {
+        PhysicalWorld world(-1000.0, 1000.0, -10.0, 1000.0);
+        world.setGravity(g);
+        world.setTimeStep(0.05);
+        world.ground.setYLevel(0.0);
+        world.ground.setFriction(mu, 0.3);
+        world.setIntegrator(kIntegrators[k]);
+        AABB* block = world.allocateShape<AABB>(1.0, 1.0, 1.0, 0.0, 0.5, v0, 0.0);
+        world.addDynamicShape(block);
+        world.start();
+        for (int i = 0; i < 120; i++) {
+            world.update(world.dynamicShapeList, world.ground);
+        }
+        double x, y, vx, vy;
+        block->getCentre(x, y);
+        block->getVelocity(vx, vy);
+        double error = std::abs(x - expected);
+        std::cout << std::fixed << std::setprecision(4) << "  " << std::left << std::setw(18)
+                  << getIntegratorName(kIntegrators[k]) << "停在 x = " << x << " m（误差 " << error
+                  << " m），vx = " << vx << std::endl;
+        // 停止后速度为 0，不会因为摩擦力反向运动；
+        // 半隐式欧拉在最后一步停在原地（误差不超过一步的位移），其他积分器停在常加速度下的精确位置
+        ok = ok && vx == 0.0 && y == 0.5 && error <= v0 * 0.05 && (k == 0 || error < 1e-9);
+    }
+    std::cout << "  解析解: " << expected << " m" << std::endl;
+    std::cout << "  结果: " << (ok ? "摩擦力截断速度的处理对所有积分器有效 ✓" : "停止位置错误 ✗") << std::endl;
+    return ok;
+}
+
+// 与位置有关的力场
+struct SpringField {           // 简谐振动 a = -x（ω = 1）
+    void operator()(const double* p, const double*, double* a) const {
+        a[0] = -p[0];
+        a[1] = -p[1];
+    }
+};
+
+struct OrbitField {            // 圆轨道 a = -r / |r|³（GM = 1）
+    void operator()(const double* p, const double*, double* a) const {
+        double r2 = p[0] * p[0] + p[1] * p[1];
+        double inv = 1.0 / (r2 * std::sqrt(r2));
+        a[0] = -p[0] * inv;
+        a[1] = -p[1] * inv;
+    }
+};
+
+// 积分到 duration，返回整个过程中与解析解的最大位置误差（两个力场的解析解都是单位圆上的匀速圆周运动）
+template <IntegratorType Type, class Field>
+double circularError(double dt, double duration) {
+    double p[2] = {1.0, 0.0};
+    double v[2] = {0.0, 1.0};
+    int steps = static_cast<int>(duration / dt + 0.5);
+    double maxError = 0.0;
+    for (int i = 1; i <= steps; i++) {
+        Integrator<Type>::step(p, v, Field(), dt);
+        double t = i * dt;
+        double ex = p[0] - std::cos(t);
+        double ey = p[1] - std::sin(t);
+        maxError = std::max(maxError, std::sqrt(ex * ex + ey * ey));
+    }
+    return maxError;
+}
+
+template <class Field>
+double errorFor(IntegratorType type, double dt, double duration) {
+    switch (type) {
+        case INTEGRATOR_VELOCITY_VERLET: return circularError<INTEGRATOR_VELOCITY_VERLET, Field>(dt, duration);
+        case INTEGRATOR_RK4:             return circularError<INTEGRATOR_RK4, Field>(dt, duration);
+        case INTEGRATOR_LEAPFROG:        return circularError<INTEGRATOR_LEAPFROG, Field>(dt, duration);
+        default:                         return circularError<INTEGRATOR_SEMI_IMPLICIT_EULER, Field>(dt, duration);
+    }
+}
+
+// 测试3：收敛阶
+bool test_convergence_order() {
+    printSeparator();
+    std::cout << "测试3：步长减半时误差的缩小倍数（积分 10 s）" << std::endl;
+    printSeparator();
+
+    const double expectedRatio[] = {2.0, 4.0, 16.0, 4.0};
+    bool ok = true;
+    for (int k = 0; k < 4; k++) {
+        double spring1 = errorFor<SpringField>(kIntegrators[k], 0.02, 10.0);
+        double spring2 = errorFor<SpringField>(kIntegrators[k], 0.01, 10.0);
+        double orbit1 = errorFor<OrbitField>(kIntegrators[k], 0.02, 10.0);
+        double orbit2 = errorFor<OrbitField>(kIntegrators[k], 0.01, 10.0);
+        double springRatio = spring1 / spring2;
+        double orbitRatio = orbit1 / orbit2;
+        std::cout << std::fixed << std::setprecision(2) << "  " << std::left << std::setw(18)
+                  << getIntegratorName(kIntegrators[k]) << "简谐振动 " << std::setw(8) << springRatio
+                  << "圆轨道 " << std::setw(8) << orbitRatio << "（理论 " << expectedRatio[k] << "）" << std::endl;
+        ok = ok && springRatio > 0.85 * expectedRatio[k] && orbitRatio > 0.85 * expectedRatio[k];
+    }
+    std::cout << "  结果: " << (ok ? "收敛阶与理论一致 ✓" : "收敛阶不符 ✗") << std::endl;
+    return ok;
+}
+
+// 圆轨道：count 个质点各积分 duration 秒的 CPU 时间（微秒），同时返回误差
+template <IntegratorType Type>
+double timeOrbit(double dt, double duration, int count, double& error) {
+    std::vector<double> p(2 * count), v(2 * count);
+    for (int i = 0; i < count; i++) {
+        p[2 * i] = 1.0; p[2 * i + 1] = 0.0;
+        v[2 * i] = 0.0; v[2 * i + 1] = 1.0;
+    }
+    int steps = static_cast<int>(duration / dt + 0.5);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int s = 0; s < steps; s++) {
+        for (int i = 0; i < count; i++) {
+            Integrator<Type>::step(&p[2 * i], &v[2 * i], OrbitField(), dt);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double t = steps * dt;
+    double ex = p[0] - std::cos(t), ey = p[1] - std::sin(t);
+    error = std::sqrt(ex * ex + ey * ey);
+    return std::chrono::duration<double, std::micro>(end - start).count() / count;
+}
+
+double timeOrbitFor(IntegratorType type, double dt, double duration, int count, double& error) {
+    switch (type) {
+        case INTEGRATOR_VELOCITY_VERLET: return timeOrbit<INTEGRATOR_VELOCITY_VERLET>(dt, duration, count, error);
+        case INTEGRATOR_RK4:             return timeOrbit<INTEGRATOR_RK4>(dt, duration, count, error);
+        case INTEGRATOR_LEAPFROG:        return timeOrbit<INTEGRATOR_LEAPFROG>(dt, duration, count, error);
+        default:                         return timeOrbit<INTEGRATOR_SEMI_IMPLICIT_EULER>(dt, duration, count, error);
+    }
+}
+
+// 测试4：精度与开销
+bool test_accuracy_vs_cost() {
+    printSeparator();
+    std::cout << "测试4：圆轨道一周（2π s）的终点误差与每个质点的 CPU 时间" << std::endl;
+    printSeparator();
+
+    const double duration = 2.0 * 3.14159265358979323846;
+    const double tolerance = 1e-4;
+    const double steps[] = {0.1, 0.05, 0.02, 0.01, 0.005, 0.002, 0.001};
+    const int count = 200;
+
+    std::cout << std::left << "  " << std::setw(18) << "积分器" << std::setw(10) << "dt"
+              << std::setw(14) << "误差" << std::setw(14) << "CPU(μs)" << "误差·μs" << std::endl;
+    bool ok = true;
+    IntegratorType best = INTEGRATOR_SEMI_IMPLICIT_EULER;
+    double bestCost = -1.0, bestDt = 0.0;
+    for (int k = 0; k < 4; k++) {
+        double cheapest = -1.0;
+        for (int s = 0; s < 7; s++) {
+            double error;
+            double micros = timeOrbitFor(kIntegrators[k], steps[s], duration, count, error);
+            std::cout << "  " << std::setw(18) << getIntegratorName(kIntegrators[k])
+                      << std::fixed << std::setprecision(3) << std::setw(10) << steps[s]
+                      << std::scientific << std::setprecision(2) << std::setw(14) << error
+                      << std::fixed << std::setprecision(2) << std::setw(14) << micros
+                      << std::scientific << std::setprecision(2) << error * micros << std::endl;
+            // 满足精度要求的最大步长
+            if (error < tolerance && cheapest < 0.0) {
+                cheapest = micros;
+                if (bestCost < 0.0 || micros < bestCost) {
+                    best = kIntegrators[k];
+                    bestCost = micros;
+                    bestDt = steps[s];
+                }
+            }
+            ok = ok && std::isfinite(error);
+        }
+    }
+
+    // 世界中一步的开销（1000 个在空中的球）
+    std::cout << std::fixed << std::setprecision(2);
+    for (int k = 0; k < 4; k++) {
+        PhysicalWorld world(-100000.0, 100000.0, -100000.0, 100000.0);
+        world.setSleepingEnabled(false);
+        world.ground.setYLevel(-100000.0);
+        world.setIntegrator(kIntegrators[k]);
+        for (int i = 0; i < 1000; i++) {
+            Circle* ball = world.allocateShape<Circle>(1.0, 0.5, i * 10.0, 500.0, 15.0, 0.0);
+            world.addDynamicShape(ball);
+        }
+        world.start();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int step = 0; step < 100; step++) {
+            world.update(world.dynamicShapeList, world.ground);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "  世界中 1000 个球一步（" << getIntegratorName(kIntegrators[k]) << "）: "
+                  << std::chrono::duration<double, std::micro>(end - start).count() / 100 << " μs" << std::endl;
+    }
+
+    ok = ok && bestCost >= 0.0;
+    std::cout << "  误差 < " << std::scientific << std::setprecision(0) << tolerance << std::fixed
+              << " 时最便宜的积分器: " << getIntegratorName(best) << "（dt = " << std::setprecision(3) << bestDt << "）" << std::endl;
+    std::cout << "  结果: " << (ok ? "完成精度与开销的比较 ✓" : "比较失败 ✗") << std::endl;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_projectile()) passed++;
+    total++; if (test_ground_sliding()) passed++;
+    total++; if (test_convergence_order()) passed++;
+    total++; if (test_accuracy_vs_cost()) passed++;
+
+    printSeparator();
+    std::cout << "积分器测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+/*=========================================================================================================
+ * 接触岛测试 - 验证按岛划分与多线程求解
+ *
+ * 测试场景：
+ * 1. 岛的划分：几摞方块和几个孤立的圆，岛的数量和最大的岛的大小
+ * 2. 逐位相同：数百个岛（方块堆、相撞的圆、高速圆撞墙）在 1 / 2 / 4 / 8 个线程下的结果完全相同
+ * 3. 冲量求解：使用 CONTACT_SOLVER_IMPULSE 时结果同样与线程数量无关，每步的接触统计和缓存中的冲量一致
+ * 4. 性能：数百个岛的场景下不同线程数量的单步耗时，4 个线程至少快 1.5 倍（硬件线程少于 4 个时跳过）
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+// 测试场景：clusters 组，每组为一摞 3 个方块、一对相向运动的圆、一个飞向墙壁的高速圆
+void buildClusterScene(PhysicalWorld& world, std::vector<Shape*>& shapes, int clusters) {
+    world.setGravity(10.0);
+    world.setBounds(-100000.0, 100000.0, -1000.0, 1000.0);
+    world.ground.setYLevel(0.0);
+    world.ground.setFriction(0.3, 0.4);
+    world.setSleepingEnabled(false);
+
+    for (int c = 0; c < clusters; c++) {
+        double baseX = c * 40.0;
+        for (int level = 0; level < 3; level++) {
+            AABB* block = new AABB(1.0, 2.0, 1.0, baseX + 0.1 * level, 0.5 + level * 1.05);
+            block->setFraction(0.3);
+            block->setStaticFraction(0.4);
+            shapes.push_back(block);
+            world.addDynamicShape(block);
+        }
+
+        Circle* left = new Circle(1.0, 0.5, baseX + 8.0, 3.0, 4.0, 0.0);
+        Circle* right = new Circle(2.0, 0.5, baseX + 12.0, 3.5, -3.0, 0.0);
+        shapes.push_back(left);
+        shapes.push_back(right);
+        world.addDynamicShape(left);
+        world.addDynamicShape(right);
+
+        Circle* bullet = new Circle(1.0, 0.3, baseX + 20.0, 5.0, 80.0, 0.0);
+        shapes.push_back(bullet);
+        world.addDynamicShape(bullet);
+        world.placeWall("Wall" + std::to_string(c), baseX + 30.0, 5.0, 0.2, 10.0);
+    }
+}
+
+// contactLog 记录每步的接触统计，以及最后仍然存在的接触的累积冲量
+std::vector<double> runClusterScene(int threads, ContactSolverType solver, int clusters, int steps,
+                                    size_t& islands, std::vector<double>* contactLog = nullptr) {
+    PhysicalWorld world;
+    world.setWorkerThreads(threads);
+    world.setContactSolver(solver);
+    std::vector<Shape*> shapes;
+    buildClusterScene(world, shapes, clusters);
+
+    for (int step = 0; step < steps; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        // 每组的高速圆（第 6 个物体）与本组的墙壁
+        for (size_t c = 0; c < world.staticShapeList.size(); c++) {
+            world.handleWallCollision(*shapes[6 * c + 5], *static_cast<Wall*>(world.staticShapeList[c]));
+        }
+        if (contactLog != nullptr) {
+            const ContactStats& stats = world.getContactStats();
+            contactLog->push_back(static_cast<double>(stats.contactCount));
+            contactLog->push_back(static_cast<double>(stats.newContacts));
+            contactLog->push_back(static_cast<double>(stats.velocityIterations));
+        }
+    }
+    islands = world.getIslandCount();
+
+    std::vector<double> state;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double x, y, vx, vy;
+        shapes[i]->getCentre(x, y);
+        shapes[i]->getVelocity(vx, vy);
+        state.push_back(x);
+        state.push_back(y);
+        state.push_back(vx);
+        state.push_back(vy);
+    }
+    if (contactLog != nullptr) {
+        for (size_t i = 0; i < shapes.size(); i++) {
+            for (size_t j = i + 1; j < shapes.size() && j < i + 6; j++) {
+                const ContactManifold* contact = world.findContact(shapes[i], shapes[j]);
+                if (contact != nullptr) {
+                    contactLog->push_back(contact->normalImpulse);
+                    contactLog->push_back(contact->tangentImpulse);
+                    contactLog->push_back(contact->age);
+                }
+            }
+        }
+    }
+
+    deleteShapes(shapes);
+    return state;
+}
+
+// 测试1：岛的划分
+bool test_island_partition() {
+    printSeparator();
+    std::cout << "测试1：三摞方块和两个孤立的圆" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.ground.setYLevel(0.0);
+    world.setSleepingEnabled(false);
+    std::vector<Shape*> shapes;
+    const int heights[3] = {2, 4, 3};
+    for (int column = 0; column < 3; column++) {
+        for (int level = 0; level < heights[column]; level++) {
+            AABB* block = new AABB(1.0, 2.0, 1.0, column * 10.0, 0.5 + level * 1.0);
+            shapes.push_back(block);
+            world.addDynamicShape(block);
+        }
+    }
+    for (int k = 0; k < 2; k++) {
+        Circle* circle = new Circle(1.0, 0.5, 50.0 + k * 10.0, 20.0);
+        shapes.push_back(circle);
+        world.addDynamicShape(circle);
+    }
+
+    world.update(world.dynamicShapeList, world.ground);
+    std::cout << "  岛的数量: " << world.getIslandCount() << "（期望 5），最大的岛: "
+              << world.getLargestIslandSize() << " 个物体（期望 4）" << std::endl;
+
+    bool ok = world.getIslandCount() == 5 && world.getLargestIslandSize() == 4;
+    std::cout << "  结果: " << (ok ? "岛划分正确 ✓" : "岛划分错误 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试2：逐位相同
+bool test_bit_identical(ContactSolverType solver, const char* title) {
+    printSeparator();
+    std::cout << title << std::endl;
+    printSeparator();
+
+    const int threadCounts[4] = {1, 2, 4, 8};
+    size_t islands = 0;
+    std::vector<double> log1;
+    std::vector<double> reference = runClusterScene(1, solver, 100, 240, islands, &log1);
+    std::cout << "  100 组物体，240 步，最后一步的岛数量: " << islands << std::endl;
+
+    bool ok = islands > 100;
+    for (int k = 1; k < 4; k++) {
+        size_t count = 0;
+        std::vector<double> log;
+        std::vector<double> state = runClusterScene(threadCounts[k], solver, 100, 240, count, &log);
+        bool same = state == reference && log == log1 && count == islands;
+        std::cout << "  " << threadCounts[k] << " 个线程: " << (same ? "与单线程逐位相同 ✓" : "结果不同 ✗") << std::endl;
+        ok = ok && same;
+    }
+    if (solver == CONTACT_SOLVER_IMPULSE) {
+        double contacts = 0.0;
+        for (int step = 0; step < 240; step++) contacts += log1[3 * step];
+        std::cout << "  240 步中求解的接触总数: " << contacts << std::endl;
+        ok = ok && contacts > 0.0;
+    }
+    return ok;
+}
+
+// 测试4：性能
+enum TestResult { TEST_FAILED, TEST_PASSED, TEST_SKIPPED };
+
+TestResult test_throughput() {
+    printSeparator();
+    std::cout << "测试4：400 组物体（数百个岛）的单步耗时" << std::endl;
+    printSeparator();
+
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    std::cout << "  硬件线程数量: " << hardwareThreads << std::endl;
+    if (hardwareThreads < 4) {
+        std::cout << "  跳过: 硬件线程少于 4 个，无法测量多线程加速比" << std::endl;
+        return TEST_SKIPPED;
+    }
+
+    const int threadCounts[3] = {1, 2, 4};
+    double baseline = 0.0;
+    double speedup = 0.0;
+    std::cout << std::fixed << std::setprecision(3);
+    for (int k = 0; k < 3; k++) {
+        PhysicalWorld world;
+        world.setWorkerThreads(threadCounts[k]);
+        std::vector<Shape*> shapes;
+        buildClusterScene(world, shapes, 400);
+        for (int step = 0; step < 10; step++) {
+            world.update(world.dynamicShapeList, world.ground);
+        }
+
+        const int steps = 60;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int step = 0; step < steps; step++) {
+            world.update(world.dynamicShapeList, world.ground);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double perStep = std::chrono::duration<double, std::milli>(end - start).count() / steps;
+        if (k == 0) baseline = perStep;
+        speedup = baseline / perStep;
+        std::cout << "  " << threadCounts[k] << " 个线程: " << perStep << " ms/步，加速比 "
+                  << std::setprecision(2) << speedup << "x" << std::setprecision(3)
+                  << "（岛数量 " << world.getIslandCount() << "）" << std::endl;
+
+        deleteShapes(shapes);
+    }
+    bool ok = speedup >= 1.5;
+    std::cout << "  结果: " << (ok ? "4 个线程加速比不低于 1.5x ✓" : "多线程没有加速 ✗") << std::endl;
+    return ok ? TEST_PASSED : TEST_FAILED;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+    int skipped = 0;
+
+    total++; if (test_island_partition()) passed++;
+    total++; if (test_bit_identical(CONTACT_SOLVER_DIRECT, "测试2：不同线程数量下结果逐位相同（默认碰撞响应）")) passed++;
+    total++; if (test_bit_identical(CONTACT_SOLVER_IMPULSE, "测试3：不同线程数量下结果逐位相同（冲量求解）")) passed++;
+    TestResult throughput = test_throughput();
+    if (throughput == TEST_SKIPPED) {
+        skipped++;
+    } else {
+        total++; if (throughput == TEST_PASSED) passed++;
+    }
+
+    printSeparator();
+    std::cout << "接触岛测试完成: " << passed << "/" << total << " 通过";
+    if (skipped > 0) std::cout << "，跳过 " << skipped << " 个";
+    std::cout << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,319 @@
+/*=========================================================================================================
+ * 批量窄相位测试 - 验证 SIMD 批量检测与逐对 check_collision 的结果相同
+ *
+ * 测试场景：
+ * 1. 判定一致：随机的圆-圆、圆-矩形、矩形-矩形物体对（含恰好相切），每种指令集的接触与 check_collision 相同
+ * 2. 接触记录：法向（由 first 指向 second）和穿透深度，各指令集逐位相同
+ * 3. 整步模拟：圆和方块混合的场景，标量与 SIMD 模拟 300 步后逐位相同
+ * 4. 性能：20 万个候选对，批量检测与逐对 check_collision 的耗时
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "narrowphase.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+// 线性同余随机数（结果与平台无关）
+struct Random {
+    unsigned long long state;
+    explicit Random(unsigned long long seed) : state(seed) {}
+    double next(double lo, double hi) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return lo + (hi - lo) * static_cast<double>(state >> 11) / 9007199254740992.0;
+    }
+};
+
+// 可用的指令集：标量，以及 CPU 支持的 SSE2 / AVX2
+std::vector<NarrowphaseISA> availableISAs() {
+    std::vector<NarrowphaseISA> isas;
+    for (int isa = NARROWPHASE_SCALAR; isa <= detectNarrowphaseISA(); isa++) {
+        isas.push_back(static_cast<NarrowphaseISA>(isa));
+    }
+    return isas;
+}
+
+bool sameContacts(const std::vector<NarrowphaseContact>& a, const std::vector<NarrowphaseContact>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; k < a.size(); k++) {
+        if (a[k].pair != b[k].pair || std::memcmp(&a[k].nx, &b[k].nx, sizeof(double)) != 0
+            || std::memcmp(&a[k].ny, &b[k].ny, sizeof(double)) != 0
+            || std::memcmp(&a[k].depth, &b[k].depth, sizeof(double)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 随机形状：圆和方块交替，位置集中在小范围内，大约一半的物体对接触
+void buildRandomShapes(std::vector<Shape*>& shapes, std::vector<CandidatePair>& pairs, int count, int pairCount, Random& random) {
+    for (int i = 0; i < count; i++) {
+        double x = random.next(0.0, 20.0), y = random.next(0.0, 20.0);
+        if (i % 3 == 2) {
+            shapes.push_back(new AABB(1.0, random.next(0.5, 4.0), random.next(0.5, 4.0), x, y));
+        } else {
+            shapes.push_back(new Circle(1.0, random.next(0.2, 3.0), x, y));
+        }
+    }
+    for (int k = 0; k < pairCount; k++) {
+        int i = static_cast<int>(random.next(0.0, count - 1.0));
+        int j = static_cast<int>(random.next(0.0, count - 1.0));
+        if (i == j) continue;
+        pairs.push_back(CandidatePair(std::min(i, j), std::max(i, j)));
+    }
+}
+
+// 测试1：判定一致
+bool test_matches_check_collision() {
+    printSeparator();
+    std::cout << "测试1：批量检测与 check_collision 判定相同（CPU 支持: "
+              << getNarrowphaseISAName(detectNarrowphaseISA()) << "）" << std::endl;
+    printSeparator();
+
+    std::vector<Shape*> shapes;
+    std::vector<CandidatePair> pairs;
+    Random random(2024);
+    buildRandomShapes(shapes, pairs, 300, 20000, random);
+
+    // 恰好相切：圆-圆（3-4-5 三角形）、圆-矩形（贴着右边）、圆-矩形（贴着角）
+    size_t base = shapes.size();
+    shapes.push_back(new Circle(1.0, 2.0, 0.0, 0.0));
+    shapes.push_back(new Circle(1.0, 3.0, 3.0, 4.0));
+    shapes.push_back(new AABB(1.0, 2.0, 2.0, 100.0, 0.0));
+    shapes.push_back(new Circle(1.0, 0.5, 101.5, 0.0));
+    shapes.push_back(new Circle(1.0, 5.0, 104.0, 5.0));
+    pairs.push_back(CandidatePair(static_cast<int>(base), static_cast<int>(base + 1)));
+    pairs.push_back(CandidatePair(static_cast<int>(base + 2), static_cast<int>(base + 3)));
+    pairs.push_back(CandidatePair(static_cast<int>(base + 2), static_cast<int>(base + 4)));
+
+    std::vector<int> expected;
+    for (size_t k = 0; k < pairs.size(); k++) {
+        if (shapes[pairs[k].first]->check_collision(*shapes[pairs[k].second])) expected.push_back(static_cast<int>(k));
+    }
+
+    bool ok = true;
+    std::vector<NarrowphaseISA> isas = availableISAs();
+    for (size_t s = 0; s < isas.size(); s++) {
+        BatchNarrowphase narrowphase;
+        narrowphase.setISA(isas[s]);
+        std::vector<NarrowphaseContact> contacts;
+        narrowphase.collide(shapes, pairs.data(), pairs.size(), contacts);
+
+        bool same = contacts.size() == expected.size();
+        for (size_t k = 0; same && k < contacts.size(); k++) {
+            same = contacts[k].pair == expected[k];
+        }
+        bool tangent = contacts.size() >= 3 && contacts[contacts.size() - 3].pair == static_cast<int>(pairs.size() - 3)
+                       && contacts.back().pair == static_cast<int>(pairs.size() - 1);
+        std::cout << "  " << std::setw(6) << getNarrowphaseISAName(narrowphase.getISA()) << ": " << contacts.size()
+                  << " 个接触（批量 " << narrowphase.getBatchedPairCount() << " 对，逐对 " << narrowphase.getScalarPairCount()
+                  << " 对），相切算作接触: " << (tangent ? "是" : "否") << std::endl;
+        ok = ok && same && tangent;
+    }
+    std::cout << "  check_collision: " << expected.size() << " 个接触" << std::endl;
+    std::cout << "  结果: " << (ok ? "所有指令集与 check_collision 相同 ✓" : "判定不同 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试2：接触记录
+bool test_contact_records() {
+    printSeparator();
+    std::cout << "测试2：法向和穿透深度" << std::endl;
+    printSeparator();
+
+    std::vector<Shape*> shapes;
+    shapes.push_back(new Circle(1.0, 1.0, 0.0, 0.0));      // 0
+    shapes.push_back(new Circle(1.0, 1.0, 1.5, 0.0));      // 1：与 0 重叠 0.5
+    shapes.push_back(new AABB(1.0, 4.0, 2.0, 0.0, 10.0));  // 2：矩形 [-2, 2] × [9, 11]
+    shapes.push_back(new Circle(1.0, 1.0, 0.0, 11.5));     // 3：在矩形上方，重叠 0.5
+    shapes.push_back(new Circle(1.0, 0.5, 1.8, 10.0));     // 4：圆心在矩形内，离右边 0.2
+    std::vector<CandidatePair> pairs;
+    pairs.push_back(CandidatePair(0, 1));
+    pairs.push_back(CandidatePair(2, 3));
+    pairs.push_back(CandidatePair(2, 4));
+
+    std::vector<NarrowphaseContact> reference;
+    bool ok = true;
+    std::vector<NarrowphaseISA> isas = availableISAs();
+    for (size_t s = 0; s < isas.size(); s++) {
+        BatchNarrowphase narrowphase;
+        narrowphase.setISA(isas[s]);
+        std::vector<NarrowphaseContact> contacts;
+        narrowphase.collide(shapes, pairs.data(), pairs.size(), contacts);
+        if (s == 0) {
+            reference = contacts;
+        } else {
+            ok = ok && sameContacts(contacts, reference);
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (size_t k = 0; k < reference.size(); k++) {
+        std::cout << "  候选对 " << reference[k].pair << ": 法向 (" << reference[k].nx << ", " << reference[k].ny
+                  << ")，深度 " << reference[k].depth << std::endl;
+    }
+    ok = ok && reference.size() == 3
+         && reference[0].nx == 1.0 && reference[0].ny == 0.0 && std::abs(reference[0].depth - 0.5) < 1e-12
+         && reference[1].nx == 0.0 && reference[1].ny == 1.0 && std::abs(reference[1].depth - 0.5) < 1e-12
+         && reference[2].nx == 1.0 && reference[2].ny == 0.0 && std::abs(reference[2].depth - 0.7) < 1e-12;
+    std::cout << "  结果: " << (ok ? "法向和深度正确，各指令集逐位相同 ✓" : "接触记录错误 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试3：整步模拟
+std::vector<double> runMixedScene(NarrowphaseISA isa, ContactSolverType solver) {
+    PhysicalWorld world;
+    world.setNarrowphaseISA(isa);
+    world.setContactSolver(solver);
+    world.setGravity(10.0);
+    world.setSleepingEnabled(false);
+    world.ground.setYLevel(0.0);
+    world.ground.setFriction(0.3, 0.4);
+
+    std::vector<Shape*> shapes;
+    Random random(31);
+    for (int i = 0; i < 400; i++) {
+        double x = (i % 40) * 1.5 + random.next(-0.2, 0.2);
+        double y = 1.0 + (i / 40) * 1.6 + random.next(0.0, 0.3);
+        Shape* shape;
+        if (i % 4 == 3) {
+            shape = new AABB(1.0, 1.0, 1.0, x, y, random.next(-2.0, 2.0), 0.0);
+        } else {
+            shape = new Circle(1.0, 0.6, x, y, random.next(-2.0, 2.0), random.next(-2.0, 2.0));
+        }
+        shapes.push_back(shape);
+        world.addDynamicShape(shape);
+    }
+    for (int step = 0; step < 300; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+
+    std::vector<double> state;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double x, y, vx, vy;
+        shapes[i]->getCentre(x, y);
+        shapes[i]->getVelocity(vx, vy);
+        state.push_back(x);
+        state.push_back(y);
+        state.push_back(vx);
+        state.push_back(vy);
+    }
+    deleteShapes(shapes);
+    return state;
+}
+
+bool test_world_identical() {
+    printSeparator();
+    std::cout << "测试3：400 个圆和方块模拟 300 步，标量与 SIMD 逐位相同" << std::endl;
+    printSeparator();
+
+    bool ok = true;
+    const ContactSolverType solvers[2] = {CONTACT_SOLVER_DIRECT, CONTACT_SOLVER_IMPULSE};
+    const char* names[2] = {"默认碰撞响应", "冲量求解"};
+    std::vector<NarrowphaseISA> isas = availableISAs();
+    for (int s = 0; s < 2; s++) {
+        std::vector<double> reference = runMixedScene(NARROWPHASE_SCALAR, solvers[s]);
+        for (size_t k = 1; k < isas.size(); k++) {
+            bool same = runMixedScene(isas[k], solvers[s]) == reference;
+            std::cout << "  " << names[s] << "，" << getNarrowphaseISAName(isas[k]) << ": "
+                      << (same ? "与标量逐位相同" : "结果不同") << std::endl;
+            ok = ok && same;
+        }
+    }
+    std::cout << "  结果: " << (ok ? "结果与指令集无关 ✓" : "结果不同 ✗") << std::endl;
+    return ok;
+}
+
+// 测试4：性能
+bool test_performance() {
+    printSeparator();
+    std::cout << "测试4：20 万个候选对（圆-圆、圆-矩形为主）" << std::endl;
+    printSeparator();
+
+    std::vector<Shape*> shapes;
+    std::vector<CandidatePair> pairs;
+    Random random(7);
+    buildRandomShapes(shapes, pairs, 5000, 200000, random);
+    for (size_t i = 0; i < shapes.size(); i++) {
+        // 放大范围：大部分候选对并不接触（与宽相位输出的情况相同）
+        double x, y;
+        shapes[i]->getCentre(x, y);
+        shapes[i]->setCentre(x * 3.0, y * 3.0);
+    }
+    std::sort(pairs.begin(), pairs.end());  // 宽相位输出的候选对按下标排序
+
+    const int repeats = 20;
+    size_t scalarTouching = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (size_t k = 0; k < pairs.size(); k++) {
+            if (shapes[pairs[k].first]->check_collision(*shapes[pairs[k].second])) scalarTouching++;
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double perPairMs = std::chrono::duration<double, std::milli>(end - start).count() / repeats;
+    scalarTouching /= repeats;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  逐对 check_collision: " << perPairMs << " ms（" << scalarTouching << " 个接触）" << std::endl;
+
+    bool ok = true;
+    double best = perPairMs;
+    std::vector<NarrowphaseISA> isas = availableISAs();
+    std::vector<NarrowphaseContact> contacts;
+    for (size_t s = 0; s < isas.size(); s++) {
+        BatchNarrowphase narrowphase;
+        narrowphase.setISA(isas[s]);
+        narrowphase.collide(shapes, pairs.data(), pairs.size(), contacts);  // 预热，分配数组
+        start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < repeats; r++) {
+            narrowphase.collide(shapes, pairs.data(), pairs.size(), contacts);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count() / repeats;
+        std::cout << "  批量 " << std::setw(6) << getNarrowphaseISAName(isas[s]) << ": " << ms << " ms（" << contacts.size()
+                  << " 个接触，加速比 " << std::setprecision(2) << perPairMs / ms << "x）" << std::setprecision(3) << std::endl;
+        ok = ok && contacts.size() == scalarTouching;
+        best = std::min(best, ms);
+    }
+
+    std::cout << "  结果: " << (ok ? "接触数量相同 ✓" : "接触数量不同 ✗") << std::endl;
+    deleteShapes(shapes);
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_matches_check_collision()) passed++;
+    total++; if (test_contact_records()) passed++;
+    total++; if (test_world_identical()) passed++;
+    total++; if (test_performance()) passed++;
+
+    printSeparator();
+    std::cout << "批量窄相位测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
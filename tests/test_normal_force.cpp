@@ -0,0 +1,196 @@
+/*=========================================================================================================
+ * 正压力传递测试 - 验证基于支撑森林的正压力累加
+ *
+ * 测试场景：
+ * 1. 高塔：单列方块，底部方块的正压力等于整座塔的重力，每层依次递减
+ * 2. 金字塔：所有根节点（地面上的方块）的正压力之和等于全部方块的重力
+ * 3. 规模：塔高增加 4 倍时，单步耗时接近线性增长
+ * 4. 零重力：正压力全部为 0（不依赖 0.0 作为"未计算"标记）
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+// 在世界中放一座单列方块塔（从下往上），返回方块列表
+std::vector<Shape*> buildTower(PhysicalWorld& world, int height, double mass) {
+    std::vector<Shape*> shapes;
+    for (int level = 0; level < height; level++) {
+        AABB* block = new AABB(mass, 2.0, 1.0, 0.0, 0.5 + level * 1.0);
+        shapes.push_back(block);
+        world.addDynamicShape(block);
+    }
+    return shapes;
+}
+
+// 测试1：高塔
+bool test_tower() {
+    printSeparator();
+    std::cout << "测试1：高塔（200 层，每块 2 kg）" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(10.0);
+    world.ground.setYLevel(0.0);
+    std::vector<Shape*> shapes = buildTower(world, 200, 2.0);
+
+    world.update(world.dynamicShapeList, world.ground);
+
+    bool ok = true;
+    for (size_t level = 0; level < shapes.size(); level++) {
+        double fx, fy;
+        shapes[level]->getNormalForce(fx, fy);
+        double expected = -2.0 * 10.0 * static_cast<double>(shapes.size() - level);
+        if (std::abs(fy - expected) > 1e-6) {
+            ok = false;
+        }
+    }
+
+    double bottomFx, bottomFy, topFx, topFy;
+    shapes.front()->getNormalForce(bottomFx, bottomFy);
+    shapes.back()->getNormalForce(topFx, topFy);
+    std::cout << "  底部方块正压力: " << bottomFy << " N（期望 " << -2.0 * 10.0 * 200 << " N）" << std::endl;
+    std::cout << "  顶部方块正压力: " << topFy << " N（期望 " << -2.0 * 10.0 << " N）" << std::endl;
+    std::cout << "  结果: " << (ok ? "每层正压力正确 ✓" : "正压力错误 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试2：金字塔
+bool test_pyramid() {
+    printSeparator();
+    std::cout << "测试2：金字塔（底层 30 块）" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(10.0);
+    world.ground.setYLevel(0.0);
+
+    std::vector<Shape*> shapes;
+    double totalMass = 0.0;
+    for (int level = 0; level < 30; level++) {
+        for (int k = 0; k < 30 - level; k++) {
+            double mass = 1.0 + 0.1 * level;
+            AABB* block = new AABB(mass, 2.0, 1.0, k * 2.0 + level * 1.0, 0.5 + level * 1.0);
+            shapes.push_back(block);
+            world.addDynamicShape(block);
+            totalMass += mass;
+        }
+    }
+
+    world.update(world.dynamicShapeList, world.ground);
+
+    double rootSum = 0.0;
+    size_t roots = 0;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        if (shapes[i]->getSupporter() == nullptr) {
+            double fx, fy;
+            shapes[i]->getNormalForce(fx, fy);
+            rootSum += std::abs(fy);
+            roots++;
+        }
+    }
+    double expected = totalMass * 10.0;
+    bool ok = roots == 30 && std::abs(rootSum - expected) < 1e-6 * expected;
+
+    std::cout << "  方块数量: " << shapes.size() << "，地面上的方块: " << roots << std::endl;
+    std::cout << "  地面承受的正压力: " << std::fixed << std::setprecision(3) << rootSum
+              << " N（期望 " << expected << " N）" << std::endl;
+    std::cout << "  结果: " << (ok ? "重力全部传到地面 ✓" : "正压力丢失或重复 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试3：规模
+double timeTowerStep(int height) {
+    // 边界要比塔高，否则超出边界的方块会被推回同一位置
+    PhysicalWorld world(-1000.0, 1000.0, -1000.0, height + 1000.0);
+    world.setGravity(10.0);
+    world.ground.setYLevel(0.0);
+    std::vector<Shape*> shapes = buildTower(world, height, 1.0);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 5; i++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    deleteShapes(shapes);
+    return std::chrono::duration<double, std::milli>(end - start).count() / 5.0;
+}
+
+bool test_scaling() {
+    printSeparator();
+    std::cout << "测试3：单步耗时随塔高的增长" << std::endl;
+    printSeparator();
+
+    double small = timeTowerStep(2500);
+    double large = timeTowerStep(10000);
+    double ratio = large / small;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  2500 层: " << small << " ms/步" << std::endl;
+    std::cout << "  10000 层: " << large << " ms/步" << std::endl;
+    std::cout << "  比值: " << ratio << "（线性为 4，平方为 16）" << std::endl;
+
+    bool ok = ratio < 10.0;
+    std::cout << "  结果: " << (ok ? "接近线性 ✓" : "增长过快 ✗") << std::endl;
+    return ok;
+}
+
+// 测试4：零重力
+bool test_zero_gravity() {
+    printSeparator();
+    std::cout << "测试4：零重力下正压力为 0" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    world.ground.setYLevel(0.0);
+    std::vector<Shape*> shapes = buildTower(world, 50, 1.0);
+
+    world.update(world.dynamicShapeList, world.ground);
+
+    bool ok = true;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double fx, fy;
+        shapes[i]->getNormalForce(fx, fy);
+        if (fx != 0.0 || fy != 0.0) ok = false;
+    }
+    std::cout << "  结果: " << (ok ? "全部为 0 ✓" : "出现非零正压力 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_tower()) passed++;
+    total++; if (test_pyramid()) passed++;
+    total++; if (test_scaling()) passed++;
+    total++; if (test_zero_gravity()) passed++;
+
+    printSeparator();
+    std::cout << "正压力测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
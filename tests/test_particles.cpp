@@ -0,0 +1,309 @@
+/*=========================================================================================================
+ * 粒子系统测试 - 验证发射器、寿命与回收、与地面和墙壁的碰撞，以及 100 万个粒子的吞吐量
+ *
+ * 测试场景：
+ * 1. 发射与回收：按速率连续发射、寿命 1 秒，存活数量达到 速率 × 寿命 后保持稳定；数组不重新分配
+ * 2. 容量：一次喷发超过容量时多出的粒子被丢弃
+ * 3. 碰撞：从高处落下的粒子反弹到 e² 倍的高度；射向墙壁的粒子全部被挡回，不会穿入墙内
+ * 4. 确定性：多线程与单线程的结果逐位相同
+ * 5. 吞吐量：地面和两面墙围成的箱子中 100 万个粒子，每帧（1/60 秒）的耗时；与同样数量的 Circle 物体比较每个的代价
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <ctime>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+const double frame = 1.0 / 60.0;
+
+/*=========================================================================================================
+ * 测试 1：发射与回收
+ *=========================================================================================================*/
+bool testEmissionAndRecycling() {
+    printSeparator();
+    std::cout << "测试 1：连续发射、寿命与回收" << std::endl;
+    printSeparator('-');
+
+    PhysicalWorld world;
+    world.gravity = 0.0;
+    ParticleEmitter emitter;
+    emitter.x = 0.0;
+    emitter.y = 500.0;
+    emitter.rate = 600.0;
+    emitter.lifetime = 1.0;
+    emitter.spread = 3.14159265358979323846;
+    emitter.speedMin = 1.0;
+    emitter.speedMax = 2.0;
+    int id = world.addParticleEmitter(emitter);
+    world.start();
+
+    size_t emitted = 0, recycled = 0;
+    const float* storage = nullptr;
+    bool reallocated = false;
+    for (int f = 0; f < 180; f++) {
+        world.update(world.dynamicShapeList, frame, world.ground);
+        emitted += world.getParticleStats().emitted;
+        recycled += world.getParticleStats().recycled;
+        if (storage == nullptr) storage = world.getParticleSystem().positionX();
+        reallocated = reallocated || storage != world.getParticleSystem().positionX();
+    }
+    size_t live = world.getParticleCount();
+    std::cout << "  发射器 " << id << "：3 秒内发射 " << emitted << " 个，回收 " << recycled << " 个，存活 " << live
+              << " 个（速率 × 寿命 = 600）" << std::endl;
+    std::cout << "  粒子数组" << (reallocated ? "重新分配过" : "没有重新分配") << std::endl;
+
+    // 关闭发射器后，剩余的粒子在 1 秒内全部回收
+    world.getParticleEmitter(id)->enabled = false;
+    for (int f = 0; f < 61; f++) {
+        world.update(world.dynamicShapeList, frame, world.ground);
+    }
+    std::cout << "  关闭发射器 1 秒后存活 " << world.getParticleCount() << " 个" << std::endl;
+
+    bool ok = emitted == 1800 && emitted == recycled + live && live >= 590 && live <= 610 && !reallocated &&
+              world.getParticleCount() == 0;
+    std::cout << (ok ? "✓ 存活数量稳定，寿命耗尽的粒子被回收" : "✗ 发射或回收不正确") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 2：容量
+ *=========================================================================================================*/
+bool testCapacity() {
+    printSeparator();
+    std::cout << "测试 2：容量已满时丢弃" << std::endl;
+    printSeparator('-');
+
+    PhysicalWorld world;
+    world.setMaxParticles(1000);
+    ParticleEmitter emitter;
+    emitter.y = 500.0;
+    emitter.enabled = false;
+    int id = world.addParticleEmitter(emitter);
+    size_t first = world.emitParticles(id, 1500);
+    size_t second = world.emitParticles(id, 10);
+    std::cout << "  容量 1000：喷发 1500 个实际发射 " << first << " 个，再喷发 10 个实际发射 " << second << " 个" << std::endl;
+
+    bool ok = first == 1000 && second == 0 && world.getParticleCount() == 1000;
+    std::cout << (ok ? "✓ 不超过容量" : "✗ 超过容量") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 3：与地面、墙壁碰撞
+ *=========================================================================================================*/
+bool testCollisions() {
+    printSeparator();
+    std::cout << "测试 3：与地面和墙壁碰撞" << std::endl;
+    printSeparator('-');
+
+    bool ok = true;
+
+    // 从 5 m 高处落下，恢复系数 0.8：第一次反弹的最高点约为 0.64 × 5 m
+    {
+        PhysicalWorld world;
+        ParticleEmitter emitter;
+        emitter.x = 0.0;
+        emitter.y = 5.0 + 0.05;
+        emitter.speedMin = emitter.speedMax = 0.0;
+        emitter.restitution = 0.8;
+        emitter.lifetime = 0.0;
+        emitter.enabled = false;
+        int id = world.addParticleEmitter(emitter);
+        world.emitParticles(id, 1);
+        world.start();
+
+        double peak = 0.0;
+        bool bounced = false;
+        for (int i = 0; i < 2400; i++) {
+            world.update(world.dynamicShapeList, 1.0 / 1200.0, world.ground);
+            double y = world.getParticleSystem().positionY()[0] - 0.05;
+            if (world.getParticleStats().collisions > 0) bounced = true;
+            if (bounced) peak = std::max(peak, y);
+        }
+        double expected = 0.64 * 5.0;
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "  反弹高度 " << peak << " m（理论 " << expected << " m）" << std::endl;
+        ok = ok && bounced && std::fabs(peak - expected) < 0.02 * expected;
+    }
+
+    // 2000 个粒子从 (0, 10) 向右射向 x = 10 处的墙壁（墙厚 0.2 m，每步位移 0.25 m，圆心会进入墙内）
+    {
+        PhysicalWorld world;
+        world.gravity = 0.0;
+        Wall* wall = world.allocateShape<Wall>(0.2, 20.0, 10.1, 10.0);
+        world.addStaticShape(wall);
+        ParticleEmitter emitter;
+        emitter.x = 0.0;
+        emitter.y = 10.0;
+        emitter.angle = 0.0;
+        emitter.spread = 0.5;
+        emitter.speedMin = 10.0;
+        emitter.speedMax = 15.0;
+        emitter.restitution = 1.0;
+        emitter.lifetime = 0.0;
+        emitter.enabled = false;
+        int id = world.addParticleEmitter(emitter);
+        world.emitParticles(id, 2000);
+        world.start();
+
+        // 1.25 秒：最慢的粒子已经撞到墙壁，斜着返回的粒子还没有到达地面
+        size_t collisions = 0;
+        double maxX = -1e9;
+        for (int f = 0; f < 75; f++) {
+            world.update(world.dynamicShapeList, frame, world.ground);
+            collisions += world.getParticleStats().collisions;
+            const ParticleSystem& ps = world.getParticleSystem();
+            for (size_t i = 0; i < ps.size(); i++) {
+                maxX = std::max(maxX, static_cast<double>(ps.positionX()[i] + ps.radius()[i]));
+            }
+        }
+        const ParticleSystem& ps = world.getParticleSystem();
+        size_t returning = 0;
+        for (size_t i = 0; i < ps.size(); i++) {
+            if (ps.velocityX()[i] < 0.0f) returning++;
+        }
+        std::cout << "  射向墙壁的 2000 个粒子：碰撞 " << collisions << " 次，" << returning << " 个正在返回，"
+                  << "粒子最右端 x = " << maxX << "（墙面 x = 10.000）" << std::endl;
+        ok = ok && collisions == 2000 && returning == 2000 && maxX <= 10.0 + 1e-4;
+    }
+
+    std::cout << (ok ? "✓ 地面反弹高度正确，墙壁挡住所有粒子" : "✗ 碰撞不正确") << std::endl;
+    return ok;
+}
+
+/*=========================================================================================================
+ * 测试 4、5：箱子中的粒子
+ *=========================================================================================================*/
+struct BoxResult {
+    double msPerFrame;
+    double cpuMsPerFrame;
+    size_t live;
+    size_t collisions;
+    std::vector<float> x, y;
+};
+
+// 地面（y = 0）和 x = ±50 两面墙围成的箱子，count 个粒子从 (0, 50) 向各个方向喷出
+BoxResult simulateBox(size_t count, int threads, int frames) {
+    PhysicalWorld world;
+    world.setWorkerThreads(threads);
+    world.setMaxParticles(count);
+    world.addStaticShape(world.allocateShape<Wall>(1.0, 200.0, -50.5, 100.0));
+    world.addStaticShape(world.allocateShape<Wall>(1.0, 200.0, 50.5, 100.0));
+    ParticleEmitter emitter;
+    emitter.x = 0.0;
+    emitter.y = 50.0;
+    emitter.spread = 3.14159265358979323846;
+    emitter.speedMin = 0.0;
+    emitter.speedMax = 30.0;
+    emitter.lifetime = 0.0;
+    emitter.radius = 0.02;
+    emitter.restitution = 0.7;
+    emitter.enabled = false;
+    world.emitParticles(world.addParticleEmitter(emitter), count);
+    world.start();
+
+    BoxResult result;
+    result.collisions = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::clock_t cpuStart = std::clock();
+    for (int f = 0; f < frames; f++) {
+        world.update(world.dynamicShapeList, frame, world.ground);
+        result.collisions += world.getParticleStats().collisions;
+    }
+    std::clock_t cpuEnd = std::clock();
+    auto end = std::chrono::high_resolution_clock::now();
+    result.msPerFrame = std::chrono::duration<double, std::milli>(end - start).count() / frames;
+    result.cpuMsPerFrame = 1000.0 * (cpuEnd - cpuStart) / CLOCKS_PER_SEC / frames;
+    const ParticleSystem& ps = world.getParticleSystem();
+    result.live = ps.size();
+    result.x.assign(ps.positionX(), ps.positionX() + ps.size());
+    result.y.assign(ps.positionY(), ps.positionY() + ps.size());
+    return result;
+}
+
+bool testDeterminism() {
+    printSeparator();
+    std::cout << "测试 4：多线程结果与单线程相同" << std::endl;
+    printSeparator('-');
+
+    BoxResult single = simulateBox(200000, 1, 180);
+    BoxResult multi = simulateBox(200000, 4, 180);
+    bool identical = single.x == multi.x && single.y == multi.y;
+    std::cout << "  20 万个粒子 3 秒：碰撞 " << single.collisions << " 次，4 线程结果" << (identical ? "逐位相同" : "不同") << std::endl;
+
+    bool ok = identical && single.live == 200000 && single.collisions > 0;
+    std::cout << (ok ? "✓ 结果与线程数无关" : "✗ 结果与线程数有关") << std::endl;
+    return ok;
+}
+
+bool testThroughput() {
+    printSeparator();
+    std::cout << "测试 5：100 万个粒子的吞吐量" << std::endl;
+    printSeparator('-');
+
+    const size_t count = 1000000;
+    BoxResult particles = simulateBox(count, 1, 60);
+
+    // 只有箱子内的粒子：离开的粒子被回收，存活数量说明墙壁和地面挡住了全部粒子
+    bool contained = true;
+    for (size_t i = 0; i < particles.live; i++) {
+        if (particles.x[i] < -50.0f || particles.x[i] > 50.0f || particles.y[i] < 0.0f) {
+            contained = false;
+            break;
+        }
+    }
+
+    // 对照：同样场景中的 Circle 物体（数量少得多），按每个物体的代价比较
+    const int circleCount = 5000;
+    PhysicalWorld world;
+    world.setSleepingEnabled(false);
+    world.addStaticShape(world.allocateShape<Wall>(1.0, 200.0, -50.5, 100.0));
+    world.addStaticShape(world.allocateShape<Wall>(1.0, 200.0, 50.5, 100.0));
+    for (int i = 0; i < circleCount; i++) {
+        double angle = 2.0 * 3.14159265358979323846 * i / circleCount;
+        double speed = 30.0 * (i % 97) / 97.0;
+        world.addDynamicShape(world.allocateShape<Circle>(0.01, 0.02, 0.0, 50.0, speed * std::cos(angle), speed * std::sin(angle)));
+    }
+    world.start();
+    std::clock_t cpuStart = std::clock();
+    for (int f = 0; f < 20; f++) {
+        world.update(world.dynamicShapeList, frame, world.ground);
+    }
+    double circleNs = 1e9 * (std::clock() - cpuStart) / CLOCKS_PER_SEC / 20 / circleCount;
+    double particleNs = 1e6 * particles.cpuMsPerFrame / count;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  " << particles.live << " 个存活粒子，每帧 " << particles.msPerFrame << " ms（CPU 时间 "
+              << particles.cpuMsPerFrame << " ms，60 Hz 需要 < 16.67 ms），" << (contained ? "全部留在箱子内" : "有粒子离开箱子") << std::endl;
+    std::cout << "  每个粒子每帧 " << particleNs << " ns，每个 Circle 物体每帧 " << circleNs << " ns（"
+              << circleNs / particleNs << " 倍）" << std::endl;
+
+    bool ok = particles.live == count && contained && particles.cpuMsPerFrame < 1000.0 / 60.0;
+    std::cout << (ok ? "✓ 100 万个粒子以 60 Hz 运行" : "✗ 吞吐量不足或粒子离开箱子") << std::endl;
+    return ok;
+}
+
+int main() {
+    std::cout << "粒子系统测试" << std::endl;
+
+    int passed = 0, total = 0;
+    total++; if (testEmissionAndRecycling()) passed++;
+    total++; if (testCapacity()) passed++;
+    total++; if (testCollisions()) passed++;
+    total++; if (testDeterminism()) passed++;
+    total++; if (testThroughput()) passed++;
+
+    printSeparator();
+    std::cout << "结果：" << passed << " / " << total << " 通过" << std::endl;
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+/*=========================================================================================================
+ * 形状句柄测试 - 验证 ShapeHandle 在形状删除、槽位复用、存储重排之后仍然安全
+ *
+ * 测试场景：
+ * 1. 解析：加入世界后句柄有效，删除后失效（resolveShape 返回 nullptr）
+ * 2. 代数：释放的槽位延迟、按先进先出复用，旧句柄不会指向新形状；反复创建删除时代数回绕，槽位数量有界
+ * 3. 支撑关系：支撑物被删除后 getSupporter 返回 nullptr；暂停期间删除支撑物，继续后不恢复悬空的支撑物；
+ *    不在世界中的形状 checkSupportStatus 后仍能取得支撑物
+ * 4. 存储重排：BodyStore 交换删除移动了物体状态，句柄仍指向原来的形状；直接放进列表的形状在 update 时分配句柄
+ * 5. 性能：resolveShape 与直接使用指针比较
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+// 测试1：解析与失效
+bool test_resolve_and_invalidate() {
+    printSeparator();
+    std::cout << "测试1：加入世界后句柄有效，删除后失效" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    Shape* ball = world.placeDynamicShapeByType("Circle", "Ball", 0.0, 10.0, 1.0, 0.5);
+    Wall* wall = world.placeWall("Wall", 5.0, 0.0, 0.5, 4.0);
+    Circle* free = new Circle(1.0, 0.5, 0.0, 0.0);
+
+    ShapeHandle ballHandle = ball->getHandle();
+    ShapeHandle wallHandle = wall->getHandle();
+    bool resolved = world.resolveShape(ballHandle) == ball && world.resolveShape(wallHandle) == wall;
+    bool freeNull = free->getHandle().isNull() && world.resolveShape(ShapeHandle()) == nullptr;
+    std::cout << "  Ball 句柄 0x" << std::hex << ballHandle.value << "，Wall 句柄 0x" << wallHandle.value << std::dec
+              << (resolved ? "，解析正确" : "，解析错误") << std::endl;
+    std::cout << "  未加入世界的形状: " << (freeNull ? "空句柄" : "有句柄") << std::endl;
+
+    world.removeDynamicShape(ball);   // 池中的形状被回收
+    world.removeStaticShape(wall);
+    bool invalid = !world.isValidShape(ballHandle) && world.resolveShape(wallHandle) == nullptr;
+    std::cout << "  删除后: " << (invalid ? "句柄失效" : "句柄仍然有效") << std::endl;
+
+    // 用户自己的形状移出世界后句柄清空，可以再加入
+    world.addDynamicShape(free);
+    ShapeHandle freeHandle = free->getHandle();
+    world.removeDynamicShape(free);
+    bool userReleased = free->getHandle().isNull() && !world.isValidShape(freeHandle);
+    std::cout << "  用户的形状移出世界后: " << (userReleased ? "句柄清空" : "句柄未清空") << std::endl;
+
+    bool ok = resolved && freeNull && invalid && userReleased;
+    std::cout << "  结果: " << (ok ? "句柄解析正确 ✓" : "句柄解析错误 ✗") << std::endl;
+    delete free;
+    return ok;
+}
+
+// 测试2：槽位复用
+bool test_generation_reuse() {
+    printSeparator();
+    std::cout << "测试2：删除后复用槽位，旧句柄不指向新形状" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    std::vector<ShapeHandle> stale;
+    Shape* current = world.placeDynamicShapeByType("Circle", "Ball", 0.0, 10.0, 1.0, 0.5);
+    bool delayed = true;
+    for (int round = 0; round < 100; round++) {
+        ShapeHandle old = current->getHandle();
+        stale.push_back(old);
+        world.removeDynamicShape(current);
+        current = world.placeDynamicShapeByType("Circle", "Ball", 0.0, 10.0, 1.0, 0.5);
+        // 空闲槽位还不到 kMinFreeSlots 个：新形状使用新的句柄槽位，不立即复用刚释放的槽位
+        for (size_t i = 0; i < stale.size(); i++) {
+            delayed = delayed && current->getHandle().index() != stale[i].index();
+        }
+    }
+    bool allStale = true;
+    for (size_t i = 0; i < stale.size(); i++) {
+        allStale = allStale && world.resolveShape(stale[i]) == nullptr;
+    }
+    bool currentValid = world.resolveShape(current->getHandle()) == current;
+    std::cout << "  100 次删除再创建: 句柄槽位" << (delayed ? "延迟复用" : "立即复用") << std::endl;
+    std::cout << "  100 个旧句柄: " << (allStale ? "全部失效" : "有的指向了新形状") << std::endl;
+
+    // 反复创建删除 200 万次：槽位按先进先出复用，代数用完后回到 1，槽位数量不增长、不抛出异常
+    HandleTable table;
+    Circle probe(1.0, 0.5, 0.0, 0.0);
+    const int churns = 2000000;
+    std::vector<ShapeHandle> recent;
+    bool wrapped = false;
+    bool threw = false;
+    try {
+        for (int k = 0; k < churns; k++) {
+            ShapeHandle handle = table.acquire(&probe);
+            if (handle.generation() == 1 && k > static_cast<int>(HandleTable::kMinFreeSlots)) wrapped = true;
+            if (k >= churns - 1000) recent.push_back(handle);
+            table.release(&probe);
+        }
+    } catch (const std::length_error&) {
+        threw = true;
+    }
+    bool recentStale = true;
+    for (size_t i = 0; i < recent.size(); i++) {
+        recentStale = recentStale && table.resolve(recent[i]) == nullptr;
+    }
+    size_t slotCount = table.slotCount();
+    bool boundedOk = !threw && wrapped && recentStale && slotCount <= HandleTable::kMinFreeSlots + 1;
+    std::cout << "  " << churns << " 次创建删除: 槽位 " << slotCount << " 个，代数"
+              << (wrapped ? "用完后回到 1" : "没有回绕") << (threw ? "，抛出了异常" : "") << std::endl;
+
+    bool ok = delayed && allStale && currentValid && boundedOk;
+    std::cout << "  结果: " << (ok ? "旧句柄全部失效，槽位数量有界 ✓" : "旧句柄指向了新形状或槽位无限增长 ✗") << std::endl;
+    return ok;
+}
+
+// 测试3：支撑关系
+bool test_supporter_removed() {
+    printSeparator();
+    std::cout << "测试3：支撑物被删除" << std::endl;
+    printSeparator();
+
+    // 3a：删除支撑物（支撑关系按 test_block_models 的方式直接设置）
+    PhysicalWorld world;
+    AABB* platform = world.allocateShape<AABB>(8.0, 12.0, 2.0, 15.0, 1.0);
+    AABB* block = world.allocateShape<AABB>(2.0, 6.0, 1.5, 15.0, 2.75);
+    world.addDynamicShape(block);
+    world.addDynamicShape(platform);
+    block->setSupporter(platform);
+    block->setIsSupported(true);
+    bool supported = block->getSupporter() == platform;
+    world.removeDynamicShape(platform);
+    bool cleared = block->getSupporter() == nullptr;
+    for (int step = 0; step < 30; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    double x, y;
+    block->getCentre(x, y);
+    bool fell = y < 2.75;
+    std::cout << "  删除前支撑物为平台: " << (supported ? "是" : "否") << "，删除后 getSupporter: "
+              << (cleared ? "nullptr" : "悬空指针") << "，30 步后 y = " << y << std::endl;
+
+    // 3b：暂停期间删除支撑物，又创建了同类形状（复用同一块内存），继续时不恢复失效的支撑物
+    PhysicalWorld paused;
+    AABB* base = paused.allocateShape<AABB>(8.0, 12.0, 2.0, 15.0, 1.0);
+    AABB* crate = paused.allocateShape<AABB>(2.0, 6.0, 1.5, 15.0, 2.75);
+    paused.addDynamicShape(crate);
+    paused.addDynamicShape(base);
+    crate->setSupporter(base);
+    crate->setIsSupported(true);
+    paused.start();
+    paused.Pause();
+    paused.removeDynamicShape(base);
+    AABB* replacement = paused.allocateShape<AABB>(1.0, 2.0, 2.0, 100.0, 1.0);
+    paused.addDynamicShape(replacement);
+    bool sameMemory = replacement == base;
+    paused.Continue();
+    bool restored = crate->getSupporter() == nullptr && !crate->getIsSupported();
+    std::cout << "  暂停期间删除平台，新形状" << (sameMemory ? "复用了平台的内存" : "没有复用平台的内存")
+              << "，继续后: " << (restored ? "不被支撑" : "支撑物指向了新形状") << std::endl;
+
+    // 3c：不在世界中的形状仍能记住支撑物
+    AABB floorBox(1.0, 4.0, 1.0, 0.0, 0.5);
+    AABB box(1.0, 1.0, 1.0, 0.0, 1.45);
+    box.checkSupportStatus(floorBox);
+    bool standalone = box.getIsSupported() && box.getSupporter() == &floorBox;
+    box.resetSupportStatus();
+    standalone = standalone && box.getSupporter() == nullptr;
+    std::cout << "  不在世界中的形状: checkSupportStatus 后 getSupporter "
+              << (standalone ? "返回支撑物" : "丢失了支撑物") << std::endl;
+
+    bool ok = supported && cleared && fell && sameMemory && restored && standalone;
+    std::cout << "  结果: " << (ok ? "不会访问已删除的支撑物 ✓" : "访问了已删除的支撑物 ✗") << std::endl;
+    return ok;
+}
+
+// 测试4：存储重排
+bool test_relocation() {
+    printSeparator();
+    std::cout << "测试4：BodyStore 交换删除之后" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world(-1000.0, 1000.0, -1000.0, 1000.0);
+    std::vector<Shape*> balls;
+    std::vector<ShapeHandle> handles;
+    for (int i = 0; i < 200; i++) {
+        Shape* ball = world.placeDynamicShapeByType("Circle", "", (i % 20) * 5.0, 10.0 + (i / 20) * 5.0, 1.0, 0.5);
+        balls.push_back(ball);
+        handles.push_back(ball->getHandle());
+    }
+    // 删除前面的物体，末尾的物体被交换到空出的槽位
+    for (int i = 0; i < 50; i++) {
+        world.removeDynamicShape(balls[i * 2]);
+    }
+    bool stable = true;
+    for (int i = 0; i < 200; i++) {
+        bool removed = (i % 2 == 0) && i < 100;
+        Shape* resolved = world.resolveShape(handles[i]);
+        stable = stable && (removed ? resolved == nullptr : resolved == balls[i]);
+    }
+    for (int step = 0; step < 10; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    bool stillStable = true;
+    for (int i = 101; i < 200; i++) {
+        double x, y, hx, hy;
+        balls[i]->getCentre(x, y);
+        world.resolveShape(handles[i])->getCentre(hx, hy);
+        stillStable = stillStable && x == hx && y == hy;
+    }
+    std::cout << "  删除 50 个之后，150 个句柄仍指向原来的形状: " << (stable ? "是" : "否") << std::endl;
+    std::cout << "  10 步之后读到的位置相同: " << (stillStable ? "是" : "否") << std::endl;
+
+    // 直接放进列表的形状
+    Circle* pushed = new Circle(1.0, 0.5, 500.0, 10.0);
+    world.dynamicShapeList.push_back(pushed);
+    world.update(world.dynamicShapeList, world.ground);
+    bool synced = world.resolveShape(pushed->getHandle()) == pushed;
+    std::cout << "  直接 push_back 的形状 update 后: " << (synced ? "已分配句柄" : "没有句柄") << std::endl;
+    world.removeDynamicShape(pushed);
+    delete pushed;
+
+    bool ok = stable && stillStable && synced;
+    std::cout << "  结果: " << (ok ? "句柄不受存储顺序影响 ✓" : "句柄指向了错误的形状 ✗") << std::endl;
+    return ok;
+}
+
+// 测试5：解析的开销
+bool test_resolve_cost() {
+    printSeparator();
+    std::cout << "测试5：resolveShape 与直接使用指针" << std::endl;
+    printSeparator();
+
+    const int count = 10000, rounds = 200;
+    PhysicalWorld world;
+    std::vector<Shape*> shapes;
+    std::vector<ShapeHandle> handles;
+    for (int i = 0; i < count; i++) {
+        Shape* ball = world.placeDynamicShapeByType("Circle", "", (i % 100) * 3.0, (i / 100) * 3.0, 1.0, 1.0);
+        shapes.push_back(ball);
+        handles.push_back(ball->getHandle());
+    }
+
+    double pointerSum = 0.0, handleSum = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < count; i++) pointerSum += shapes[i]->getMass();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double pointerMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < count; i++) {
+            Shape* shape = world.resolveShape(handles[i]);
+            if (shape) handleSum += shape->getMass();
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double handleMs = std::chrono::duration<double, std::milli>(end - start).count();
+    double total = static_cast<double>(count) * rounds;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  直接指针: " << pointerMs << " ms（" << pointerMs * 1e6 / total << " ns/次）" << std::endl;
+    std::cout << "  句柄解析: " << handleMs << " ms（" << handleMs * 1e6 / total << " ns/次）" << std::endl;
+
+    bool ok = pointerSum == handleSum && pointerSum == total;
+    std::cout << "  结果: " << (ok ? "解析结果一致 ✓" : "解析结果不同 ✗") << std::endl;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_resolve_and_invalidate()) passed++;
+    total++; if (test_generation_reuse()) passed++;
+    total++; if (test_supporter_removed()) passed++;
+    total++; if (test_relocation()) passed++;
+    total++; if (test_resolve_cost()) passed++;
+
+    printSeparator();
+    std::cout << "形状句柄测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,346 @@
+/*=========================================================================================================
+ * 名称与类型索引测试 - 验证 ShapeIndex 的查找结果与逐个比较相同
+ *
+ * 测试场景：
+ * 1. 查找：重名、改名（setName）、删除之后，findXxxShapeByName、findXxxShapesByType 与遍历列表的结果相同（包括顺序）
+ * 2. 直接修改形状列表：push_back 后自动重建，替换元素后 invalidateShapeIndex
+ * 3. 类型字符串：placeDynamicShapeByType 不区分大小写，无法识别的类型返回 nullptr
+ * 4. 自动命名：名称唯一；创建 10 万个未命名形状的耗时，与原来逐个试探编号的方法（1000 个）比较
+ * 5. 只清空一个列表：另一类形状仍可按名称、类型查找，自动编号不会回到 1；clearAllShapes 才重置编号
+ * 6. 删除：10 万个同类型形状按打乱的顺序逐个移出，每次 O(1)；移出一半后按类型查找仍按加入顺序
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <set>
+#include <chrono>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+// 简单的线性同余随机数，保证每次运行结果相同
+struct TestRandom {
+    unsigned int state;
+    explicit TestRandom(unsigned int seed) : state(seed) {}
+    int next(int n) {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<int>((state >> 8) % static_cast<unsigned int>(n));
+    }
+};
+
+// 逐个比较（原来的实现）
+Shape* bruteFindByName(const std::vector<Shape*>& list, const std::string& name) {
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i]->getName() == name) return list[i];
+    }
+    return nullptr;
+}
+
+std::vector<Shape*> bruteFindByType(const std::vector<Shape*>& list, const std::string& type) {
+    std::vector<Shape*> result;
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i]->getType() == type) result.push_back(list[i]);
+    }
+    return result;
+}
+
+bool matchesBruteForce(PhysicalWorld& world, int nameCount) {
+    bool ok = true;
+    for (int n = 0; n < nameCount; n++) {
+        std::string name = "Body" + std::to_string(n);
+        ok = ok && world.findDynamicShapeByName(name) == bruteFindByName(world.dynamicShapeList, name);
+        ok = ok && world.findStaticShapeByName(name) == bruteFindByName(world.staticShapeList, name);
+    }
+    const char* types[] = {"Circle", "AABB", "Wall", "Slope"};
+    for (int t = 0; t < 4; t++) {
+        ok = ok && world.findDynamicShapesByType(types[t]) == bruteFindByType(world.dynamicShapeList, types[t]);
+        ok = ok && world.findStaticShapesByType(types[t]) == bruteFindByType(world.staticShapeList, types[t]);
+    }
+    return ok;
+}
+
+// 测试1：名称与类型查找
+bool test_lookup_matches_scan() {
+    printSeparator();
+    std::cout << "测试1：重名、改名、删除之后按名称、类型查找" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    TestRandom random(7);
+    std::vector<Shape*> owned;
+    const int nameCount = 150;
+    for (int i = 0; i < 400; i++) {
+        Shape* shape = (i % 3 == 0) ? static_cast<Shape*>(new AABB(1.0, 1.0, 1.0, i * 2.0, 10.0))
+                                    : static_cast<Shape*>(new Circle(1.0, 0.5, i * 2.0, 10.0));
+        shape->setName("Body" + std::to_string(random.next(nameCount)));   // 有重名
+        owned.push_back(shape);
+        world.addDynamicShape(shape);
+    }
+    for (int w = 0; w < 30; w++) {
+        world.placeWall("Body" + std::to_string(random.next(nameCount)), w * 5.0, 0.0, 0.5, 2.0);
+    }
+    bool afterAdd = matchesBruteForce(world, nameCount);
+
+    // 已加入世界后改名
+    for (int k = 0; k < 100; k++) {
+        world.dynamicShapeList[random.next(static_cast<int>(world.dynamicShapeList.size()))]
+            ->setName("Body" + std::to_string(random.next(nameCount)));
+    }
+    bool afterRename = matchesBruteForce(world, nameCount);
+
+    // 删除
+    for (int k = 0; k < 80; k++) {
+        world.removeDynamicShape(world.dynamicShapeList[random.next(static_cast<int>(world.dynamicShapeList.size()))]);
+    }
+    for (int k = 0; k < 10; k++) {
+        world.removeStaticShape(world.staticShapeList[random.next(static_cast<int>(world.staticShapeList.size()))]);
+    }
+    bool afterRemove = matchesBruteForce(world, nameCount);
+
+    std::cout << "  加入后: " << (afterAdd ? "一致" : "不一致") << std::endl;
+    std::cout << "  改名后: " << (afterRename ? "一致" : "不一致") << std::endl;
+    std::cout << "  删除后: " << (afterRemove ? "一致" : "不一致") << "（动态 " << world.getDynamicShapeCount()
+              << " 个，静态 " << world.getStaticShapeCount() << " 个）" << std::endl;
+
+    bool ok = afterAdd && afterRename && afterRemove;
+    std::cout << "  结果: " << (ok ? "索引与逐个比较一致 ✓" : "结果不同 ✗") << std::endl;
+    world.clearDynamicShapes();
+    for (size_t i = 0; i < owned.size(); i++) delete owned[i];
+    return ok;
+}
+
+// 测试2：直接修改形状列表
+bool test_direct_list_edits() {
+    printSeparator();
+    std::cout << "测试2：直接修改 dynamicShapeList" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    Circle* a = new Circle(1.0, 0.5, 0.0, 10.0);
+    Circle* b = new Circle(1.0, 0.5, 5.0, 10.0);
+    a->setName("A");
+    b->setName("B");
+    world.addDynamicShape(a);
+    world.findShapeByName("A");
+
+    world.dynamicShapeList.push_back(b);
+    bool pushed = world.findShapeByName("B") == b;
+
+    // 数量不变的替换需要 invalidateShapeIndex
+    world.dynamicShapeList[0] = b;
+    world.dynamicShapeList.pop_back();
+    world.dynamicShapeList.push_back(a);
+    world.dynamicShapeList[0] = b;
+    world.dynamicShapeList[1] = a;
+    world.invalidateShapeIndex();
+    std::vector<Shape*> circles = world.findDynamicShapesByType("Circle");
+    bool replaced = circles.size() == 2 && circles[0] == b && circles[1] == a;
+
+    std::cout << "  push_back 后自动重建: " << (pushed ? "是" : "否") << std::endl;
+    std::cout << "  替换元素 + invalidateShapeIndex 后顺序正确: " << (replaced ? "是" : "否") << std::endl;
+
+    bool ok = pushed && replaced;
+    std::cout << "  结果: " << (ok ? "索引与列表同步 ✓" : "索引过期 ✗") << std::endl;
+    world.clearDynamicShapes();
+    delete a;
+    delete b;
+    return ok;
+}
+
+// 测试3：类型字符串
+bool test_type_strings() {
+    printSeparator();
+    std::cout << "测试3：placeDynamicShapeByType 的类型字符串" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    const char* spellings[] = {"circle", "CIRCLE", "Circle", "aabb", "Box", "RECTANGLE", "rect"};
+    const char* expected[] = {"Circle", "Circle", "Circle", "AABB", "AABB", "AABB", "AABB"};
+    bool ok = true;
+    for (int i = 0; i < 7; i++) {
+        Shape* shape = world.placeDynamicShapeByType(spellings[i], "", i * 5.0, 0.0, 1.0, 1.0);
+        bool match = shape != nullptr && shape->getType() == expected[i];
+        std::cout << "  \"" << spellings[i] << "\" -> " << (shape ? shape->getType() : std::string("nullptr"))
+                  << (shape ? "（" + shape->getName() + "）" : "") << std::endl;
+        ok = ok && match;
+    }
+    std::cerr.setstate(std::ios::failbit);   // 下面两次预期会打印错误信息
+    bool rejected = world.placeDynamicShapeByType("triangle", "", 0.0, 0.0, 1.0, 1.0) == nullptr &&
+                    world.placeDynamicShapeByType("circles", "", 0.0, 0.0, 1.0, 1.0) == nullptr;
+    std::cerr.clear();
+    std::cout << "  \"triangle\"、\"circles\" -> " << (rejected ? "nullptr" : "错误地创建了形状") << std::endl;
+
+    ok = ok && rejected;
+    std::cout << "  结果: " << (ok ? "不区分大小写识别 ✓" : "识别错误 ✗") << std::endl;
+    return ok;
+}
+
+// 原来的自动命名：每次从 1 开始试探，每个名称都要遍历两个列表
+std::string bruteUniqueName(PhysicalWorld& world, const std::string& type) {
+    int counter = 1;
+    std::string name;
+    do {
+        name = type + "_" + std::to_string(counter++);
+    } while (bruteFindByName(world.dynamicShapeList, name) != nullptr ||
+             bruteFindByName(world.staticShapeList, name) != nullptr);
+    return name;
+}
+
+// 测试4：自动命名
+bool test_unique_names() {
+    printSeparator();
+    std::cout << "测试4：自动命名" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    Shape* taken = world.placeDynamicShapeByType("Circle", "Circle_2", 0.0, 0.0, 1.0, 1.0);
+    Shape* first = world.placeDynamicShapeByType("Circle", "", 0.0, 0.0, 1.0, 1.0);
+    Shape* second = world.placeDynamicShapeByType("Circle", "", 0.0, 0.0, 1.0, 1.0);
+    Wall* wall = world.placeWall("", 0.0, 0.0, 1.0, 1.0);
+    bool skipped = taken != nullptr && first->getName() == "Circle_1" && second->getName() == "Circle_3"
+                   && wall->getName() == "Wall_1";
+    std::cout << "  已有 Circle_2 时自动命名: " << first->getName() << "、" << second->getName()
+              << "，墙壁: " << wall->getName() << std::endl;
+
+    // 10 万个未命名形状
+    const int count = 100000;
+    world.clearAllShapes();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < count; i++) {
+        world.placeDynamicShapeByType((i % 2 == 0) ? "circle" : "box", "", (i % 1000) * 3.0, (i / 1000) * 3.0, 1.0, 1.0);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double indexMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::set<std::string> names;
+    for (size_t i = 0; i < world.dynamicShapeList.size(); i++) names.insert(world.dynamicShapeList[i]->getName());
+    bool unique = names.size() == static_cast<size_t>(count);
+    bool lookups = world.findShapeByName("Circle_50000") != nullptr && world.findShapeByName("AABB_50001") == nullptr
+                   && world.findDynamicShapesByType("AABB").size() == static_cast<size_t>(count / 2);
+
+    // 原来的方法：每个名称 O(n²)，只算 1000 个
+    const int bruteCount = 1000;
+    PhysicalWorld bruteWorld;
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < bruteCount; i++) {
+        Shape* shape = bruteWorld.allocateShape<Circle>(1.0, 1.0, 0.0, 0.0);
+        shape->setName(bruteUniqueName(bruteWorld, "Circle"));
+        bruteWorld.addDynamicShape(shape);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double bruteMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  ShapeIndex: " << count << " 个未命名形状 " << indexMs << " ms，名称"
+              << (unique ? "全部唯一" : "有重复") << std::endl;
+    std::cout << "  逐个试探编号: " << bruteCount << " 个未命名形状 " << bruteMs << " ms" << std::endl;
+
+    bool ok = skipped && unique && lookups;
+    std::cout << "  结果: " << (ok ? "自动命名唯一 ✓" : "命名错误 ✗") << std::endl;
+    return ok;
+}
+
+// 测试5：只清空一个列表
+bool test_clear_one_list() {
+    printSeparator();
+    std::cout << "测试5：清空动态（或静态）形状后，另一类形状的名称和自动编号保持不变" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.placeDynamicShapeByType("Circle", "", 0.0, 0.0, 1.0, 1.0);    // Circle_1
+    world.placeDynamicShapeByType("Circle", "", 3.0, 0.0, 1.0, 1.0);    // Circle_2
+    world.placeWall("LeftWall", -10.0, 0.0, 1.0, 5.0);
+    world.placeWall("", 10.0, 0.0, 1.0, 5.0);                           // Wall_1
+
+    world.clearDynamicShapes();
+    bool staticKept = world.findStaticShapeByName("LeftWall") != nullptr && world.findStaticShapeByName("Wall_1") != nullptr
+                      && world.findStaticShapesByType("Wall").size() == 2 && world.findShapeByName("Circle_1") == nullptr;
+    Shape* circle = world.placeDynamicShapeByType("Circle", "", 0.0, 0.0, 1.0, 1.0);
+    bool dynamicCounter = circle->getName() == "Circle_3";
+    std::cout << "  清空动态形状后: 墙壁" << (staticKept ? "仍可查找" : "查找不到")
+              << "，新的圆命名为 " << circle->getName() << std::endl;
+
+    world.clearStaticShapes();
+    bool dynamicKept = world.findDynamicShapeByName("Circle_3") == circle && world.findStaticShapeByName("LeftWall") == nullptr
+                       && world.findDynamicShapesByType("Circle").size() == 1;
+    Wall* wall = world.placeWall("", 10.0, 0.0, 1.0, 5.0);
+    bool staticCounter = wall->getName() == "Wall_2";
+    std::cout << "  清空静态形状后: 圆" << (dynamicKept ? "仍可查找" : "查找不到")
+              << "，新的墙壁命名为 " << wall->getName() << std::endl;
+
+    world.clearAllShapes();
+    Shape* fresh = world.placeDynamicShapeByType("Circle", "", 0.0, 0.0, 1.0, 1.0);
+    bool reset = fresh->getName() == "Circle_1";
+    std::cout << "  清空所有形状后: 新的圆命名为 " << fresh->getName() << std::endl;
+
+    bool ok = staticKept && dynamicCounter && dynamicKept && staticCounter && reset;
+    std::cout << "  结果: " << (ok ? "只移出被清空的列表 ✓" : "索引被整体清空 ✗") << std::endl;
+    return ok;
+}
+
+// 测试6：同类型形状的删除
+bool test_remove_same_type() {
+    printSeparator();
+    std::cout << "测试6：10 万个同类型形状逐个移出" << std::endl;
+    printSeparator();
+
+    const int count = 100000;
+    ShapeIndex index;
+    std::vector<Circle*> shapes;
+    for (int i = 0; i < count; i++) {
+        shapes.push_back(new Circle(1.0, 0.5, 0.0, 0.0));
+        shapes.back()->setName("Ball_" + std::to_string(i));
+        index.add(shapes.back(), true);
+    }
+
+    // 先移出一半（步长 7 打乱顺序），剩下的形状按类型查找时仍按加入顺序
+    std::vector<bool> removed(count, false);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int k = 0; k < count / 2; k++) {
+        size_t victim = (static_cast<size_t>(k) * 7) % count;
+        index.remove(shapes[victim]);
+        removed[victim] = true;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double removeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::vector<Shape*> expected;
+    for (int i = 0; i < count; i++) {
+        if (!removed[i]) expected.push_back(shapes[i]);
+    }
+    bool ordered = index.findByType("Circle", true) == expected && expected.size() == static_cast<size_t>(count / 2);
+
+    for (int i = 0; i < count; i++) index.remove(shapes[i]);
+    bool empty = index.size() == 0 && index.findByType("Circle", true).empty();
+    for (int i = 0; i < count; i++) delete shapes[i];
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  移出 " << count / 2 << " 个: " << removeMs << " ms，剩余形状"
+              << (ordered ? "按加入顺序" : "顺序错误") << std::endl;
+
+    bool ok = ordered && empty && removeMs < 200.0;
+    std::cout << "  结果: " << (ok ? "移出不随同类型形状数量变慢 ✓" : "移出太慢或顺序错误 ✗") << std::endl;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_lookup_matches_scan()) passed++;
+    total++; if (test_direct_list_edits()) passed++;
+    total++; if (test_type_strings()) passed++;
+    total++; if (test_unique_names()) passed++;
+    total++; if (test_clear_one_list()) passed++;
+    total++; if (test_remove_same_type()) passed++;
+
+    printSeparator();
+    std::cout << "名称与类型索引测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
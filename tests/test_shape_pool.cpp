@@ -0,0 +1,273 @@
+/*=========================================================================================================
+ * 形状内存池测试 - 验证世界创建的形状来自 ShapePool，删除、清空时回收
+ *
+ * 测试场景：
+ * 1. 所有权：placeXxxShapeByType、placeWall、allocateShape 创建的形状属于世界，用户 new 的形状不属于
+ * 2. 空闲链表：删除形状后再创建同类形状，复用同一个槽位
+ * 3. 切换场景：反复创建 1000 个形状再 clearAllShapes，析构函数全部调用，内存不再增长
+ * 4. 频繁创建删除：50000 个休眠物体中每秒创建、删除数万个物体，稳定后不再向系统堆申请内存，与逐个 new / delete 比较耗时
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+// 统计系统堆的分配次数
+static size_t heapAllocations = 0;
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+// 析构时计数的圆
+static int destroyedCircles = 0;
+
+class CountedCircle : public Circle {
+public:
+    CountedCircle(double m, double r, double x, double y) : Circle(m, r, x, y) {}
+    ~CountedCircle() { destroyedCircles++; }
+};
+
+// 测试1：所有权
+bool test_ownership() {
+    printSeparator();
+    std::cout << "测试1：世界创建的形状属于内存池" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    Shape* ball = world.placeDynamicShapeByType("Circle", "Ball", 0.0, 10.0, 1.0, 0.5);
+    Shape* block = world.placeStaticShapeByType("Box", "Block", 5.0, 0.0, 1.0, 2.0, 1.0);
+    Wall* wall = world.placeWall("Wall", -5.0, 0.0, 0.5, 4.0);
+    AABB* crate = world.allocateShape<AABB>(1.0, 1.0, 1.0, 3.0, 10.0);
+    world.addDynamicShape(crate);
+    Circle* userBall = new Circle(1.0, 0.5, -3.0, 10.0);
+    world.addDynamicShape(userBall);
+
+    bool owned = world.ownsShape(ball) && world.ownsShape(block) && world.ownsShape(wall) && world.ownsShape(crate);
+    Circle copiedBall(*static_cast<Circle*>(ball));   // 复制出来的形状不属于池
+    bool userNotOwned = !world.ownsShape(userBall) && !world.ownsShape(&copiedBall) && world.getShapePool().size() == 4;
+    std::cout << "  placeDynamicShapeByType / placeStaticShapeByType / placeWall / allocateShape: "
+              << (owned ? "属于世界" : "不属于世界") << std::endl;
+    std::cout << "  用户 new 的形状、池中形状的副本: " << (userNotOwned ? "不属于世界" : "属于世界") << std::endl;
+
+    // 删除：池中的形状被回收，用户的形状保持可用
+    world.removeDynamicShape(ball);
+    world.removeStaticShape(wall);
+    world.removeDynamicShape(userBall);
+    double x, y;
+    userBall->getCentre(x, y);
+    bool removed = world.getShapePool().size() == 2 && x == -3.0 && y == 10.0;
+    std::cout << "  删除后池中剩余 " << world.getShapePool().size() << " 个形状，用户的形状仍在 ("
+              << x << ", " << y << ")" << std::endl;
+
+    bool ok = owned && userNotOwned && removed;
+    std::cout << "  结果: " << (ok ? "所有权正确 ✓" : "所有权错误 ✗") << std::endl;
+    delete userBall;
+    return ok;
+}
+
+// 测试2：空闲链表复用
+bool test_free_list_reuse() {
+    printSeparator();
+    std::cout << "测试2：删除后再创建，复用同一个槽位" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    std::vector<Shape*> balls;
+    for (int i = 0; i < 10; i++) {
+        Circle* ball = world.allocateShape<Circle>(1.0, 0.5, i * 2.0, 10.0);
+        world.addDynamicShape(ball);
+        balls.push_back(ball);
+    }
+    Shape* removed = balls[4];
+    world.removeDynamicShape(removed);
+    Circle* reused = world.allocateShape<Circle>(2.0, 1.0, 0.0, 0.0);
+    world.addDynamicShape(reused);
+
+    double r = reused->getRadius();
+    double m = reused->getMass();
+    bool sameSlot = static_cast<Shape*>(reused) == removed && r == 1.0 && m == 2.0;
+    size_t capacity = world.getShapePool().capacity();
+    std::cout << "  新形状复用了被删除形状的槽位: " << (sameSlot ? "是" : "否")
+              << "（半径 " << r << "，质量 " << m << "）" << std::endl;
+    std::cout << "  池容量 " << capacity << " 个槽位，存活 " << world.getShapePool().size() << " 个" << std::endl;
+
+    bool ok = sameSlot && world.getShapePool().size() == 10;
+    std::cout << "  结果: " << (ok ? "空闲链表复用正确 ✓" : "没有复用 ✗") << std::endl;
+    return ok;
+}
+
+// 测试3：切换场景
+bool test_scene_switch() {
+    printSeparator();
+    std::cout << "测试3：20 次切换场景（每次 1000 个形状 + 10 面墙）" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    destroyedCircles = 0;
+    size_t firstReserved = 0;
+    size_t lastReserved = 0;
+    bool allReleased = true;
+    for (int scene = 0; scene < 20; scene++) {
+        for (int i = 0; i < 1000; i++) {
+            CountedCircle* ball = world.allocateShape<CountedCircle>(1.0, 0.5, (i % 50) * 2.0, 10.0 + (i / 50) * 2.0);
+            world.addDynamicShape(ball);
+        }
+        for (int w = 0; w < 10; w++) {
+            world.placeWall("Wall" + std::to_string(w), w * 20.0, 0.0, 0.5, 4.0);
+        }
+        for (int step = 0; step < 5; step++) {
+            world.update(world.dynamicShapeList, world.ground);
+        }
+        world.clearAllShapes();
+        allReleased = allReleased && world.getShapePool().size() == 0 && world.getTotalShapeCount() == 0;
+        if (scene == 0) firstReserved = world.getShapePool().reservedBytes();
+        lastReserved = world.getShapePool().reservedBytes();
+    }
+
+    std::cout << "  析构的圆: " << destroyedCircles << " / 20000" << std::endl;
+    std::cout << "  池占用: 第 1 次切换后 " << firstReserved / 1024 << " KB，第 20 次切换后 "
+              << lastReserved / 1024 << " KB" << std::endl;
+
+    bool ok = allReleased && destroyedCircles == 20000 && lastReserved == firstReserved;
+    std::cout << "  结果: " << (ok ? "一次性释放，内存不增长 ✓" : "有泄漏或增长 ✗") << std::endl;
+    return ok;
+}
+
+// 测试4：频繁创建删除
+// 物体都在休眠（删除物体时要唤醒被它支撑的休眠物体），第 i 个物体总是放在同一个位置
+Shape* spawnPooled(PhysicalWorld& world, int index, bool circle) {
+    double x = (index % 500) * 2.0, y = 10.0 + (index / 500) * 2.0;
+    if (circle) return world.allocateShape<Circle>(1.0, 0.5, x, y);
+    return world.allocateShape<AABB>(1.0, 1.0, 1.0, x, y);
+}
+
+Shape* spawnHeap(int index, bool circle) {
+    double x = (index % 500) * 2.0, y = 10.0 + (index / 500) * 2.0;
+    if (circle) return new Circle(1.0, 0.5, x, y);
+    return new AABB(1.0, 1.0, 1.0, x, y);
+}
+
+void sleepAll(PhysicalWorld& world) {
+    for (size_t i = 0; i < world.dynamicShapeList.size(); i++) {
+        world.dynamicShapeList[i]->putToSleep();
+    }
+    world.update(world.dynamicShapeList, world.ground);
+}
+
+bool test_spawn_despawn() {
+    printSeparator();
+    std::cout << "测试4：50000 个休眠的物体，每批创建、删除 500 个，共 40 批" << std::endl;
+    printSeparator();
+
+    const int live = 50000, batch = 500, batches = 40;
+    PhysicalWorld world;
+    world.setSleepingEnabled(true);
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < live; i++) {
+        shapes.push_back(spawnPooled(world, i, true));
+        world.addDynamicShape(shapes.back());
+    }
+    // 先按同样的方式把所有物体替换一遍，之后各容器的容量已经稳定
+    sleepAll(world);
+    for (int index = 0; index < live; index++) {
+        world.removeDynamicShape(shapes[index]);
+        shapes[index] = spawnPooled(world, index, index % 2 == 0);
+        world.addDynamicShape(shapes[index]);
+    }
+    sleepAll(world);
+
+    size_t allocationsBefore = heapAllocations;
+    size_t reservedBefore = world.getShapePool().reservedBytes();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int b = 0; b < batches; b++) {
+        for (int k = 0; k < batch; k++) {
+            int index = (b * batch + k) % live;
+            world.removeDynamicShape(shapes[index]);
+            shapes[index] = spawnPooled(world, index, k % 2 == 0);
+            world.addDynamicShape(shapes[index]);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double poolMs = std::chrono::duration<double, std::milli>(end - start).count();
+    size_t poolAllocations = heapAllocations - allocationsBefore;
+    size_t reservedAfter = world.getShapePool().reservedBytes();
+
+    // 对照：同样的操作，用户逐个 new / delete
+    PhysicalWorld heapWorld;
+    heapWorld.setSleepingEnabled(true);
+    std::vector<Shape*> heapShapes;
+    for (int i = 0; i < live; i++) {
+        heapShapes.push_back(spawnHeap(i, true));
+        heapWorld.addDynamicShape(heapShapes.back());
+    }
+    sleepAll(heapWorld);
+    allocationsBefore = heapAllocations;
+    start = std::chrono::high_resolution_clock::now();
+    for (int b = 0; b < batches; b++) {
+        for (int k = 0; k < batch; k++) {
+            int index = (b * batch + k) % live;
+            heapWorld.removeDynamicShape(heapShapes[index]);
+            delete heapShapes[index];
+            heapShapes[index] = spawnHeap(index, k % 2 == 0);
+            heapWorld.addDynamicShape(heapShapes[index]);
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double heapMs = std::chrono::duration<double, std::milli>(end - start).count();
+    size_t heapCount = heapAllocations - allocationsBefore;
+    for (size_t i = 0; i < heapShapes.size(); i++) {
+        heapWorld.removeDynamicShape(heapShapes[i]);
+        delete heapShapes[i];
+    }
+
+    const double operations = static_cast<double>(batch) * batches;
+    const double perSecond = operations / (poolMs / 1000.0);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  内存池: " << poolMs << " ms，系统堆分配 " << poolAllocations << " 次，池占用 "
+              << reservedBefore / 1024 << " KB -> " << reservedAfter / 1024 << " KB" << std::endl;
+    std::cout << "  逐个 new / delete: " << heapMs << " ms，系统堆分配 " << heapCount << " 次" << std::endl;
+    std::cout << "  吞吐量: " << std::setprecision(0) << perSecond << " 次创建删除/秒" << std::endl;
+
+    bool noHeap = poolAllocations == 0 && reservedAfter == reservedBefore && world.getShapePool().size() == static_cast<size_t>(live);
+    bool fast = perSecond >= 20000.0;   // 每秒数万次
+    std::cout << "  结果: " << (noHeap ? "稳定后不再分配系统堆内存 ✓" : "仍在分配系统堆内存 ✗") << std::endl;
+    std::cout << "  结果: " << (fast ? "每秒可创建删除数万个物体 ✓" : "创建删除太慢 ✗") << std::endl;
+    return noHeap && fast;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_ownership()) passed++;
+    total++; if (test_free_list_reuse()) passed++;
+    total++; if (test_scene_switch()) passed++;
+    total++; if (test_spawn_despawn()) passed++;
+
+    printSeparator();
+    std::cout << "形状内存池测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
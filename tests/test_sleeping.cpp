@@ -0,0 +1,469 @@
+/*=========================================================================================================
+ * 休眠测试 - 验证静止物体的休眠与唤醒
+ *
+ * 测试场景：
+ * 1. 进入休眠：放在地面上的方块静止约 60 步后进入休眠
+ * 2. 跳过计算：休眠的物体不再积分，位置保持不变
+ * 3. 主动唤醒：setVelocity / applyImpulse / move 会唤醒休眠的物体
+ * 4. 接触唤醒：下落的圆砸到休眠的一摞方块上，整摞方块一起醒来
+ * 5. 按岛休眠：岛内还有物体在运动时，静止的物体也不休眠
+ * 6. 性能：大量静止物体休眠后单步耗时明显下降
+ * 7. 改变受力唤醒：静止后再倾斜世界，休眠的方块醒来并沿斜面滑动，与关闭休眠时结果一致
+ * 8. 宽相位只处理清醒的物体：推动一摞中的一个方块，只有这一摞醒来并进入宽相位
+ * 9. 删除支撑物：删除休眠的一摞方块中间的一块，上面的方块醒来并落到底层方块上
+ * 10. 约束相连：距离约束连接的两个圆一起休眠；推动其中一个，另一个随之醒来并被约束拉动
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+void setupWorld(PhysicalWorld& world) {
+    world.setGravity(10.0);
+    world.ground.setYLevel(0.0);
+    world.ground.setFriction(0.3, 0.4);
+}
+
+AABB* makeBlock(double x, double y, double width = 2.0) {
+    AABB* block = new AABB(1.0, width, 1.0, x, y);
+    block->setFraction(0.3);
+    block->setStaticFraction(0.4);
+    return block;
+}
+
+// 运行到所有物体休眠为止，返回所用步数（超过 maxSteps 返回 -1）
+int stepUntilAllSleeping(PhysicalWorld& world, int maxSteps) {
+    for (int step = 1; step <= maxSteps; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        if (world.getSleepingShapeCount() == world.dynamicShapeList.size()) return step;
+    }
+    return -1;
+}
+
+// 测试1：进入休眠
+bool test_fall_asleep() {
+    printSeparator();
+    std::cout << "测试1：地面上的方块静止后进入休眠" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    setupWorld(world);
+    AABB* block = makeBlock(0.0, 0.5);
+    world.addDynamicShape(block);
+
+    int steps = stepUntilAllSleeping(world, 200);
+    std::cout << "  进入休眠所用步数: " << steps << "（设置的连续静止步数 60）" << std::endl;
+
+    bool ok = steps >= 60 && steps <= 70 && block->isSleeping();
+    std::cout << "  结果: " << (ok ? "静止后进入休眠 ✓" : "没有按时休眠 ✗") << std::endl;
+
+    delete block;
+    return ok;
+}
+
+// 测试2：跳过计算
+bool test_sleeping_skipped() {
+    printSeparator();
+    std::cout << "测试2：休眠的物体不再积分" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    setupWorld(world);
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < 5; i++) {
+        AABB* block = makeBlock(i * 3.0, 0.5);
+        shapes.push_back(block);
+        world.addDynamicShape(block);
+    }
+    stepUntilAllSleeping(world, 200);
+
+    std::vector<double> before;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double x, y;
+        shapes[i]->getCentre(x, y);
+        before.push_back(x);
+        before.push_back(y);
+    }
+    for (int step = 0; step < 300; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+
+    bool frozen = true;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double x, y, vx, vy;
+        shapes[i]->getCentre(x, y);
+        shapes[i]->getVelocity(vx, vy);
+        if (x != before[2 * i] || y != before[2 * i + 1] || vx != 0.0 || vy != 0.0 || !shapes[i]->isSleeping()) {
+            frozen = false;
+        }
+    }
+    std::cout << "  300 步后休眠物体数量: " << world.getSleepingShapeCount() << "/" << shapes.size()
+              << "，位置" << (frozen ? "保持不变" : "发生了变化") << std::endl;
+
+    bool ok = frozen && world.getSleepingShapeCount() == shapes.size();
+    std::cout << "  结果: " << (ok ? "休眠物体被跳过 ✓" : "休眠物体仍在计算 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试3：主动唤醒
+bool test_wake_on_api() {
+    printSeparator();
+    std::cout << "测试3：setVelocity / applyImpulse / move 唤醒休眠的物体" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    setupWorld(world);
+    AABB* a = makeBlock(0.0, 0.5);
+    AABB* b = makeBlock(10.0, 0.5);
+    world.addDynamicShape(a);
+    world.addDynamicShape(b);
+    stepUntilAllSleeping(world, 200);
+    bool asleep = a->isSleeping() && b->isSleeping();
+
+    a->setVelocity(3.0, 0.0);
+    b->applyImpulse(3.0, 0.0);
+    bool woken = !a->isSleeping() && !b->isSleeping();
+
+    world.update(world.dynamicShapeList, world.ground);
+    double ax, ay, bx, by;
+    a->getCentre(ax, ay);
+    b->getCentre(bx, by);
+    bool moved = ax > 0.0 && bx > 10.0;
+    std::cout << "  唤醒后第一步: A.x = " << ax << "，B.x = " << bx << std::endl;
+
+    // move 同样唤醒：把已经休眠的方块抬起来，它应该醒来并下落
+    AABB* c = makeBlock(20.0, 0.5);
+    world.addDynamicShape(c);
+    stepUntilAllSleeping(world, 300);
+    c->move(0.0, 2.0);
+    woken = woken && !c->isSleeping();
+    world.update(world.dynamicShapeList, world.ground);
+    double cx, cy;
+    c->getCentre(cx, cy);
+    moved = moved && cy < 2.5;
+    std::cout << "  move 抬起后第一步: C.y = " << cy << std::endl;
+
+    bool ok = asleep && woken && moved;
+    std::cout << "  结果: " << (ok ? "三个物体都被唤醒并开始运动 ✓" : "没有被唤醒 ✗") << std::endl;
+
+    delete a;
+    delete b;
+    delete c;
+    return ok;
+}
+
+// 测试4：接触唤醒
+bool test_wake_on_contact() {
+    printSeparator();
+    std::cout << "测试4：下落的圆砸到休眠的一摞方块上" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    setupWorld(world);
+    std::vector<Shape*> shapes;
+    for (int level = 0; level < 3; level++) {
+        AABB* block = makeBlock(0.0, 0.5 + level * 1.0);
+        shapes.push_back(block);
+        world.addDynamicShape(block);
+    }
+    stepUntilAllSleeping(world, 300);
+    size_t sleepingBefore = world.getSleepingShapeCount();
+
+    Circle* ball = new Circle(1.0, 0.4, 0.0, 6.0, 0.0, -5.0);
+    shapes.push_back(ball);
+    world.addDynamicShape(ball);
+
+    bool allWoken = false;
+    for (int step = 0; step < 60 && !allWoken; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        allWoken = !shapes[0]->isSleeping() && !shapes[1]->isSleeping() && !shapes[2]->isSleeping();
+    }
+    std::cout << "  砸中之前休眠的方块: " << sleepingBefore << "/3，砸中后"
+              << (allWoken ? "整摞方块都醒来" : "仍有方块在休眠") << std::endl;
+
+    bool ok = sleepingBefore == 3 && allWoken && world.getSleepingShapeCount() == 0;
+    std::cout << "  结果: " << (ok ? "接触唤醒整座岛 ✓" : "唤醒没有传播 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试5：按岛休眠
+bool test_island_stays_awake() {
+    printSeparator();
+    std::cout << "测试5：岛内有物体运动时整座岛保持清醒" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    setupWorld(world);
+    world.ground.setFriction(0.0, 0.0);
+    AABB* base = makeBlock(0.0, 0.5, 20.0);
+    base->setFraction(0.0);
+    base->setStaticFraction(0.0);
+    AABB* slider = new AABB(1.0, 1.0, 1.0, -5.0, 1.5, 0.5, 0.0);
+    slider->setFraction(0.0);
+    slider->setStaticFraction(0.0);
+    world.addDynamicShape(base);
+    world.addDynamicShape(slider);
+
+    bool baseSlept = false;
+    for (int step = 0; step < 240; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        if (base->isSleeping()) baseSlept = true;
+    }
+    double x, y;
+    slider->getCentre(x, y);
+    std::cout << "  240 步内底座" << (baseSlept ? "进入过休眠" : "一直清醒") << "，滑块 x = " << x << std::endl;
+
+    bool ok = !baseSlept && x > -4.0;
+    std::cout << "  结果: " << (ok ? "整座岛一起判断是否休眠 ✓" : "岛内物体单独休眠 ✗") << std::endl;
+
+    delete base;
+    delete slider;
+    return ok;
+}
+
+// 测试7：改变受力唤醒
+// 方块在地面上静止（开启休眠时已进入休眠）后把世界倾斜 40°，再运行 120 步，返回方块的 x 坐标和 x 方向速度
+void tiltSettledBlock(bool sleeping, double& x, double& vx, bool& sleptBeforeTilt) {
+    PhysicalWorld world;
+    setupWorld(world);
+    world.setSleepingEnabled(sleeping);
+    AABB* block = makeBlock(0.0, 0.5);
+    world.addDynamicShape(block);
+    for (int step = 0; step < 120; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    sleptBeforeTilt = block->isSleeping();
+
+    world.setInclineAngle(40.0);
+    for (int step = 0; step < 120; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    double y, vy;
+    block->getCentre(x, y);
+    block->getVelocity(vx, vy);
+    delete block;
+}
+
+bool test_wake_on_tilt() {
+    printSeparator();
+    std::cout << "测试7：静止后倾斜世界，休眠的方块醒来并滑动" << std::endl;
+    printSeparator();
+
+    double x, vx, refX, refVx;
+    bool slept, unused;
+    tiltSettledBlock(true, x, vx, slept);
+    tiltSettledBlock(false, refX, refVx, unused);
+    std::cout << "  开启休眠: x = " << x << "，vx = " << vx << "（倾斜前" << (slept ? "已休眠" : "未休眠") << "）" << std::endl;
+    std::cout << "  关闭休眠: x = " << refX << "，vx = " << refVx << std::endl;
+
+    bool ok = slept && std::fabs(x) > 1.0 && std::fabs(vx) > 1.0
+           && std::fabs(x - refX) < 1e-6 && std::fabs(vx - refVx) < 1e-6;
+    std::cout << "  结果: " << (ok ? "倾斜后唤醒，结果与不休眠一致 ✓" : "休眠改变了运动结果 ✗") << std::endl;
+    return ok;
+}
+
+// 测试6：性能
+double timeRestingScene(bool sleeping, int count) {
+    PhysicalWorld world;
+    setupWorld(world);
+    world.setSleepingEnabled(sleeping);
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < count; i++) {
+        AABB* block = makeBlock((i % 100) * 3.0, 0.5 + (i / 100) * 1.0);
+        shapes.push_back(block);
+        world.addDynamicShape(block);
+    }
+    for (int step = 0; step < 120; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+
+    const int steps = 60;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < steps; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    deleteShapes(shapes);
+    return std::chrono::duration<double, std::milli>(end - start).count() / steps;
+}
+
+bool test_sleeping_performance() {
+    printSeparator();
+    std::cout << "测试6：1000 个静止方块（100 摞 × 10 层）的单步耗时" << std::endl;
+    printSeparator();
+
+    double awake = timeRestingScene(false, 1000);
+    double sleeping = timeRestingScene(true, 1000);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  关闭休眠: " << awake << " ms/步" << std::endl;
+    std::cout << "  开启休眠: " << sleeping << " ms/步" << std::endl;
+    std::cout << "  加速比: " << std::setprecision(2) << awake / sleeping << "x" << std::endl;
+
+    bool ok = sleeping < awake;
+    std::cout << "  结果: " << (ok ? "休眠后单步耗时下降 ✓" : "没有加速 ✗") << std::endl;
+    return ok;
+}
+
+// 测试8：休眠的物体不进入宽相位
+bool test_broadphase_awake_only() {
+    printSeparator();
+    std::cout << "测试8：1000 个休眠的方块中推动一摞的顶层方块" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    setupWorld(world);
+    world.setSleepingEnabled(true);
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < 1000; i++) {
+        AABB* block = makeBlock((i % 100) * 3.0, 0.5 + (i / 100) * 1.0);
+        shapes.push_back(block);
+        world.addDynamicShape(block);
+    }
+    bool allAsleep = stepUntilAllSleeping(world, 300) > 0;
+
+    // 全部休眠：整步跳过，宽相位没有物体
+    world.update(world.dynamicShapeList, world.ground);
+    size_t idleShapes = world.getBroadphaseStats().shapeCount;
+
+    // 推动第 0 摞的顶层方块：它碰到的下一层方块一起醒来，其他 99 摞保持休眠
+    shapes[900]->setVelocity(0.5, 0.0);
+    world.update(world.dynamicShapeList, world.ground);
+    size_t activeShapes = world.getBroadphaseStats().shapeCount;
+    size_t sleeping = world.getSleepingShapeCount();
+
+    std::cout << "  全部休眠时宽相位物体数: " << idleShapes << std::endl;
+    std::cout << "  推动后宽相位物体数: " << activeShapes << "，休眠物体数: " << sleeping << std::endl;
+
+    bool ok = allAsleep && idleShapes == 0 && activeShapes > 0 && activeShapes <= 10 && sleeping >= 990;
+    std::cout << "  结果: " << (ok ? "只有被推动的一摞进入宽相位 ✓" : "休眠的物体进入了宽相位 ✗") << std::endl;
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试9：删除支撑物
+bool test_wake_on_remove_supporter() {
+    printSeparator();
+    std::cout << "测试9：删除休眠的三层方块中间的一块" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    setupWorld(world);
+    std::vector<Shape*> shapes;
+    for (int level = 0; level < 3; level++) {
+        AABB* block = makeBlock(0.0, 0.5 + level * 1.0);
+        shapes.push_back(block);
+        world.addDynamicShape(block);
+    }
+    bool allAsleep = stepUntilAllSleeping(world, 300) > 0;
+
+    world.removeDynamicShape(shapes[1]);
+    bool topWoken = !shapes[2]->isSleeping();
+    double lowest = 2.5;
+    for (int step = 0; step < 60; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        double x, y;
+        shapes[2]->getCentre(x, y);
+        lowest = std::min(lowest, y);
+    }
+    std::cout << "  删除后顶层方块" << (topWoken ? "醒来" : "仍在休眠") << "，最低高度 y = "
+              << std::fixed << std::setprecision(3) << lowest << "（落到底层方块上为 1.5）" << std::endl;
+
+    bool ok = allAsleep && topWoken && lowest < 1.6;
+    std::cout << "  结果: " << (ok ? "失去支撑的方块醒来下落 ✓" : "方块悬在空中 ✗") << std::endl;
+
+    delete shapes[0];
+    delete shapes[1];
+    delete shapes[2];
+    return ok;
+}
+
+// 测试10：约束相连的物体一起休眠、一起醒来
+bool test_constraint_sleep_together() {
+    printSeparator();
+    std::cout << "测试10：距离约束连接的两个圆一起休眠、一起醒来" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    setupWorld(world);
+    Circle* a = new Circle(1.0, 0.5, 0.0, 0.5);
+    Circle* b = new Circle(1.0, 0.5, 3.0, 0.5);
+    world.addDynamicShape(a);
+    world.addDynamicShape(b);
+    world.addDistanceConstraint(a, b, 3.0);
+
+    // 只有一端休眠的步数（应当始终为 0）
+    int splitSteps = 0;
+    bool allAsleep = false;
+    for (int step = 0; step < 300 && !allAsleep; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        if (a->isSleeping() != b->isSleeping()) splitSteps++;
+        allAsleep = a->isSleeping() && b->isSleeping();
+    }
+
+    double bx0, by0;
+    b->getCentre(bx0, by0);
+    a->setVelocity(-5.0, 0.0);
+    world.update(world.dynamicShapeList, world.ground);
+    bool bWoken = !b->isSleeping();
+    for (int step = 0; step < 30; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        if (a->isSleeping() != b->isSleeping()) splitSteps++;
+    }
+    double ax, ay, bx, by;
+    a->getCentre(ax, ay);
+    b->getCentre(bx, by);
+    double length = std::hypot(bx - ax, by - ay);
+    std::cout << "  推动 a 后 b " << (bWoken ? "醒来" : "仍在休眠") << "，30 步后 b 移动 "
+              << std::fixed << std::setprecision(3) << bx0 - bx << " m，两圆距离 " << length
+              << "，只有一端休眠的步数 " << splitSteps << std::endl;
+
+    bool ok = allAsleep && bWoken && bx0 - bx > 0.5 && std::fabs(length - 3.0) < 1e-3 && splitSteps == 0;
+    std::cout << "  结果: " << (ok ? "约束两端一起休眠、一起醒来 ✓" : "约束一端休眠、一端清醒 ✗") << std::endl;
+
+    delete a;
+    delete b;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_fall_asleep()) passed++;
+    total++; if (test_sleeping_skipped()) passed++;
+    total++; if (test_wake_on_api()) passed++;
+    total++; if (test_wake_on_contact()) passed++;
+    total++; if (test_island_stays_awake()) passed++;
+    total++; if (test_sleeping_performance()) passed++;
+    total++; if (test_wake_on_tilt()) passed++;
+    total++; if (test_broadphase_awake_only()) passed++;
+    total++; if (test_wake_on_remove_supporter()) passed++;
+    total++; if (test_constraint_sleep_together()) passed++;
+
+    printSeparator();
+    std::cout << "休眠测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,404 @@
+/*=========================================================================================================
+ * 空间查询测试 - 验证 queryPoint / queryAABB / queryRadius / raycast / raycastAll
+ *
+ * 测试场景：
+ * 1. 区域查询：随机的点、矩形区域和圆形区域，结果与逐个判断所有形状完全相同（包括顺序）
+ * 2. 索引更新：模拟若干步、增删动态物体、在两步之间移动物体之后，结果仍然正确
+ * 3. 射线检测：命中圆和矩形的位置、法向，起点在形状内部，所有命中按距离排序
+ * 4. 随机射线：最近的命中和所有命中与逐个判断所有形状相同
+ * 5. 性能：5000 个形状上 10000 次点查询，空间查询与逐个判断的耗时
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+bool near(double a, double b, double eps = 1e-9) {
+    return std::abs(a - b) < eps;
+}
+
+// 线性同余随机数（结果与平台无关）
+struct Random {
+    unsigned long long state;
+    explicit Random(unsigned long long seed) : state(seed) {}
+    double next(double lo, double hi) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return lo + (hi - lo) * static_cast<double>(state >> 11) / 9007199254740992.0;
+    }
+};
+
+// 测试场景：count 个随机的圆和方块（动态），以及一些墙壁（静态）
+void buildScene(PhysicalWorld& world, std::vector<Shape*>& shapes, int count, Random& random) {
+    world.setGravity(0.0);
+    world.setSleepingEnabled(false);
+    world.setBounds(-10000.0, 10000.0, -10000.0, 10000.0);
+    for (int i = 0; i < count; i++) {
+        double x = random.next(0.0, 200.0), y = random.next(0.0, 200.0);
+        double vx = random.next(-5.0, 5.0), vy = random.next(-5.0, 5.0);
+        Shape* shape;
+        if (i % 2 == 0) {
+            shape = new Circle(1.0, random.next(0.3, 2.0), x, y, vx, vy);
+        } else {
+            shape = new AABB(1.0, random.next(0.5, 3.0), random.next(0.5, 3.0), x, y, vx, vy);
+        }
+        shapes.push_back(shape);
+        world.addDynamicShape(shape);
+    }
+    for (int w = 0; w < count / 10; w++) {
+        world.placeWall("Wall" + std::to_string(w), random.next(0.0, 200.0), random.next(0.0, 200.0),
+                        random.next(0.2, 1.0), random.next(2.0, 10.0));
+    }
+}
+
+void deleteScene(PhysicalWorld& world, std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) delete shapes[i];
+    shapes.clear();
+    // 墙壁由 placeWall 创建，属于世界
+}
+
+// 逐个判断：点到形状的距离（圆按圆，其他按包围盒）
+double bruteDistance(const Shape& shape, double x, double y) {
+    double cx, cy;
+    shape.getCentre(cx, cy);
+    if (shape.getKind() == SHAPE_CIRCLE) {
+        double d = std::sqrt((x - cx) * (x - cx) + (y - cy) * (y - cy)) - static_cast<const Circle&>(shape).getRadius();
+        return std::max(d, 0.0);
+    }
+    double minX, minY, maxX, maxY;
+    shape.getBoundingBox(minX, minY, maxX, maxY);
+    double dx = std::max(std::max(minX - x, x - maxX), 0.0);
+    double dy = std::max(std::max(minY - y, y - maxY), 0.0);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// 逐个判断：按 dynamicShapeList、staticShapeList 的顺序
+std::vector<Shape*> bruteRadius(PhysicalWorld& world, double x, double y, double radius) {
+    std::vector<Shape*> result;
+    for (size_t i = 0; i < world.dynamicShapeList.size(); i++) {
+        if (bruteDistance(*world.dynamicShapeList[i], x, y) <= radius) result.push_back(world.dynamicShapeList[i]);
+    }
+    for (size_t i = 0; i < world.staticShapeList.size(); i++) {
+        if (bruteDistance(*world.staticShapeList[i], x, y) <= radius) result.push_back(world.staticShapeList[i]);
+    }
+    return result;
+}
+
+std::vector<Shape*> bruteAABB(PhysicalWorld& world, const BroadphaseBounds& area) {
+    std::vector<Shape*> result;
+    const std::vector<Shape*>* lists[2] = {&world.dynamicShapeList, &world.staticShapeList};
+    for (int k = 0; k < 2; k++) {
+        for (size_t i = 0; i < lists[k]->size(); i++) {
+            BroadphaseBounds b;
+            (*lists[k])[i]->getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+            if (b.overlaps(area)) result.push_back((*lists[k])[i]);
+        }
+    }
+    return result;
+}
+
+// 随机的点、矩形、圆形查询与逐个判断比较
+bool compareAreaQueries(PhysicalWorld& world, Random& random, int queries, size_t& totalHits) {
+    std::vector<Shape*> found;
+    bool allMatch = true;
+    for (int q = 0; q < queries; q++) {
+        double x = random.next(-10.0, 210.0), y = random.next(-10.0, 210.0);
+
+        found.clear();
+        totalHits += world.queryPoint(x, y, found);
+        if (found != bruteRadius(world, x, y, 0.0)) allMatch = false;
+
+        double radius = random.next(0.5, 15.0);
+        found.clear();
+        totalHits += world.queryRadius(x, y, radius, found);
+        if (found != bruteRadius(world, x, y, radius)) allMatch = false;
+
+        BroadphaseBounds area;
+        area.minX = x;
+        area.minY = y;
+        area.maxX = x + random.next(0.0, 20.0);
+        area.maxY = y + random.next(0.0, 20.0);
+        found.clear();
+        totalHits += world.queryAABB(area, found);
+        if (found != bruteAABB(world, area)) allMatch = false;
+    }
+    return allMatch;
+}
+
+// 测试1：区域查询
+bool test_area_queries() {
+    printSeparator();
+    std::cout << "测试1：点、矩形区域、圆形区域查询与逐个判断相同" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    std::vector<Shape*> shapes;
+    Random random(12345);
+    buildScene(world, shapes, 500, random);
+
+    size_t hits = 0;
+    bool ok = compareAreaQueries(world, random, 1000, hits);
+    std::cout << "  500 个动态物体、50 面墙，3000 次查询，命中 " << hits << " 次" << std::endl;
+    ok = ok && hits > 0;
+    std::cout << "  结果: " << (ok ? "与逐个判断相同 ✓" : "结果不同 ✗") << std::endl;
+
+    deleteScene(world, shapes);
+    return ok;
+}
+
+// 测试2：索引更新
+bool test_index_refresh() {
+    printSeparator();
+    std::cout << "测试2：模拟、增删物体、手动移动物体之后的查询" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    std::vector<Shape*> shapes;
+    Random random(777);
+    buildScene(world, shapes, 300, random);
+
+    size_t hits = 0;
+    bool afterSteps = true;
+    for (int round = 0; round < 5; round++) {
+        for (int step = 0; step < 30; step++) {
+            world.update(world.dynamicShapeList, world.ground);
+        }
+        afterSteps = compareAreaQueries(world, random, 200, hits) && afterSteps;
+    }
+    std::cout << "  每 30 步查询一次（共 150 步）: " << (afterSteps ? "正确" : "错误") << std::endl;
+
+    // 增删动态物体
+    world.removeDynamicShape(shapes[0]);
+    world.removeDynamicShape(shapes[10]);
+    Circle* extra = new Circle(1.0, 3.0, 100.0, 100.0);
+    world.addDynamicShape(extra);
+    bool afterEdits = compareAreaQueries(world, random, 200, hits);
+    std::vector<Shape*> found;
+    world.queryPoint(100.0, 100.0, found);
+    afterEdits = afterEdits && std::find(found.begin(), found.end(), extra) != found.end();
+    std::cout << "  增删动态物体之后: " << (afterEdits ? "正确" : "错误") << std::endl;
+
+    // 两步之间直接移动物体
+    extra->setCentre(-500.0, -500.0);
+    world.invalidateSpatialIndex();
+    found.clear();
+    world.queryPoint(-500.0, -500.0, found);
+    bool afterMove = found.size() == 1 && found[0] == extra;
+    found.clear();
+    world.queryPoint(100.0, 100.0, found);
+    afterMove = afterMove && std::find(found.begin(), found.end(), extra) == found.end();
+    std::cout << "  setCentre + invalidateSpatialIndex 之后: " << (afterMove ? "正确" : "错误") << std::endl;
+
+    bool ok = afterSteps && afterEdits && afterMove;
+    std::cout << "  结果: " << (ok ? "索引随物体更新 ✓" : "索引过期 ✗") << std::endl;
+
+    delete extra;
+    deleteScene(world, shapes);
+    return ok;
+}
+
+// 测试3：射线检测
+bool test_raycast_basic() {
+    printSeparator();
+    std::cout << "测试3：射线命中圆和矩形" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    Circle* circle = new Circle(1.0, 1.0, 10.0, 0.0);
+    AABB* box = new AABB(1.0, 2.0, 4.0, 20.0, 0.0);
+    world.addDynamicShape(circle);
+    world.addDynamicShape(box);
+    Wall* wall = world.placeWall("Wall", 30.0, 0.0, 1.0, 10.0);
+
+    bool ok = true;
+    RaycastHit hit;
+
+    // 沿 x 轴：先碰到圆的左端 (9, 0)
+    bool found = world.raycast(0.0, 0.0, 40.0, 0.0, hit);
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "  (0,0)→(40,0): 命中 " << (found ? hit.shape->getType() : "无") << "，点 (" << hit.x << ", " << hit.y
+              << ")，法向 (" << hit.nx << ", " << hit.ny << ")" << std::endl;
+    ok = ok && found && hit.shape == circle && near(hit.fraction, 9.0 / 40.0) && near(hit.nx, -1.0) && near(hit.ny, 0.0);
+
+    // 从上往下：碰到方块的顶面 y = 2
+    found = world.raycast(20.5, 10.0, 20.5, -10.0, hit);
+    std::cout << "  (20.5,10)→(20.5,-10): 命中 " << (found ? hit.shape->getType() : "无") << "，点 (" << hit.x << ", " << hit.y
+              << ")，法向 (" << hit.nx << ", " << hit.ny << ")" << std::endl;
+    ok = ok && found && hit.shape == box && near(hit.y, 2.0) && near(hit.nx, 0.0) && near(hit.ny, 1.0);
+
+    // 起点在圆内部
+    found = world.raycast(10.0, 0.0, 10.0, 5.0, hit);
+    std::cout << "  起点在圆内: fraction = " << hit.fraction << std::endl;
+    ok = ok && found && hit.shape == circle && hit.fraction == 0.0;
+
+    // 错过所有形状
+    found = world.raycast(0.0, 20.0, 40.0, 20.0, hit);
+    std::cout << "  (0,20)→(40,20): " << (found ? "命中 ✗" : "未命中") << std::endl;
+    ok = ok && !found;
+
+    // 所有命中：圆、方块、墙壁按距离排序
+    std::vector<RaycastHit> hits;
+    size_t count = world.raycastAll(0.0, 0.0, 40.0, 0.0, hits);
+    std::cout << "  raycastAll 命中 " << count << " 个:";
+    for (size_t k = 0; k < hits.size(); k++) std::cout << " " << hits[k].shape->getType() << "@" << hits[k].fraction;
+    std::cout << std::endl;
+    ok = ok && count == 3 && hits[0].shape == circle && hits[1].shape == box && hits[2].shape == wall
+            && near(hits[1].x, 19.0) && near(hits[2].x, 29.5);
+
+    std::cout << "  结果: " << (ok ? "命中位置和法向正确 ✓" : "射线检测错误 ✗") << std::endl;
+
+    delete circle;
+    delete box;
+    return ok;
+}
+
+// 逐个判断：线段与形状的第一个交点
+bool bruteRaycastShape(const Shape& shape, double x0, double y0, double dx, double dy, double& t) {
+    if (shape.getKind() == SHAPE_CIRCLE) {
+        double cx, cy;
+        shape.getCentre(cx, cy);
+        double r = static_cast<const Circle&>(shape).getRadius();
+        double fx = x0 - cx, fy = y0 - cy;
+        double c = fx * fx + fy * fy - r * r;
+        if (c <= 0.0) { t = 0.0; return true; }
+        double a = dx * dx + dy * dy, b = fx * dx + fy * dy;
+        double disc = b * b - a * c;
+        if (b >= 0.0 || disc < 0.0) return false;
+        t = (-b - std::sqrt(disc)) / a;
+        return t <= 1.0;
+    }
+    BroadphaseBounds b;
+    shape.getBoundingBox(b.minX, b.minY, b.maxX, b.maxY);
+    return b.intersectsSegment(x0, y0, dx, dy, t);
+}
+
+// 测试4：随机射线
+bool test_raycast_random() {
+    printSeparator();
+    std::cout << "测试4：随机射线与逐个判断相同" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    std::vector<Shape*> shapes;
+    Random random(4242);
+    buildScene(world, shapes, 500, random);
+    for (int step = 0; step < 20; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+
+    bool allMatch = true;
+    size_t totalHits = 0;
+    std::vector<RaycastHit> hits;
+    for (int q = 0; q < 500; q++) {
+        double x0 = random.next(-10.0, 210.0), y0 = random.next(-10.0, 210.0);
+        double x1 = random.next(-10.0, 210.0), y1 = random.next(-10.0, 210.0);
+
+        // 逐个判断：所有命中的 (t, 形状)，按 t 排序，t 相同时保持列表顺序
+        std::vector<std::pair<double, Shape*> > expected;
+        const std::vector<Shape*>* lists[2] = {&world.dynamicShapeList, &world.staticShapeList};
+        for (int k = 0; k < 2; k++) {
+            for (size_t i = 0; i < lists[k]->size(); i++) {
+                double t;
+                if (bruteRaycastShape(*(*lists[k])[i], x0, y0, x1 - x0, y1 - y0, t)) {
+                    expected.push_back(std::make_pair(t, (*lists[k])[i]));
+                }
+            }
+        }
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const std::pair<double, Shape*>& a, const std::pair<double, Shape*>& b) { return a.first < b.first; });
+
+        hits.clear();
+        size_t count = world.raycastAll(x0, y0, x1, y1, hits);
+        totalHits += count;
+        bool same = count == expected.size();
+        for (size_t k = 0; same && k < count; k++) {
+            same = hits[k].shape == expected[k].second && hits[k].fraction == expected[k].first;
+        }
+
+        RaycastHit first;
+        bool found = world.raycast(x0, y0, x1, y1, first);
+        same = same && found == !expected.empty();
+        if (found && !expected.empty()) {
+            same = same && first.shape == expected[0].second && first.fraction == expected[0].first;
+        }
+        if (!same) allMatch = false;
+    }
+    std::cout << "  500 条随机射线，命中 " << totalHits << " 次" << std::endl;
+
+    bool ok = allMatch && totalHits > 0;
+    std::cout << "  结果: " << (ok ? "最近命中和所有命中都与逐个判断相同 ✓" : "结果不同 ✗") << std::endl;
+
+    deleteScene(world, shapes);
+    return ok;
+}
+
+// 测试5：性能
+bool test_query_performance() {
+    printSeparator();
+    std::cout << "测试5：5000 个形状上 10000 次点查询" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    std::vector<Shape*> shapes;
+    Random random(99);
+    buildScene(world, shapes, 5000, random);
+    world.update(world.dynamicShapeList, world.ground);
+
+    std::vector<double> points;
+    for (int q = 0; q < 10000; q++) {
+        points.push_back(random.next(0.0, 200.0));
+        points.push_back(random.next(0.0, 200.0));
+    }
+
+    std::vector<Shape*> found;
+    size_t spatialHits = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int q = 0; q < 10000; q++) {
+        found.clear();
+        spatialHits += world.queryPoint(points[2 * q], points[2 * q + 1], found);
+    }
+    auto mid = std::chrono::high_resolution_clock::now();
+    size_t linearHits = 0;
+    for (int q = 0; q < 10000; q++) {
+        linearHits += bruteRadius(world, points[2 * q], points[2 * q + 1], 0.0).size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double spatialMs = std::chrono::duration<double, std::milli>(mid - start).count();
+    double linearMs = std::chrono::duration<double, std::milli>(end - mid).count();
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  空间查询: " << spatialMs << " ms（命中 " << spatialHits << "）" << std::endl;
+    std::cout << "  逐个判断: " << linearMs << " ms（命中 " << linearHits << "）" << std::endl;
+    std::cout << "  加速比: " << std::setprecision(2) << linearMs / spatialMs << "x" << std::endl;
+
+    bool ok = spatialHits == linearHits && spatialMs < linearMs;
+    std::cout << "  结果: " << (ok ? "空间查询更快且结果相同 ✓" : "没有加速 ✗") << std::endl;
+
+    deleteScene(world, shapes);
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_area_queries()) passed++;
+    total++; if (test_index_refresh()) passed++;
+    total++; if (test_raycast_basic()) passed++;
+    total++; if (test_raycast_random()) passed++;
+    total++; if (test_query_performance()) passed++;
+
+    printSeparator();
+    std::cout << "空间查询测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+/*=========================================================================================================
+ * 静态形状碰撞测试 - 验证每步自动处理动态物体与静态形状的碰撞
+ *
+ * 测试场景：
+ * 1. 墙壁：飞向墙壁的圆不需要手动调用 handleWallCollision 就会被弹回
+ * 2. 静态矩形和圆：滑向静态方块的方块停在方块外，撞向静态圆的圆被弹回
+ * 3. 静态形状树：多步模拟中只建一次，placeWall 之后重建一次
+ * 4. 逐位相同：自动处理与"关闭自动处理 + 每步之后对每面墙调用 handleWallCollision"的结果完全相同
+ * 5. 性能：1000 面墙、1000 个圆，自动处理（O(n log s)）与逐个调用（O(n·s)）的单步耗时
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <chrono>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+void deleteShapes(std::vector<Shape*>& shapes) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        delete shapes[i];
+    }
+    shapes.clear();
+}
+
+// 每步之后对每个动态物体和每面墙调用 handleWallCollision（原来的用法）
+void handleWallsManually(PhysicalWorld& world) {
+    for (size_t i = 0; i < world.dynamicShapeList.size(); i++) {
+        for (size_t w = 0; w < world.staticShapeList.size(); w++) {
+            world.handleWallCollision(*world.dynamicShapeList[i], *static_cast<Wall*>(world.staticShapeList[w]));
+        }
+    }
+}
+
+// 测试1：墙壁
+bool test_wall_bounce() {
+    printSeparator();
+    std::cout << "测试1：飞向墙壁的圆（不调用 handleWallCollision）" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    world.placeWall("Wall", 5.0, 500.0, 0.2, 10.0);
+    Circle* ball = new Circle(1.0, 0.5, 0.0, 500.0, 10.0, 0.0);
+    world.addDynamicShape(ball);
+
+    size_t contacts = 0;
+    for (int step = 0; step < 60; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        contacts += world.getStaticContactCount();
+    }
+
+    double x, y, vx, vy;
+    ball->getCentre(x, y);
+    ball->getVelocity(vx, vy);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  1 秒后: x = " << x << "，vx = " << vx << "，与静态形状的碰撞次数 " << contacts << std::endl;
+
+    bool ok = x < 5.0 && vx < 0.0 && contacts > 0;
+    std::cout << "  结果: " << (ok ? "自动被墙壁弹回 ✓" : "穿过了墙壁 ✗") << std::endl;
+
+    delete ball;
+    return ok;
+}
+
+// 测试2：静态矩形和圆
+bool test_static_box_and_circle() {
+    printSeparator();
+    std::cout << "测试2：撞向静态方块和静态圆" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    AABB* block = new AABB(1.0, 2.0, 2.0, 10.0, 500.0);
+    Circle* post = new Circle(1.0, 1.0, 10.0, 520.0);
+    world.addStaticShape(block);
+    world.addStaticShape(post);
+
+    AABB* box = new AABB(1.0, 1.0, 1.0, 0.0, 500.0, 5.0, 0.0);
+    Circle* ball = new Circle(1.0, 0.5, 0.0, 520.0, 5.0, 0.0);
+    world.addDynamicShape(box);
+    world.addDynamicShape(ball);
+
+    for (int step = 0; step < 180; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+
+    double bx, by, bvx, bvy, cx, cy, cvx, cvy;
+    box->getCentre(bx, by);
+    box->getVelocity(bvx, bvy);
+    ball->getCentre(cx, cy);
+    ball->getVelocity(cvx, cvy);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  方块: x = " << bx << "，vx = " << bvx << "（静态方块左边缘 x = 9）" << std::endl;
+    std::cout << "  圆:   x = " << cx << "，vx = " << cvx << "（静态圆左边缘 x = 9）" << std::endl;
+
+    bool ok = bx < 9.0 && bvx <= 0.0 && cx < 9.0 && cvx < 0.0;
+    std::cout << "  结果: " << (ok ? "静态矩形和圆都挡住了动态物体 ✓" : "穿过了静态形状 ✗") << std::endl;
+
+    delete box;
+    delete ball;
+    delete block;
+    delete post;
+    return ok;
+}
+
+// 测试3：静态形状树
+bool test_tree_built_once() {
+    printSeparator();
+    std::cout << "测试3：静态形状树只在静态形状修改后重建" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world;
+    world.setGravity(0.0);
+    for (int w = 0; w < 100; w++) {
+        world.placeWall("Wall" + std::to_string(w), w * 10.0, 500.0, 0.2, 4.0);
+    }
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < 50; i++) {
+        Circle* ball = new Circle(1.0, 0.5, i * 20.0 + 5.0, 500.0, (i % 2 == 0) ? 6.0 : -6.0, 0.0);
+        shapes.push_back(ball);
+        world.addDynamicShape(ball);
+    }
+
+    for (int step = 0; step < 120; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    size_t buildsAfterSteps = world.getStaticTreeBuildCount();
+
+    world.placeWall("Extra", -100.0, 500.0, 0.2, 4.0);
+    for (int step = 0; step < 120; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+    }
+    size_t buildsAfterEdit = world.getStaticTreeBuildCount();
+
+    std::cout << "  重建次数: 120 步后 " << buildsAfterSteps << "，placeWall 后再 120 步 " << buildsAfterEdit << std::endl;
+
+    bool ok = buildsAfterSteps == 1 && buildsAfterEdit == 2;
+    std::cout << "  结果: " << (ok ? "只建一次，修改后重建一次 ✓" : "重建次数错误 ✗") << std::endl;
+
+    deleteShapes(shapes);
+    return ok;
+}
+
+// 测试场景：rows × columns 格子中每格一面短墙，每格一个斜向运动的圆
+void buildWallGrid(PhysicalWorld& world, std::vector<Shape*>& shapes, int rows, int columns) {
+    world.setGravity(0.0);
+    world.setBounds(-10000.0, 10000.0, -10000.0, 10000.0);
+    world.setSleepingEnabled(false);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < columns; c++) {
+            double x = c * 10.0, y = r * 10.0;
+            world.placeWall("Wall" + std::to_string(r * columns + c), x + 5.0, y + 5.0, 0.5, 6.0);
+            double vx = ((r + c) % 2 == 0) ? 4.0 : -3.0;
+            double vy = ((r * 7 + c) % 3) - 1.0;
+            Circle* ball = new Circle(1.0, 0.5, x + 2.0, y + 5.0, vx, vy);
+            shapes.push_back(ball);
+            world.addDynamicShape(ball);
+        }
+    }
+}
+
+std::vector<double> runWallGrid(bool automatic, int rows, int columns, int steps, size_t& contacts) {
+    PhysicalWorld world;
+    std::vector<Shape*> shapes;
+    buildWallGrid(world, shapes, rows, columns);
+    world.setStaticCollisions(automatic);
+
+    contacts = 0;
+    for (int step = 0; step < steps; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        if (automatic) {
+            contacts += world.getStaticContactCount();
+        } else {
+            handleWallsManually(world);
+        }
+    }
+
+    std::vector<double> state;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double x, y, vx, vy;
+        shapes[i]->getCentre(x, y);
+        shapes[i]->getVelocity(vx, vy);
+        state.push_back(x);
+        state.push_back(y);
+        state.push_back(vx);
+        state.push_back(vy);
+    }
+    deleteShapes(shapes);
+    return state;
+}
+
+// 测试4：逐位相同
+bool test_matches_manual_loop() {
+    printSeparator();
+    std::cout << "测试4：自动处理与每步之后逐个调用 handleWallCollision 的结果相同" << std::endl;
+    printSeparator();
+
+    size_t contacts = 0, unused = 0;
+    std::vector<double> automatic = runWallGrid(true, 10, 10, 240, contacts);
+    std::vector<double> manual = runWallGrid(false, 10, 10, 240, unused);
+    std::cout << "  100 面墙、100 个圆，240 步，与静态形状的碰撞次数: " << contacts << std::endl;
+
+    bool ok = automatic == manual && contacts > 0;
+    std::cout << "  结果: " << (ok ? "逐位相同 ✓" : "结果不同 ✗") << std::endl;
+    return ok;
+}
+
+// 测试5：性能
+double timeWallGrid(bool automatic, int rows, int columns) {
+    PhysicalWorld world;
+    std::vector<Shape*> shapes;
+    buildWallGrid(world, shapes, rows, columns);
+    world.setStaticCollisions(automatic);
+
+    const int steps = 30;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < steps; step++) {
+        world.update(world.dynamicShapeList, world.ground);
+        if (!automatic) handleWallsManually(world);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    deleteShapes(shapes);
+    return std::chrono::duration<double, std::milli>(end - start).count() / steps;
+}
+
+bool test_performance() {
+    printSeparator();
+    std::cout << "测试5：1000 面墙、1000 个圆的单步耗时" << std::endl;
+    printSeparator();
+
+    double manual = timeWallGrid(false, 25, 40);
+    double automatic = timeWallGrid(true, 25, 40);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  逐个调用 handleWallCollision: " << manual << " ms/步" << std::endl;
+    std::cout << "  自动处理（静态形状树）:       " << automatic << " ms/步" << std::endl;
+    std::cout << "  加速比: " << std::setprecision(2) << manual / automatic << "x" << std::endl;
+
+    bool ok = automatic < manual;
+    std::cout << "  结果: " << (ok ? "自动处理更快 ✓" : "没有加速 ✗") << std::endl;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_wall_bounce()) passed++;
+    total++; if (test_static_box_and_circle()) passed++;
+    total++; if (test_tree_built_once()) passed++;
+    total++; if (test_matches_manual_loop()) passed++;
+    total++; if (test_performance()) passed++;
+
+    printSeparator();
+    std::cout << "静态形状碰撞测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}
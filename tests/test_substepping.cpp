@@ -0,0 +1,261 @@
+/*=========================================================================================================
+ * 自适应子步测试 - 验证 update() 按速度和穿透深度选择子步数
+ *
+ * 测试场景：
+ * 1. 平静的场景：每帧只走一步，结果与关闭自适应子步时逐位相同
+ * 2. 高速物体：子步数随速度与尺寸之比增加，不超过 maxSubsteps
+ * 3. 穿透：速度估计只需要一步的正面碰撞，出现较深的穿透后，之后的子步（下一帧）增加子步数，分开后恢复一步
+ * 4. 开销：间歇剧烈的场景中与"每帧一步""每帧固定 8 步"比较子步总数、耗时和最大穿透深度
+ *=========================================================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include "physicalWorld.h"
+#include "shapes.h"
+
+void printSeparator(char c = '=', int length = 80) {
+    std::cout << std::string(length, c) << std::endl;
+}
+
+// 测试1：平静的场景
+bool test_quiet_scene() {
+    printSeparator();
+    std::cout << "测试1：平静的场景（慢速滚动的球和静止在地面上的方块）" << std::endl;
+    printSeparator();
+
+    PhysicalWorld fixed, adaptive;
+    adaptive.setAdaptiveSubstepping(true);
+    PhysicalWorld* worlds[] = {&fixed, &adaptive};
+    for (int w = 0; w < 2; w++) {
+        for (int i = 0; i < 50; i++) {
+            Shape* ball = worlds[w]->allocateShape<Circle>(1.0, 0.5, i * 3.0, 0.5, 0.5, 0.0);
+            worlds[w]->addDynamicShape(ball);
+        }
+        for (int i = 0; i < 20; i++) {
+            Shape* block = worlds[w]->allocateShape<AABB>(2.0, 1.0, 1.0, 200.0 + i * 3.0, 0.5);
+            worlds[w]->addDynamicShape(block);
+        }
+        worlds[w]->start();
+    }
+
+    int maxCount = 0;
+    for (int step = 0; step < 300; step++) {
+        fixed.update(fixed.dynamicShapeList, fixed.ground);
+        adaptive.update(adaptive.dynamicShapeList, adaptive.ground);
+        maxCount = std::max(maxCount, adaptive.getSubstepCount());
+    }
+    bool identical = true;
+    for (size_t i = 0; i < fixed.dynamicShapeList.size(); i++) {
+        double x, y, vx, vy, ax, ay, avx, avy;
+        fixed.dynamicShapeList[i]->getCentre(x, y);
+        fixed.dynamicShapeList[i]->getVelocity(vx, vy);
+        adaptive.dynamicShapeList[i]->getCentre(ax, ay);
+        adaptive.dynamicShapeList[i]->getVelocity(avx, avy);
+        identical = identical && x == ax && y == ay && vx == avx && vy == avy;
+    }
+    std::cout << "  300 帧中最多的子步数: " << maxCount << std::endl;
+    std::cout << "  与关闭自适应子步的世界: " << (identical ? "逐位相同" : "结果不同") << std::endl;
+
+    bool ok = maxCount == 1 && identical;
+    std::cout << "  结果: " << (ok ? "平静的场景每帧一步 ✓" : "平静的场景走了多步 ✗") << std::endl;
+    return ok;
+}
+
+// 测试2：高速物体
+bool test_fast_bodies() {
+    printSeparator();
+    std::cout << "测试2：半径 0.5 m 的球以不同速度飞行（dt = 1/60 s，位移上限为 0.5 倍半径）" << std::endl;
+    printSeparator();
+
+    const double speeds[] = {10.0, 30.0, 60.0, 120.0, 600.0};
+    const int expected[] = {1, 2, 4, 8, 8};   // ceil(v / 0.5 / 60 / 0.5)，上限 8
+    bool ok = true;
+    for (int s = 0; s < 5; s++) {
+        PhysicalWorld world(-100000.0, 100000.0, -100000.0, 100000.0);
+        world.setGravity(0.0);
+        world.setAdaptiveSubstepping(true);
+        world.ground.setYLevel(-100000.0);
+        Shape* ball = world.allocateShape<Circle>(1.0, 0.5, 0.0, 0.0, speeds[s], 0.0);
+        world.addDynamicShape(ball);
+        world.start();
+        world.update(world.dynamicShapeList, world.ground);
+
+        double x, y;
+        ball->getCentre(x, y);
+        bool distance = std::abs(x - speeds[s] / 60.0) < 1e-9;
+        std::cout << std::fixed << std::setprecision(1) << "  " << std::setw(6) << speeds[s] << " m/s: "
+                  << world.getSubstepCount() << " 个子步（预期 " << expected[s] << "），一帧位移 " << std::setprecision(4) << x
+                  << " m" << std::endl;
+        ok = ok && world.getSubstepCount() == expected[s] && distance;
+    }
+
+    // 预算
+    PhysicalWorld capped(-100000.0, 100000.0, -100000.0, 100000.0);
+    capped.setGravity(0.0);
+    capped.setAdaptiveSubstepping(true);
+    capped.setMaxSubsteps(3);
+    capped.ground.setYLevel(-100000.0);
+    capped.addDynamicShape(capped.allocateShape<Circle>(1.0, 0.5, 0.0, 0.0, 600.0, 0.0));
+    capped.start();
+    capped.update(capped.dynamicShapeList, capped.ground);
+    std::cout << "  maxSubsteps = 3 时 600 m/s: " << capped.getSubstepCount() << " 个子步" << std::endl;
+
+    ok = ok && capped.getSubstepCount() == 3;
+    std::cout << "  结果: " << (ok ? "子步数随速度增加，不超过预算 ✓" : "子步数错误 ✗") << std::endl;
+    return ok;
+}
+
+// 测试3：穿透
+bool test_penetration() {
+    printSeparator();
+    std::cout << "测试3：两个半径 1 m 的球以 ±25 m/s 正面相撞" << std::endl;
+    printSeparator();
+
+    PhysicalWorld world(-1000.0, 1000.0, -1000.0, 1000.0);
+    world.setGravity(0.0);
+    world.setAdaptiveSubstepping(true);
+    world.setContinuousCollision(false);
+    world.ground.setYLevel(-1000.0);
+    Shape* left = world.allocateShape<Circle>(1.0, 1.0, -10.0, 0.0, 25.0, 0.0);
+    Shape* right = world.allocateShape<Circle>(1.0, 1.0, 10.0, 0.0, -25.0, 0.0);
+    world.addDynamicShape(left);
+    world.addDynamicShape(right);
+    world.start();
+
+    // 速度与尺寸之比 25 / 1 × (1/60) / 0.5 < 1，只按速度估计时每帧一步
+    int collisionFrame = -1, maxCount = 0;
+    double collisionDepth = 0.0;
+    std::vector<int> counts;
+    for (int frame = 0; frame < 40; frame++) {
+        world.update(world.dynamicShapeList, world.ground);
+        counts.push_back(world.getSubstepCount());
+        maxCount = std::max(maxCount, world.getSubstepCount());
+        double vx, vy;
+        left->getVelocity(vx, vy);
+        if (collisionFrame < 0 && vx < 0.0) {
+            collisionFrame = frame;
+        }
+    }
+    // 同样的场景，关闭自适应子步时碰撞那一步的穿透深度
+    PhysicalWorld single(-1000.0, 1000.0, -1000.0, 1000.0);
+    single.setGravity(0.0);
+    single.setContinuousCollision(false);
+    single.ground.setYLevel(-1000.0);
+    single.addDynamicShape(single.allocateShape<Circle>(1.0, 1.0, -10.0, 0.0, 25.0, 0.0));
+    single.addDynamicShape(single.allocateShape<Circle>(1.0, 1.0, 10.0, 0.0, -25.0, 0.0));
+    single.start();
+    for (int frame = 0; frame < 40; frame++) {
+        single.update(single.dynamicShapeList, single.ground);
+        collisionDepth = std::max(collisionDepth, single.getWorstPenetration());
+    }
+
+    std::cout << "  每帧子步数: ";
+    for (size_t i = 0; i < counts.size(); i++) std::cout << counts[i];
+    std::cout << std::endl;
+    int afterCount = (collisionFrame >= 0 && collisionFrame + 1 < 40) ? counts[collisionFrame + 1] : 0;
+    std::cout << "  碰撞发生在第 " << collisionFrame << " 帧，下一帧 " << afterCount << " 个子步；"
+              << "关闭自适应子步时碰撞的穿透深度 " << std::fixed << std::setprecision(3) << collisionDepth << " m" << std::endl;
+
+    // 穿透只能在发生之后测量：碰撞所在的子步无法回退，之后的子步按穿透深度增加
+    bool ok = collisionFrame >= 0 && collisionDepth > world.getSubstepPenetrationLimit() && afterCount > 1
+              && counts.front() == 1 && counts.back() == 1;
+    std::cout << "  结果: " << (ok ? "只在碰撞时增加子步 ✓" : "子步数没有随穿透增加 ✗") << std::endl;
+    return ok;
+}
+
+// 间歇剧烈的场景：小球先落到地面上，第 60、180 帧获得很大的速度（爆炸），分别在 40 帧、20 帧之后被停下
+struct SceneResult {
+    long long substeps;
+    double maxPenetration;
+    double ms;
+};
+
+SceneResult runViolentScene(int mode) {
+    // mode 0：每帧一步；mode 1：每帧固定 8 个子步；mode 2：自适应子步（预算 8）
+    PhysicalWorld world(-50.0, 50.0, -10.0, 100.0);
+    world.setContinuousCollision(false);
+    world.setSleepingEnabled(false);
+    world.ground.setYLevel(0.0);
+    if (mode == 2) {
+        world.setAdaptiveSubstepping(true);
+        world.setMaxSubsteps(8);
+    }
+    std::vector<Shape*> balls;
+    for (int i = 0; i < 200; i++) {
+        Shape* ball = world.allocateShape<Circle>(1.0, 0.4, -40.0 + (i % 40) * 2.0, 0.4 + (i / 40) * 2.0);
+        world.addDynamicShape(ball);
+        balls.push_back(ball);
+    }
+    world.start();
+
+    SceneResult result = {0, 0.0, 0.0};
+    const double dt = 1.0 / 60.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < 300; frame++) {
+        if (frame == 60 || frame == 180) {
+            for (size_t i = 0; i < balls.size(); i++) {
+                balls[i]->setVelocity(std::cos(i * 2.3) * 40.0, 20.0 + std::sin(i * 1.7) * 20.0);
+            }
+        }
+        if (frame == 100 || frame == 200) {
+            for (size_t i = 0; i < balls.size(); i++) {
+                balls[i]->setVelocity(0.0, 0.0);
+            }
+        }
+        if (mode == 1) {
+            for (int s = 0; s < 8; s++) {
+                world.update(world.dynamicShapeList, dt / 8.0, world.ground);
+                result.maxPenetration = std::max(result.maxPenetration, world.getWorstPenetration());
+            }
+            result.substeps += 8;
+        } else {
+            world.update(world.dynamicShapeList, world.ground);
+            result.maxPenetration = std::max(result.maxPenetration, world.getWorstPenetration());
+            result.substeps += world.getSubstepCount();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
+
+// 测试4：开销
+bool test_cost() {
+    printSeparator();
+    std::cout << "测试4：200 个小球，第 60-99、180-199 帧高速运动，共 300 帧" << std::endl;
+    printSeparator();
+
+    const char* names[] = {"每帧一步", "每帧固定 8 步", "自适应（最多 8 步）"};
+    SceneResult results[3];
+    for (int mode = 0; mode < 3; mode++) {
+        results[mode] = runViolentScene(mode);
+        std::cout << std::fixed << std::setprecision(3) << "  " << std::left << std::setw(22) << names[mode]
+                  << "子步 " << std::setw(8) << results[mode].substeps << "耗时 " << std::setw(10) << results[mode].ms
+                  << "ms  最大穿透 " << results[mode].maxPenetration << " m" << std::endl;
+    }
+
+    // 自适应子步的总步数明显少于固定 8 步，最大穿透深度明显小于每帧一步
+    bool ok = results[2].substeps < results[1].substeps / 2 && results[2].substeps > results[0].substeps
+              && results[2].maxPenetration < results[0].maxPenetration;
+    std::cout << "  结果: " << (ok ? "只在剧烈的帧多走子步 ✓" : "子步分配不合理 ✗") << std::endl;
+    return ok;
+}
+
+int main() {
+    int passed = 0;
+    int total = 0;
+
+    total++; if (test_quiet_scene()) passed++;
+    total++; if (test_fast_bodies()) passed++;
+    total++; if (test_penetration()) passed++;
+    total++; if (test_cost()) passed++;
+
+    printSeparator();
+    std::cout << "自适应子步测试完成: " << passed << "/" << total << " 通过" << std::endl;
+    printSeparator();
+    return passed == total ? 0 : 1;
+}